@@ -1,6 +1,8 @@
 #include "application.h"
 #include "board.h"
 #include "display.h"
+#include "lvgl_display.h"
+#include "screen_streamer.h"
 #include "system_info.h"
 #include "audio_codec.h"
 #include "mqtt_protocol.h"
@@ -10,15 +12,16 @@
 #include "assets.h"
 #include "settings.h"
 #include "web_server/web_server.h"
+#include "emotion_table.h"
 
 #include <cstring>
+#include <cstdlib>
 #include <esp_log.h>
 #include <cJSON.h>
 #include <driver/ledc.h>
 #include <driver/gpio.h>
 #include <arpa/inet.h>
 #include <font_awesome.h>
-#include <tuple>
 
 #define TAG "Application"
 // 包含板级引脚配置（由选定的 board 提供的 config.h）
@@ -46,7 +49,7 @@
 // - 主事件循环（处理定时、网络、音频、状态变化等）
 // - 协议初始化与消息处理（MQTT/WebSocket）
 // - 将服务器下发的情绪（emotion）映射为电机动作并调度执行
-// 注：电机动作通过消息队列发送到 `MotorControlTask` 在单独任务中执行，避免阻塞主循环。
+// 注：电机动作由 `MotorScheduler` 按优先级时间线执行（esp_timer 驱动），避免阻塞主循环。
 
 // Motor control functions - only available on qebabe-xiaoche board
 // These are declared as weak externs and will be resolved at link time
@@ -54,27 +57,21 @@ extern "C" void HandleMotorActionForEmotion(const char* emotion) __attribute__((
 extern "C" void (*HandleMotorActionForEmotionPtr)(const char* emotion) __attribute__((weak));
 extern "C" void (*HandleMotorIdleActionPtr)(void) __attribute__((weak));
 
-// Motor action queue for sequential execution
-#include <queue>
-#include <mutex>
-struct MotorAction {
-    int direction;
-    int speed;
-    int duration_ms;
-    std::string description;
-};
-
-static std::queue<MotorAction> motor_action_queue_;
-static std::mutex motor_queue_mutex_;
-static volatile bool motor_executor_running_ = false;
-
 // Motor control task (deprecated - now using global functions)
 
 // Motor action flags for state-based actions
 
 
-Application::Application() {
+Application::Application() : motor_scheduler_([this](int direction, int speed, ChoreoEasing easing) {
+        if (direction == 0 || speed == 0) {
+            StopRealtimeMotorControl(easing);
+        } else {
+            SetRealtimeMotorCommand(direction, speed, easing);
+        }
+    }) {
     event_group_ = xEventGroupCreate();
+    // Built-in routines until the assets partition provides its own
+    choreography_.LoadBuiltin();
 
     // 构造函数说明（中文）：
     // 创建事件组、定时器等基础资源。实际的电机队列和任务在 Initialize() 中创建，
@@ -159,6 +156,8 @@ void Application::Initialize() {
         xEventGroupSetBits(event_group_, MAIN_EVENT_SEND_AUDIO);
     };
     callbacks.on_wake_word_detected = [this](const std::string& wake_word) {
+        // Start connecting right away, the main loop joins the attempt in HandleWakeWordDetectedEvent()
+        PreconnectAudioChannel();
         xEventGroupSetBits(event_group_, MAIN_EVENT_WAKE_WORD_DETECTED);
     };
     callbacks.on_vad_change = [this](bool speaking) {
@@ -289,88 +288,169 @@ void Application::Run() {
         MAIN_EVENT_ACTIVATION_DONE |
         MAIN_EVENT_STATE_CHANGED;
 
+    // Handlers run in three lanes: queued audio first, then control events, then bulk work
+    // (scheduled tasks and the clock tick). Queued audio is also serviced between control
+    // handlers and between scheduled tasks, so it never waits behind a long batch.
+    auto timed = [this](MainLoopHandler handler, auto&& callback) {
+        int64_t start_time = esp_timer_get_time();
+        callback();
+        loop_stats_.Record(handler, esp_timer_get_time() - start_time);
+        ServicePendingAudio();
+    };
+
     while (true) {
         auto bits = xEventGroupWaitBits(event_group_, ALL_EVENTS, pdTRUE, pdFALSE, portMAX_DELAY);
 
+        // Audio lane
+        if (bits & MAIN_EVENT_SEND_AUDIO) {
+            int64_t start_time = esp_timer_get_time();
+            SendQueuedAudio();
+            loop_stats_.Record(kMainHandlerSendAudio, esp_timer_get_time() - start_time);
+        }
+
+        // Control lane
         if (bits & MAIN_EVENT_ERROR) {
-            SetDeviceState(kDeviceStateIdle);
-            Alert(Lang::Strings::ERROR, last_error_message_.c_str(), "circle_xmark", Lang::Sounds::OGG_EXCLAMATION);
+            timed(kMainHandlerError, [this]() {
+                SetDeviceState(kDeviceStateIdle);
+                Alert(Lang::Strings::ERROR, last_error_message_.c_str(), "circle_xmark", Lang::Sounds::OGG_EXCLAMATION);
+            });
         }
 
         if (bits & MAIN_EVENT_NETWORK_CONNECTED) {
-            HandleNetworkConnectedEvent();
+            timed(kMainHandlerNetwork, [this]() { HandleNetworkConnectedEvent(); });
         }
 
         if (bits & MAIN_EVENT_NETWORK_DISCONNECTED) {
-            HandleNetworkDisconnectedEvent();
+            timed(kMainHandlerNetwork, [this]() { HandleNetworkDisconnectedEvent(); });
         }
 
         if (bits & MAIN_EVENT_ACTIVATION_DONE) {
-            HandleActivationDoneEvent();
+            timed(kMainHandlerActivationDone, [this]() { HandleActivationDoneEvent(); });
         }
 
         if (bits & MAIN_EVENT_STATE_CHANGED) {
-            HandleStateChangedEvent();
+            timed(kMainHandlerStateChanged, [this]() { HandleStateChangedEvent(); });
         }
 
         if (bits & MAIN_EVENT_TOGGLE_CHAT) {
-            HandleToggleChatEvent();
+            timed(kMainHandlerToggleChat, [this]() { HandleToggleChatEvent(); });
         }
 
         if (bits & MAIN_EVENT_START_LISTENING) {
-            HandleStartListeningEvent();
+            timed(kMainHandlerListening, [this]() { HandleStartListeningEvent(); });
         }
 
         if (bits & MAIN_EVENT_STOP_LISTENING) {
-            HandleStopListeningEvent();
-        }
-
-        if (bits & MAIN_EVENT_SEND_AUDIO) {
-            while (auto packet = audio_service_.PopPacketFromSendQueue()) {
-                if (protocol_ && !protocol_->SendAudio(std::move(packet))) {
-                    break;
-                }
-            }
+            timed(kMainHandlerListening, [this]() { HandleStopListeningEvent(); });
         }
 
         if (bits & MAIN_EVENT_WAKE_WORD_DETECTED) {
-            HandleWakeWordDetectedEvent();
+            timed(kMainHandlerWakeWord, [this]() { HandleWakeWordDetectedEvent(); });
         }
 
         if (bits & MAIN_EVENT_VAD_CHANGE) {
-            if (GetDeviceState() == kDeviceStateListening) {
-                auto led = Board::GetInstance().GetLed();
-                led->OnStateChanged();
-            }
+            timed(kMainHandlerVadChange, [this]() {
+                if (GetDeviceState() == kDeviceStateListening) {
+                    auto led = Board::GetInstance().GetLed();
+                    led->OnStateChanged();
+                }
+            });
         }
 
+        // Bulk lane
         if (bits & MAIN_EVENT_SCHEDULE) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            auto tasks = std::move(main_tasks_);
-            lock.unlock();
-            for (auto& task : tasks) {
-                task();
-            }
+            int64_t start_time = esp_timer_get_time();
+            main_tasks_.RunPending([this, &start_time]() {
+                int64_t now = esp_timer_get_time();
+                loop_stats_.Record(kMainHandlerScheduledTask, now - start_time);
+                if (ServicePendingAudio()) {
+                    loop_stats_.RecordAudioPreemption();
+                }
+                start_time = esp_timer_get_time();
+            });
         }
 
         if (bits & MAIN_EVENT_CLOCK_TICK) {
-            clock_ticks_++;
-            auto display = Board::GetInstance().GetDisplay();
-            display->UpdateStatusBar();
+            timed(kMainHandlerClockTick, [this]() { HandleClockTickEvent(); });
+        }
+    }
+}
 
-            // Update animated emotion if enabled
-            display->UpdateAnimatedEmotion();
+void Application::SendQueuedAudio() {
+    while (auto packet = audio_service_.PopPacketFromSendQueue()) {
+        if (protocol_ && !protocol_->SendAudio(std::move(packet))) {
+            break;
+        }
+        OnUplinkPacketSent();
+    }
+}
 
-            // Handle motor idle actions (only on boards that support it)
-            // Use separate motor control task to avoid stability issues
-            // Trigger motor control every 30 seconds to reduce frequency
-            // Removed old motor control task trigger - now using unified PWM system
+bool Application::ServicePendingAudio() {
+    if ((xEventGroupGetBits(event_group_) & MAIN_EVENT_SEND_AUDIO) == 0) {
+        return false;
+    }
+    xEventGroupClearBits(event_group_, MAIN_EVENT_SEND_AUDIO);
+    loop_stats_.RecordAudioWait();
+    int64_t start_time = esp_timer_get_time();
+    SendQueuedAudio();
+    loop_stats_.Record(kMainHandlerSendAudio, esp_timer_get_time() - start_time);
+    return true;
+}
 
-            // Motor feedback is now handled in HandleStateChangedEvent() to avoid duplication
-            // Print debug info every 10 seconds
-            if (clock_ticks_ % 10 == 0) {
-                SystemInfo::PrintHeapStats();
-            }
+void Application::HandleClockTickEvent() {
+    clock_ticks_++;
+    auto display = Board::GetInstance().GetDisplay();
+    display->UpdateStatusBar();
+
+    // Update animated emotion if enabled
+    display->UpdateAnimatedEmotion();
+
+    // Ping or release an audio channel kept warm after the last conversation
+    if (protocol_) {
+        protocol_->CheckKeepWarm();
+        protocol_->ProbeLink();
+    }
+
+    // Handle motor idle actions (only on boards that support it)
+    // Use separate motor control task to avoid stability issues
+    // Trigger motor control every 30 seconds to reduce frequency
+    // Removed old motor control task trigger - now using unified PWM system
+
+    // Motor feedback is now handled in HandleStateChangedEvent() to avoid duplication
+    // Print debug info every 10 seconds
+    if (clock_ticks_ % 10 == 0) {
+        SystemInfo::PrintHeapStats();
+        auto tasks = main_tasks_.GetStats();
+        uint32_t overflows = tasks.overflow_full + tasks.overflow_oversize;
+        if (overflows != last_task_overflows_) {
+            last_task_overflows_ = overflows;
+            ESP_LOGW(TAG, "Scheduled tasks: %lu pushed, %lu queue full, %lu oversized captures",
+                tasks.pushed, tasks.overflow_full, tasks.overflow_oversize);
+        }
+        auto states = state_machine_.GetStats();
+        if (states.transitions != last_state_transitions_) {
+            last_state_transitions_ = states.transitions;
+            ESP_LOGI(TAG, "State transitions: %lu, notify avg %lldus max %lldus, async delay max %lldus, dropped %lu",
+                states.transitions, states.notify_total_us / states.transitions, states.notify_max_us,
+                states.async_max_delay_us, states.async_dropped);
+        }
+        auto cues = audio_service_.GetPlaybackCueStats();
+        if (cues.cues != last_playback_cues_) {
+            last_playback_cues_ = cues.cues;
+            ESP_LOGI(TAG, "Playback cues: %lu, %lu waited for audio (max %lldms), %lu expired",
+                cues.cues, cues.deferred, cues.max_wait_us / 1000, cues.expired);
+        }
+        auto motors = motor_scheduler_.GetStats();
+        if (motors.started != last_motor_actions_) {
+            last_motor_actions_ = motors.started;
+            ESP_LOGI(TAG, "Motor timeline: %lu actions, %lu routine keyframes, %lu preempted, max start lag %lldus",
+                motors.started, motors.keyframes, motors.preempted, motors.max_start_lag_us);
+        }
+        if (protocol_ && protocol_->IsAudioChannelOpened()) {
+            auto link = protocol_->GetLinkStats();
+            ESP_LOGD(TAG, "Link: rtt=%dms (min %dms) jitter=%dms audio lost %lu/%lu probes lost %lu/%lu",
+                link.rtt_ms, link.rtt_min_ms, link.jitter_ms, link.audio_lost, link.audio_received,
+                link.probes_lost, link.probes_sent);
         }
     }
 }
@@ -438,6 +518,7 @@ void Application::HandleActivationDoneEvent() {
     web_server_->SetMotorControlCallback([this](int direction, int speed) {
         HandleWebMotorControl(direction, speed);
     });
+    web_server_->SetControlTickMs(MOTION_TICK_MS);
 
     // Set emotion callback for web interface
     web_server_->SetEmotionCallback([](const char* emotion) {
@@ -445,6 +526,37 @@ void Application::HandleActivationDoneEvent() {
         display->SetEmotion(emotion);
     });
 
+    web_server_->SetMainLoopStatsCallback([this]() {
+        return loop_stats_.ToJson();
+    });
+
+    web_server_->SetTelemetryCallback([this](TelemetrySnapshot& snapshot) {
+        telemetry_sampler_.Sample(snapshot);
+        auto queues = audio_service_.GetQueueDepths();
+        snapshot.decode_queue = queues.decode;
+        snapshot.send_queue = queues.send;
+        snapshot.encode_queue = queues.encode;
+        snapshot.playback_queue = queues.playback;
+        loop_stats_.TakeWindowMax(snapshot.handler_max_us);
+
+        LinkStats link;
+        if (GetLinkStats(link)) {
+            snapshot.rtt_ms = link.rtt_ms;
+            snapshot.jitter_ms = link.jitter_ms;
+            snapshot.audio_lost = link.audio_lost;
+        } else {
+            snapshot.rtt_ms = -1;
+        }
+    });
+
+    web_server_->SetAudioTap(&audio_service_.GetAudioTap());
+
+    auto lvgl_display = dynamic_cast<LvglDisplay*>(board.GetDisplay());
+    if (lvgl_display != nullptr) {
+        screen_streamer_ = std::make_unique<ScreenStreamer>(lvgl_display);
+        web_server_->SetScreenStreamer(screen_streamer_.get());
+    }
+
     // Set motor action config callbacks for web interface
     web_server_->SetMotorActionConfigCallback(
         [this]() -> WebServer::MotorActionConfig {
@@ -542,6 +654,13 @@ void Application::CheckAssetsVersion() {
         board.SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
         display->SetChatMessage("system", Lang::Strings::PLEASE_WAIT);
 
+        // The download unmaps the partition, so no routine may keep playing from it
+        {
+            std::lock_guard<std::mutex> lock(choreography_mutex_);
+            motor_scheduler_.Stop();
+            choreography_.LoadBuiltin();
+        }
+
         bool success = assets.Download(download_url, [display](int progress, size_t speed) -> void {
             std::thread([display, progress, speed]() {
                 char buffer[32];
@@ -563,6 +682,7 @@ void Application::CheckAssetsVersion() {
 
     // Apply assets
     assets.Apply();
+    LoadChoreography();
     display->SetChatMessage("system", "");
     display->SetEmotion("microchip_ai");
 }
@@ -700,186 +820,56 @@ void Application::InitializeProtocol() {
     // - mcp: MCP 协议消息
     // - system: 系统命令（例如 reboot）
     // - alert: 弹出通知（包含 status/message/emotion）
+    // 高频消息 (tts / stt / llm) 以 ControlMessage 到达：来自二进制控制帧，或由协议层直接从
+    // 接收缓冲区扫描 JSON 得到；协议层无法处理的（如过长的文本）再经 cJSON 转换后交给同一个 HandleControlMessage
+    protocol_->OnIncomingControl([this](const ControlMessage& message) {
+        HandleControlMessage(message);
+    });
+
     protocol_->OnIncomingJson([this, display](const cJSON* root) {
-        // 将收到的原始 JSON 打印到串口，便于调试
-        char* json_str = cJSON_PrintUnformatted(root);
-        if (json_str != nullptr) {
-            ESP_LOGI(TAG, "Received JSON message: %s", json_str);
-            cJSON_free(json_str);
+        // 将收到的原始 JSON 打印到串口，便于调试（仅在 Debug 日志级别下序列化）
+        if (esp_log_level_get(TAG) >= ESP_LOG_DEBUG) {
+            char* json_str = cJSON_PrintUnformatted(root);
+            if (json_str != nullptr) {
+                ESP_LOGD(TAG, "Received JSON message: %s", json_str);
+                cJSON_free(json_str);
+            }
         }
 
         // 开始解析 JSON 字段 type 并分发处理逻辑
         auto type = cJSON_GetObjectItem(root, "type");
         if (strcmp(type->valuestring, "tts") == 0) {
             auto state = cJSON_GetObjectItem(root, "state");
+            ControlMessage message;
             if (strcmp(state->valuestring, "start") == 0) {
-                Schedule([this]() {
-                    aborted_ = false;
-                    SetDeviceState(kDeviceStateSpeaking);
-                });
+                message.opcode = kControlTtsStart;
             } else if (strcmp(state->valuestring, "stop") == 0) {
-                Schedule([this]() {
-                    if (GetDeviceState() == kDeviceStateSpeaking) {
-                        if (listening_mode_ == kListeningModeManualStop) {
-                            SetDeviceState(kDeviceStateIdle);
-                        } else {
-                            SetDeviceState(kDeviceStateListening);
-                        }
-                    }
-                });
+                message.opcode = kControlTtsStop;
             } else if (strcmp(state->valuestring, "sentence_start") == 0) {
                 auto text = cJSON_GetObjectItem(root, "text");
-                if (cJSON_IsString(text)) {
-                    ESP_LOGI(TAG, "<< %s", text->valuestring);
-                Schedule([display, message = std::string(text->valuestring)]() {
-                    // 在动画表情模式下不显示聊天消息
-                    if (!display->IsAnimatedEmotionMode()) {
-                        display->SetChatMessage("assistant", message.c_str());
-                    }
-                });
+                if (!cJSON_IsString(text)) {
+                    return;
                 }
+                message.opcode = kControlTtsSentence;
+                message.text = text->valuestring;
+            } else {
+                return;
             }
+            HandleControlMessage(message);
         } else if (strcmp(type->valuestring, "stt") == 0) {
             auto text = cJSON_GetObjectItem(root, "text");
             if (cJSON_IsString(text)) {
-                std::string message = std::string(text->valuestring);
-                ESP_LOGI(TAG, ">> %s", message.c_str());
-
-                // 检查是否是显示模式切换命令
-                bool is_display_mode_command = false;
-                if (message.find("切换模式") != std::string::npos ||
-                    message.find("切换显示") != std::string::npos ||
-                    message.find("眼睛模式") != std::string::npos ||
-                    message.find("默认模式") != std::string::npos ||
-                    message.find("文字模式") != std::string::npos ||
-                    message.find("change mode") != std::string::npos ||
-                    message.find("eye mode") != std::string::npos ||
-                    message.find("text mode") != std::string::npos) {
-                    is_display_mode_command = true;
-                    ESP_LOGI(TAG, "Detected display mode toggle command");
-                    Schedule([this]() {
-                        ToggleDisplayMode();
-                    });
-                }
-
-                Schedule([this, display, message, is_command = is_display_mode_command]() {
-                    // 在眼睛模式或命令模式下不显示聊天消息
-                    if (display_mode_ != kDisplayModeEyeOnly && !is_command) {
-                        display->SetChatMessage("user", message.c_str());
-                    }
-                });
+                HandleControlMessage(ControlMessage{kControlStt, 0, text->valuestring});
             }
         } else if (strcmp(type->valuestring, "llm") == 0) {
             auto emotion = cJSON_GetObjectItem(root, "emotion");
             if (cJSON_IsString(emotion)) {
-                std::string emotion_str = std::string(emotion->valuestring);
-
-                // 更新显示表情
-                Schedule([display, emotion_str]() {
-                    display->SetEmotion(emotion_str.c_str());
-                });
-
-                // 根据常用 emoji / 情绪字符串映射到电机命令
-                // 命令说明（约定）：
-                // 0: 不触发
-                // 1: 短促向前（温柔 / 开心）
-                // 2: 短促向后（悲伤 / 哭）
-                // 3: 左右快摆（顽皮 / 笑）
-                // 4: 轻点/点头（喜欢 / 自信 / 酷）
-                // 5: 轻微倾斜/停顿（困惑 / 尴尬 / 思考）
-                // 6: 突然/强烈动作（惊讶 / 震惊 / 生气）
-                int motor_cmd = 0;
-
-                // 支持情绪文本和 emoji 字符两种情况 - 与眼睛表情完全对应
-                if (emotion_str == "smile") {
-                    // smile -> happy
-                    motor_cmd = 1;
-                } else if (emotion_str == "laugh") {
-                    // laugh -> laughing
-                    motor_cmd = 3;
-                } else if (emotion_str == "cry") {
-                    // cry -> crying
-                    motor_cmd = 2;
-                } else if (emotion_str == "wink") {
-                    // wink -> winking
-                    motor_cmd = 3;
-                } else if (emotion_str == "😶" || emotion_str == "neutral") {
-                    // 1. 😶 - neutral
-                    motor_cmd = 0;
-                } else if (emotion_str == "🙂" || emotion_str == "happy") {
-                    // 2. 🙂 - happy
-                    motor_cmd = 1;
-                } else if (emotion_str == "😆" || emotion_str == "laughing") {
-                    // 3. 😆 - laughing
-                    motor_cmd = 3;
-                } else if (emotion_str == "😂" || emotion_str == "funny") {
-                    // 4. 😂 - funny
-                    motor_cmd = 3;
-                } else if (emotion_str == "😔" || emotion_str == "sad") {
-                    // 5. 😔 - sad
-                    motor_cmd = 2;
-                } else if (emotion_str == "😠" || emotion_str == "angry") {
-                    // 6. 😠 - angry
-                    motor_cmd = 6;
-                } else if (emotion_str == "😭" || emotion_str == "crying") {
-                    // 7. 😭 - crying
-                    motor_cmd = 2;
-                } else if (emotion_str == "😍" || emotion_str == "loving") {
-                    // 8. 😍 - loving
-                    motor_cmd = 4;
-                } else if (emotion_str == "😳" || emotion_str == "embarrassed") {
-                    // 9. 😳 - embarrassed
-                    motor_cmd = 5;
-                } else if (emotion_str == "😲" || emotion_str == "surprised") {
-                    // 10. 😲 - surprised
-                    motor_cmd = 6;
-                } else if (emotion_str == "😱" || emotion_str == "shocked") {
-                    // 11. 😱 - shocked
-                    motor_cmd = 6;
-                } else if (emotion_str == "🤔" || emotion_str == "thinking") {
-                    // 12. 🤔 - thinking
-                    motor_cmd = 5;
-                } else if (emotion_str == "😉" || emotion_str == "winking") {
-                    // 13. 😉 - winking
-                    motor_cmd = 3;
-                } else if (emotion_str == "😎" || emotion_str == "cool") {
-                    // 14. 😎 - cool
-                    motor_cmd = 1;
-                } else if (emotion_str == "😌" || emotion_str == "relaxed") {
-                    // 15. 😌 - relaxed
-                    motor_cmd = 1;
-                } else if (emotion_str == "🤤" || emotion_str == "delicious") {
-                    // 16. 🤤 - delicious
-                    motor_cmd = 1;
-                } else if (emotion_str == "😘" || emotion_str == "kissy") {
-                    // 17. 😘 - kissy
-                    motor_cmd = 4;
-                } else if (emotion_str == "😏" || emotion_str == "confident") {
-                    // 18. 😏 - confident
-                    motor_cmd = 1;
-                } else if (emotion_str == "😴" || emotion_str == "sleepy") {
-                    // 19. 😴 - sleepy
-                    motor_cmd = 0;
-                } else if (emotion_str == "😜" || emotion_str == "silly") {
-                    // 20. 😜 - silly
-                    motor_cmd = 3;
-                } else if (emotion_str == "🙄" || emotion_str == "confused") {
-                    // 21. 🙄 - confused
-                    motor_cmd = 5;
-                } else {
-                    // 如果 emotion 字段是原生 emoji 字符（例如 "😊"）但未覆盖上面分支，可在这里做更多指定
-                    motor_cmd = 0;
-                }
-
-                if (motor_cmd != 0) {
-                    Schedule([this, motor_cmd]() {
-                        TriggerMotorEmotion(motor_cmd);
-                    });
-                }
+                HandleControlMessage(ControlMessage{kControlLlmEmotion, 0, emotion->valuestring});
             }
         } else if (strcmp(type->valuestring, "mcp") == 0) {
             auto payload = cJSON_GetObjectItem(root, "payload");
-            if (cJSON_IsObject(payload)) {
+            // A single request, or a JSON-RPC batch array of them
+            if (cJSON_IsObject(payload) || cJSON_IsArray(payload)) {
                 McpServer::GetInstance().ParseMessage(payload);
             }
         } else if (strcmp(type->valuestring, "system") == 0) {
@@ -927,6 +917,92 @@ void Application::InitializeProtocol() {
     protocol_->Start();
 }
 
+void Application::HandleControlMessage(const ControlMessage& message) {
+    auto display = Board::GetInstance().GetDisplay();
+    switch (message.opcode) {
+    case kControlTtsStart:
+        Schedule([this]() {
+            aborted_ = false;
+            SetDeviceState(kDeviceStateSpeaking);
+        });
+        break;
+    case kControlTtsStop:
+        Schedule([this]() {
+            if (GetDeviceState() == kDeviceStateSpeaking) {
+                if (listening_mode_ == kListeningModeManualStop) {
+                    SetDeviceState(kDeviceStateIdle);
+                } else {
+                    SetDeviceState(kDeviceStateListening);
+                }
+            }
+        });
+        break;
+    case kControlTtsSentence: {
+        ESP_LOGI(TAG, "<< %.*s", (int)message.text.size(), message.text.data());
+        // 句子在对应的语音开始播放时才显示，而不是消息到达时
+        audio_service_.SchedulePlaybackCue([this, display, text = std::string(message.text)]() mutable {
+            Schedule([display, text = std::move(text)]() {
+                // 在动画表情模式下不显示聊天消息
+                if (!display->IsAnimatedEmotionMode()) {
+                    display->SetChatMessage("assistant", text.c_str());
+                }
+            });
+        });
+        break;
+    }
+    case kControlStt: {
+        std::string text(message.text);
+        ESP_LOGI(TAG, ">> %s", text.c_str());
+
+        // 检查是否是显示模式切换命令
+        bool is_display_mode_command = false;
+        if (text.find("切换模式") != std::string::npos ||
+            text.find("切换显示") != std::string::npos ||
+            text.find("眼睛模式") != std::string::npos ||
+            text.find("默认模式") != std::string::npos ||
+            text.find("文字模式") != std::string::npos ||
+            text.find("change mode") != std::string::npos ||
+            text.find("eye mode") != std::string::npos ||
+            text.find("text mode") != std::string::npos) {
+            is_display_mode_command = true;
+            ESP_LOGI(TAG, "Detected display mode toggle command");
+            Schedule([this]() {
+                ToggleDisplayMode();
+            });
+        }
+
+        Schedule([this, display, text = std::move(text), is_command = is_display_mode_command]() {
+            // 在眼睛模式或命令模式下不显示聊天消息
+            if (display_mode_ != kDisplayModeEyeOnly && !is_command) {
+                display->SetChatMessage("user", text.c_str());
+            }
+        });
+        break;
+    }
+    case kControlLlmEmotion: {
+        // 情绪名 / emoji 通过 emotion_table 的完美哈希解析，显示、眼睛和电机动作共用同一张表
+        // 电机命令（TriggerMotorEmotion）：0 不触发，1 短促向前，2 短促向后，3 左右快摆，
+        // 4 轻点/点头，5 轻微倾斜/停顿，6 突然/强烈动作
+        std::string emotion_str(message.text);
+        int motor_cmd = GetEmotionInfo(ResolveEmotion(emotion_str)).motor;
+
+        // 表情和电机动作与语音对齐：等播放到这条消息之后的音频时再执行
+        audio_service_.SchedulePlaybackCue([this, display, emotion_str = std::move(emotion_str), motor_cmd]() mutable {
+            Schedule([this, display, emotion_str = std::move(emotion_str), motor_cmd]() {
+                display->SetEmotion(emotion_str.c_str());
+                if (motor_cmd != 0) {
+                    TriggerMotorEmotion(motor_cmd);
+                }
+            });
+        });
+        break;
+    }
+    default:
+        ESP_LOGW(TAG, "Unknown control opcode: 0x%02x", message.opcode);
+        break;
+    }
+}
+
 void Application::ShowActivationCode(const std::string& code, const std::string& message) {
     struct digit_sound {
         char digit;
@@ -992,10 +1068,12 @@ void Application::DismissAlert() {
 }
 
 void Application::ToggleChatState() {
+    PreconnectAudioChannel();
     xEventGroupSetBits(event_group_, MAIN_EVENT_TOGGLE_CHAT);
 }
 
 void Application::StartListening() {
+    PreconnectAudioChannel();
     xEventGroupSetBits(event_group_, MAIN_EVENT_START_LISTENING);
 }
 
@@ -1036,7 +1114,7 @@ void Application::HandleToggleChatEvent() {
     } else if (state == kDeviceStateSpeaking) {
         AbortSpeaking(kAbortReasonNone);
     } else if (state == kDeviceStateListening) {
-        protocol_->CloseAudioChannel();
+        protocol_->CloseAudioChannel(true);
     }
 }
 
@@ -1110,7 +1188,9 @@ void Application::HandleWakeWordDetectedEvent() {
 #if CONFIG_SEND_WAKE_WORD_DATA
         // Encode and send the wake word data to the server
         while (auto packet = audio_service_.PopWakeWordPacket()) {
-            protocol_->SendAudio(std::move(packet));
+            if (protocol_->SendAudio(std::move(packet))) {
+                OnUplinkPacketSent();
+            }
         }
         // Set the chat state to wake word detected
         protocol_->SendWakeWordDetected(wake_word);
@@ -1140,12 +1220,11 @@ void Application::HandleStateChangedEvent() {
             case kDeviceStateListening:
                 ESP_LOGI("Application", "状态变化事件: 唤醒 - 加入平衡电机反馈队列");
                 // Queue wake balance feedback actions
-                this->QueueMotorAction(4, 40, 200, "Wake forward");
-                this->QueueMotorAction(2, 40, 200, "Wake backward");
+                QueueRoutine("wake");
                 break;
             case kDeviceStateSpeaking:
                 ESP_LOGI("Application", "状态变化事件: 开始说话 - 加入电机反馈队列");
-                this->QueueMotorAction(4, 50, 250, "Start speaking forward");
+                QueueRoutine("speak_start");
                 break;
             default:
                 // No motor feedback for other state changes
@@ -1155,7 +1234,7 @@ void Application::HandleStateChangedEvent() {
         // Handle transition FROM speaking
         if (last_state_for_motor == kDeviceStateSpeaking && new_state != kDeviceStateSpeaking) {
             ESP_LOGI("Application", "状态变化事件: 说话结束 - 加入电机反馈队列");
-            this->QueueMotorAction(2, 45, 220, "End speaking backward");
+            QueueRoutine("speak_end");
         }
 
         last_state_for_motor = new_state;
@@ -1255,14 +1334,6 @@ void Application::HandleStateChangedEvent() {
     }
 }
 
-void Application::Schedule(std::function<void()>&& callback) {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        main_tasks_.push_back(std::move(callback));
-    }
-    xEventGroupSetBits(event_group_, MAIN_EVENT_SCHEDULE);
-}
-
 void Application::AbortSpeaking(AbortReason reason) {
     ESP_LOGI(TAG, "Abort speaking");
     aborted_ = true;
@@ -1271,6 +1342,27 @@ void Application::AbortSpeaking(AbortReason reason) {
     }
 }
 
+void Application::PreconnectAudioChannel() {
+    // May be called from the audio input task or a button task
+    if (!protocol_ || GetDeviceState() != kDeviceStateIdle) {
+        return;
+    }
+    int64_t expected = 0;
+    uplink_request_time_us_.compare_exchange_strong(expected, esp_timer_get_time());
+#if CONFIG_USE_AUDIO_CHANNEL_PRECONNECT
+    if (!protocol_->IsAudioChannelOpened()) {
+        protocol_->PreconnectAudioChannel();
+    }
+#endif
+}
+
+void Application::OnUplinkPacketSent() {
+    auto request_time = uplink_request_time_us_.exchange(0);
+    if (request_time > 0) {
+        ESP_LOGI(TAG, "Time to first uplink packet: %lld ms", (esp_timer_get_time() - request_time) / 1000);
+    }
+}
+
 void Application::SetListeningMode(ListeningMode mode) {
     listening_mode_ = mode;
     SetDeviceState(kDeviceStateListening);
@@ -1297,7 +1389,7 @@ bool Application::UpgradeFirmware(const std::string& url, const std::string& ver
     std::string version_info = version.empty() ? "(Manual upgrade)" : version;
 
     // Close audio channel if it's open
-    if (protocol_ && protocol_->IsAudioChannelOpened()) {
+    if (protocol_ && (protocol_->IsAudioChannelOpened() || protocol_->IsKeepingWarm())) {
         ESP_LOGI(TAG, "Closing audio channel before firmware upgrade");
         protocol_->CloseAudioChannel();
     }
@@ -1366,7 +1458,9 @@ void Application::WakeWordInvoke(const std::string& wake_word) {
 #if CONFIG_USE_AFE_WAKE_WORD || CONFIG_USE_CUSTOM_WAKE_WORD
         // Encode and send the wake word data to the server
         while (auto packet = audio_service_.PopWakeWordPacket()) {
-            protocol_->SendAudio(std::move(packet));
+            if (protocol_->SendAudio(std::move(packet))) {
+                OnUplinkPacketSent();
+            }
         }
         // Set the chat state to wake word detected
         protocol_->SendWakeWordDetected(wake_word);
@@ -1384,18 +1478,26 @@ void Application::WakeWordInvoke(const std::string& wake_word) {
     } else if (state == kDeviceStateListening) {   
         Schedule([this]() {
             if (protocol_) {
-                protocol_->CloseAudioChannel();
+                protocol_->CloseAudioChannel(true);
             }
         });
     }
 }
 
+bool Application::GetLinkStats(LinkStats& stats) {
+    if (!protocol_) {
+        return false;
+    }
+    stats = protocol_->GetLinkStats();
+    return true;
+}
+
 bool Application::CanEnterSleepMode() {
     if (GetDeviceState() != kDeviceStateIdle) {
         return false;
     }
 
-    if (protocol_ && protocol_->IsAudioChannelOpened()) {
+    if (protocol_ && (protocol_->IsAudioChannelOpened() || protocol_->IsKeepingWarm())) {
         return false;
     }
 
@@ -1407,11 +1509,11 @@ bool Application::CanEnterSleepMode() {
     return true;
 }
 
-void Application::SendMcpMessage(const std::string& payload) {
+void Application::SendMcpMessage(std::string payload) {
     // Always schedule to run in main task for thread safety
-    Schedule([this, payload = std::move(payload)]() {
+    Schedule([this, payload = std::move(payload)]() mutable {
         if (protocol_) {
-            protocol_->SendMcpMessage(payload);
+            protocol_->SendMcpMessage(std::move(payload));
         }
     });
 }
@@ -1436,8 +1538,8 @@ void Application::SetAecMode(AecMode mode) {
             break;
         }
 
-        // If the AEC mode is changed, close the audio channel
-        if (protocol_ && protocol_->IsAudioChannelOpened()) {
+        // If the AEC mode is changed, close the audio channel (a warm session carries the old hello features)
+        if (protocol_ && (protocol_->IsAudioChannelOpened() || protocol_->IsKeepingWarm())) {
             protocol_->CloseAudioChannel();
         }
     });
@@ -1460,172 +1562,111 @@ void Application::ResetProtocol() {
 
 
 void Application::TriggerMotorEmotion(int emotion_type) {
-    // Use the queue system for all motor actions to ensure they all execute
+    // 情感动作类型对应的编舞例程（见 assets/choreography/routines.json），按索引查找
+    static const char* const kEmotionRoutines[] = {
+        nullptr,
+        "twitch_forward",   // 1: 非常短暂的向前（唤醒反馈）
+        "twitch_backward",  // 2: 非常短暂的向后（说话反馈）
+        "wiggle_quick",     // 3: 左右快摆（顽皮 / 笑 / 眨眼）
+        "nod",              // 4: 轻点/点头（喜欢 / 自信）
+        "tilt",             // 5: 轻微倾斜/停顿（困惑 / 尴尬 / 思考）
+        "recoil",           // 6: 突然/强烈动作（惊讶 / 震惊 / 生气）
+        "wake",             // 7: 唤醒反馈：前进后退平衡
+        "speak_start",      // 8: 开始说话反馈：向前
+        "speak_end",        // 9: 结束说话反馈：向后
+    };
+    if (emotion_type <= 0 || emotion_type >= (int)(sizeof(kEmotionRoutines) / sizeof(kEmotionRoutines[0]))) {
+        ESP_LOGW("Application", "未知的情感动作类型: %d", emotion_type);
+        return;
+    }
+    if (emotion_type > 6) {
+        // 状态反馈（7-9）使用例程中的固定速度和时长
+        QueueRoutine(kEmotionRoutines[emotion_type]);
+        return;
+    }
+
+    // 情感动作（1-6）跟随默认速度配置；例程按默认时长编写，
+    // 时长按网页配置的对应动作时长相对默认值缩放
+    static const MotorActionConfig defaults;
+    const auto& config = motor_action_config_;
+    int time_percent = 100;
     switch (emotion_type) {
-        case 1: // 非常短暂的向前（唤醒反馈）
-            QueueMotorAction(4, motor_action_config_.default_speed_percent,
-                           200, "Emotion forward twitch");
-            break;
-        case 2: // 非常短暂的向后（说话反馈）
-            QueueMotorAction(2, motor_action_config_.default_speed_percent,
-                           150, "Emotion backward twitch");
-            break;
-        case 3: // 左右快摆（顽皮 / 笑 / 眨眼）
-            // Quick left-right wiggle
-            QueueMotorAction(3, motor_action_config_.default_speed_percent,
-                           motor_action_config_.wiggle_duration_ms / 6, "Emotion left wiggle");
-            QueueMotorAction(1, motor_action_config_.default_speed_percent,
-                           motor_action_config_.wiggle_duration_ms / 6, "Emotion right wiggle");
-            break;
-        case 4: // 轻点/点头（喜欢 / 自信）
-            QueueMotorAction(4, motor_action_config_.default_speed_percent,
-                           motor_action_config_.forward_duration_ms / 6, "Emotion nod forward");
-            break;
-        case 5: // 轻微倾斜/停顿（困惑 / 尴尬 / 思考）
-            QueueMotorAction(3, motor_action_config_.default_speed_percent / 2,
-                           motor_action_config_.left_turn_duration_ms / 4, "Emotion confused left");
-            QueueMotorAction(1, motor_action_config_.default_speed_percent / 2,
-                           motor_action_config_.right_turn_duration_ms / 4, "Emotion confused right");
-            break;
-        case 6: // 突然/强烈动作（惊讶 / 震惊 / 生气）
-            QueueMotorAction(2, motor_action_config_.default_speed_percent,
-                           motor_action_config_.backward_duration_ms / 6, "Emotion shocked back");
-            QueueMotorAction(4, motor_action_config_.default_speed_percent,
-                           motor_action_config_.forward_duration_ms / 6, "Emotion shocked forward");
+        case 3:
+            time_percent = config.wiggle_duration_ms * 100 / defaults.wiggle_duration_ms;
             break;
-        case 7: // 唤醒反馈：前进后退平衡（最高优先级）
-            ESP_LOGI("Application", "唤醒电机反馈：前进后退平衡");
-            QueueMotorAction(4, 40, 200, "Wake balance forward");
-            QueueMotorAction(2, 40, 200, "Wake balance backward");
+        case 4:
+            time_percent = config.forward_duration_ms * 100 / defaults.forward_duration_ms;
             break;
-        case 8: // 开始说话反馈：向前（最高优先级）
-            ESP_LOGI("Application", "开始说话电机反馈");
-            QueueMotorAction(4, 50, 250, "Start speaking forward");
+        case 5:
+            time_percent = (config.left_turn_duration_ms + config.right_turn_duration_ms) * 100 /
+                           (defaults.left_turn_duration_ms + defaults.right_turn_duration_ms);
             break;
-        case 9: // 结束说话反馈：向后（最高优先级）
-            ESP_LOGI("Application", "结束说话电机反馈");
-            QueueMotorAction(2, 45, 220, "End speaking backward");
+        case 6:
+            time_percent = (config.backward_duration_ms + config.forward_duration_ms) * 100 /
+                           (defaults.backward_duration_ms + defaults.forward_duration_ms);
             break;
         default:
-            ESP_LOGW("Application", "未知的情感动作类型: %d", emotion_type);
+            // 1-2 的短促动作本来就是固定时长
             break;
     }
+    QueueRoutine(kEmotionRoutines[emotion_type], config.default_speed_percent, time_percent);
 }
 
-// Global function for motor control with duration (used by CompactWifiBoard)
-// Priority levels: 0=low (emotion), 1=medium (speech), 2=high (MCP commands)
-extern "C" void HandleMotorActionForApplication(int direction, int speed, int duration_ms, int priority) {
-    // Get Application instance and handle motor action
-    Application& app = Application::GetInstance();
-    app.HandleMotorActionWithDuration(direction, speed, duration_ms, priority);
+bool Application::PlayRoutine(std::string_view name, int speed_percent, int priority) {
+    std::lock_guard<std::mutex> lock(choreography_mutex_);
+    auto routine = choreography_.Find(name);
+    if (routine == nullptr) {
+        ESP_LOGW(TAG, "Routine not found: %.*s", (int)name.size(), name.data());
+        return false;
+    }
+    motor_scheduler_.Play(*routine, speed_percent, priority);
+    return true;
 }
 
-void Application::QueueMotorAction(int direction, int speed, int duration_ms, const std::string& description) {
-    ESP_LOGI(TAG, "Queue motor action: %s (direction=%d, speed=%d, duration=%dms)",
-             description.c_str(), direction, speed, duration_ms);
-
-    // Add action to queue
-    {
-        std::lock_guard<std::mutex> lock(motor_queue_mutex_);
-        motor_action_queue_.push({direction, speed, duration_ms, description});
+bool Application::QueueRoutine(std::string_view name, int speed_percent, int time_percent) {
+    std::lock_guard<std::mutex> lock(choreography_mutex_);
+    auto routine = choreography_.Find(name);
+    if (routine == nullptr) {
+        ESP_LOGW(TAG, "Routine not found: %.*s", (int)name.size(), name.data());
+        return false;
     }
+    motor_scheduler_.Queue(*routine, speed_percent, 0, time_percent);
+    return true;
+}
 
-    // Start executor if not running
-    if (!motor_executor_running_) {
-        motor_executor_running_ = true;
-        xTaskCreate([](void* param) {
-            Application* app = static_cast<Application*>(param);
-            app->ExecuteMotorActionQueue();
-        }, "motor_executor", 4096, this, tskIDLE_PRIORITY + 1, NULL);
+void Application::LoadChoreography() {
+    void* ptr = nullptr;
+    size_t size = 0;
+    std::lock_guard<std::mutex> lock(choreography_mutex_);
+    if (Assets::GetInstance().GetAssetData("choreography.bin", ptr, size) && choreography_.Load(ptr, size)) {
+        ESP_LOGI(TAG, "Using choreography from the assets partition");
     }
 }
 
-void Application::ExecuteMotorActionQueue() {
-    ESP_LOGI(TAG, "Motor action queue executor started");
-
-    while (true) {
-        MotorAction action;
-        bool has_action = false;
-
-        // Get next action from queue
-        {
-            std::lock_guard<std::mutex> lock(motor_queue_mutex_);
-            if (!motor_action_queue_.empty()) {
-                action = motor_action_queue_.front();
-                motor_action_queue_.pop();
-                has_action = true;
-            }
-        }
-
-        if (has_action) {
-            ESP_LOGI(TAG, "Executing queued motor action: %s", action.description.c_str());
-
-            // Execute the action synchronously
-            SetRealtimeMotorCommand(action.direction, action.speed);
-            if (action.duration_ms > 0) {
-                vTaskDelay(pdMS_TO_TICKS(action.duration_ms));
-            }
-            StopRealtimeMotorControl();
-
-            // Small delay between actions
-            vTaskDelay(pdMS_TO_TICKS(50));
-        } else {
-            // No more actions, check again after a short delay
-            vTaskDelay(pdMS_TO_TICKS(10));
-        }
-    }
+// Global function for motor control with duration (used by CompactWifiBoard)
+// Priority levels: 0=low (emotion), 1=medium (speech), 2=high (MCP commands)
+extern "C" void HandleMotorActionForApplication(int direction, int speed, int duration_ms, int priority) {
+    // Get Application instance and handle motor action
+    Application& app = Application::GetInstance();
+    app.HandleMotorActionWithDuration(direction, speed, duration_ms, priority);
 }
 
 void Application::HandleMotorActionWithDuration(int direction, int speed, int duration_ms, int priority) {
     ESP_LOGI(TAG, "Motor action with duration: direction=%d, speed=%d, duration=%dms, priority=%d", direction, speed, duration_ms, priority);
 
-    // Check if there's already a motor action in progress
-    if (realtime_control_active_.load()) {
-        int current_priority = current_motor_priority_.load();
-        if (priority >= current_priority) {
-            ESP_LOGW(TAG, "Higher/equal priority motor action (new:%d >= current:%d), canceling previous action", priority, current_priority);
-            StopRealtimeMotorControl();
-            // Give a small delay for the previous action to stop
-            vTaskDelay(pdMS_TO_TICKS(50));
-        } else {
-            ESP_LOGW(TAG, "Lower priority motor action (new:%d < current:%d), queuing instead", priority, current_priority);
-            // Queue the action to ensure it gets executed eventually
-            std::string desc = "Queued action (dir=" + std::to_string(direction) +
-                             ", speed=" + std::to_string(speed) +
-                             ", duration=" + std::to_string(duration_ms) + "ms, pri=" + std::to_string(priority) + ")";
-            QueueMotorAction(direction, speed, duration_ms, desc);
-            return;
-        }
+    if (direction == 0 || speed == 0) {
+        motor_scheduler_.Stop();
+        return;
     }
 
-    // Set the current priority
-    current_motor_priority_.store(priority);
-
-    // Start the motor action
-    SetRealtimeMotorCommand(direction, speed);
-
-    // Schedule auto-stop after duration
-    if (duration_ms > 0) {
-        // Use a task to handle the delay and stop
-        auto stop_task = [](void* params) -> void {
-            auto* timing_params = static_cast<std::tuple<int, int, Application*>*>(params);
-            auto [duration, priority, app] = *timing_params;
-            delete timing_params;
-
-            vTaskDelay(pdMS_TO_TICKS(duration));
-            // Stop the motor control after the specified duration
-            // This is a simple approach: just stop whatever is running
-            app->StopRealtimeMotorControl();
-            vTaskDelete(NULL);
-        };
-
-        auto* params = new std::tuple<int, int, Application*>(duration_ms, priority, this);
-        xTaskCreate(stop_task, "motor_stop", 2048, params, tskIDLE_PRIORITY + 1, NULL);
-    }
+    std::string desc = "Action (dir=" + std::to_string(direction) +
+                       ", speed=" + std::to_string(speed) +
+                       ", duration=" + std::to_string(duration_ms) + "ms, pri=" + std::to_string(priority) + ")";
+    motor_scheduler_.Play(direction, speed, duration_ms, priority, std::move(desc));
 }
 
 void Application::HandleWebMotorControl(int direction, int speed) {
-    ESP_LOGI(TAG, "Web motor control: direction=%d, speed=%d", direction, speed);
+    ESP_LOGD(TAG, "Web motor control: direction=%d, speed=%d", direction, speed);
 
     // 将网页控制转换为电机命令
     // direction: 0=停止, 1=右, 2=下(后退), 3=左, 4=上(前进)
@@ -1642,6 +1683,9 @@ void Application::HandleWebMotorControl(int direction, int speed) {
     last_direction = direction;
     last_speed = speed;
 
+    // 摇杆控制优先于时间线上的动作，先清空时间线，避免定时器稍后把电机停掉
+    motor_scheduler_.Stop();
+
     // 如果速度为0或方向为0，停止实时控制并停止电机
     if (speed == 0 || direction == 0) {
         StopRealtimeMotorControl();
@@ -1654,8 +1698,9 @@ void Application::HandleWebMotorControl(int direction, int speed) {
     SetRealtimeMotorCommand(direction, speed);
 }
 
-void Application::SetRealtimeMotorCommand(int direction, int speed) {
-    ESP_LOGI(TAG, "SetRealtimeMotorCommand: direction=%d speed=%d", direction, speed);
+void Application::SetRealtimeMotorCommand(int direction, int speed, ChoreoEasing easing) {
+    // Debug level: routines and the joystick call this for every step
+    ESP_LOGD(TAG, "SetRealtimeMotorCommand: direction=%d speed=%d", direction, speed);
 
     // 标记实时控制开启
     realtime_control_active_.store(true);
@@ -1689,49 +1734,10 @@ void Application::SetRealtimeMotorCommand(int direction, int speed) {
     }
 
     if (motor_pwm_initialized_member_) {
-        uint32_t max_duty = (1 << pwm_resolution_bits_) - 1;
-        uint32_t duty = (speed * max_duty) / 100;
-
-        // 使用 ledc fade 实现平滑过渡（模式 A：把目标通道设置为 PWM，其他通道为 0）
-        // 先把所有通道设为 0（平滑）
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, LEDC_FADE_NO_WAIT);
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, LEDC_FADE_NO_WAIT);
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, LEDC_FADE_NO_WAIT);
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, LEDC_FADE_NO_WAIT);
-
-        // 然后根据方向，把对应的通道设为目标占空比（平滑）
-        switch (direction) {
-            case 1: // 右: LF (ch0) + RB (ch3)
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, LEDC_FADE_NO_WAIT);
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, LEDC_FADE_NO_WAIT);
-                break;
-            case 2: // 后退: LB (ch1) + RB (ch3)
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, LEDC_FADE_NO_WAIT);
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, LEDC_FADE_NO_WAIT);
-                break;
-            case 3: // 左: LB (ch1) + RF (ch2)
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, LEDC_FADE_NO_WAIT);
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, LEDC_FADE_NO_WAIT);
-                break;
-            case 4: // 前进: LF (ch0) + RF (ch2)
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, LEDC_FADE_NO_WAIT);
-                ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, duty, pwm_ramp_ms_);
-                ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, LEDC_FADE_NO_WAIT);
-                break;
-            default:
-                break;
-        }
+        // 由运动规划器按加速度限制从当前速度平滑过渡到目标速度（连续动作之间不再先停下）
+        int left, right;
+        MotionPlanner::DirectionToWheels(direction, speed, left, right);
+        SetMotionTarget(left, right, easing);
     } else {
         // 回退到 GPIO 控制（如果 PWM 未初始化）
         if (motor_gpio_initialized_member_) {
@@ -1764,20 +1770,12 @@ void Application::SetRealtimeMotorCommand(int direction, int speed) {
     }
 }
 
-void Application::StopRealtimeMotorControl() {
-    ESP_LOGI(TAG, "StopRealtimeMotorControl");
+void Application::StopRealtimeMotorControl(ChoreoEasing easing) {
+    ESP_LOGD(TAG, "StopRealtimeMotorControl");
     realtime_control_active_.store(false);
-    current_motor_priority_.store(0); // Reset priority
     if (motor_pwm_initialized_member_) {
-        // 平滑降到 0
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, LEDC_FADE_NO_WAIT);
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, LEDC_FADE_NO_WAIT);
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, LEDC_FADE_NO_WAIT);
-        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, 0, pwm_ramp_ms_);
-        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, LEDC_FADE_NO_WAIT);
+        // 按加速度限制平滑降到 0
+        SetMotionTarget(0, 0, easing);
     } else if (motor_gpio_initialized_member_) {
         gpio_set_level(MOTOR_LF_GPIO, 0);
         gpio_set_level(MOTOR_LB_GPIO, 0);
@@ -1848,18 +1846,81 @@ void Application::InitMotorPwm() {
     if (ledc_channel_config(&ch) != ESP_OK) {
         ESP_LOGE(TAG, "InitMotorPwm: ledc_channel_config ch3 failed");
     }
-    // Install fade service for smooth transitions
-    if (ledc_fade_func_install(0) != ESP_OK) {
-        ESP_LOGW(TAG, "InitMotorPwm: ledc_fade_func_install failed or already installed");
-    }
+    esp_timer_create_args_t motion_timer_args = {
+        .callback = [](void* arg) {
+            static_cast<Application*>(arg)->OnMotionTick();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "motion_planner",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&motion_timer_args, &motion_timer_handle_);
 
     motor_pwm_initialized_member_ = true;
-    ESP_LOGI(TAG, "InitMotorPwm: initialized (freq=%dHz, bits=%d, ramp=%dms)", pwm_freq_hz_, pwm_resolution_bits_, pwm_ramp_ms_);
+    ESP_LOGI(TAG, "InitMotorPwm: initialized (freq=%dHz, bits=%d, max accel=%d%%/s)", pwm_freq_hz_, pwm_resolution_bits_,
+        CONFIG_MOTOR_MAX_ACCEL_PERCENT);
+}
+
+void Application::SetMotionTarget(int left, int right, ChoreoEasing easing) {
+    std::lock_guard<std::mutex> lock(motion_mutex_);
+    switch (easing) {
+        case kEaseLinear:
+            motion_planner_.SetTarget(left, right, esp_timer_get_time(), MotionPlanner::kProfileTrapezoid);
+            break;
+        case kEaseSmooth:
+            motion_planner_.SetTarget(left, right, esp_timer_get_time(), MotionPlanner::kProfileSCurve);
+            break;
+        case kEaseStep:
+            motion_planner_.SetTarget(left, right, esp_timer_get_time(), MotionPlanner::kProfileStep);
+            break;
+        default:
+            motion_planner_.SetTarget(left, right, esp_timer_get_time());
+            break;
+    }
+    if (!esp_timer_is_active(motion_timer_handle_)) {
+        esp_timer_start_periodic(motion_timer_handle_, MOTION_TICK_MS * 1000);
+    }
+    ApplyNextMotionStep();
+}
+
+void Application::OnMotionTick() {
+    std::lock_guard<std::mutex> lock(motion_mutex_);
+    if (!ApplyNextMotionStep()) {
+        esp_timer_stop(motion_timer_handle_);
+    }
+}
+
+bool Application::ApplyNextMotionStep() {
+    // The profile is sampled every tick and held until the next one, 10 ms steps are far
+    // shorter than the motor's mechanical time constant
+    int left, right;
+    bool moving = motion_planner_.Sample(esp_timer_get_time(), left, right);
+    SetWheelDuty(LEDC_CHANNEL_0, LEDC_CHANNEL_1, left);
+    SetWheelDuty(LEDC_CHANNEL_2, LEDC_CHANNEL_3, right);
+    return moving;
+}
+
+void Application::SetWheelDuty(ledc_channel_t forward_channel, ledc_channel_t backward_channel, int speed) {
+    uint32_t max_duty = (1 << pwm_resolution_bits_) - 1;
+    uint32_t duty = (std::abs(speed) * max_duty) / 100;
+    ledc_channel_t on = speed >= 0 ? forward_channel : backward_channel;
+    ledc_channel_t off = speed >= 0 ? backward_channel : forward_channel;
+    // Plain duty writes, no hardware fade, as this runs on the esp_timer task every tick.
+    // The idle side of the H-bridge goes to 0 first, so both sides never conduct together
+    if (ledc_get_duty(LEDC_LOW_SPEED_MODE, off) != 0) {
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, off, 0);
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, off);
+    }
+    if (ledc_get_duty(LEDC_LOW_SPEED_MODE, on) != duty) {
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, on, duty);
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, on);
+    }
 }
 
 // TriggerMotorEmotion 说明（中文）：
-// 该函数将情感命令放入 motor_control_queue_，由 MotorControlTask 异步执行。
-// 通过队列方式可以保证所有电机动作在同一任务中串行执行，避免并发冲突和阻塞主线程。
+// 该函数把情感动作放到 MotorScheduler 的时间线上（低优先级），由定时器依次执行，
+// 保证所有电机动作串行执行，且高优先级命令（MCP/网页）可以随时打断。
 
 void Application::LoadMotorActionConfig() {
     Settings settings("motor_config", true);
@@ -5,8 +5,10 @@
 #include <freertos/event_groups.h>
 #include <freertos/task.h>
 #include <esp_timer.h>
+#include <driver/ledc.h>
 
 #include <string>
+#include <string_view>
 #include <mutex>
 #include <deque>
 #include <memory>
@@ -18,6 +20,13 @@
 #include "device_state_machine.h"
 #include <atomic>
 #include "web_server/web_server.h"
+#include "task_queue.h"
+#include "main_loop_stats.h"
+#include "telemetry.h"
+#include "screen_streamer.h"
+#include "motor_scheduler.h"
+#include "motion_planner.h"
+#include "choreography.h"
 
 // Main event bits
 #define MAIN_EVENT_SCHEDULE             (1 << 0)
@@ -34,6 +43,13 @@
 #define MAIN_EVENT_STOP_LISTENING       (1 << 11)
 #define MAIN_EVENT_STATE_CHANGED        (1 << 12)
 
+// Scheduled callbacks: ring size and inline capture size (bytes) before falling back to the heap
+#define MAIN_TASK_QUEUE_SIZE            32
+#define MAIN_TASK_STORAGE_SIZE          48
+
+// Motor speed profile update period while a wheel is ramping
+#define MOTION_TICK_MS                  10
+
 
 enum AecMode {
     kAecOff,
@@ -85,9 +101,14 @@ public:
     bool SetDeviceState(DeviceState state);
 
     /**
-     * Schedule a callback to be executed in the main task
+     * Schedule a callback to be executed in the main task.
+     * Lock-free and heap-free for callbacks whose captures fit in MAIN_TASK_STORAGE_SIZE bytes
      */
-    void Schedule(std::function<void()>&& callback);
+    template <typename F>
+    void Schedule(F&& callback) {
+        main_tasks_.Push(std::forward<F>(callback));
+        xEventGroupSetBits(event_group_, MAIN_EVENT_SCHEDULE);
+    }
 
     /**
      * Alert with status, message, emotion and optional sound
@@ -119,7 +140,16 @@ public:
     void WakeWordInvoke(const std::string& wake_word);
     bool UpgradeFirmware(const std::string& url, const std::string& version = "");
     bool CanEnterSleepMode();
-    void SendMcpMessage(const std::string& payload);
+    /**
+     * Copy the protocol's RTT / jitter / loss measurements, false if there is no protocol yet
+     */
+    bool GetLinkStats(LinkStats& stats);
+    void SendMcpMessage(std::string payload);
+    /**
+     * Main loop handler timing, longest stall and audio wait counters as JSON
+     */
+    std::string GetMainLoopStatsJson() { return loop_stats_.ToJson(); }
+    void ResetMainLoopStats() { loop_stats_.Reset(); }
     void SetAecMode(AecMode mode);
     AecMode GetAecMode() const { return aec_mode_; }
     void PlaySound(const std::string_view& sound);
@@ -150,8 +180,14 @@ public:
     void TriggerMotorEmotion(int emotion_type);
     void HandleWebMotorControl(int direction, int speed);
     void HandleMotorActionWithDuration(int direction, int speed, int duration_ms, int priority = 1);
-    void QueueMotorAction(int direction, int speed, int duration_ms, const std::string& description);
-    void ExecuteMotorActionQueue();
+
+    /**
+     * Play a choreography routine (dance, wiggle, emotion gestures) by name, with its
+     * keyframe speeds scaled by speed_percent. Returns false if there is no such routine.
+     */
+    bool PlayRoutine(std::string_view name, int speed_percent, int priority);
+    // Low priority, after the actions already waiting; keyframe durations scaled by time_percent
+    bool QueueRoutine(std::string_view name, int speed_percent = 100, int time_percent = 100);
 
     /**
      * Reset protocol resources (thread-safe)
@@ -164,17 +200,20 @@ private:
     Application();
     ~Application();
 
-    std::mutex mutex_;
-    std::deque<std::function<void()>> main_tasks_;
+    TaskQueue<MAIN_TASK_QUEUE_SIZE, MAIN_TASK_STORAGE_SIZE> main_tasks_;
+    MainLoopStats loop_stats_;
+    uint32_t last_task_overflows_ = 0;
     std::unique_ptr<Protocol> protocol_;
     EventGroupHandle_t event_group_ = nullptr;
     esp_timer_handle_t clock_timer_handle_ = nullptr;
     DeviceStateMachine state_machine_;
+    uint32_t last_state_transitions_ = 0;
     ListeningMode listening_mode_ = kListeningModeAutoStop;
     AecMode aec_mode_ = kAecOff;
     DisplayMode display_mode_ = kDisplayModeDefault;
     std::string last_error_message_;
     AudioService audio_service_;
+    uint32_t last_playback_cues_ = 0;
     std::unique_ptr<Ota> ota_;
 
     bool has_server_time_ = false;
@@ -183,25 +222,29 @@ private:
     bool play_popup_on_listening_ = false;  // Flag to play popup sound after state changes to listening
     int clock_ticks_ = 0;
     TaskHandle_t activation_task_handle_ = nullptr;
+    // Time (us) the user asked to talk, used to report the time to the first uplink packet
+    std::atomic<int64_t> uplink_request_time_us_{0};
 
     // Motor control task
 
     // Web server for remote control
     std::unique_ptr<WebServer> web_server_;
+    std::unique_ptr<ScreenStreamer> screen_streamer_;
+    // Samples heap and per-task CPU for /api/telemetry (web server task only)
+    TelemetrySampler telemetry_sampler_;
 
     // Motor action configuration
     MotorActionConfig motor_action_config_;
 
     // Real-time motor control support
     std::atomic<bool> realtime_control_active_{false};
-    std::atomic<int> current_motor_priority_{0}; // Current motor action priority
     // Initialize motor gpio on demand in a thread-safe way
     std::mutex motor_gpio_init_mutex_;
     bool motor_gpio_initialized_member_ = false;
 
     // API for realtime control (bypass queue)
-    void SetRealtimeMotorCommand(int direction, int speed);
-    void StopRealtimeMotorControl();
+    void SetRealtimeMotorCommand(int direction, int speed, ChoreoEasing easing = kEaseDefault);
+    void StopRealtimeMotorControl(ChoreoEasing easing = kEaseDefault);
     // Timestamp (ms) of last realtime command, used for watchdog to auto-stop
     std::atomic<int64_t> last_realtime_command_ms_{0};
     // PWM (LEDC) support
@@ -209,11 +252,31 @@ private:
     int pwm_freq_hz_ = 20000;
     int pwm_resolution_bits_ = 10;
     void InitMotorPwm();
-    // Ramp (ms) for PWM fade
-    int pwm_ramp_ms_ = 50;
+    // Acceleration limited wheel speed profiles, stepped by motion_timer_handle_ while ramping
+    std::mutex motion_mutex_;
+    MotionPlanner motion_planner_{CONFIG_MOTOR_MAX_ACCEL_PERCENT,
+#if CONFIG_MOTOR_RAMP_S_CURVE
+        MotionPlanner::kProfileSCurve
+#else
+        MotionPlanner::kProfileTrapezoid
+#endif
+    };
+    esp_timer_handle_t motion_timer_handle_ = nullptr;
+    void SetMotionTarget(int left, int right, ChoreoEasing easing);
+    void OnMotionTick();
+    bool ApplyNextMotionStep();
+    void SetWheelDuty(ledc_channel_t forward_channel, ledc_channel_t backward_channel, int speed);
+    // Motor routines, from the assets partition or built in
+    std::mutex choreography_mutex_;
+    ChoreographyLibrary choreography_;
+    void LoadChoreography();
+    // Timed actions (emotions, MCP and web commands); declared last so it stops before the PWM state goes
+    MotorScheduler motor_scheduler_;
+    uint32_t last_motor_actions_ = 0;
 
 
     // Event handlers
+    void HandleControlMessage(const ControlMessage& message);
     void HandleStateChangedEvent();
     void HandleToggleChatEvent();
     void HandleStartListeningEvent();
@@ -222,6 +285,10 @@ private:
     void HandleNetworkDisconnectedEvent();
     void HandleActivationDoneEvent();
     void HandleWakeWordDetectedEvent();
+    void HandleClockTickEvent();
+    void SendQueuedAudio();
+    // Send queued audio now if MAIN_EVENT_SEND_AUDIO is pending, returns true if it was
+    bool ServicePendingAudio();
 
     // Activation task (runs in background)
     void ActivationTask();
@@ -232,6 +299,8 @@ private:
     void InitializeProtocol();
     void ShowActivationCode(const std::string& code, const std::string& message);
     void SetListeningMode(ListeningMode mode);
+    void PreconnectAudioChannel();
+    void OnUplinkPacketSent();
     
     // State change handler called by state machine
     void OnStateChanged(DeviceState old_state, DeviceState new_state);
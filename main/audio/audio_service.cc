@@ -99,6 +99,7 @@ void AudioService::Initialize(AudioCodec* codec) {
 #endif
 
     audio_processor_->OnOutput([this](std::vector<int16_t>&& data) {
+        audio_tap_.Feed(kAudioTapAfeOutput, data, 16000, 1);
         PushTaskToEncodeQueue(kAudioTaskTypeEncodeToSendQueue, std::move(data));
     });
 
@@ -216,13 +217,7 @@ bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, in
     last_input_time_ = std::chrono::steady_clock::now();
     debug_statistics_.input_count++;
 
-#if CONFIG_USE_AUDIO_DEBUGGER
-    // 音频调试：发送原始音频数据
-    if (audio_debugger_ == nullptr) {
-        audio_debugger_ = std::make_unique<AudioDebugger>();
-    }
-    audio_debugger_->Feed(data);
-#endif
+    audio_tap_.Feed(kAudioTapRawMic, data, sample_rate, codec_->input_channels());
 
     return true;
 }
@@ -315,6 +310,7 @@ void AudioService::AudioOutputTask() {
             codec_->EnableOutput(true);
         }
         codec_->OutputData(task->pcm);
+        playback_clock_.OnFramePlayed();
 
         /* Update the last output time */
         last_output_time_ = std::chrono::steady_clock::now();
@@ -375,6 +371,7 @@ void AudioService::OpusCodecTask() {
                 decoder_lock.unlock();
                 if (ret == ESP_AUDIO_ERR_OK) {
                     task->pcm.resize(out_frame.decoded_size / sizeof(int16_t));
+                    audio_tap_.Feed(kAudioTapDecoderOutput, task->pcm, decoder_sample_rate_, 1);
                     if (decoder_sample_rate_ != codec_->output_sample_rate() && output_resampler_ != nullptr) {
                         uint32_t target_size = 0;
                         esp_ae_rate_cvt_get_max_out_sample_num(output_resampler_, task->pcm.size(), &target_size);
@@ -391,10 +388,13 @@ void AudioService::OpusCodecTask() {
                     debug_statistics_.decode_count++;
                 } else {
                     ESP_LOGE(TAG, "Failed to decode audio after resize, error code: %d", ret);
+                    // Keep the playback clock in step with the stream
+                    playback_clock_.OnFramePlayed();
                     lock.lock();
                 }
             } else {
                 ESP_LOGE(TAG, "Audio decoder is not configured");
+                playback_clock_.OnFramePlayed();
                 lock.lock();
             }
             debug_statistics_.decode_count++;
@@ -411,6 +411,7 @@ void AudioService::OpusCodecTask() {
             packet->sample_rate = 16000;
             packet->timestamp = task->timestamp;
 
+            audio_tap_.Feed(kAudioTapEncoderInput, task->pcm, encoder_sample_rate_, 1);
             if (opus_encoder_ != nullptr && task->pcm.size() == encoder_frame_size_) {
                 std::vector<uint8_t> buf(encoder_outbuf_size_);
                 esp_audio_enc_in_frame_t in = {
@@ -521,6 +522,7 @@ bool AudioService::PushPacketToDecodeQueue(std::unique_ptr<AudioStreamPacket> pa
         }
     }
     audio_decode_queue_.push_back(std::move(packet));
+    playback_clock_.OnFrameQueued();
     audio_queue_cv_.notify_all();
     return true;
 }
@@ -740,18 +742,28 @@ bool AudioService::IsIdle() {
     return audio_encode_queue_.empty() && audio_decode_queue_.empty() && audio_playback_queue_.empty() && audio_testing_queue_.empty();
 }
 
-void AudioService::ResetDecoder() {
+AudioQueueDepths AudioService::GetQueueDepths() {
     std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    std::unique_lock<std::mutex> decoder_lock(decoder_mutex_);
-    if (opus_decoder_ != nullptr) {
-        esp_opus_dec_reset(opus_decoder_);
+    return AudioQueueDepths{(uint16_t)audio_decode_queue_.size(), (uint16_t)audio_send_queue_.size(),
+                            (uint16_t)audio_encode_queue_.size(), (uint16_t)audio_playback_queue_.size()};
+}
+
+void AudioService::ResetDecoder() {
+    {
+        std::lock_guard<std::mutex> lock(audio_queue_mutex_);
+        std::unique_lock<std::mutex> decoder_lock(decoder_mutex_);
+        if (opus_decoder_ != nullptr) {
+            esp_opus_dec_reset(opus_decoder_);
+        }
+        decoder_lock.unlock();
+        timestamp_queue_.clear();
+        audio_decode_queue_.clear();
+        audio_playback_queue_.clear();
+        audio_testing_queue_.clear();
+        audio_queue_cv_.notify_all();
     }
-    decoder_lock.unlock();
-    timestamp_queue_.clear();
-    audio_decode_queue_.clear();
-    audio_playback_queue_.clear();
-    audio_testing_queue_.clear();
-    audio_queue_cv_.notify_all();
+    // The audio the cues were waiting for is gone; present them now rather than never
+    playback_clock_.Reset();
 }
 
 void AudioService::CheckAndUpdateAudioPowerState() {
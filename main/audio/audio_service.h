@@ -20,7 +20,8 @@
 
 #include "audio_codec.h"
 #include "audio_processor.h"
-#include "processors/audio_debugger.h"
+#include "playback_clock.h"
+#include "audio_tap.h"
 #include "wake_word.h"
 #include "protocol.h"
 
@@ -95,6 +96,13 @@ struct AudioTask {
     uint32_t timestamp;
 };
 
+struct AudioQueueDepths {
+    uint16_t decode;
+    uint16_t send;
+    uint16_t encode;
+    uint16_t playback;
+};
+
 struct DebugStatistics {
     uint32_t input_count = 0;
     uint32_t decode_count = 0;
@@ -115,6 +123,7 @@ public:
     const std::string& GetLastWakeWord() const;
     bool IsVoiceDetected() const { return voice_detected_; }
     bool IsIdle();
+    AudioQueueDepths GetQueueDepths();
     bool IsWakeWordRunning() const { return xEventGroupGetBits(event_group_) & AS_EVENT_WAKE_WORD_RUNNING; }
     bool IsAudioProcessorRunning() const { return xEventGroupGetBits(event_group_) & AS_EVENT_AUDIO_PROCESSOR_RUNNING; }
     bool IsAfeWakeWord();
@@ -127,6 +136,13 @@ public:
     void SetCallbacks(AudioServiceCallbacks& callbacks);
 
     bool PushPacketToDecodeQueue(std::unique_ptr<AudioStreamPacket> packet, bool wait = false);
+    /*
+     * Run cue when the speaker reaches the audio queued so far, so text, emotions and motion
+     * line up with what is heard. Cues run in the audio output task and should only hand work off.
+     */
+    void SchedulePlaybackCue(std::function<void()> cue) { playback_clock_.AddCue(std::move(cue)); }
+    PlaybackClock::Stats GetPlaybackCueStats() { return playback_clock_.GetStats(); }
+    AudioTap& GetAudioTap() { return audio_tap_; }
     std::unique_ptr<AudioStreamPacket> PopPacketFromSendQueue();
     void PlaySound(const std::string_view& sound);
     bool ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples);
@@ -138,7 +154,6 @@ private:
     AudioServiceCallbacks callbacks_;
     std::unique_ptr<AudioProcessor> audio_processor_;
     std::unique_ptr<WakeWord> wake_word_;
-    std::unique_ptr<AudioDebugger> audio_debugger_;
     void* opus_encoder_ = nullptr;
     void* opus_decoder_ = nullptr;
     std::mutex decoder_mutex_;
@@ -172,6 +187,8 @@ private:
     std::deque<std::unique_ptr<AudioTask>> audio_playback_queue_;
     // For server AEC
     std::deque<uint32_t> timestamp_queue_;
+    PlaybackClock playback_clock_;
+    AudioTap audio_tap_;
 
     bool wake_word_initialized_ = false;
     bool audio_processor_initialized_ = false;
@@ -0,0 +1,424 @@
+#include "audio_tap.h"
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_random.h>
+#include "esp_audio_enc.h"
+#include "esp_opus_enc.h"
+#include "esp_audio_types.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define TAG "AudioTap"
+
+#define AUDIO_TAP_PCM_RING_SIZE (16 * 1024)
+#define AUDIO_TAP_OUTPUT_RING_SIZE (16 * 1024)
+#define AUDIO_TAP_FRAME_MS 20
+#define AUDIO_TAP_TASK_STACK_SIZE (4096 * 6)
+
+static const char* const POINT_NAMES[] = {
+    "none",
+    "raw_mic",
+    "afe_output",
+    "encoder_input",
+    "decoder_output",
+};
+
+namespace {
+
+// Ogg CRC32: polynomial 0x04c11db7, not reflected, zero initial value
+uint32_t OggCrc(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i << 24;
+            for (int j = 0; j < 8; j++) {
+                r = (r & 0x80000000) ? (r << 1) ^ 0x04c11db7 : r << 1;
+            }
+            table[i] = r;
+        }
+    }
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc << 8) ^ table[((crc >> 24) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+void PutLe(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * Ogg Opus (RFC 7845) with one 20ms packet per page. A change of sample rate or channel
+ * count starts a new chained stream.
+ */
+class OggOpusMuxer {
+public:
+    ~OggOpusMuxer() { Close(); }
+
+    bool Open(int sample_rate, int channels, std::vector<uint8_t>& out) {
+        Close();
+        esp_opus_enc_config_t config = {
+            .sample_rate        = (uint32_t)sample_rate,
+            .channel            = (uint8_t)channels,
+            .bits_per_sample    = ESP_AUDIO_BIT16,
+            .bitrate            = ESP_OPUS_BITRATE_AUTO,
+            .frame_duration     = ESP_OPUS_ENC_FRAME_DURATION_20_MS,
+            .application_mode   = ESP_OPUS_ENC_APPLICATION_AUDIO,
+            .complexity         = 0,
+            .enable_fec         = false,
+            .enable_dtx         = false,
+            .enable_vbr         = true,
+        };
+        auto ret = esp_opus_enc_open(&config, sizeof(config), &encoder_);
+        if (encoder_ == nullptr) {
+            ESP_LOGW(TAG, "Cannot encode %dHz x%d as Opus, error code: %d", sample_rate, channels, ret);
+            return false;
+        }
+        int frame_bytes = 0;
+        int outbuf_size = 0;
+        esp_opus_enc_get_frame_size(encoder_, &frame_bytes, &outbuf_size);
+        frame_samples_ = frame_bytes / sizeof(int16_t);
+        packet_.resize(outbuf_size);
+        serial_ = esp_random();
+        sequence_ = 0;
+        granule_ = 0;
+
+        // OpusHead, then OpusTags, each on its own page
+        std::vector<uint8_t> head = {'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, (uint8_t)channels};
+        PutLe(head, kPreSkip, 2);
+        PutLe(head, sample_rate, 4);
+        PutLe(head, 0, 2);    // Output gain
+        head.push_back(0);    // Mapping family: mono / stereo
+        AppendPage(out, 0x02, 0, head.data(), head.size());
+
+        static const char vendor[] = "xiaozhi audio tap";
+        std::vector<uint8_t> tags = {'O', 'p', 'u', 's', 'T', 'a', 'g', 's'};
+        PutLe(tags, sizeof(vendor) - 1, 4);
+        tags.insert(tags.end(), vendor, vendor + sizeof(vendor) - 1);
+        PutLe(tags, 0, 4);    // No comments
+        AppendPage(out, 0, 0, tags.data(), tags.size());
+        return true;
+    }
+
+    void Close() {
+        if (encoder_ != nullptr) {
+            esp_opus_enc_close(encoder_);
+            encoder_ = nullptr;
+        }
+    }
+
+    size_t frame_samples() const { return frame_samples_; }
+
+    bool Encode(const int16_t* pcm, std::vector<uint8_t>& out) {
+        esp_audio_enc_in_frame_t in = {
+            .buffer = (uint8_t*)pcm,
+            .len = (uint32_t)(frame_samples_ * sizeof(int16_t)),
+        };
+        esp_audio_enc_out_frame_t encoded = {
+            .buffer = packet_.data(),
+            .len = (uint32_t)packet_.size(),
+            .encoded_bytes = 0,
+        };
+        auto ret = esp_opus_enc_process(encoder_, &in, &encoded);
+        if (ret != ESP_AUDIO_ERR_OK) {
+            ESP_LOGW(TAG, "Failed to encode audio, error code: %d", ret);
+            return false;
+        }
+        // Granule positions count 48kHz samples whatever the input rate
+        granule_ += 48000 / 1000 * AUDIO_TAP_FRAME_MS;
+        AppendPage(out, 0, granule_, packet_.data(), encoded.encoded_bytes);
+        return true;
+    }
+
+private:
+    static constexpr int kPreSkip = 312;
+
+    void* encoder_ = nullptr;
+    size_t frame_samples_ = 0;
+    std::vector<uint8_t> packet_;
+    uint32_t serial_ = 0;
+    uint32_t sequence_ = 0;
+    int64_t granule_ = 0;
+
+    void AppendPage(std::vector<uint8_t>& out, uint8_t flags, int64_t granule, const uint8_t* payload, size_t size) {
+        size_t start = out.size();
+        const uint8_t capture[] = {'O', 'g', 'g', 'S', 0, flags};
+        out.insert(out.end(), capture, capture + sizeof(capture));
+        PutLe(out, granule, 8);
+        PutLe(out, serial_, 4);
+        PutLe(out, sequence_++, 4);
+        PutLe(out, 0, 4);    // CRC, filled in below
+        size_t segments = size / 255 + 1;
+        out.push_back(segments);
+        for (size_t i = 0; i + 1 < segments; i++) {
+            out.push_back(255);
+        }
+        out.push_back(size % 255);
+        out.insert(out.end(), payload, payload + size);
+
+        uint32_t crc = OggCrc(out.data() + start, out.size() - start);
+        for (int i = 0; i < 4; i++) {
+            out[start + 22 + i] = (crc >> (8 * i)) & 0xFF;
+        }
+    }
+};
+
+void WavHeader(int sample_rate, int channels, std::vector<uint8_t>& out) {
+    // Sizes are left at the maximum: the stream ends when the client disconnects
+    const uint8_t riff[] = {'R', 'I', 'F', 'F', 0xFF, 0xFF, 0xFF, 0xFF, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' '};
+    out.insert(out.end(), riff, riff + sizeof(riff));
+    PutLe(out, 16, 4);
+    PutLe(out, 1, 2);    // PCM
+    PutLe(out, channels, 2);
+    PutLe(out, sample_rate, 4);
+    PutLe(out, sample_rate * channels * sizeof(int16_t), 4);
+    PutLe(out, channels * sizeof(int16_t), 2);
+    PutLe(out, 16, 2);
+    const uint8_t data[] = {'d', 'a', 't', 'a', 0xFF, 0xFF, 0xFF, 0xFF};
+    out.insert(out.end(), data, data + sizeof(data));
+}
+
+} // namespace
+
+bool AudioTap::Ring::Allocate(size_t size) {
+    data = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (data == nullptr) {
+        data = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    capacity = data != nullptr ? size : 0;
+    return data != nullptr;
+}
+
+void AudioTap::Ring::CopyIn(size_t position, const void* src, size_t size) {
+    size_t offset = position % capacity;
+    size_t first = std::min(size, capacity - offset);
+    memcpy(data + offset, src, first);
+    memcpy(data, (const uint8_t*)src + first, size - first);
+}
+
+void AudioTap::Ring::CopyOut(size_t position, void* dst, size_t size) const {
+    size_t offset = position % capacity;
+    size_t first = std::min(size, capacity - offset);
+    memcpy(dst, data + offset, first);
+    memcpy((uint8_t*)dst + first, data, size - first);
+}
+
+AudioTap::~AudioTap() {
+    Stop();
+    while (task_.load() != nullptr) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    heap_caps_free(pcm_.data);
+    heap_caps_free(output_.data);
+}
+
+void AudioTap::Write(AudioTapPoint point, const int16_t* pcm, size_t samples, int sample_rate, int channels) {
+    // Only one point feeds at a time; a second feeder can only appear while the point is switched
+    if (feeding_.exchange(true, std::memory_order_acquire)) {
+        dropped_frames_++;
+        return;
+    }
+    if (point != point_.load(std::memory_order_acquire)) {
+        feeding_.store(false, std::memory_order_release);
+        return;
+    }
+
+    size_t bytes = samples * sizeof(int16_t);
+    if (samples > UINT16_MAX || pcm_.Free() < sizeof(PcmHeader) + bytes) {
+        dropped_frames_++;
+    } else {
+        PcmHeader header = {(uint16_t)sample_rate, (uint8_t)channels, 0, (uint16_t)samples};
+        size_t head = pcm_.head.load(std::memory_order_relaxed);
+        pcm_.CopyIn(head, &header, sizeof(header));
+        pcm_.CopyIn(head + sizeof(header), pcm, bytes);
+        pcm_.head.store(head + sizeof(header) + bytes, std::memory_order_release);
+        frames_++;
+        TaskHandle_t task = task_.load(std::memory_order_relaxed);
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+    feeding_.store(false, std::memory_order_release);
+}
+
+bool AudioTap::Start(AudioTapPoint point, AudioTapFormat format, std::function<void()> on_data) {
+    Stop();
+    // The previous tap task exits within one wait period once stopped
+    while (task_.load() != nullptr) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (point == kAudioTapNone) {
+        return false;
+    }
+    if (pcm_.data == nullptr && !pcm_.Allocate(AUDIO_TAP_PCM_RING_SIZE)) {
+        ESP_LOGE(TAG, "Failed to allocate the PCM ring");
+        return false;
+    }
+    if (output_.data == nullptr && !output_.Allocate(AUDIO_TAP_OUTPUT_RING_SIZE)) {
+        ESP_LOGE(TAG, "Failed to allocate the output ring");
+        return false;
+    }
+    pcm_.Reset();
+    output_.Reset();
+    tapped_point_ = point;
+    format_ = format;
+    on_data_ = std::move(on_data);
+    frames_ = 0;
+    dropped_frames_ = 0;
+    packets_ = 0;
+    dropped_packets_ = 0;
+
+    running_ = true;
+    TaskHandle_t task = nullptr;
+    if (xTaskCreate([](void* arg) {
+        AudioTap* tap = (AudioTap*)arg;
+        tap->TapTask();
+        vTaskDelete(NULL);
+    }, "audio_tap", AUDIO_TAP_TASK_STACK_SIZE, this, 1, &task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the audio tap task");
+        running_ = false;
+        return false;
+    }
+    task_ = task;
+
+    ESP_LOGI(TAG, "Tapping %s as %s", PointName(point), format == kAudioTapOgg ? "Ogg Opus" : "WAV");
+    point_.store(point, std::memory_order_release);
+    return true;
+}
+
+void AudioTap::Stop() {
+    point_.store(kAudioTapNone, std::memory_order_release);
+    while (feeding_.load(std::memory_order_acquire)) {
+        vTaskDelay(1);
+    }
+    if (running_.exchange(false)) {
+        TaskHandle_t task = task_.load();
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+        ESP_LOGI(TAG, "Stopped tapping %s: %lu frames (%lu dropped), %lu packets (%lu dropped)",
+                 PointName(tapped_point_), frames_.load(), dropped_frames_.load(), packets_.load(), dropped_packets_.load());
+    }
+}
+
+size_t AudioTap::Peek(const uint8_t** data) {
+    size_t tail = output_.tail.load(std::memory_order_relaxed);
+    size_t used = output_.head.load(std::memory_order_acquire) - tail;
+    if (used == 0) {
+        return 0;
+    }
+    size_t offset = tail % output_.capacity;
+    *data = output_.data + offset;
+    return std::min(used, output_.capacity - offset);
+}
+
+void AudioTap::Consume(size_t bytes) {
+    output_.tail.store(output_.tail.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+}
+
+AudioTapPoint AudioTap::PointFromName(const char* name) {
+    for (int i = kAudioTapRawMic; i <= kAudioTapDecoderOutput; i++) {
+        if (strcmp(name, POINT_NAMES[i]) == 0) {
+            return (AudioTapPoint)i;
+        }
+    }
+    return kAudioTapNone;
+}
+
+const char* AudioTap::PointName(AudioTapPoint point) {
+    return POINT_NAMES[point];
+}
+
+void AudioTap::TapTask() {
+    OggOpusMuxer ogg;
+    std::vector<int16_t> pending;
+    std::vector<uint8_t> out;
+    int sample_rate = 0;
+    int channels = 0;
+    size_t frame_samples = 0;
+    bool header_sent = false;
+
+    // Output goes out whole or not at all, so a slow client loses pages but never gets a torn one.
+    // on_data runs either way: a full ring also means the network side should try again.
+    auto flush = [&](bool must_send) {
+        while (output_.Free() < out.size() && must_send && running_) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (output_.Free() < out.size()) {
+            dropped_packets_++;
+        } else {
+            size_t head = output_.head.load(std::memory_order_relaxed);
+            output_.CopyIn(head, out.data(), out.size());
+            output_.head.store(head + out.size(), std::memory_order_release);
+        }
+        out.clear();
+        if (on_data_) {
+            on_data_();
+        }
+    };
+
+    while (running_) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+        while (running_) {
+            size_t tail = pcm_.tail.load(std::memory_order_relaxed);
+            if (tail == pcm_.head.load(std::memory_order_acquire)) {
+                break;
+            }
+            PcmHeader header;
+            pcm_.CopyOut(tail, &header, sizeof(header));
+            size_t offset = pending.size();
+            pending.resize(offset + header.samples);
+            pcm_.CopyOut(tail + sizeof(header), pending.data() + offset, header.samples * sizeof(int16_t));
+            pcm_.tail.store(tail + sizeof(header) + header.samples * sizeof(int16_t), std::memory_order_release);
+
+            if (header.sample_rate != sample_rate || header.channels != channels) {
+                if (format_ == kAudioTapWav && header_sent) {
+                    // A WAV stream cannot change format; keep the first one
+                    pending.resize(offset);
+                    dropped_frames_++;
+                    continue;
+                }
+                sample_rate = header.sample_rate;
+                channels = header.channels;
+                pending.erase(pending.begin(), pending.begin() + offset);
+                if (format_ == kAudioTapOgg) {
+                    header_sent = ogg.Open(sample_rate, channels, out);
+                    frame_samples = header_sent ? ogg.frame_samples() : 0;
+                } else {
+                    WavHeader(sample_rate, channels, out);
+                    header_sent = true;
+                    frame_samples = sample_rate / 1000 * AUDIO_TAP_FRAME_MS * channels;
+                }
+                ESP_LOGI(TAG, "%s: %dHz, %d channel(s)", PointName(tapped_point_), sample_rate, channels);
+                flush(true);
+            }
+            if (!header_sent) {
+                pending.clear();
+                continue;
+            }
+
+            size_t consumed = 0;
+            while (pending.size() - consumed >= frame_samples) {
+                const int16_t* frame = pending.data() + consumed;
+                if (format_ == kAudioTapOgg) {
+                    ogg.Encode(frame, out);
+                } else {
+                    auto bytes = (const uint8_t*)frame;
+                    out.insert(out.end(), bytes, bytes + frame_samples * sizeof(int16_t));
+                }
+                packets_++;
+                flush(false);
+                consumed += frame_samples;
+            }
+            pending.erase(pending.begin(), pending.begin() + consumed);
+        }
+    }
+
+    ogg.Close();
+    task_ = nullptr;
+}
@@ -0,0 +1,109 @@
+#ifndef AUDIO_TAP_H
+#define AUDIO_TAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+enum AudioTapPoint : uint8_t {
+    kAudioTapNone,
+    kAudioTapRawMic,           // Microphone input as read from the codec (resampled to 16 kHz, all channels)
+    kAudioTapAfeOutput,        // Audio processor output
+    kAudioTapEncoderInput,     // PCM handed to the uplink Opus encoder
+    kAudioTapDecoderOutput,    // Downlink PCM after the Opus decoder, before output resampling
+};
+
+enum AudioTapFormat : uint8_t {
+    kAudioTapOgg,              // Ogg Opus, plays in an <audio> element
+    kAudioTapWav,              // 16-bit PCM WAV with an open ended length, lossless
+};
+
+/**
+ * AudioTap - Streams one point of the audio pipeline, selected at runtime
+ *
+ * The audio tasks call Feed() at every tap point. Unless that point is the selected one it
+ * returns after a single atomic load. The selected point's PCM is copied into a lock-free
+ * ring; a full ring drops the frame, so the audio tasks never wait for the tap or the network.
+ *
+ * A tap task takes the PCM off the ring, encodes and muxes it into an output byte stream
+ * (a second lock-free ring) and calls on_data; the network side drains it with Peek/Consume.
+ * Whole Ogg pages are dropped if the network falls behind, which players treat as packet loss.
+ */
+class AudioTap {
+public:
+    ~AudioTap();
+
+    void Feed(AudioTapPoint point, const std::vector<int16_t>& pcm, int sample_rate, int channels) {
+        if (point == point_.load(std::memory_order_relaxed)) {
+            Write(point, pcm.data(), pcm.size(), sample_rate, channels);
+        }
+    }
+
+    /**
+     * Start tapping point, replacing any running tap. on_data runs in the tap task whenever
+     * new output is available and should only hand off to the network task.
+     */
+    bool Start(AudioTapPoint point, AudioTapFormat format, std::function<void()> on_data);
+
+    /**
+     * Stop tapping; does not wait for the tap task to exit
+     */
+    void Stop();
+
+    /**
+     * Contiguous output bytes ready to send (single consumer); returns 0 if none
+     */
+    size_t Peek(const uint8_t** data);
+    void Consume(size_t bytes);
+
+    static AudioTapPoint PointFromName(const char* name);
+    static const char* PointName(AudioTapPoint point);
+
+private:
+    // Single producer / single consumer byte ring, positions grow monotonically
+    struct Ring {
+        uint8_t* data = nullptr;
+        size_t capacity = 0;
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+
+        bool Allocate(size_t size);
+        void Reset() { head = 0; tail = 0; }
+        size_t Free() const { return capacity - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire)); }
+        void CopyIn(size_t position, const void* src, size_t size);
+        void CopyOut(size_t position, void* dst, size_t size) const;
+    };
+
+    struct PcmHeader {
+        uint16_t sample_rate;
+        uint8_t channels;
+        uint8_t reserved;
+        uint16_t samples;
+    };
+
+    std::atomic<AudioTapPoint> point_{kAudioTapNone};
+    std::atomic<bool> feeding_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<TaskHandle_t> task_{nullptr};
+    AudioTapPoint tapped_point_ = kAudioTapNone;
+    AudioTapFormat format_ = kAudioTapOgg;
+    std::function<void()> on_data_;
+    Ring pcm_;
+    Ring output_;
+
+    // Logged when the tap stops
+    std::atomic<uint32_t> frames_{0};           // PCM frames taken from the selected point
+    std::atomic<uint32_t> dropped_frames_{0};   // PCM frames dropped: ring full, or a WAV format change
+    std::atomic<uint32_t> packets_{0};          // Frames encoded for the output stream
+    std::atomic<uint32_t> dropped_packets_{0};  // Output dropped because the network fell behind
+
+    void Write(AudioTapPoint point, const int16_t* pcm, size_t samples, int sample_rate, int channels);
+    void TapTask();
+};
+
+#endif // AUDIO_TAP_H
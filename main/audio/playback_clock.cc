@@ -0,0 +1,86 @@
+#include "playback_clock.h"
+
+#include <esp_timer.h>
+
+// A cue never waits longer than this, even if its audio never gets played
+#define PLAYBACK_CUE_TIMEOUT_US (5 * 1000 * 1000)
+
+void PlaybackClock::OnFrameQueued() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_++;
+}
+
+void PlaybackClock::OnFramePlayed() {
+    std::deque<Cue> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Local sounds and test playback can play frames that were never counted as queued
+        if (played_ != queued_) {
+            played_++;
+        }
+        if (cues_.empty()) {
+            return;
+        }
+        TakeDueLocked(due, esp_timer_get_time());
+    }
+    for (auto& cue : due) {
+        cue.callback();
+    }
+}
+
+void PlaybackClock::AddCue(std::function<void()> cue) {
+    std::deque<Cue> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.cues++;
+        int64_t now_us = esp_timer_get_time();
+        if (played_ == queued_ && cues_.empty()) {
+            due.push_back(Cue{queued_, now_us, std::move(cue)});
+        } else {
+            stats_.deferred++;
+            cues_.push_back(Cue{queued_, now_us, std::move(cue)});
+            TakeDueLocked(due, now_us);
+        }
+    }
+    for (auto& item : due) {
+        item.callback();
+    }
+}
+
+void PlaybackClock::Reset() {
+    std::deque<Cue> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        played_ = queued_;
+        due = std::move(cues_);
+        cues_.clear();
+    }
+    for (auto& cue : due) {
+        cue.callback();
+    }
+}
+
+PlaybackClock::Stats PlaybackClock::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void PlaybackClock::TakeDueLocked(std::deque<Cue>& due, int64_t now_us) {
+    // Positions only grow, so cues are already in release order
+    while (!cues_.empty()) {
+        auto& cue = cues_.front();
+        int64_t waited_us = now_us - cue.time_us;
+        // Wrap-safe "played_ >= position"
+        if ((int32_t)(played_ - cue.position) < 0) {
+            if (waited_us < PLAYBACK_CUE_TIMEOUT_US) {
+                break;
+            }
+            stats_.expired++;
+        }
+        if (waited_us > stats_.max_wait_us) {
+            stats_.max_wait_us = waited_us;
+        }
+        due.push_back(std::move(cue));
+        cues_.pop_front();
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef PLAYBACK_CLOCK_H
+#define PLAYBACK_CLOCK_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+/*
+ * Downlink playback clock measured in frames: every frame that enters the decode queue
+ * advances the queued position, every frame that reaches the speaker advances the
+ * played position.
+ *
+ * A cue (text, emotion, motion) is stamped with the queued position when it arrives,
+ * i.e. the point in the stream where the audio that follows it starts, and runs once
+ * playback gets there instead of when the message lands.
+ */
+class PlaybackClock {
+public:
+    struct Stats {
+        uint32_t cues;
+        uint32_t deferred;         // Cues that had to wait for audio
+        int64_t max_wait_us;       // Longest a deferred cue waited
+        uint32_t expired;          // Released by the timeout instead of playback
+    };
+
+    /**
+     * Called when a downlink frame enters the decode queue
+     */
+    void OnFrameQueued();
+
+    /**
+     * Called after a frame has been written to the speaker (or dropped by the decoder).
+     * Runs the cues that are due, in the calling task.
+     */
+    void OnFramePlayed();
+
+    /**
+     * Run cue when the audio queued so far has been played; right away if nothing is pending
+     */
+    void AddCue(std::function<void()> cue);
+
+    /**
+     * The queues were cleared: resynchronize and run all pending cues now
+     */
+    void Reset();
+
+    Stats GetStats();
+
+private:
+    struct Cue {
+        uint32_t position;
+        int64_t time_us;
+        std::function<void()> callback;
+    };
+
+    std::mutex mutex_;
+    uint32_t queued_ = 0;
+    uint32_t played_ = 0;
+    std::deque<Cue> cues_;
+    Stats stats_{};
+
+    void TakeDueLocked(std::deque<Cue>& due, int64_t now_us);
+};
+
+#endif // PLAYBACK_CLOCK_H
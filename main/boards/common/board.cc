@@ -1,4 +1,5 @@
 #include "board.h"
+#include "application.h"
 #include "system_info.h"
 #include "settings.h"
 #include "display/display.h"
@@ -9,6 +10,7 @@
 #include <esp_ota_ops.h>
 #include <esp_chip_info.h>
 #include <esp_random.h>
+#include <cJSON.h>
 
 #define TAG "Board"
 
@@ -45,6 +47,20 @@ std::string Board::GenerateUuid() {
     return std::string(uuid_str);
 }
 
+void Board::AddLinkStatsJson(cJSON* network) {
+    LinkStats link;
+    if (!Application::GetInstance().GetLinkStats(link) || (link.rtt_ms < 0 && link.audio_received == 0)) {
+        return;
+    }
+    auto link_json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(link_json, "rtt_ms", link.rtt_ms);
+    cJSON_AddNumberToObject(link_json, "rtt_min_ms", link.rtt_min_ms);
+    cJSON_AddNumberToObject(link_json, "jitter_ms", link.jitter_ms);
+    uint32_t expected = link.audio_received + link.audio_lost;
+    cJSON_AddNumberToObject(link_json, "loss_percent", expected > 0 ? link.audio_lost * 100.0 / expected : 0);
+    cJSON_AddItemToObject(network, "link", link_json);
+}
+
 bool Board::GetBatteryLevel(int &level, bool& charging, bool& discharging) {
     return false;
 }
@@ -44,6 +44,7 @@ enum class PowerSaveLevel {
 using NetworkEventCallback = std::function<void(NetworkEvent event, const std::string& data)>;
 
 void* create_board();
+struct cJSON;
 class AudioCodec;
 class Display;
 class Board {
@@ -54,6 +55,8 @@ private:
 protected:
     Board();
     std::string GenerateUuid();
+    // Adds the link quality measured by the protocol to a device status "network" object
+    void AddLinkStatsJson(cJSON* network);
 
     // 软件生成的设备唯一标识
     std::string uuid_;
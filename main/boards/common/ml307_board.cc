@@ -206,7 +206,13 @@ std::string Ml307Board::GetDeviceStatusJson() {
      *     "network": {
      *         "type": "cellular",
      *         "carrier": "CHINA MOBILE",
-     *         "csq": 10
+     *         "csq": 10,
+     *         "link": {
+     *             "rtt_ms": 80,
+     *             "rtt_min_ms": 60,
+     *             "jitter_ms": 12,
+     *             "loss_percent": 0.5
+     *         }
      *     }
      * }
      */
@@ -263,6 +269,8 @@ std::string Ml307Board::GetDeviceStatusJson() {
     } else if (csq >= 25 && csq <= 31) {
         cJSON_AddStringToObject(network, "signal", "strong");
     }
+
+    AddLinkStatsJson(network);
     cJSON_AddItemToObject(root, "network", network);
 
     auto json_str = cJSON_PrintUnformatted(root);
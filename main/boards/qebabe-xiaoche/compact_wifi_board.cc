@@ -7,6 +7,7 @@
 #include "button.h"
 #include "config.h"
 #include "mcp_server.h"
+#include "emotion_table.h"
 #include "lamp_controller.h"
 #include "led/single_led.h"
 #include "assets/lang_config.h"
@@ -286,7 +287,7 @@ private:
             });
 
         mcp_server.AddTool("self.motor.wiggle",
-            "Make the robot perform a quick wiggle movement (turn right briefly).\n"
+            "Make the robot perform a quick wiggle movement (right-left-right turns).\n"
             "Args:\n"
             "  `speed_percent`: Motor speed (0-100), default 100\n"
             "Return:\n"
@@ -473,48 +474,14 @@ private:
     }
 
     void MotorWiggle(uint8_t speed_percent = 100) {
-        // Simple wiggle - just a quick left-right movement for MCP calls
-        // Since MCP calls are synchronous, we can't use delays
-        HandleMotorActionForApplication(1, speed_percent, 300, 2); // right turn, high priority
+        Application::GetInstance().PlayRoutine("wiggle", speed_percent, 2); // high priority
     }
 
 public:
     void MotorDance(uint8_t speed_percent = 100) {
-        ESP_LOGI(TAG, "电机跳舞: 执行完整的舞蹈序列 (速度: %d%%)", speed_percent);
-
-        // 舞蹈序列：前进 -> 左转 -> 右转 -> 后退 -> 前进 -> 左转 -> 右转 -> 结束
-        // 使用高优先级确保舞蹈动作不被其他动作打断
-
-        // 第一步：快速前进
-        HandleMotorActionForApplication(4, speed_percent, 300, 2); // forward
-        vTaskDelay(pdMS_TO_TICKS(350));
-
-        // 第二步：左转
-        HandleMotorActionForApplication(3, speed_percent, 250, 2); // left
-        vTaskDelay(pdMS_TO_TICKS(300));
-
-        // 第三步：右转
-        HandleMotorActionForApplication(1, speed_percent, 250, 2); // right
-        vTaskDelay(pdMS_TO_TICKS(300));
-
-        // 第四步：后退
-        HandleMotorActionForApplication(2, speed_percent, 300, 2); // backward
-        vTaskDelay(pdMS_TO_TICKS(350));
-
-        // 第五步：前进
-        HandleMotorActionForApplication(4, speed_percent, 200, 2); // forward
-        vTaskDelay(pdMS_TO_TICKS(250));
-
-        // 第六步：左转
-        HandleMotorActionForApplication(3, speed_percent, 200, 2); // left
-        vTaskDelay(pdMS_TO_TICKS(250));
-
-        // 第七步：右转
-        HandleMotorActionForApplication(1, speed_percent, 200, 2); // right
-        vTaskDelay(pdMS_TO_TICKS(250));
-
-        // 第八步：最终前进结束舞蹈
-        HandleMotorActionForApplication(4, speed_percent, 400, 2); // forward
+        // 舞蹈序列由编舞例程 "dance" 定义（assets/choreography/routines.json），由电机调度器按关键帧执行，
+        // 不再阻塞调用者；使用高优先级确保舞蹈动作不被其他动作打断
+        Application::GetInstance().PlayRoutine("dance", speed_percent, 2);
     }
 
 public:
@@ -544,79 +511,17 @@ public:
     }
 
     // Motor control interface for different emotions and actions
-    void OnWakeUp() {
-        ESP_LOGI(TAG, "电机情感: 唤醒被触发 - 执行兴奋动作");
-        PerformMotorAction(1, 300); // FORWARD for 300ms - 兴奋的前进动作
-    }
-
-    void OnHappy() {
-        ESP_LOGI(TAG, "电机情感: 开心被触发 - 执行欢快动作");
-        PerformMotorAction(1, 200); // FORWARD for 200ms - 简单的开心动作
-        vTaskDelay(pdMS_TO_TICKS(100));
-        PerformMotorAction(3, 200); // LEFT for 200ms - 左转表示开心
-    }
-
-    void OnSad() {
-        ESP_LOGI(TAG, "电机情感: 悲伤被触发 - 执行缓慢动作");
-        PerformMotorAction(2, 400); // BACKWARD for 400ms - 缓慢后退表示悲伤
-    }
-
-    void OnThinking() {
-        ESP_LOGI(TAG, "电机情感: 思考被触发 - 执行轻微动作");
-        PerformMotorAction(3, 150); // LEFT for 150ms - 轻微左转表示思考
-        vTaskDelay(pdMS_TO_TICKS(200));
-        PerformMotorAction(4, 150); // RIGHT for 150ms - 右转表示思考
-    }
-
-    void OnListening() {
-        ESP_LOGI(TAG, "电机情感: 倾听被触发 - 执行轻柔动作");
-        PerformMotorAction(3, 100); // LEFT for 100ms - 轻柔左转
-        vTaskDelay(pdMS_TO_TICKS(150));
-        PerformMotorAction(4, 100); // RIGHT for 100ms - 右转表示倾听
-    }
-
-    void OnSpeaking() {
-        ESP_LOGI(TAG, "电机情感: 说话被触发 - 执行前进动作");
-        PerformMotorAction(1, 250); // FORWARD for 250ms - 前进表示说话
-    }
-
-    void OnExcited() {
-        ESP_LOGI(TAG, "电机情感: 兴奋被触发 - 执行快速动作");
-        PerformMotorAction(1, 150); // FORWARD for 150ms - 快速前进
-        vTaskDelay(pdMS_TO_TICKS(50));
-        PerformMotorAction(3, 150); // LEFT for 150ms - 快速左转
-        vTaskDelay(pdMS_TO_TICKS(50));
-        PerformMotorAction(4, 150); // RIGHT for 150ms - 快速右转
-    }
-
-    void OnLoving() {
-        ESP_LOGI(TAG, "电机情感: 爱慕被触发 - 执行温柔动作");
-        PerformMotorAction(1, 300); // FORWARD for 300ms - 温柔前进
-        vTaskDelay(pdMS_TO_TICKS(200));
-        PerformMotorAction(3, 200); // LEFT for 200ms - 轻柔左转
-    }
-
-    void OnAngry() {
-        ESP_LOGI(TAG, "电机情感: 生气被触发 - 执行强烈动作");
-        PerformMotorAction(2, 200); // BACKWARD for 200ms - 后退表示生气
-        vTaskDelay(pdMS_TO_TICKS(100));
-        PerformMotorAction(1, 200); // FORWARD for 200ms - 前冲表示生气
-    }
-
-    void OnSurprised() {
-        ESP_LOGI(TAG, "电机情感: 惊讶被触发 - 执行突然动作");
-        PerformMotorAction(2, 100); // BACKWARD for 100ms - 快速后退
-        vTaskDelay(pdMS_TO_TICKS(150));
-        PerformMotorAction(1, 200); // FORWARD for 200ms - 前进表示惊讶
-    }
-
-    void OnConfused() {
-        ESP_LOGI(TAG, "电机情感: 困惑被触发 - 执行犹豫动作");
-        PerformMotorAction(3, 100); // LEFT for 100ms - 犹豫左转
-        vTaskDelay(pdMS_TO_TICKS(200));
-        PerformMotorAction(4, 100); // RIGHT for 100ms - 犹豫右转
-        vTaskDelay(pdMS_TO_TICKS(200));
-        PerformMotorAction(3, 100); // LEFT for 100ms - 再次犹豫
+    // 情感手势由同名编舞例程定义（happy、sad ...），中优先级：可被 MCP 命令打断
+    void PlayGesture(EmotionGesture gesture) {
+        static const char* const kGestureRoutines[] = {
+            nullptr, "wake_up", "happy", "sad", "thinking", "listening", "speaking",
+            "excited", "loving", "angry", "surprised", "confused",
+        };
+        static_assert(sizeof(kGestureRoutines) / sizeof(kGestureRoutines[0]) == kGestureConfused + 1,
+                      "Every gesture needs a routine");
+        if (gesture != kGestureNone && gesture <= kGestureConfused) {
+            Application::GetInstance().PlayRoutine(kGestureRoutines[gesture], 100, 1);
+        }
     }
 
     void OnIdle() {
@@ -627,61 +532,18 @@ public:
             HandleMotorActionForApplication(random_action, 60, 500, 0); // 60% speed, 500ms duration, low priority
         }
     }
-
-    // 电机动作执行函数实现 - 使用Application的统一PWM系统
-    void PerformMotorAction(int action, int duration_ms) {
-        uint8_t speed_percent = 80; // 使用80%的速度进行情感表达动作
-
-        // Emotion actions use medium priority (1) - can be interrupted by MCP commands (2) but not by lower priority
-        switch (action) {
-            case 1: // FORWARD
-                HandleMotorActionForApplication(4, speed_percent, duration_ms, 1);
-                break;
-            case 2: // BACKWARD
-                HandleMotorActionForApplication(2, speed_percent, duration_ms, 1);
-                break;
-            case 3: // LEFT
-                HandleMotorActionForApplication(3, speed_percent, duration_ms, 1);
-                break;
-            case 4: // RIGHT
-                HandleMotorActionForApplication(1, speed_percent, duration_ms, 1);
-                break;
-            default:
-                break;
-        }
-    }
 };
 
 // Public wrapper functions for motor control
 extern "C" void HandleMotorActionForEmotion(const char* emotion) {
     auto board = static_cast<CompactWifiBoard*>(&Board::GetInstance());
     if (emotion) {
-        std::string emotion_str(emotion);
-        if (emotion_str == "happy" || emotion_str == "joy") {
-            board->OnHappy();
-        } else if (emotion_str == "excited") {
-            board->OnExcited();
-        } else if (emotion_str == "sad" || emotion_str == "unhappy") {
-            board->OnSad();
-        } else if (emotion_str == "thinking") {
-            board->OnThinking();
-        } else if (emotion_str == "confused") {
-            board->OnConfused();
-        } else if (emotion_str == "listening" || emotion_str == "curious") {
-            board->OnListening();
-        } else if (emotion_str == "speaking" || emotion_str == "talking") {
-            board->OnSpeaking();
-        } else if (emotion_str == "wake" || emotion_str == "wakeup") {
-            board->OnWakeUp();
-        } else if (emotion_str == "loving") {
-            board->OnLoving();
-        } else if (emotion_str == "angry") {
-            board->OnAngry();
-        } else if (emotion_str == "surprised") {
-            board->OnSurprised();
-        } else {
-            ESP_LOGW(TAG, "Unknown emotion: %s", emotion_str.c_str());
+        auto gesture = GetEmotionInfo(ResolveEmotion(emotion)).gesture;
+        if (gesture == kGestureNone) {
+            ESP_LOGW(TAG, "Unknown emotion: %s", emotion);
+            return;
         }
+        board->PlayGesture(gesture);
     }
 }
 
@@ -0,0 +1,69 @@
+#include "choreography.h"
+#include "choreography_builtin.h"
+
+#include <esp_log.h>
+
+#include <cstring>
+
+#define TAG "Choreography"
+
+#define CHOREO_VERSION 1
+#define CHOREO_HEADER_SIZE 8
+#define CHOREO_NAME_SIZE 16
+#define CHOREO_ROUTINE_SIZE (CHOREO_NAME_SIZE + 4)
+
+static uint16_t ReadU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+bool ChoreographyLibrary::Load(const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    if (size < CHOREO_HEADER_SIZE || memcmp(bytes, "CHOR", 4) != 0) {
+        ESP_LOGE(TAG, "Not a choreography file");
+        return false;
+    }
+    if (bytes[4] != CHOREO_VERSION) {
+        ESP_LOGE(TAG, "Choreography version %d is not supported", bytes[4]);
+        return false;
+    }
+
+    size_t routine_count = bytes[5];
+    size_t keyframe_count = ReadU16(bytes + 6);
+    size_t keyframes_offset = CHOREO_HEADER_SIZE + routine_count * CHOREO_ROUTINE_SIZE;
+    if (keyframes_offset + keyframe_count * sizeof(ChoreoKeyframe) > size) {
+        ESP_LOGE(TAG, "Choreography file is truncated (%u bytes)", size);
+        return false;
+    }
+    auto keyframes = reinterpret_cast<const ChoreoKeyframe*>(bytes + keyframes_offset);
+
+    std::vector<ChoreoRoutine> routines;
+    routines.reserve(routine_count);
+    for (size_t i = 0; i < routine_count; i++) {
+        auto entry = bytes + CHOREO_HEADER_SIZE + i * CHOREO_ROUTINE_SIZE;
+        auto name = reinterpret_cast<const char*>(entry);
+        uint16_t first = ReadU16(entry + CHOREO_NAME_SIZE);
+        uint16_t count = ReadU16(entry + CHOREO_NAME_SIZE + 2);
+        if (count == 0 || first + count > keyframe_count) {
+            ESP_LOGE(TAG, "Routine %u has invalid keyframes (%u+%u of %u)", i, first, count, keyframe_count);
+            return false;
+        }
+        routines.push_back(ChoreoRoutine{std::string_view(name, strnlen(name, CHOREO_NAME_SIZE)), keyframes + first, count});
+    }
+
+    routines_ = std::move(routines);
+    ESP_LOGI(TAG, "Loaded %u routines, %u keyframes", routine_count, keyframe_count);
+    return true;
+}
+
+void ChoreographyLibrary::LoadBuiltin() {
+    Load(kBuiltinChoreography, sizeof(kBuiltinChoreography));
+}
+
+const ChoreoRoutine* ChoreographyLibrary::Find(std::string_view name) const {
+    for (auto& routine : routines_) {
+        if (routine.name == name) {
+            return &routine;
+        }
+    }
+    return nullptr;
+}
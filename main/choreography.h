@@ -0,0 +1,69 @@
+#ifndef CHOREOGRAPHY_H
+#define CHOREOGRAPHY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * Choreography - Precompiled motor routines (dance, wiggle, emotion gestures)
+ *
+ * Routines are written as JSON (main/assets/choreography/routines.json) and compiled by
+ * scripts/choreography_compiler.py into a small binary, which ships as choreography.bin in
+ * the assets partition and, as a fallback, built into the firmware. New routines can
+ * therefore be delivered with an assets update instead of a reflash.
+ *
+ * Binary layout (little endian, version 1):
+ *   header    "CHOR", uint8 version, uint8 routine_count, uint16 keyframe_count
+ *   routines  routine_count x { char name[16] (NUL padded), uint16 first, uint16 count }
+ *   keyframes keyframe_count x ChoreoKeyframe
+ *
+ * Every field is read byte by byte, so the data can be used in place from the mmapped
+ * partition whatever its alignment.
+ */
+
+enum ChoreoEasing : uint8_t {
+    kEaseDefault,    // The motion planner's configured profile
+    kEaseLinear,     // Constant acceleration
+    kEaseSmooth,     // S-curve
+    kEaseStep,       // Jump to the new speed
+};
+
+struct ChoreoKeyframe {
+    uint8_t direction;       // 0=pause, 1=right, 2=backward, 3=left, 4=forward
+    uint8_t speed;           // Percent, scaled by the speed the routine is played at
+    uint8_t easing;          // ChoreoEasing used to reach this keyframe's speed
+    uint8_t duration[2];     // Milliseconds
+
+    uint16_t duration_ms() const { return duration[0] | (duration[1] << 8); }
+};
+static_assert(sizeof(ChoreoKeyframe) == 5, "ChoreoKeyframe must match the compiled layout");
+
+struct ChoreoRoutine {
+    std::string_view name;
+    const ChoreoKeyframe* keyframes;
+    uint16_t keyframe_count;
+};
+
+class ChoreographyLibrary {
+public:
+    /**
+     * Use a compiled choreography; the data must stay valid until the next Load().
+     * Returns false, keeping the current routines, if the data is malformed.
+     */
+    bool Load(const void* data, size_t size);
+
+    /**
+     * Use the routines built into the firmware
+     */
+    void LoadBuiltin();
+
+    const ChoreoRoutine* Find(std::string_view name) const;
+    size_t routine_count() const { return routines_.size(); }
+
+private:
+    std::vector<ChoreoRoutine> routines_;
+};
+
+#endif // CHOREOGRAPHY_H
@@ -0,0 +1,53 @@
+// Auto-generated by scripts/choreography_compiler.py from routines.json, do not edit
+#pragma once
+
+#include <cstdint>
+
+static const uint8_t kBuiltinChoreography[] = {
+    0x43, 0x48, 0x4f, 0x52, 0x01, 0x16, 0x39, 0x00, 0x64, 0x61, 0x6e, 0x63, 0x65, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x77, 0x69, 0x67, 0x67,
+    0x6c, 0x65, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x03, 0x00,
+    0x74, 0x77, 0x69, 0x74, 0x63, 0x68, 0x5f, 0x66, 0x6f, 0x72, 0x77, 0x61, 0x72, 0x64, 0x00, 0x00,
+    0x12, 0x00, 0x01, 0x00, 0x74, 0x77, 0x69, 0x74, 0x63, 0x68, 0x5f, 0x62, 0x61, 0x63, 0x6b, 0x77,
+    0x61, 0x72, 0x64, 0x00, 0x13, 0x00, 0x01, 0x00, 0x77, 0x69, 0x67, 0x67, 0x6c, 0x65, 0x5f, 0x71,
+    0x75, 0x69, 0x63, 0x6b, 0x00, 0x00, 0x00, 0x00, 0x14, 0x00, 0x02, 0x00, 0x6e, 0x6f, 0x64, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x16, 0x00, 0x01, 0x00,
+    0x74, 0x69, 0x6c, 0x74, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x17, 0x00, 0x02, 0x00, 0x72, 0x65, 0x63, 0x6f, 0x69, 0x6c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x19, 0x00, 0x02, 0x00, 0x77, 0x61, 0x6b, 0x65, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x02, 0x00, 0x73, 0x70, 0x65, 0x61,
+    0x6b, 0x5f, 0x73, 0x74, 0x61, 0x72, 0x74, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1d, 0x00, 0x01, 0x00,
+    0x73, 0x70, 0x65, 0x61, 0x6b, 0x5f, 0x65, 0x6e, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1e, 0x00, 0x01, 0x00, 0x77, 0x61, 0x6b, 0x65, 0x5f, 0x75, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x01, 0x00, 0x68, 0x61, 0x70, 0x70, 0x79, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x02, 0x00, 0x73, 0x61, 0x64, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x22, 0x00, 0x01, 0x00,
+    0x74, 0x68, 0x69, 0x6e, 0x6b, 0x69, 0x6e, 0x67, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x23, 0x00, 0x03, 0x00, 0x6c, 0x69, 0x73, 0x74, 0x65, 0x6e, 0x69, 0x6e, 0x67, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x26, 0x00, 0x03, 0x00, 0x73, 0x70, 0x65, 0x61, 0x6b, 0x69, 0x6e, 0x67,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0x00, 0x01, 0x00, 0x65, 0x78, 0x63, 0x69,
+    0x74, 0x65, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2a, 0x00, 0x03, 0x00,
+    0x6c, 0x6f, 0x76, 0x69, 0x6e, 0x67, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2d, 0x00, 0x02, 0x00, 0x61, 0x6e, 0x67, 0x72, 0x79, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x2f, 0x00, 0x02, 0x00, 0x73, 0x75, 0x72, 0x70, 0x72, 0x69, 0x73, 0x65,
+    0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x31, 0x00, 0x03, 0x00, 0x63, 0x6f, 0x6e, 0x66,
+    0x75, 0x73, 0x65, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x34, 0x00, 0x05, 0x00,
+    0x04, 0x64, 0x00, 0x2c, 0x01, 0x00, 0x00, 0x00, 0x32, 0x00, 0x03, 0x64, 0x00, 0xfa, 0x00, 0x00,
+    0x00, 0x00, 0x32, 0x00, 0x01, 0x64, 0x00, 0xfa, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x02, 0x64,
+    0x00, 0x2c, 0x01, 0x00, 0x00, 0x00, 0x32, 0x00, 0x04, 0x64, 0x00, 0xc8, 0x00, 0x00, 0x00, 0x00,
+    0x32, 0x00, 0x03, 0x64, 0x00, 0xc8, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x01, 0x64, 0x00, 0xc8,
+    0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x04, 0x64, 0x00, 0x90, 0x01, 0x01, 0x64, 0x00, 0x64, 0x00,
+    0x03, 0x64, 0x00, 0x64, 0x00, 0x01, 0x64, 0x00, 0x64, 0x00, 0x04, 0x64, 0x00, 0xc8, 0x00, 0x02,
+    0x64, 0x00, 0x96, 0x00, 0x03, 0x64, 0x00, 0x64, 0x00, 0x01, 0x64, 0x00, 0x64, 0x00, 0x04, 0x64,
+    0x00, 0x41, 0x03, 0x03, 0x32, 0x00, 0x96, 0x00, 0x01, 0x32, 0x00, 0x96, 0x00, 0x02, 0x64, 0x03,
+    0x41, 0x03, 0x04, 0x64, 0x00, 0x41, 0x03, 0x04, 0x28, 0x00, 0xc8, 0x00, 0x02, 0x28, 0x00, 0xc8,
+    0x00, 0x04, 0x32, 0x00, 0xfa, 0x00, 0x02, 0x2d, 0x00, 0xdc, 0x00, 0x04, 0x50, 0x00, 0x2c, 0x01,
+    0x04, 0x50, 0x00, 0xc8, 0x00, 0x03, 0x50, 0x00, 0xc8, 0x00, 0x02, 0x50, 0x02, 0x90, 0x01, 0x03,
+    0x50, 0x00, 0x96, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x01, 0x50, 0x00, 0x96, 0x00, 0x03, 0x50,
+    0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x01, 0x50, 0x00, 0x64, 0x00, 0x04, 0x50, 0x00,
+    0xfa, 0x00, 0x04, 0x50, 0x00, 0x96, 0x00, 0x03, 0x50, 0x00, 0x96, 0x00, 0x01, 0x50, 0x00, 0x96,
+    0x00, 0x04, 0x50, 0x02, 0x2c, 0x01, 0x03, 0x50, 0x02, 0xc8, 0x00, 0x02, 0x50, 0x00, 0xc8, 0x00,
+    0x04, 0x50, 0x00, 0xc8, 0x00, 0x02, 0x50, 0x03, 0x64, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x04,
+    0x50, 0x00, 0xc8, 0x00, 0x03, 0x50, 0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x64, 0x00, 0x01, 0x50,
+    0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x64, 0x00, 0x03, 0x50, 0x00, 0x64, 0x00,
+};
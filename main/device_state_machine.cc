@@ -2,9 +2,17 @@
 
 #include <algorithm>
 #include <esp_log.h>
+#include <esp_pthread.h>
+#include <esp_timer.h>
 
 static const char* TAG = "StateMachine";
 
+// Pending changes kept per async listener; the oldest is dropped when full
+#define STATE_LISTENER_QUEUE_DEPTH 8
+#define STATE_LISTENER_PRIORITY 3
+// Sync listeners taking longer than this for one transition are logged
+#define STATE_NOTIFY_WARN_US 20000
+
 // State name strings for logging
 static const char* const STATE_STRINGS[] = {
     "unknown",
@@ -21,7 +29,7 @@ static const char* const STATE_STRINGS[] = {
     "invalid_state"
 };
 
-DeviceStateMachine::DeviceStateMachine() {
+DeviceStateMachine::DeviceStateMachine() : listeners_(std::make_shared<ListenerList>()) {
 }
 
 const char* DeviceStateMachine::GetStateName(DeviceState state) {
@@ -106,56 +114,213 @@ bool DeviceStateMachine::CanTransitionTo(DeviceState target) const {
 }
 
 bool DeviceStateMachine::TransitionTo(DeviceState new_state) {
-    DeviceState old_state = current_state_.load();
-    
-    // No-op if already in the target state
-    if (old_state == new_state) {
-        return true;
-    }
+    DeviceState old_state;
+    bool deliver;
+    {
+        // The check, the change, its sequence number and its place in the delivery queue
+        // are one step, so changes are delivered in the order the state actually changed in
+        std::lock_guard<std::mutex> lock(mutex_);
+        old_state = current_state_.load();
+
+        // No-op if already in the target state
+        if (old_state == new_state) {
+            return true;
+        }
 
-    // Validate transition
-    if (!IsValidTransition(old_state, new_state)) {
-        ESP_LOGW(TAG, "Invalid state transition: %s -> %s",
-                 GetStateName(old_state), GetStateName(new_state));
-        return false;
+        // Validate transition
+        if (!IsValidTransition(old_state, new_state)) {
+            ESP_LOGW(TAG, "Invalid state transition: %s -> %s",
+                     GetStateName(old_state), GetStateName(new_state));
+            return false;
+        }
+        current_state_.store(new_state);
+        changes_.push_back(StateChange{++sequence_, old_state, new_state, esp_timer_get_time()});
+        // A task already delivering, possibly this one from inside a listener, picks the
+        // change up after the ones before it
+        deliver = !delivering_;
+        delivering_ = true;
     }
 
-    // Perform transition
-    current_state_.store(new_state);
     ESP_LOGI(TAG, "State: %s -> %s",
              GetStateName(old_state), GetStateName(new_state));
 
-    // Notify callback
-    NotifyStateChange(old_state, new_state);
+    if (deliver) {
+        DeliverStateChanges();
+    }
     return true;
 }
 
-int DeviceStateMachine::AddStateChangeListener(StateCallback callback) {
+int DeviceStateMachine::AddStateChangeListener(StateCallback callback, StateListenerDelivery delivery) {
+    auto listener = std::make_shared<Listener>();
+    listener->callback = std::move(callback);
+    listener->delivery = delivery;
+
+    if (delivery == kStateListenerAsync) {
+        esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+        cfg.thread_name = "state_listener";
+        cfg.stack_size = 4096;
+        cfg.prio = STATE_LISTENER_PRIORITY;
+        esp_pthread_set_cfg(&cfg);
+        listener->thread = std::thread(ListenerTask, listener.get(), this);
+        cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&cfg);
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
     int id = next_listener_id_++;
-    listeners_.emplace_back(id, std::move(callback));
+    listener->id = id;
+    auto listeners = std::make_shared<ListenerList>(*listeners_);
+    listeners->push_back(std::move(listener));
+    listeners_ = std::move(listeners);
     return id;
 }
 
 void DeviceStateMachine::RemoveStateChangeListener(int listener_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    listeners_.erase(
-        std::remove_if(listeners_.begin(), listeners_.end(),
-            [listener_id](const auto& p) { return p.first == listener_id; }),
-        listeners_.end());
+    std::shared_ptr<Listener> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto listeners = std::make_shared<ListenerList>(*listeners_);
+        auto it = std::find_if(listeners->begin(), listeners->end(),
+            [listener_id](const auto& listener) { return listener->id == listener_id; });
+        if (it == listeners->end()) {
+            return;
+        }
+        removed = *it;
+        listeners->erase(it);
+        listeners_ = std::move(listeners);
+        if (removed->delivery == kStateListenerAsync) {
+            // Not joined here, since a listener may remove itself from its own task
+            removed_listeners_.push_back(removed);
+        }
+    }
+
+    // A delivery that took its snapshot before the removal may still call a sync
+    // listener once; async listeners stop taking changes from here on
+    if (removed->delivery == kStateListenerAsync) {
+        StopListener(*removed);
+    }
 }
 
-void DeviceStateMachine::NotifyStateChange(DeviceState old_state, DeviceState new_state) {
-    std::vector<StateCallback> callbacks_copy;
+DeviceStateMachine::~DeviceStateMachine() {
+    std::vector<std::shared_ptr<Listener>> listeners;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        callbacks_copy.reserve(listeners_.size());
-        for (const auto& [id, cb] : listeners_) {
-            callbacks_copy.push_back(cb);
+        listeners.assign(listeners_->begin(), listeners_->end());
+        listeners.insert(listeners.end(), removed_listeners_.begin(), removed_listeners_.end());
+    }
+    for (auto& listener : listeners) {
+        if (listener->delivery == kStateListenerAsync) {
+            StopListener(*listener);
+            listener->thread.join();
         }
     }
-    
-    for (const auto& cb : callbacks_copy) {
-        cb(old_state, new_state);
+}
+
+void DeviceStateMachine::DeliverStateChanges() {
+    while (true) {
+        StateChange change;
+        // Only the reference count is touched under the lock; listeners run without it,
+        // so they may add or remove listeners, or transition again
+        std::shared_ptr<const ListenerList> listeners;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (changes_.empty()) {
+                delivering_ = false;
+                return;
+            }
+            change = changes_.front();
+            changes_.pop_front();
+            listeners = listeners_;
+        }
+
+        for (const auto& listener : *listeners) {
+            if (listener->delivery == kStateListenerAsync) {
+                Enqueue(*listener, change);
+            } else {
+                listener->callback(change.old_state, change.new_state);
+            }
+        }
+
+        int64_t elapsed_us = esp_timer_get_time() - change.time_us;
+        if (elapsed_us > STATE_NOTIFY_WARN_US) {
+            ESP_LOGW(TAG, "Slow state listeners: %s -> %s took %lldms",
+                     GetStateName(change.old_state), GetStateName(change.new_state), elapsed_us / 1000);
+        }
+
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.transitions++;
+        stats_.notify_total_us += elapsed_us;
+        if (elapsed_us > stats_.notify_max_us) {
+            stats_.notify_max_us = elapsed_us;
+        }
+    }
+}
+
+void DeviceStateMachine::Enqueue(Listener& listener, const StateChange& change) {
+    bool dropped = false;
+    {
+        std::lock_guard<std::mutex> lock(listener.mutex);
+        if (listener.stopped) {
+            return;
+        }
+        if (listener.pending.size() >= STATE_LISTENER_QUEUE_DEPTH) {
+            // Keep the newest changes, so the listener still ends up in the current state
+            listener.pending.pop_front();
+            dropped = true;
+        }
+        listener.pending.push_back(change);
+    }
+    listener.cv.notify_one();
+
+    if (dropped) {
+        ESP_LOGW(TAG, "State listener %d is falling behind, dropped a change", listener.id);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.async_dropped++;
     }
 }
+
+void DeviceStateMachine::StopListener(Listener& listener) {
+    std::lock_guard<std::mutex> lock(listener.mutex);
+    listener.stopped = true;
+    listener.pending.clear();
+    listener.cv.notify_one();
+}
+
+void DeviceStateMachine::ListenerTask(Listener* listener, DeviceStateMachine* machine) {
+    while (true) {
+        StateChange change;
+        {
+            std::unique_lock<std::mutex> lock(listener->mutex);
+            listener->cv.wait(lock, [listener]() {
+                return listener->stopped || !listener->pending.empty();
+            });
+            if (listener->stopped) {
+                break;
+            }
+            change = listener->pending.front();
+            listener->pending.pop_front();
+        }
+
+        // Changes arrive from a single delivering task in sequence order
+        if (static_cast<int32_t>(change.sequence - listener->last_sequence) <= 0) {
+            ESP_LOGE(TAG, "State listener %d got change %lu after %lu", listener->id,
+                     (unsigned long)change.sequence, (unsigned long)listener->last_sequence);
+            continue;
+        }
+        listener->last_sequence = change.sequence;
+
+        int64_t delay_us = esp_timer_get_time() - change.time_us;
+        {
+            std::lock_guard<std::mutex> lock(machine->stats_mutex_);
+            if (delay_us > machine->stats_.async_max_delay_us) {
+                machine->stats_.async_max_delay_us = delay_us;
+            }
+        }
+        listener->callback(change.old_state, change.new_state);
+    }
+}
+
+DeviceStateMachine::Stats DeviceStateMachine::GetStats() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
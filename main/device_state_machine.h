@@ -2,12 +2,25 @@
 #define DEVICE_STATE_MACHINE_H
 
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #include "device_state.h"
 
+/**
+ * How a state change listener is invoked
+ */
+enum StateListenerDelivery {
+    kStateListenerSync,   // On the task delivering the change, before the next change
+    kStateListenerAsync,  // From the listener's own task, through a queue
+};
+
 /**
  * DeviceStateMachine - Manages device state transitions with validation
  * 
@@ -17,7 +30,7 @@
 class DeviceStateMachine {
 public:
     DeviceStateMachine();
-    ~DeviceStateMachine() = default;
+    ~DeviceStateMachine();
 
     // Delete copy constructor and assignment operator
     DeviceStateMachine(const DeviceStateMachine&) = delete;
@@ -48,10 +61,14 @@ public:
 
     /**
      * Add a state change listener (observer pattern)
-     * Callback is invoked in the context of the caller of TransitionTo()
+     * Changes are delivered one at a time in the order the transitions happened, with no
+     * lock held. Sync callbacks run on the task that transitioned, unless another task is
+     * already delivering: then the change is queued and that task delivers it after the
+     * ones before it. Async callbacks get their own task and a queue of pending changes,
+     * so a slow listener (display, LED, motor) does not hold up the transition.
      * @return listener id for removal
      */
-    int AddStateChangeListener(StateCallback callback);
+    int AddStateChangeListener(StateCallback callback, StateListenerDelivery delivery = kStateListenerSync);
 
     /**
      * Remove a state change listener by id
@@ -63,11 +80,55 @@ public:
      */
     static const char* GetStateName(DeviceState state);
 
+    struct Stats {
+        uint32_t transitions;
+        int64_t notify_max_us;      // Longest time from a transition to its sync listeners returning
+        int64_t notify_total_us;
+        int64_t async_max_delay_us; // Longest time from transition to an async listener running
+        uint32_t async_dropped;     // Changes dropped because an async listener's queue was full
+    };
+
+    Stats GetStats();
+
 private:
+    struct StateChange {
+        uint32_t sequence;
+        DeviceState old_state;
+        DeviceState new_state;
+        int64_t time_us;
+    };
+
+    struct Listener {
+        int id;
+        StateCallback callback;
+        StateListenerDelivery delivery;
+        // Async delivery only
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<StateChange> pending;
+        uint32_t last_sequence = 0;
+        bool stopped = false;
+        std::thread thread;
+    };
+
+    using ListenerList = std::vector<std::shared_ptr<Listener>>;
+
     std::atomic<DeviceState> current_state_{kDeviceStateUnknown};
-    std::vector<std::pair<int, StateCallback>> listeners_;
+    // Copy-on-write: writers replace the list, readers only take a reference under the lock
+    std::shared_ptr<const ListenerList> listeners_;
     int next_listener_id_{0};
+    // Async listeners that were removed, joined on destruction
+    std::vector<std::shared_ptr<Listener>> removed_listeners_;
+    // Guards the listener lists, and the state change together with its sequence number
+    // and its place in changes_
     std::mutex mutex_;
+    uint32_t sequence_ = 0;
+    // Changes waiting for delivery, in sequence order. One task at a time delivers them.
+    std::deque<StateChange> changes_;
+    bool delivering_ = false;
+
+    std::mutex stats_mutex_;
+    Stats stats_{};
 
     /**
      * Check if transition from source to target is valid
@@ -75,9 +136,13 @@ private:
     bool IsValidTransition(DeviceState from, DeviceState to) const;
 
     /**
-     * Notify callback of state change
+     * Deliver queued changes until none are left
      */
-    void NotifyStateChange(DeviceState old_state, DeviceState new_state);
+    void DeliverStateChanges();
+
+    void Enqueue(Listener& listener, const StateChange& change);
+    static void StopListener(Listener& listener);
+    static void ListenerTask(Listener* listener, DeviceStateMachine* machine);
 };
 
 #endif // DEVICE_STATE_MACHINE_H
@@ -3,6 +3,7 @@
 #include "settings.h"
 #include "lvgl_theme.h"
 #include "assets/lang_config.h"
+#include "emotion_table.h"
 
 #include <vector>
 #include <algorithm>
@@ -982,6 +983,12 @@ void LcdDisplay::SetEmotion(const char* emotion) {
         return;
     }
 
+    // Emoji characters and verb forms ("🙂", "smile") use the canonical name's image
+    EmotionId emotion_id = emotion != nullptr ? ResolveEmotion(emotion) : kEmotionUnknown;
+    if (emotion_id != kEmotionUnknown) {
+        emotion = GetEmotionInfo(emotion_id).name;
+    }
+
     auto emoji_collection = static_cast<LvglTheme*>(current_theme_)->emoji_collection();
     auto image = emoji_collection != nullptr ? emoji_collection->GetEmojiImage(emotion) : nullptr;
     if (image == nullptr) {
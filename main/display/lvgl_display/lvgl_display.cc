@@ -259,3 +259,38 @@ bool LvglDisplay::SnapshotToJpeg(std::string& jpeg_data, int quality) {
     return false;
 #endif
 }
+
+bool LvglDisplay::CaptureScreen(lv_draw_buf_t** buffer, uint32_t& generation, bool force) {
+#if CONFIG_LV_USE_SNAPSHOT
+    DisplayLockGuard lock(this);
+
+    if (!tracking_invalidations_) {
+        lv_display_add_event_cb(display_, [](lv_event_t* e) {
+            auto display = static_cast<LvglDisplay*>(lv_event_get_user_data(e));
+            display->invalidations_++;
+        }, LV_EVENT_INVALIDATE_AREA, this);
+        tracking_invalidations_ = true;
+        force = true;
+    }
+    if (!force && generation == invalidations_) {
+        return false;
+    }
+
+    lv_obj_t* screen = lv_screen_active();
+    if (*buffer == nullptr) {
+        *buffer = lv_snapshot_create_draw_buf(screen, LV_COLOR_FORMAT_RGB565);
+        if (*buffer == nullptr) {
+            ESP_LOGE(TAG, "Failed to create snapshot buffer");
+            return false;
+        }
+    }
+    if (lv_snapshot_take_to_draw_buf(screen, LV_COLOR_FORMAT_RGB565, *buffer) != LV_RESULT_OK) {
+        ESP_LOGE(TAG, "Failed to take snapshot");
+        return false;
+    }
+    generation = invalidations_;
+    return true;
+#else
+    return false;
+#endif
+}
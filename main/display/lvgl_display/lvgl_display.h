@@ -24,6 +24,12 @@ public:
     virtual void UpdateStatusBar(bool update_all = false);
     virtual void SetPowerSaveMode(bool on);
     virtual bool SnapshotToJpeg(std::string& jpeg_data, int quality = 80);
+    /**
+     * Snapshot the active screen as RGB565 into *buffer, created on the first call and reused
+     * after. Unless force is set, returns false without rendering if nothing on the display
+     * was invalidated since generation; generation is updated on success.
+     */
+    virtual bool CaptureScreen(lv_draw_buf_t** buffer, uint32_t& generation, bool force = false);
 
 protected:
     esp_pm_lock_handle_t pm_lock_ = nullptr;
@@ -44,6 +50,10 @@ protected:
     std::chrono::system_clock::time_point last_status_update_time_;
     esp_timer_handle_t notification_timer_ = nullptr;
 
+    // Count of LV_EVENT_INVALIDATE_AREA, tracked from the first CaptureScreen; under the display lock
+    uint32_t invalidations_ = 0;
+    bool tracking_invalidations_ = false;
+
     friend class DisplayLockGuard;
     virtual bool Lock(int timeout_ms = 0) = 0;
     virtual void Unlock() = 0;
@@ -0,0 +1,195 @@
+#include "screen_streamer.h"
+#include "lvgl_display.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#if CONFIG_LV_USE_SNAPSHOT
+#include "jpg/image_to_jpeg.h"
+#endif
+
+#define TAG "ScreenStreamer"
+
+#define SCREEN_STREAMER_TASK_STACK_SIZE (4096 * 3)
+
+ScreenStreamer::~ScreenStreamer() {
+    Stop();
+    while (task_.load() != nullptr) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (snapshot_ != nullptr) {
+        lv_draw_buf_destroy(snapshot_);
+    }
+}
+
+bool ScreenStreamer::Start(int fps, int quality, std::function<void()> on_frame) {
+#if CONFIG_LV_USE_SNAPSHOT
+    Stop();
+    // The previous streamer task exits as soon as it sees the stop
+    while (task_.load() != nullptr) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    interval_ms_ = 1000 / fps;
+    max_quality_ = quality;
+    quality_ = quality;
+    on_frame_ = std::move(on_frame);
+    part_size_ = 0;
+    sent_ = 0;
+    drained_us_ = 0;
+    frames_ = 0;
+    unchanged_ = 0;
+    identical_ = 0;
+    busy_ = 0;
+
+    running_ = true;
+    TaskHandle_t task = nullptr;
+    if (xTaskCreate([](void* arg) {
+        ScreenStreamer* streamer = (ScreenStreamer*)arg;
+        streamer->StreamTask();
+        vTaskDelete(NULL);
+    }, "screen_stream", SCREEN_STREAMER_TASK_STACK_SIZE, this, 1, &task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the screen stream task");
+        running_ = false;
+        return false;
+    }
+    task_ = task;
+    ESP_LOGI(TAG, "Streaming the screen at up to %d fps, quality %d", fps, quality);
+    return true;
+#else
+    ESP_LOGE(TAG, "LV_USE_SNAPSHOT is not enabled");
+    return false;
+#endif
+}
+
+void ScreenStreamer::Stop() {
+    if (running_.exchange(false)) {
+        TaskHandle_t task = task_.load();
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+}
+
+size_t ScreenStreamer::Peek(const uint8_t** data) {
+    if (part_size_.load(std::memory_order_acquire) == 0) {
+        return 0;
+    }
+    size_t offset = sent_;
+    if (offset < header_size_) {
+        *data = (const uint8_t*)header_ + offset;
+        return header_size_ - offset;
+    }
+    offset -= header_size_;
+    if (offset < jpeg_.size()) {
+        *data = (const uint8_t*)jpeg_.data() + offset;
+        return jpeg_.size() - offset;
+    }
+    offset -= jpeg_.size();
+    static const char crlf[] = "\r\n";
+    *data = (const uint8_t*)crlf + offset;
+    return 2 - offset;
+}
+
+void ScreenStreamer::Consume(size_t bytes) {
+    sent_ += bytes;
+    if (sent_ == part_size_.load(std::memory_order_relaxed)) {
+        drained_us_ = esp_timer_get_time() - published_us_;
+        sent_ = 0;
+        part_size_.store(0, std::memory_order_release);
+    }
+}
+
+void ScreenStreamer::StreamTask() {
+    bool force = true;
+
+    while (running_) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(interval_ms_));
+        if (!running_) {
+            break;
+        }
+        if (part_size_.load(std::memory_order_acquire) != 0) {
+            // The network side stopped on a full socket; nudge it to retry
+            busy_++;
+            if (on_frame_) {
+                on_frame_();
+            }
+            continue;
+        }
+
+        int64_t drained_us = drained_us_.exchange(0);
+        if (drained_us > interval_ms_ * 1000LL) {
+            quality_ = std::max(kMinQuality, quality_ - 10);
+        } else if (drained_us > 0 && drained_us < interval_ms_ * 500LL) {
+            quality_ = std::min(max_quality_, quality_ + 5);
+        }
+
+        if (!display_->CaptureScreen(&snapshot_, generation_, force)) {
+            unchanged_++;
+            continue;
+        }
+
+        // Invalidated areas are often redrawn with the same pixels (timers, animations at rest)
+        uint32_t hash = 2166136261u;
+        const uint32_t* words = (const uint32_t*)snapshot_->data;
+        for (size_t i = 0; i < snapshot_->data_size / 4; i++) {
+            hash = (hash ^ words[i]) * 16777619u;
+        }
+        if (!force && hash == last_hash_) {
+            identical_++;
+            continue;
+        }
+
+        if (!EncodeFrame()) {
+            continue;
+        }
+        force = false;
+        last_hash_ = hash;
+        frames_++;
+        published_us_ = esp_timer_get_time();
+        part_size_.store(header_size_ + jpeg_.size() + 2, std::memory_order_release);
+        if (on_frame_) {
+            on_frame_();
+        }
+    }
+
+    ESP_LOGI(TAG, "Screen stream stopped: %lu frames, %lu unchanged, %lu identical, %lu busy, quality %d",
+             frames_, unchanged_, identical_, busy_, quality_);
+    task_ = nullptr;
+}
+
+bool ScreenStreamer::EncodeFrame() {
+#if CONFIG_LV_USE_SNAPSHOT
+    // The encoder takes the pixels byte swapped, as in LvglDisplay::SnapshotToJpeg
+    uint16_t* data = (uint16_t*)snapshot_->data;
+    size_t pixel_count = snapshot_->data_size / 2;
+    for (size_t i = 0; i < pixel_count; i++) {
+        data[i] = __builtin_bswap16(data[i]);
+    }
+
+    // jpeg_ keeps its capacity, so steady state streaming does not grow the heap
+    jpeg_.clear();
+    bool ret = image_to_jpeg_cb((uint8_t*)snapshot_->data, snapshot_->data_size, snapshot_->header.w, snapshot_->header.h,
+        V4L2_PIX_FMT_RGB565, quality_,
+        [](void *arg, size_t index, const void *data, size_t len) -> size_t {
+        std::string* output = static_cast<std::string*>(arg);
+        if (data && len > 0) {
+            output->append(static_cast<const char*>(data), len);
+        }
+        return len;
+    }, &jpeg_);
+    if (!ret) {
+        ESP_LOGE(TAG, "Failed to convert image to JPEG");
+        return false;
+    }
+
+    header_size_ = snprintf(header_, sizeof(header_), "--%s\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+                            kBoundary, jpeg_.size());
+    return true;
+#else
+    return false;
+#endif
+}
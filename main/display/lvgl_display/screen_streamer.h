@@ -0,0 +1,87 @@
+#ifndef SCREEN_STREAMER_H
+#define SCREEN_STREAMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <lvgl.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class LvglDisplay;
+
+/**
+ * ScreenStreamer - Mirrors an LvglDisplay as MJPEG (multipart/x-mixed-replace)
+ *
+ * A task wakes at most fps times a second. It only renders a snapshot if LVGL invalidated
+ * something since the last frame, into one snapshot buffer kept across streams, and skips
+ * the JPEG encode if the pixels came out identical to the last frame sent.
+ *
+ * One part is in flight at a time; the network side drains it with Peek/Consume. Ticks that
+ * find the previous part still in flight are skipped, and the JPEG quality follows how long
+ * parts take to drain: down when a part outlasts a frame interval, back up when it drains
+ * within half of one.
+ */
+class ScreenStreamer {
+public:
+    static constexpr const char* kBoundary = "frame";
+
+    explicit ScreenStreamer(LvglDisplay* display) : display_(display) {}
+    ~ScreenStreamer();
+
+    /**
+     * Start streaming, replacing any running stream. on_frame runs in the streamer task when
+     * a new part is ready, or on a tick that finds the part still unsent, and should only hand
+     * off to the network task.
+     */
+    bool Start(int fps, int quality, std::function<void()> on_frame);
+
+    /**
+     * Stop streaming; does not wait for the streamer task to exit
+     */
+    void Stop();
+
+    /**
+     * Contiguous bytes of the current part left to send (single consumer); returns 0 if none
+     */
+    size_t Peek(const uint8_t** data);
+    void Consume(size_t bytes);
+
+private:
+    static constexpr int kMinQuality = 20;
+
+    LvglDisplay* display_;
+    std::atomic<bool> running_{false};
+    std::atomic<TaskHandle_t> task_{nullptr};
+    std::function<void()> on_frame_;
+    int interval_ms_ = 200;
+    int max_quality_ = 60;
+    int quality_ = 60;
+
+    lv_draw_buf_t* snapshot_ = nullptr;
+    uint32_t generation_ = 0;
+    uint32_t last_hash_ = 0;
+
+    // The part in flight: header, JPEG, CRLF. Owned by the network side while part_size_ != 0
+    char header_[96];
+    size_t header_size_ = 0;
+    std::string jpeg_;
+    std::atomic<size_t> part_size_{0};
+    size_t sent_ = 0;
+    int64_t published_us_ = 0;
+    std::atomic<int64_t> drained_us_{0};   // Publish to last byte sent, for the last part
+
+    // Logged when the stream stops
+    uint32_t frames_ = 0;       // Parts sent
+    uint32_t unchanged_ = 0;    // Ticks with nothing invalidated
+    uint32_t identical_ = 0;    // Snapshots equal to the last frame sent
+    uint32_t busy_ = 0;         // Ticks skipped with a part still in flight
+
+    void StreamTask();
+    bool EncodeFrame();
+};
+
+#endif // SCREEN_STREAMER_H
@@ -1,5 +1,6 @@
 #include "oled_display.h"
 #include "assets/lang_config.h"
+#include "emotion_table.h"
 #include "lvgl_theme.h"
 #include "lvgl_font.h"
 
@@ -448,8 +449,9 @@ void OledDisplay::SetEmotion(const char* emotion) {
             roboeyes_adapter_->SetEmotion(emotion);
         }
     } else {
-        // 静态表情模式：使用原来的逻辑
-        const char* utf8 = font_awesome_get_utf8(emotion);
+        // 静态表情模式：emoji / 动词形式先转换成标准情绪名再查图标
+        EmotionId emotion_id = emotion != nullptr ? ResolveEmotion(emotion) : kEmotionUnknown;
+        const char* utf8 = font_awesome_get_utf8(emotion_id != kEmotionUnknown ? GetEmotionInfo(emotion_id).name : emotion);
         if (emotion_label_ == nullptr) {
             return;
         }
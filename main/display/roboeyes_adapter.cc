@@ -6,7 +6,6 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <unordered_map>
-#include <vector>
 // Provide Arduino-like 'byte' type used by RoboEyes header
 using byte = uint8_t;
 // forward-declare Arduino-like helpers used inside the header
@@ -15,6 +14,7 @@ long random(long v);
 // Include vendored RoboEyes header (vendored path)
 #include "third_party/roboeyes/src/FluxGarage_RoboEyes.h"
 #include <algorithm>
+#include <cmath>
 
 // Provide Arduino-like millis() and random() used by RoboEyes header
 extern "C" unsigned long millis() {
@@ -26,15 +26,57 @@ long random(long v) {
     return (long)(rand() % (uint32_t)v);
 }
 
-// Adafruit-like shim used by RoboEyes (file-scoped so type is visible)
+static size_t FrameBytes(int width, int height, RoboEyesLayout layout) {
+    if (layout == RoboEyesLayout::kPageMajor) {
+        return static_cast<size_t>((height + 7) / 8) * width;
+    }
+    return static_cast<size_t>((width + 7) / 8) * height;
+}
+
+// Set or clear columns x1..x2 (inclusive, already clipped) of row y in a 1-bit frame
+static void FillSpan(uint8_t* frame, int width, RoboEyesLayout layout, int y, int x1, int x2, bool on) {
+    if (layout == RoboEyesLayout::kPageMajor) {
+        // One byte per column; the row is the same bit of each of them
+        uint8_t* column = frame + (y >> 3) * width + x1;
+        uint8_t mask = 1 << (y & 7);
+        if (on) {
+            for (int x = x1; x <= x2; ++x) *column++ |= mask;
+        } else {
+            for (int x = x1; x <= x2; ++x) *column++ &= ~mask;
+        }
+        return;
+    }
+    // Row-major: partial bytes at both ends, whole bytes in between
+    uint8_t* row = frame + y * ((width + 7) / 8);
+    int first = x1 >> 3;
+    int last = x2 >> 3;
+    uint8_t head = 0xFF >> (x1 & 7);
+    uint8_t tail = static_cast<uint8_t>(0xFF << (7 - (x2 & 7)));
+    if (first == last) {
+        head &= tail;
+    }
+    row[first] = on ? (row[first] | head) : (row[first] & ~head);
+    if (first == last) return;
+    if (last > first + 1) memset(row + first + 1, on ? 0xFF : 0x00, last - first - 1);
+    row[last] = on ? (row[last] | tail) : (row[last] & ~tail);
+}
+
+static bool FramePixel(const uint8_t* frame, int width, RoboEyesLayout layout, int x, int y) {
+    if (layout == RoboEyesLayout::kPageMajor) {
+        return (frame[(y >> 3) * width + x] >> (y & 7)) & 0x1;
+    }
+    return (frame[y * ((width + 7) / 8) + (x >> 3)] >> (7 - (x & 7))) & 0x1;
+}
+
+// Adafruit-like shim used by RoboEyes (file-scoped so type is visible).
+// Shapes are filled one row span at a time, straight into the frame's layout.
 class AdafruitShim {
 public:
-    AdafruitShim(uint8_t* bitbuf, int w, int h, RoboEyesAdapter* parent, const char* tag) : bitbuf_(bitbuf), w_(w), h_(h), parent_(parent), tag_(tag) {
-        stride_ = (w_ + 7) / 8;
-    }
+    AdafruitShim(uint8_t* frame, int w, int h, RoboEyesLayout layout, RoboEyesAdapter* parent, const char* tag)
+        : frame_(frame), w_(w), h_(h), layout_(layout), parent_(parent), tag_(tag) {}
     void clearDisplay() {
-        if (bitbuf_) {
-            memset(bitbuf_, 0x00, stride_ * h_);
+        if (frame_) {
+            memset(frame_, 0x00, FrameBytes(w_, h_, layout_));
             if (parent_ && parent_->verbose_logging()) ESP_LOGI(tag_, "AdafruitShim: clearDisplay called");
             if (parent_) parent_->SetDrewThisFrame(true);
         }
@@ -44,7 +86,7 @@ public:
     }
     void fillRoundRect(int x, int y, int w, int h, int r, uint8_t color) {
         bool on = color ? true : false;
-        if (!bitbuf_) return;
+        if (!frame_) return;
         int x1 = x;
         int y1 = y;
         int x2 = x + w - 1;
@@ -55,60 +97,33 @@ public:
         if (y2 >= h_) y2 = h_ - 1;
         if (r > w/2) r = w/2;
         if (r > h/2) r = h/2;
+        if (r < 0) r = 0;
         if (parent_ && parent_->verbose_logging()) ESP_LOGI(tag_, "AdafruitShim: fillRoundRect x=%d y=%d w=%d h=%d r=%d color=%d", x, y, w, h, r, color);
         if (parent_) parent_->SetDrewThisFrame(true);
         for (int yy = y1; yy <= y2; ++yy) {
-            uint8_t* row = bitbuf_ + yy * stride_;
-            for (int xx = x1; xx <= x2; ++xx) {
-                bool should_draw = true;
-
-                // Check if pixel is in a corner that should be rounded
-                if (xx < x1 + r && yy < y1 + r) {
-                    // Top-left corner
-                    int dx = (x1 + r) - xx;
-                    int dy = (y1 + r) - yy;
-                    if (dx*dx + dy*dy > r*r) should_draw = false;
-                } else if (xx > x2 - r && yy < y1 + r) {
-                    // Top-right corner
-                    int dx = xx - (x2 - r);
-                    int dy = (y1 + r) - yy;
-                    if (dx*dx + dy*dy > r*r) should_draw = false;
-                } else if (xx < x1 + r && yy > y2 - r) {
-                    // Bottom-left corner
-                    int dx = (x1 + r) - xx;
-                    int dy = yy - (y2 - r);
-                    if (dx*dx + dy*dy > r*r) should_draw = false;
-                } else if (xx > x2 - r && yy > y2 - r) {
-                    // Bottom-right corner
-                    int dx = xx - (x2 - r);
-                    int dy = yy - (y2 - r);
-                    if (dx*dx + dy*dy > r*r) should_draw = false;
-                }
-                // Non-corner areas are always drawn
-
-                if (should_draw) {
-                    int byte_idx = xx / 8;
-                    int bit_idx = 7 - (xx % 8);
-                    if (on) row[byte_idx] |= (1 << bit_idx);
-                    else row[byte_idx] &= ~(1 << bit_idx);
-                }
+            int lo = x1;
+            int hi = x2;
+            // Rows within r of the top (checked first) or bottom edge have rounded corners
+            int dy = 0;
+            if (yy < y1 + r) {
+                dy = (y1 + r) - yy;
+            } else if (yy > y2 - r) {
+                dy = yy - (y2 - r);
             }
-        }
-        // Dump a small region of the affected row for debugging to confirm bits were set
-        {
-            int sample_row = y1;
-            if (sample_row < 0) sample_row = 0;
-            if (sample_row >= h_) sample_row = h_ - 1;
-            uint8_t* srow = bitbuf_ + sample_row * stride_;
-            int byte_start = x1 / 8;
-            int max_print = std::min(8, stride_ - byte_start);
-            if (max_print > 0 && parent_ && parent_->verbose_logging()) {
-                char dbg[128];
-                int p = 0;
-                p += snprintf(dbg + p, sizeof(dbg) - p, "AdafruitShim: rowdump y=%d:", sample_row);
-                for (int i = 0; i < max_print; ++i) p += snprintf(dbg + p, sizeof(dbg) - p, " %02X", srow[byte_start + i]);
-                ESP_LOGI(tag_, "%s", dbg);
+            if (dy > 0) {
+                // Corner columns are drawn while dx*dx + dy*dy <= r*r, dx counted from the
+                // corner centre. The left corner owns its columns even if it overlaps the right.
+                int reach = static_cast<int>(sqrtf(static_cast<float>(r * r - dy * dy)));
+                while (reach * reach > r * r - dy * dy) --reach;
+                while ((reach + 1) * (reach + 1) <= r * r - dy * dy) ++reach;
+                int left_lo = std::max(x1, x1 + r - reach);
+                int left_hi = std::min(x2, x1 + r - 1);
+                int right_lo = x1 + r;
+                int right_hi = std::min(x2, x2 - r + reach);
+                lo = left_lo <= left_hi ? left_lo : right_lo;
+                hi = right_lo <= right_hi ? right_hi : left_hi;
             }
+            if (lo <= hi) FillSpan(frame_, w_, layout_, yy, lo, hi, on);
         }
     }
     void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color) {
@@ -124,28 +139,30 @@ public:
         auto edge = [](int x0,int y0,int x1,int y1,int x,int y)->bool{
             return (x - x0) * (y1 - y0) - (y - y0) * (x1 - x0) >= 0;
         };
+        auto inside = [&](int x, int y) -> bool {
+            bool b0 = edge(x0,y0,x1,y1,x,y);
+            bool b1 = edge(x1,y1,x2,y2,x,y);
+            bool b2 = edge(x2,y2,x0,y0,x,y);
+            return (b0 && b1 && b2) || (!b0 && !b1 && !b2);
+        };
         if (parent_ && parent_->verbose_logging()) ESP_LOGI(tag_, "AdafruitShim: fillTriangle x0=%d y0=%d x1=%d y1=%d x2=%d y2=%d color=%d", x0,y0,x1,y1,x2,y2,color);
         if (parent_) parent_->SetDrewThisFrame(true);
+        if (!frame_) return;
+        // A triangle crosses each row in one span: find its ends from both sides
         for (int yy = miny; yy <= maxy; ++yy) {
-            uint8_t* row = bitbuf_ + yy * stride_;
-            for (int xx = minx; xx <= maxx; ++xx) {
-                bool b0 = edge(x0,y0,x1,y1,xx,yy);
-                bool b1 = edge(x1,y1,x2,y2,xx,yy);
-                bool b2 = edge(x2,y2,x0,y0,xx,yy);
-                if ((b0 && b1 && b2) || (!b0 && !b1 && !b2)) {
-                    int byte_idx = xx / 8;
-                    int bit_idx = 7 - (xx % 8);
-                    if (on) row[byte_idx] |= (1 << bit_idx);
-                    else row[byte_idx] &= ~(1 << bit_idx);
-                }
-            }
+            int lo = minx;
+            while (lo <= maxx && !inside(lo, yy)) ++lo;
+            if (lo > maxx) continue;
+            int hi = maxx;
+            while (!inside(hi, yy)) --hi;
+            FillSpan(frame_, w_, layout_, yy, lo, hi, on);
         }
     }
 private:
-    uint8_t* bitbuf_;
+    uint8_t* frame_;
     int w_;
     int h_;
-    int stride_ = 0;
+    RoboEyesLayout layout_;
     RoboEyesAdapter* parent_;
     const char* tag_;
 };
@@ -173,14 +190,18 @@ RoboEyesAdapter::~RoboEyesAdapter() {
         delete[] canvas_buffer_;
         canvas_buffer_ = nullptr;
     }
-    if (bit_buffer_ != nullptr) {
-        delete[] bit_buffer_;
-        bit_buffer_ = nullptr;
+    if (frame_buffer_ != nullptr) {
+        delete[] frame_buffer_;
+        frame_buffer_ = nullptr;
     }
     if (indexed_buffer_ != nullptr) {
         delete[] indexed_buffer_;
         indexed_buffer_ = nullptr;
     }
+    if (panel_shadow_ != nullptr) {
+        delete[] panel_shadow_;
+        panel_shadow_ = nullptr;
+    }
     // stop any panel timer
     if (panel_timer_ != nullptr) {
         esp_timer_stop(panel_timer_);
@@ -214,22 +235,28 @@ bool RoboEyesAdapter::Begin(lv_obj_t* parent, int width, int height, int max_fps
     height_ = height;
     max_fps_ = max_fps > 0 ? max_fps : 15;
 
-    // allocate internal 1-bit packed buffer (stride bytes per row)
-    int stride = (width_ + 7) / 8;
-    bit_buffer_ = new uint8_t[stride * height_];
-    if (bit_buffer_ == nullptr) {
-        ESP_LOGE(TAG, "bit buffer alloc failed");
+    // allocate the internal 1-bit frame, in the panel's page layout when flushing directly to it
+    frame_layout_ = panel_ != nullptr ? RoboEyesLayout::kPageMajor : RoboEyesLayout::kRowMajor;
+    size_t frame_bytes = FrameBytes(width_, height_, frame_layout_);
+    frame_buffer_ = new uint8_t[frame_bytes];
+    if (frame_buffer_ == nullptr) {
+        ESP_LOGE(TAG, "frame buffer alloc failed");
         return false;
     }
-    // clear bit buffer
-    memset(bit_buffer_, 0x00, stride * height_);
+    memset(frame_buffer_, 0x00, frame_bytes);
+
+    // shadow of the panel contents for direct flushes
+    if (panel_ != nullptr) {
+        panel_shadow_ = new uint8_t[frame_bytes];
+        panel_synced_ = false;
+    }
 
     // allocate an RGB canvas buffer to blit converted pixels into for LVGL (fallback)
     canvas_buffer_ = new lv_color_t[width_ * height_];
     if (canvas_buffer_ == nullptr) {
         ESP_LOGE(TAG, "canvas buffer alloc failed");
-        delete[] bit_buffer_;
-        bit_buffer_ = nullptr;
+        delete[] frame_buffer_;
+        frame_buffer_ = nullptr;
         return false;
     }
     // clear canvas buffer (black)
@@ -240,8 +267,8 @@ bool RoboEyesAdapter::Begin(lv_obj_t* parent, int width, int height, int max_fps
         ESP_LOGE(TAG, "lv_canvas_create failed");
         delete[] canvas_buffer_;
         canvas_buffer_ = nullptr;
-        delete[] bit_buffer_;
-        bit_buffer_ = nullptr;
+        delete[] frame_buffer_;
+        frame_buffer_ = nullptr;
         return false;
     }
     lv_obj_set_size(canvas_, width_, height_);
@@ -257,7 +284,7 @@ bool RoboEyesAdapter::Begin(lv_obj_t* parent, int width, int height, int max_fps
     if (verbose_logging_) ESP_LOGI(TAG, "RoboEyesAdapter initialized %dx%d fps=%d", width_, height_, max_fps_);
     // Initialize RoboEyes with Adafruit-like shim
     // instantiate RoboEyes using the shim (store opaque pointers in header fields)
-    AdafruitShim* shim = new AdafruitShim(bit_buffer_, width_, height_, this, TAG);
+    AdafruitShim* shim = new AdafruitShim(frame_buffer_, width_, height_, frame_layout_, this, TAG);
     shim_obj_ = static_cast<void*>(shim);
     // Set global colors expected by RoboEyes header
     BGCOLOR = 0;
@@ -289,12 +316,21 @@ void RoboEyesAdapter::SetMood(const char* mood) {
     mood_ = mood ? mood : "neutral";
 }
 
+static_assert(kEyesMoodDefault == DEFAULT && kEyesMoodTired == TIRED && kEyesMoodAngry == ANGRY &&
+              kEyesMoodHappy == HAPPY && kEyesMoodSurprised == SURPRISED && kEyesMoodSleepy == SLEEPY &&
+              kEyesMoodLoving == LOVING, "EyesMood out of sync with RoboEyes moods");
+
 void RoboEyesAdapter::SetEmotion(const char* emotion) {
-    if (!initialized_ || eyes_obj_ == nullptr) return;
+    SetEmotion(ResolveEmotion(emotion ? emotion : "neutral"));
+}
 
-    if (emotion == nullptr) emotion = "neutral";
+void RoboEyesAdapter::SetEmotion(EmotionId emotion) {
+    if (!initialized_ || eyes_obj_ == nullptr) return;
 
     auto eyes_ptr = static_cast<RoboEyes<AdafruitShim>*>(eyes_obj_);
+    // Unknown emotions get the neutral eyes
+    const auto& info = GetEmotionInfo(emotion);
+    const auto& eyes = info.eyes;
 
     // Reset all special modes first - IMPORTANT: Clear all previous animations!
     eyes_ptr->setIdleMode(false);
@@ -303,275 +339,98 @@ void RoboEyesAdapter::SetEmotion(const char* emotion) {
     eyes_ptr->setHFlicker(false);  // Clear horizontal flicker
     eyes_ptr->setVFlicker(false);  // Clear vertical flicker
 
-    // Exact emoji and emotion mapping based on user's list
-    // Handle English verb forms that might come from LLM emotion field
-    if (strcmp(emotion, "smile") == 0) {
-        // smile -> happy
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to HAPPY (smile)");
-    } else if (strcmp(emotion, "laugh") == 0) {
-        // laugh -> laughing
-        eyes_ptr->anim_laugh();
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to LAUGHING (laugh)");
-    } else if (strcmp(emotion, "cry") == 0) {
-        // cry -> crying
-        eyes_ptr->setMood(TIRED);
-        eyes_ptr->setSweat(true);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to CRYING (cry)");
-    } else if (strcmp(emotion, "wink") == 0) {
-        // wink -> winking
-        eyes_ptr->anim_laugh();
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to WINKING (wink)");
-    } else if (strcmp(emotion, "😶") == 0 || strcmp(emotion, "neutral") == 0) {
-        // 1. 😶 - neutral
-        eyes_ptr->setMood(DEFAULT);
-        eyes_ptr->setIdleMode(true, 2, 4);  // Moderate idle movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to NEUTRAL (😶)");
-    } else if (strcmp(emotion, "🙂") == 0 || strcmp(emotion, "happy") == 0) {
-        // 2. 🙂 - happy (animated)
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setIdleMode(true, 1, 6);  // Gentle happy movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to HAPPY (🙂)");
-    } else if (strcmp(emotion, "😆") == 0 || strcmp(emotion, "laughing") == 0) {
-        // 3. 😆 - laughing
-        eyes_ptr->anim_laugh();
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to LAUGHING (😆)");
-    } else if (strcmp(emotion, "😂") == 0 || strcmp(emotion, "funny") == 0) {
-        // 4. 😂 - funny
+    if (eyes.animation == kEyesAnimLaugh) {
         eyes_ptr->anim_laugh();
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to FUNNY (😂)");
-    } else if (strcmp(emotion, "😔") == 0 || strcmp(emotion, "sad") == 0) {
-        // 5. 😔 - sad (animated with slow movement)
-        eyes_ptr->setMood(TIRED);
-        eyes_ptr->setIdleMode(true, 1, 8);  // Very slow, sad movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to SAD (😔)");
-    } else if (strcmp(emotion, "😠") == 0 || strcmp(emotion, "angry") == 0) {
-        // 6. 😠 - angry (animated with aggressive movement)
-        eyes_ptr->setMood(ANGRY);
-        eyes_ptr->setIdleMode(true, 2, 2);  // Quick, angry movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to ANGRY (😠)");
-    } else if (strcmp(emotion, "😭") == 0 || strcmp(emotion, "crying") == 0) {
-        // 7. 😭 - crying
-        eyes_ptr->setMood(TIRED);
-        eyes_ptr->setSweat(true);
-        eyes_ptr->setIdleMode(true, 1, 5);  // Slow crying movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to CRYING (😭)");
-    } else if (strcmp(emotion, "😍") == 0 || strcmp(emotion, "loving") == 0) {
-        // 8. 😍 - loving (animated with heart eyes effect)
-        eyes_ptr->setMood(LOVING);
-        eyes_ptr->setIdleMode(true, 1, 7);  // Gentle loving movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to LOVING (😍)");
-    } else if (strcmp(emotion, "😳") == 0 || strcmp(emotion, "embarrassed") == 0) {
-        // 9. 😳 - embarrassed
-        eyes_ptr->setIdleMode(true, 2, 2);  // Frequent idle movement for embarrassment
-        eyes_ptr->setMood(DEFAULT);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to EMBARRASSED (😳)");
-    } else if (strcmp(emotion, "😲") == 0 || strcmp(emotion, "surprised") == 0) {
-        // 10. 😲 - surprised (animated with shocked movement)
-        eyes_ptr->setMood(SURPRISED);
-        eyes_ptr->setIdleMode(true, 2, 1);  // Quick, surprised movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to SURPRISED (😲)");
-    } else if (strcmp(emotion, "😱") == 0 || strcmp(emotion, "shocked") == 0) {
-        // 11. 😱 - shocked
+    } else if (eyes.animation == kEyesAnimConfused) {
         eyes_ptr->anim_confused();
-        eyes_ptr->setMood(DEFAULT);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to SHOCKED (😱)");
-    } else if (strcmp(emotion, "🤔") == 0 || strcmp(emotion, "thinking") == 0) {
-        // 12. 🤔 - thinking
-        eyes_ptr->setIdleMode(true, 2, 2);  // Looking around while thinking
-        eyes_ptr->setMood(DEFAULT);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to THINKING (🤔)");
-    } else if (strcmp(emotion, "😉") == 0 || strcmp(emotion, "winking") == 0) {
-        // 13. 😉 - winking
-        eyes_ptr->anim_laugh();
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to WINKING (😉)");
-    } else if (strcmp(emotion, "😎") == 0 || strcmp(emotion, "cool") == 0) {
-        // 14. 😎 - cool (animated with sunglasses vibe)
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setIdleMode(true, 1, 10);  // Very slow, cool movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to COOL (😎)");
-    } else if (strcmp(emotion, "😌") == 0 || strcmp(emotion, "relaxed") == 0) {
-        // 15. 😌 - relaxed (animated with calm movement)
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setIdleMode(true, 1, 12);  // Extremely slow, relaxed movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to RELAXED (😌)");
-    } else if (strcmp(emotion, "🤤") == 0 || strcmp(emotion, "delicious") == 0) {
-        // 16. 🤤 - delicious (animated with drooling effect)
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setIdleMode(true, 1, 8);  // Slow, savoring movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to DELICIOUS (🤤)");
-    } else if (strcmp(emotion, "😘") == 0 || strcmp(emotion, "kissy") == 0) {
-        // 17. 😘 - kissy
-        eyes_ptr->setMood(LOVING);
-        eyes_ptr->setIdleMode(true, 2, 3);  // Playful kissy movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to KISSY (😘)");
-    } else if (strcmp(emotion, "😏") == 0 || strcmp(emotion, "confident") == 0) {
-        // 18. 😏 - confident (animated with knowing movement)
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setIdleMode(true, 1, 9);  // Slow, confident movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to CONFIDENT (😏)");
-    } else if (strcmp(emotion, "😴") == 0 || strcmp(emotion, "sleepy") == 0) {
-        // 19. 😴 - sleepy
-        eyes_ptr->setMood(SLEEPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to SLEEPY (😴)");
-    } else if (strcmp(emotion, "😜") == 0 || strcmp(emotion, "silly") == 0) {
-        // 20. 😜 - silly
-        eyes_ptr->anim_laugh();
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to SILLY (😜)");
-    } else if (strcmp(emotion, "🙄") == 0 || strcmp(emotion, "confused") == 0) {
-        // 21. 🙄 - confused
-        eyes_ptr->setIdleMode(true, 3, 1);  // More frequent movement for confusion
-        eyes_ptr->setMood(DEFAULT);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to CONFUSED (🙄)");
-    } else if (strcmp(emotion, "wake") == 0) {
-        // 22. wake - waking up (animated sleepy to awake transition)
-        eyes_ptr->setMood(SLEEPY);
-        eyes_ptr->setIdleMode(true, 2, 3);  // Waking up movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to WAKE (sleepy animation)");
-    } else if (strcmp(emotion, "listening") == 0) {
-        // 23. listening - focused listening (use confident expression)
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setIdleMode(true, 1, 4);  // Slow, focused movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to LISTENING (confident)");
-    } else if (strcmp(emotion, "speaking") == 0) {
-        // 24. speaking - talking (use wink animation)
-        eyes_ptr->anim_laugh();  // wink-like animation
-        eyes_ptr->setMood(HAPPY);
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to SPEAKING (wink)");
-    } else if (strcmp(emotion, "excited") == 0) {
-        // 25. excited - excited (use excited jumping animation)
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setVFlicker(true, 8);  // Excited jumping up and down
-        eyes_ptr->setIdleMode(true, 1, 2);  // Quick random movements
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to EXCITED (jumping)");
-    } else if (strcmp(emotion, "twinkle") == 0) {
-        // 26. twinkle - magical twinkling effect
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setHFlicker(true, 3);  // Gentle twinkling left-right
-        eyes_ptr->setVFlicker(true, 3);  // Gentle twinkling up-down
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to TWINKLE (magical)");
-    } else if (strcmp(emotion, "bounce") == 0) {
-        // 27. bounce - bouncy playful animation
-        eyes_ptr->setMood(HAPPY);
-        eyes_ptr->setVFlicker(true, 12);  // Big bouncy movements
-        eyes_ptr->setIdleMode(true, 1, 1);  // Very frequent position changes
-        if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to BOUNCE (playful)");
-    } else {
-        // Default to neutral for unknown emotions
-        eyes_ptr->setMood(DEFAULT);
-        eyes_ptr->setIdleMode(true, 2, 4);  // Moderate idle movement
-        if (verbose_logging_) ESP_LOGI(TAG, "Unknown emotion '%s', set to DEFAULT", emotion);
     }
+    eyes_ptr->setMood(eyes.mood);
+    if (eyes.sweat) {
+        eyes_ptr->setSweat(true);
+    }
+    if (eyes.idle_interval > 0) {
+        eyes_ptr->setIdleMode(true, eyes.idle_interval, eyes.idle_variation);
+    }
+    if (eyes.hflicker > 0) {
+        eyes_ptr->setHFlicker(true, eyes.hflicker);
+    }
+    if (eyes.vflicker > 0) {
+        eyes_ptr->setVFlicker(true, eyes.vflicker);
+    }
+    if (verbose_logging_) ESP_LOGI(TAG, "Set eyes to %s (id %d)", info.name, emotion);
 }
 
 
 void RoboEyesAdapter::DrawFrame() {
-    if (!initialized_ || bit_buffer_ == nullptr || canvas_buffer_ == nullptr) return;
+    if (!initialized_ || frame_buffer_ == nullptr || canvas_buffer_ == nullptr) return;
 
     // Reset drawing flag for this frame
     drew_this_frame_ = false;
 
-    // If vendored RoboEyes is available, call its update() to render into the bit buffer
+    // If vendored RoboEyes is available, call its update() to render into the frame
     if (eyes_obj_) {
         if (verbose_logging_) ESP_LOGI(TAG, "Drawing with RoboEyes");
         auto eyes_ptr = static_cast<RoboEyes<AdafruitShim>*>(eyes_obj_);
         eyes_ptr->update();
-        // convert 1-bit buffer -> canvas buffer (either indexed 1-bit or RGB565)
+        // If panel handle provided, the frame is already in the panel's page layout: flush it
+        // directly and skip the LVGL canvas.
+        // RoboEyes only draws once its own frame interval has elapsed; otherwise nothing changed.
+        if (panel_ != nullptr) {
+            if (drew_this_frame_ || !panel_synced_) {
+                if (verbose_logging_) ESP_LOGI(TAG, "Flushing frame directly to panel");
+                FlushToPanel();
+            }
+            return;
+        }
+        if (!drew_this_frame_) {
+            return;
+        }
+        // convert 1-bit frame -> canvas buffer (either indexed 1-bit or RGB565)
         int stride = (width_ + 7) / 8;
         if (use_indexed_canvas_ && indexed_buffer_ != nullptr) {
             // palette occupies first 4 bytes (u16 x 2), copy bit data directly after palette
             int pal_bytes = sizeof(uint16_t) * 2;
-            memcpy(indexed_buffer_ + pal_bytes, bit_buffer_, stride * height_);
-        } else {
-            for (int y = 0; y < height_; ++y) {
-                uint8_t* row = bit_buffer_ + y * stride;
-                for (int x = 0; x < width_; ++x) {
-                    int byte_idx = x / 8;
-                    int bit_idx = 7 - (x % 8);
-                    bool on = (row[byte_idx] >> bit_idx) & 0x1;
-                    canvas_buffer_[y * width_ + x] = on ? lv_color_white() : lv_color_black();
-                }
-            }
-        }
-        // quick sanity: count white pixels (handle indexed vs RGB canvas)
-        int white_count = 0;
-        if (use_indexed_canvas_ && indexed_buffer_ != nullptr) {
-            int stride_local = (width_ + 7) / 8;
-            for (int y = 0; y < height_; ++y) {
-                uint8_t* row = indexed_buffer_ + sizeof(uint16_t)*2 + y * stride_local;
-                for (int b = 0; b < stride_local; ++b) {
-                    uint8_t v = row[b];
-                    // count bits set
-                    white_count += __builtin_popcount((unsigned)v);
-                }
-            }
+            memcpy(indexed_buffer_ + pal_bytes, frame_buffer_, stride * height_);
         } else {
-            for (int i = 0; i < width_ * height_; ++i) {
-                if (lv_color_to_u16(canvas_buffer_[i]) != 0x0000) ++white_count;
-            }
-        }
-        if (verbose_logging_) ESP_LOGI(TAG, "Converted canvas white pixels: %d", white_count);
-        // If panel handle provided, flush raw 1-bit buffer directly to panel and skip LVGL canvas
-        if (panel_ != nullptr) {
-            if (verbose_logging_) ESP_LOGI(TAG, "Flushing frame directly to panel");
-            FlushToPanel();
-            return;
+            FrameToCanvas();
         }
         // Periodic debug dump (once per second-ish) to help diagnose bit ordering issues
         frame_counter_++;
-        if ((frame_counter_ % (max_fps_ > 0 ? max_fps_ : 30)) == 0) {
-            // dump first 16 bytes of bit buffer and first 16 pixels of canvas buffer
-            int dump_bytes = (stride * height_) >= 16 ? 16 : (stride * height_);
+        if (verbose_logging_ && (frame_counter_ % (max_fps_ > 0 ? max_fps_ : 30)) == 0) {
+            // white pixel count, first 16 bytes of the frame and first 16 pixels of the canvas
+            size_t frame_bytes = FrameBytes(width_, height_, frame_layout_);
+            int white_count = 0;
+            for (size_t i = 0; i < frame_bytes; ++i) white_count += __builtin_popcount((unsigned)frame_buffer_[i]);
+            ESP_LOGI(TAG, "Frame white pixels: %d", white_count);
+            int dump_bytes = frame_bytes >= 16 ? 16 : frame_bytes;
             char buf[256];
             int pos = 0;
-            if (verbose_logging_) {
-                pos += snprintf(buf + pos, sizeof(buf) - pos, "bitbuf:");
-                for (int i = 0; i < dump_bytes; ++i) pos += snprintf(buf + pos, sizeof(buf) - pos, " %02X", bit_buffer_[i]);
-                ESP_LOGI(TAG, "%s", buf);
-            }
+            pos += snprintf(buf + pos, sizeof(buf) - pos, "frame:");
+            for (int i = 0; i < dump_bytes; ++i) pos += snprintf(buf + pos, sizeof(buf) - pos, " %02X", frame_buffer_[i]);
+            ESP_LOGI(TAG, "%s", buf);
             pos = 0;
             if (use_indexed_canvas_ && indexed_buffer_ != nullptr) {
                 int pal_bytes = sizeof(uint16_t) * 2;
-                int dump_bytes2 = dump_bytes;
-                if (verbose_logging_) {
-                    pos += snprintf(buf + pos, sizeof(buf) - pos, "indexed:");
-                    for (int i = 0; i < dump_bytes2; ++i) pos += snprintf(buf + pos, sizeof(buf) - pos, " %02X", indexed_buffer_[pal_bytes + i]);
-                    ESP_LOGI(TAG, "%s", buf);
-                }
+                pos += snprintf(buf + pos, sizeof(buf) - pos, "indexed:");
+                for (int i = 0; i < dump_bytes; ++i) pos += snprintf(buf + pos, sizeof(buf) - pos, " %02X", indexed_buffer_[pal_bytes + i]);
+                ESP_LOGI(TAG, "%s", buf);
             } else {
-                if (verbose_logging_) {
-                    pos += snprintf(buf + pos, sizeof(buf) - pos, "canvas:");
-                    int dump_pixels = (width_ * height_) >= 16 ? 16 : (width_ * height_);
-                    for (int i = 0; i < dump_pixels; ++i) {
-                        uint16_t v = lv_color_to_u16(canvas_buffer_[i]);
-                        pos += snprintf(buf + pos, sizeof(buf) - pos, " %04X", v);
-                    }
-                    ESP_LOGI(TAG, "%s", buf);
+                pos += snprintf(buf + pos, sizeof(buf) - pos, "canvas:");
+                int dump_pixels = (width_ * height_) >= 16 ? 16 : (width_ * height_);
+                for (int i = 0; i < dump_pixels; ++i) {
+                    uint16_t v = lv_color_to_u16(canvas_buffer_[i]);
+                    pos += snprintf(buf + pos, sizeof(buf) - pos, " %04X", v);
                 }
+                ESP_LOGI(TAG, "%s", buf);
             }
         }
         lv_obj_invalidate(canvas_);
-
-        // If RoboEyes didn't call any drawing functions this frame, draw a test pattern
-        if (!drew_this_frame_) {
-            ESP_LOGW(TAG, "RoboEyes didn't draw anything this frame, drawing test pattern");
-            DrawTestPattern();
-        }
-
         return;
     }
     if (verbose_logging_) ESP_LOGI(TAG, "Drawing demo eyes (RoboEyes not available)");
     // fallback simple demo rendering
-    // clear
-    // clear bit buffer and canvas buffer
-    int stride = (width_ + 7) / 8;
-    memset(bit_buffer_, 0x00, stride * height_);
+    // clear frame and canvas buffer
+    memset(frame_buffer_, 0x00, FrameBytes(width_, height_, frame_layout_));
     for (int i = 0; i < width_ * height_; ++i) canvas_buffer_[i] = lv_color_black();
 
     int eye_w = width_ / 4;
@@ -591,22 +450,15 @@ void RoboEyesAdapter::DrawFrame() {
         y = (height_ - eye_h_draw) / 2;
     }
 
-    // left and right eyes -> draw into bit buffer using helper that sets bits
-    // we'll use fill_rect_bits which writes bits into bit_buffer_
+    // left and right eyes -> draw into the frame using helper that sets bits
     auto fill_rect_bits = [&](int bx1,int by1,int bx2,int by2,bool on){
         if (bx1 < 0) bx1 = 0;
         if (by1 < 0) by1 = 0;
         if (bx2 >= width_) bx2 = width_ - 1;
         if (by2 >= height_) by2 = height_ - 1;
-        int stride_local = (width_ + 7) / 8;
+        if (bx1 > bx2) return;
         for (int yy = by1; yy <= by2; ++yy) {
-            uint8_t* row = bit_buffer_ + yy * stride_local;
-            for (int xx = bx1; xx <= bx2; ++xx) {
-                int byte_idx = xx / 8;
-                int bit_idx = 7 - (xx % 8);
-                if (on) row[byte_idx] |= (1 << bit_idx);
-                else row[byte_idx] &= ~(1 << bit_idx);
-            }
+            FillSpan(frame_buffer_, width_, frame_layout_, yy, bx1, bx2, on);
         }
     };
     fill_rect_bits(left_x, y, left_x + eye_w - 1, y + eye_h_draw - 1, true);
@@ -623,37 +475,33 @@ void RoboEyesAdapter::DrawFrame() {
     frame_counter_++;
 }
 
-void RoboEyesAdapter::DrawTestPattern() {
-    if (!bit_buffer_ || !canvas_buffer_) return;
-
-    int stride = (width_ + 7) / 8;
-
-    // Clear bit buffer
-    memset(bit_buffer_, 0, stride * height_);
-
-    // Draw a simple test pattern: alternating checkerboard
+void RoboEyesAdapter::FrameToCanvas() {
+    const lv_color_t white = lv_color_white();
+    const lv_color_t black = lv_color_black();
+    lv_color_t* out = canvas_buffer_;
     for (int y = 0; y < height_; ++y) {
-        uint8_t* row = bit_buffer_ + y * stride;
         for (int x = 0; x < width_; ++x) {
-            bool on = ((x / 8) + (y / 8)) % 2 == 0;
-            int byte_idx = x / 8;
-            int bit_idx = 7 - (x % 8);
-            if (on) row[byte_idx] |= (1 << bit_idx);
-            else row[byte_idx] &= ~(1 << bit_idx);
+            *out++ = FramePixel(frame_buffer_, width_, frame_layout_, x, y) ? white : black;
         }
     }
+}
 
-    // Convert to canvas buffer
+void RoboEyesAdapter::DrawTestPattern() {
+    if (!frame_buffer_ || !canvas_buffer_) return;
+
+    // Clear frame
+    memset(frame_buffer_, 0, FrameBytes(width_, height_, frame_layout_));
+
+    // Draw a simple test pattern: checkerboard of 8x8 squares
     for (int y = 0; y < height_; ++y) {
-        uint8_t* row = bit_buffer_ + y * stride;
-        for (int x = 0; x < width_; ++x) {
-            int byte_idx = x / 8;
-            int bit_idx = 7 - (x % 8);
-            bool on = (row[byte_idx] >> bit_idx) & 0x1;
-            canvas_buffer_[y * width_ + x] = on ? lv_color_white() : lv_color_black();
+        for (int x = (y / 8) % 2 == 0 ? 0 : 8; x < width_; x += 16) {
+            FillSpan(frame_buffer_, width_, frame_layout_, y, x, std::min(x + 7, width_ - 1), true);
         }
     }
 
+    // Convert to canvas buffer
+    FrameToCanvas();
+
     if (verbose_logging_) ESP_LOGI(TAG, "Drew test checkerboard pattern");
 }
 
@@ -745,41 +593,61 @@ void RoboEyesAdapter::StopTimer() {
     }
 }
 
+// A new draw call costs about as much bus traffic as this many data bytes (column and page
+// range commands, each its own I2C transaction), so shorter unchanged gaps are sent through
+#define ROBOEYES_FLUSH_MERGE_GAP 12
+
 void RoboEyesAdapter::FlushToPanel() {
-    if (!panel_ || !bit_buffer_) return;
-    int stride = (width_ + 7) / 8;
+    if (!panel_ || !frame_buffer_ || !panel_shadow_ || frame_layout_ != RoboEyesLayout::kPageMajor) return;
     int pages = (height_ + 7) / 8;
-    size_t len = static_cast<size_t>(pages) * static_cast<size_t>(width_);
-    std::vector<uint8_t> raw;
-    raw.resize(len);
 
-    // For each page (vertical 8-pixel band), for each column, pack bits LSB = top row in page
+    // Write per page, and within a page only the runs of columns that differ from what the
+    // panel shows. Until the panel has taken one whole frame, every column counts as changed.
+    bool full = !panel_synced_;
+    bool ok = true;
+    int runs = 0;
+    int bytes = 0;
     for (int p = 0; p < pages; ++p) {
-        for (int x = 0; x < width_; ++x) {
-            uint8_t b = 0;
-            for (int k = 0; k < 8; ++k) {
-                int y = p * 8 + k;
-                if (y >= height_) continue;
-                int byte_idx = (y * stride) + (x / 8);
-                int bit_idx = 7 - (x % 8); // match how AdafruitShim sets bits
-                bool on = (bit_buffer_[byte_idx] >> bit_idx) & 0x1;
-                if (on) b |= (1 << k);
-            }
-            raw[p * width_ + x] = b;
+        const uint8_t* page = frame_buffer_ + p * width_;
+        uint8_t* shadow = panel_shadow_ + p * width_;
+        if (!full && memcmp(page, shadow, width_) == 0) {
+            continue;
         }
-    }
-
-    // Write per-page to avoid driver/panel issues when sending a full frame at once.
-    for (int p = 0; p < pages; ++p) {
-        const uint8_t* page_ptr = raw.data() + (p * width_);
         int y_start = p * 8;
         int y_end = y_start + 8;
         if (y_end > height_) y_end = height_;
-        esp_err_t err = esp_lcd_panel_draw_bitmap(panel_, 0, y_start, width_, y_end, page_ptr);
-        if (err != ESP_OK) {
-            ESP_LOGW(TAG, "FlushToPanel draw_bitmap page %d failed: %d", p, err);
-        } else {
-            ESP_LOGD(TAG, "FlushToPanel wrote page %d (%d-%d)", p, y_start, y_end - 1);
+
+        int x = 0;
+        while (x < width_) {
+            if (!full && page[x] == shadow[x]) {
+                ++x;
+                continue;
+            }
+            int run_start = x;
+            int run_end = x + 1;
+            int gap = 0;
+            for (++x; x < width_; ++x) {
+                if (full || page[x] != shadow[x]) {
+                    run_end = x + 1;
+                    gap = 0;
+                } else if (++gap >= ROBOEYES_FLUSH_MERGE_GAP) {
+                    break;
+                }
+            }
+            esp_err_t err = esp_lcd_panel_draw_bitmap(panel_, run_start, y_start, run_end, y_end, page + run_start);
+            if (err != ESP_OK) {
+                // Shadow left as is, so the run is sent again with the next frame
+                ESP_LOGW(TAG, "FlushToPanel draw_bitmap page %d columns %d-%d failed: %d", p, run_start, run_end - 1, err);
+                ok = false;
+                continue;
+            }
+            memcpy(shadow + run_start, page + run_start, run_end - run_start);
+            ++runs;
+            bytes += run_end - run_start;
         }
     }
+    if (full && ok) {
+        panel_synced_ = true;
+    }
+    ESP_LOGD(TAG, "FlushToPanel wrote %d runs, %d bytes", runs, bytes);
 }
@@ -7,6 +7,14 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#include "emotion_table.h"
+
+// Pixel layout of the 1-bit frame RoboEyes draws into
+enum class RoboEyesLayout : uint8_t {
+    kRowMajor,   // 8 horizontal pixels per byte, MSB = leftmost, stride (width+7)/8 (LVGL I1 order)
+    kPageMajor,  // 8 vertical pixels per byte, LSB = top, one byte per column per page (SSD1306 GDDRAM)
+};
+
 class RoboEyesAdapter {
 public:
     RoboEyesAdapter();
@@ -30,6 +38,8 @@ public:
 
 private:
     void DrawFrame();
+    // Expand the 1-bit frame into canvas_buffer_ (RGB565)
+    void FrameToCanvas();
     static void RoboEyesTimerCallback(lv_timer_t* timer);
     bool StartTimer(int fps);
     void StopTimer();
@@ -37,8 +47,10 @@ private:
     lv_obj_t* canvas_ = nullptr;
     // LVGL canvas buffer (RGB565) used for display update
     lv_color_t* canvas_buffer_ = nullptr;
-    // Internal 1-bit buffer for RoboEyes drawing (packed bits, stride = (width+7)/8)
-    uint8_t* bit_buffer_ = nullptr;
+    // Internal 1-bit frame RoboEyes draws into: row-major for the LVGL canvas, page-major
+    // when flushing straight to an SSD1306 panel so the frame goes out without conversion
+    uint8_t* frame_buffer_ = nullptr;
+    RoboEyesLayout frame_layout_ = RoboEyesLayout::kRowMajor;
     // Optional LVGL indexed 1-bit buffer (palette + bit data) to avoid RGB conversion
     uint8_t* indexed_buffer_ = nullptr;
     bool use_indexed_canvas_ = true;
@@ -62,6 +74,11 @@ private:
     TaskHandle_t panel_task_ = nullptr;
     bool panel_task_running_ = false;
 
+    // Shadow of what the panel currently shows (page-major, like the frame).
+    // FlushToPanel only sends the columns that differ from it.
+    uint8_t* panel_shadow_ = nullptr;
+    bool panel_synced_ = false;
+
 private:
     // Debug tracking for drawing operations
     bool drew_this_frame_ = false;
@@ -83,5 +100,6 @@ public:
 
     // Set emotion/mood for the animated eyes
     void SetEmotion(const char* emotion);
+    void SetEmotion(EmotionId emotion);
 };
 
@@ -0,0 +1,172 @@
+#include "emotion_table.h"
+
+#include <array>
+
+namespace {
+
+#define EYES(mood, anim, sweat, idle_interval, idle_variation, hflicker, vflicker) \
+    EyesReaction{kEyesMood##mood, kEyesAnim##anim, sweat, idle_interval, idle_variation, hflicker, vflicker}
+
+// Indexed by EmotionId
+constexpr EmotionInfo kEmotions[] = {
+    // Unknown emotions keep their own name for the display and get neutral eyes
+    {kEmotionUnknown,     "neutral",     0, kGestureNone,      EYES(Default,   None,     false, 2, 4,  0, 0)},
+    // Verb forms the LLM sometimes sends
+    {kEmotionSmile,       "happy",       1, kGestureNone,      EYES(Happy,     None,     false, 0, 0,  0, 0)},
+    {kEmotionLaugh,       "laughing",    3, kGestureNone,      EYES(Happy,     Laugh,    false, 0, 0,  0, 0)},
+    {kEmotionCry,         "crying",      2, kGestureNone,      EYES(Tired,     None,     true,  0, 0,  0, 0)},
+    {kEmotionWink,        "winking",     3, kGestureNone,      EYES(Happy,     Laugh,    false, 0, 0,  0, 0)},
+    // The 21 server emotions
+    {kEmotionNeutral,     "neutral",     0, kGestureNone,      EYES(Default,   None,     false, 2, 4,  0, 0)},
+    {kEmotionHappy,       "happy",       1, kGestureHappy,     EYES(Happy,     None,     false, 1, 6,  0, 0)},
+    {kEmotionLaughing,    "laughing",    3, kGestureNone,      EYES(Happy,     Laugh,    false, 0, 0,  0, 0)},
+    {kEmotionFunny,       "funny",       3, kGestureNone,      EYES(Happy,     Laugh,    false, 0, 0,  0, 0)},
+    {kEmotionSad,         "sad",         2, kGestureSad,       EYES(Tired,     None,     false, 1, 8,  0, 0)},
+    {kEmotionAngry,       "angry",       6, kGestureAngry,     EYES(Angry,     None,     false, 2, 2,  0, 0)},
+    {kEmotionCrying,      "crying",      2, kGestureNone,      EYES(Tired,     None,     true,  1, 5,  0, 0)},
+    {kEmotionLoving,      "loving",      4, kGestureLoving,    EYES(Loving,    None,     false, 1, 7,  0, 0)},
+    {kEmotionEmbarrassed, "embarrassed", 5, kGestureNone,      EYES(Default,   None,     false, 2, 2,  0, 0)},
+    {kEmotionSurprised,   "surprised",   6, kGestureSurprised, EYES(Surprised, None,     false, 2, 1,  0, 0)},
+    {kEmotionShocked,     "shocked",     6, kGestureNone,      EYES(Default,   Confused, false, 0, 0,  0, 0)},
+    {kEmotionThinking,    "thinking",    5, kGestureThinking,  EYES(Default,   None,     false, 2, 2,  0, 0)},
+    {kEmotionWinking,     "winking",     3, kGestureNone,      EYES(Happy,     Laugh,    false, 0, 0,  0, 0)},
+    {kEmotionCool,        "cool",        1, kGestureNone,      EYES(Happy,     None,     false, 1, 10, 0, 0)},
+    {kEmotionRelaxed,     "relaxed",     1, kGestureNone,      EYES(Happy,     None,     false, 1, 12, 0, 0)},
+    {kEmotionDelicious,   "delicious",   1, kGestureNone,      EYES(Happy,     None,     false, 1, 8,  0, 0)},
+    {kEmotionKissy,       "kissy",       4, kGestureNone,      EYES(Loving,    None,     false, 2, 3,  0, 0)},
+    {kEmotionConfident,   "confident",   1, kGestureNone,      EYES(Happy,     None,     false, 1, 9,  0, 0)},
+    {kEmotionSleepy,      "sleepy",      0, kGestureNone,      EYES(Sleepy,    None,     false, 0, 0,  0, 0)},
+    {kEmotionSilly,       "silly",       3, kGestureNone,      EYES(Happy,     Laugh,    false, 0, 0,  0, 0)},
+    {kEmotionConfused,    "confused",    5, kGestureConfused,  EYES(Default,   None,     false, 3, 1,  0, 0)},
+    // Local triggers (device states, board gestures)
+    {kEmotionWake,        "wake",        0, kGestureWake,      EYES(Sleepy,    None,     false, 2, 3,  0, 0)},
+    {kEmotionListening,   "listening",   0, kGestureListening, EYES(Happy,     None,     false, 1, 4,  0, 0)},
+    {kEmotionSpeaking,    "speaking",    0, kGestureSpeaking,  EYES(Happy,     Laugh,    false, 0, 0,  0, 0)},
+    {kEmotionExcited,     "excited",     0, kGestureExcited,   EYES(Happy,     None,     false, 1, 2,  0, 8)},
+    {kEmotionTwinkle,     "twinkle",     0, kGestureNone,      EYES(Happy,     None,     false, 0, 0,  3, 3)},
+    {kEmotionBounce,      "bounce",      0, kGestureNone,      EYES(Happy,     None,     false, 1, 1,  0, 12)},
+};
+
+#undef EYES
+
+constexpr bool EmotionsInOrder() {
+    for (size_t i = 0; i < sizeof(kEmotions) / sizeof(kEmotions[0]); i++) {
+        if (kEmotions[i].id != i) {
+            return false;
+        }
+    }
+    return sizeof(kEmotions) / sizeof(kEmotions[0]) == kEmotionCount;
+}
+static_assert(EmotionsInOrder(), "kEmotions must list every EmotionId in order");
+
+struct EmotionAlias {
+    std::string_view name;
+    EmotionId id;
+};
+
+constexpr EmotionAlias kAliases[] = {
+    {"smile", kEmotionSmile},
+    {"laugh", kEmotionLaugh},
+    {"cry", kEmotionCry},
+    {"wink", kEmotionWink},
+    {"😶", kEmotionNeutral},      {"neutral", kEmotionNeutral},
+    {"🙂", kEmotionHappy},        {"happy", kEmotionHappy},          {"joy", kEmotionHappy},
+    {"😆", kEmotionLaughing},     {"laughing", kEmotionLaughing},
+    {"😂", kEmotionFunny},        {"funny", kEmotionFunny},
+    {"😔", kEmotionSad},          {"sad", kEmotionSad},              {"unhappy", kEmotionSad},
+    {"😠", kEmotionAngry},        {"angry", kEmotionAngry},
+    {"😭", kEmotionCrying},       {"crying", kEmotionCrying},
+    {"😍", kEmotionLoving},       {"loving", kEmotionLoving},
+    {"😳", kEmotionEmbarrassed},  {"embarrassed", kEmotionEmbarrassed},
+    {"😲", kEmotionSurprised},    {"surprised", kEmotionSurprised},
+    {"😱", kEmotionShocked},      {"shocked", kEmotionShocked},
+    {"🤔", kEmotionThinking},     {"thinking", kEmotionThinking},
+    {"😉", kEmotionWinking},      {"winking", kEmotionWinking},
+    {"😎", kEmotionCool},         {"cool", kEmotionCool},
+    {"😌", kEmotionRelaxed},      {"relaxed", kEmotionRelaxed},
+    {"🤤", kEmotionDelicious},    {"delicious", kEmotionDelicious},
+    {"😘", kEmotionKissy},        {"kissy", kEmotionKissy},
+    {"😏", kEmotionConfident},    {"confident", kEmotionConfident},
+    {"😴", kEmotionSleepy},       {"sleepy", kEmotionSleepy},
+    {"😜", kEmotionSilly},        {"silly", kEmotionSilly},
+    {"🙄", kEmotionConfused},     {"confused", kEmotionConfused},
+    {"wake", kEmotionWake},       {"wakeup", kEmotionWake},
+    {"listening", kEmotionListening}, {"curious", kEmotionListening},
+    {"speaking", kEmotionSpeaking},   {"talking", kEmotionSpeaking},
+    {"excited", kEmotionExcited},
+    {"twinkle", kEmotionTwinkle},
+    {"bounce", kEmotionBounce},
+};
+constexpr size_t kAliasCount = sizeof(kAliases) / sizeof(kAliases[0]);
+
+// Perfect hash: FNV-1a with a murmur finalizer, seeded; the seed is searched at compile
+// time so that every alias lands in its own slot
+constexpr size_t kSlotCount = 256;
+constexpr uint8_t kEmptySlot = 0xFF;
+static_assert(kAliasCount < kEmptySlot, "Too many aliases for 8-bit slots");
+
+constexpr uint32_t HashName(std::string_view name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : name) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+constexpr bool SeedIsPerfect(uint32_t seed) {
+    bool used[kSlotCount] = {};
+    for (size_t i = 0; i < kAliasCount; i++) {
+        size_t slot = HashName(kAliases[i].name, seed) % kSlotCount;
+        if (used[slot]) {
+            return false;
+        }
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t FindSeed() {
+    for (uint32_t seed = 0; seed < 100000; seed++) {
+        if (SeedIsPerfect(seed)) {
+            return seed;
+        }
+    }
+    return UINT32_MAX;
+}
+
+constexpr uint32_t kSeed = FindSeed();
+static_assert(kSeed != UINT32_MAX, "No perfect hash seed for the emotion aliases");
+
+constexpr std::array<uint8_t, kSlotCount> BuildSlots() {
+    std::array<uint8_t, kSlotCount> slots = {};
+    for (auto& slot : slots) {
+        slot = kEmptySlot;
+    }
+    for (size_t i = 0; i < kAliasCount; i++) {
+        slots[HashName(kAliases[i].name, kSeed) % kSlotCount] = (uint8_t)i;
+    }
+    return slots;
+}
+
+constexpr std::array<uint8_t, kSlotCount> kSlots = BuildSlots();
+
+} // namespace
+
+EmotionId ResolveEmotion(std::string_view name) {
+    uint8_t index = kSlots[HashName(name, kSeed) % kSlotCount];
+    if (index == kEmptySlot || kAliases[index].name != name) {
+        return kEmotionUnknown;
+    }
+    return kAliases[index].id;
+}
+
+const EmotionInfo& GetEmotionInfo(EmotionId id) {
+    if (id >= kEmotionCount) {
+        id = kEmotionUnknown;
+    }
+    return kEmotions[id];
+}
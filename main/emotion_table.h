@@ -0,0 +1,109 @@
+#ifndef EMOTION_TABLE_H
+#define EMOTION_TABLE_H
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Emotions understood by the device, from the "llm" emotion field or local triggers.
+ * Every emotion name, emoji and alias resolves to one of these once, through a perfect
+ * hash built at compile time; the display, the eyes and the motors then read their
+ * reaction from the same table entry instead of matching strings again.
+ */
+enum EmotionId : uint8_t {
+    kEmotionUnknown,
+    kEmotionSmile,
+    kEmotionLaugh,
+    kEmotionCry,
+    kEmotionWink,
+    kEmotionNeutral,
+    kEmotionHappy,
+    kEmotionLaughing,
+    kEmotionFunny,
+    kEmotionSad,
+    kEmotionAngry,
+    kEmotionCrying,
+    kEmotionLoving,
+    kEmotionEmbarrassed,
+    kEmotionSurprised,
+    kEmotionShocked,
+    kEmotionThinking,
+    kEmotionWinking,
+    kEmotionCool,
+    kEmotionRelaxed,
+    kEmotionDelicious,
+    kEmotionKissy,
+    kEmotionConfident,
+    kEmotionSleepy,
+    kEmotionSilly,
+    kEmotionConfused,
+    kEmotionWake,
+    kEmotionListening,
+    kEmotionSpeaking,
+    kEmotionExcited,
+    kEmotionTwinkle,
+    kEmotionBounce,
+    kEmotionCount,
+};
+
+// Same values as the RoboEyes mood defines (DEFAULT, TIRED, ...)
+enum EyesMood : uint8_t {
+    kEyesMoodDefault = 0,
+    kEyesMoodTired = 1,
+    kEyesMoodAngry = 2,
+    kEyesMoodHappy = 3,
+    kEyesMoodSurprised = 4,
+    kEyesMoodSleepy = 5,
+    kEyesMoodLoving = 7,
+};
+
+enum EyesAnimation : uint8_t {
+    kEyesAnimNone,
+    kEyesAnimLaugh,
+    kEyesAnimConfused,
+};
+
+/**
+ * Board specific motor gestures (qebabe-xiaoche OnHappy(), OnSad(), ...)
+ */
+enum EmotionGesture : uint8_t {
+    kGestureNone,
+    kGestureWake,
+    kGestureHappy,
+    kGestureSad,
+    kGestureThinking,
+    kGestureListening,
+    kGestureSpeaking,
+    kGestureExcited,
+    kGestureLoving,
+    kGestureAngry,
+    kGestureSurprised,
+    kGestureConfused,
+};
+
+struct EyesReaction {
+    EyesMood mood;
+    EyesAnimation animation;
+    bool sweat;
+    uint8_t idle_interval;     // Idle mode parameters, 0 = idle mode off
+    uint8_t idle_variation;
+    uint8_t hflicker;          // Flicker amplitude, 0 = off
+    uint8_t vflicker;
+};
+
+struct EmotionInfo {
+    EmotionId id;
+    const char* name;          // Canonical name, used for the emoji / icon lookup
+    uint8_t motor;             // Application::TriggerMotorEmotion() type, 0 = none
+    EmotionGesture gesture;
+    EyesReaction eyes;
+};
+
+/**
+ * Resolve an emotion name, emoji or alias; kEmotionUnknown if not in the table
+ */
+EmotionId ResolveEmotion(std::string_view name);
+
+const EmotionInfo& GetEmotionInfo(EmotionId id);
+
+#endif // EMOTION_TABLE_H
@@ -0,0 +1,118 @@
+#include "main_loop_stats.h"
+
+#include <cJSON.h>
+
+static const char* const HANDLER_NAMES[] = {
+    "send_audio",
+    "error",
+    "network",
+    "activation_done",
+    "state_changed",
+    "toggle_chat",
+    "listening",
+    "wake_word",
+    "vad_change",
+    "scheduled_task",
+    "clock_tick",
+};
+static_assert(sizeof(HANDLER_NAMES) / sizeof(HANDLER_NAMES[0]) == kMainHandlerCount, "Handler names out of sync");
+
+void MainLoopStats::Record(MainLoopHandler handler, int64_t elapsed_us) {
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && elapsed_us >= kBucketLimitsUs[bucket]) {
+        bucket++;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stats = handlers_[handler];
+    stats.count++;
+    stats.total_us += elapsed_us;
+    stats.buckets[bucket]++;
+    if (elapsed_us > stats.max_us) {
+        stats.max_us = elapsed_us;
+    }
+    if (elapsed_us > stats.window_max_us) {
+        stats.window_max_us = elapsed_us;
+    }
+    if (elapsed_us > longest_stall_us_) {
+        longest_stall_us_ = elapsed_us;
+        longest_stall_handler_ = handler;
+    }
+}
+
+void MainLoopStats::TakeWindowMax(int32_t max_us[kMainHandlerCount]) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < kMainHandlerCount; i++) {
+        max_us[i] = handlers_[i].window_max_us;
+        handlers_[i].window_max_us = 0;
+    }
+}
+
+const char* MainLoopStats::HandlerName(MainLoopHandler handler) {
+    return HANDLER_NAMES[handler];
+}
+
+void MainLoopStats::RecordAudioWait() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    audio_waits_++;
+}
+
+void MainLoopStats::RecordAudioPreemption() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    audio_preemptions_++;
+}
+
+void MainLoopStats::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& stats : handlers_) {
+        stats = HandlerStats();
+    }
+    longest_stall_us_ = 0;
+    longest_stall_handler_ = kMainHandlerSendAudio;
+    audio_waits_ = 0;
+    audio_preemptions_ = 0;
+}
+
+std::string MainLoopStats::ToJson() {
+    cJSON* root = cJSON_CreateObject();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cJSON* stall = cJSON_CreateObject();
+        cJSON_AddStringToObject(stall, "handler", HANDLER_NAMES[longest_stall_handler_]);
+        cJSON_AddNumberToObject(stall, "us", longest_stall_us_);
+        cJSON_AddItemToObject(root, "longest_stall", stall);
+        cJSON_AddNumberToObject(root, "audio_waits", audio_waits_);
+        cJSON_AddNumberToObject(root, "audio_preemptions", audio_preemptions_);
+
+        cJSON* limits = cJSON_CreateArray();
+        for (auto limit : kBucketLimitsUs) {
+            cJSON_AddItemToArray(limits, cJSON_CreateNumber(limit));
+        }
+        cJSON_AddItemToObject(root, "bucket_limits_us", limits);
+
+        cJSON* handlers = cJSON_CreateObject();
+        for (int i = 0; i < kMainHandlerCount; i++) {
+            auto& stats = handlers_[i];
+            if (stats.count == 0) {
+                continue;
+            }
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddNumberToObject(item, "count", stats.count);
+            cJSON_AddNumberToObject(item, "avg_us", stats.total_us / stats.count);
+            cJSON_AddNumberToObject(item, "max_us", stats.max_us);
+            cJSON* buckets = cJSON_CreateArray();
+            for (auto bucket : stats.buckets) {
+                cJSON_AddItemToArray(buckets, cJSON_CreateNumber(bucket));
+            }
+            cJSON_AddItemToObject(item, "histogram", buckets);
+            cJSON_AddItemToObject(handlers, HANDLER_NAMES[i], item);
+        }
+        cJSON_AddItemToObject(root, "handlers", handlers);
+    }
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    std::string result(json_str);
+    cJSON_free(json_str);
+    cJSON_Delete(root);
+    return result;
+}
@@ -0,0 +1,77 @@
+#ifndef MAIN_LOOP_STATS_H
+#define MAIN_LOOP_STATS_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * Handlers dispatched by Application::Run, in lane order:
+ * audio first, then control events, then bulk work (scheduled tasks and the clock tick)
+ */
+enum MainLoopHandler {
+    kMainHandlerSendAudio,
+    kMainHandlerError,
+    kMainHandlerNetwork,
+    kMainHandlerActivationDone,
+    kMainHandlerStateChanged,
+    kMainHandlerToggleChat,
+    kMainHandlerListening,
+    kMainHandlerWakeWord,
+    kMainHandlerVadChange,
+    kMainHandlerScheduledTask,
+    kMainHandlerClockTick,
+    kMainHandlerCount,
+};
+
+/**
+ * MainLoopStats - Per-handler execution time histograms for the main loop
+ *
+ * Written by the main task, read from the MCP and web server tasks.
+ */
+class MainLoopStats {
+public:
+    // Histogram bucket upper bounds in microseconds; the last bucket is open ended
+    static constexpr int kBucketCount = 5;
+    static constexpr int64_t kBucketLimitsUs[kBucketCount - 1] = {100, 1000, 10000, 50000};
+
+    void Record(MainLoopHandler handler, int64_t elapsed_us);
+
+    /**
+     * Count a time the audio send queue became ready while a lower priority handler was running
+     */
+    void RecordAudioWait();
+
+    /**
+     * Count a scheduled task batch that had to yield to queued audio
+     */
+    void RecordAudioPreemption();
+
+    /**
+     * Longest run of each handler since the previous call, for periodic telemetry
+     */
+    void TakeWindowMax(int32_t max_us[kMainHandlerCount]);
+
+    static const char* HandlerName(MainLoopHandler handler);
+
+    std::string ToJson();
+    void Reset();
+
+private:
+    struct HandlerStats {
+        uint32_t count = 0;
+        int64_t total_us = 0;
+        int64_t max_us = 0;
+        int64_t window_max_us = 0;
+        uint32_t buckets[kBucketCount] = {};
+    };
+
+    std::mutex mutex_;
+    HandlerStats handlers_[kMainHandlerCount];
+    int64_t longest_stall_us_ = 0;
+    MainLoopHandler longest_stall_handler_ = kMainHandlerSendAudio;
+    uint32_t audio_waits_ = 0;
+    uint32_t audio_preemptions_ = 0;
+};
+
+#endif // MAIN_LOOP_STATS_H
@@ -9,6 +9,8 @@
 #include <algorithm>
 #include <cstring>
 #include <esp_pthread.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 
 #include "application.h"
 #include "display.h"
@@ -28,6 +30,7 @@ McpServer::~McpServer() {
         delete tool;
     }
     tools_.clear();
+    tool_index_.clear();
 }
 
 void McpServer::AddCommonTools() {
@@ -37,6 +40,8 @@ void McpServer::AddCommonTools() {
 
     // Backup the original tools list and restore it after adding the common tools.
     auto original_tools = std::move(tools_);
+    tools_.clear();
+    tool_index_.clear();
     auto& board = Board::GetInstance();
 
     // Do not add custom tools here.
@@ -109,6 +114,9 @@ void McpServer::AddCommonTools() {
                 Property("question", kPropertyTypeString)
             }),
             [camera](const PropertyList& properties) -> ReturnValue {
+                // Several workers may be configured, but the camera takes one photo at a time
+                static std::mutex camera_mutex;
+                std::lock_guard<std::mutex> lock(camera_mutex);
                 // Lower the priority to do the camera capture
                 TaskPriorityReset priority_reset(1);
 
@@ -117,12 +125,13 @@ void McpServer::AddCommonTools() {
                 }
                 auto question = properties["question"].value<std::string>();
                 return camera->Explain(question);
-            });
+            }, kMcpToolBackground);
     }
 #endif
 
     // Restore the original tools list to the end of the tools list
     tools_.insert(tools_.end(), original_tools.begin(), original_tools.end());
+    RebuildToolIndex();
 }
 
 void McpServer::AddUserOnlyTools() {
@@ -135,6 +144,20 @@ void McpServer::AddUserOnlyTools() {
             return board.GetSystemInfoJson();
         });
 
+    AddUserOnlyTool("self.get_main_loop_stats",
+        "Get main loop handler execution time histograms, the longest stall and audio wait counters",
+        PropertyList({
+            Property("reset", kPropertyTypeBoolean, false)
+        }),
+        [](const PropertyList& properties) -> ReturnValue {
+            auto& app = Application::GetInstance();
+            std::string json = app.GetMainLoopStatsJson();
+            if (properties["reset"].value<bool>()) {
+                app.ResetMainLoopStats();
+            }
+            return json;
+        }, kMcpToolInline);
+
     AddUserOnlyTool("self.reboot", "Reboot the system",
         PropertyList(),
         [this](const PropertyList& properties) -> ReturnValue {
@@ -239,7 +262,7 @@ void McpServer::AddUserOnlyTools() {
                 http->Close();
                 ESP_LOGI(TAG, "Snapshot screen result: %s", result.c_str());
                 return true;
-            });
+            }, kMcpToolBackground);
         
         AddUserOnlyTool("self.screen.preview_image", "Preview an image on the screen",
             PropertyList({
@@ -279,7 +302,7 @@ void McpServer::AddUserOnlyTools() {
                 auto image = std::make_unique<LvglAllocatedImage>(data, content_length);
                 display->SetPreviewImage(std::move(image));
                 return true;
-            });
+            }, kMcpToolBackground);
 #endif // CONFIG_LV_USE_SNAPSHOT
     }
 #endif // HAVE_LVGL
@@ -302,22 +325,42 @@ void McpServer::AddUserOnlyTools() {
 
 void McpServer::AddTool(McpTool* tool) {
     // Prevent adding duplicate tools
-    if (std::find_if(tools_.begin(), tools_.end(), [tool](const McpTool* t) { return t->name() == tool->name(); }) != tools_.end()) {
+    if (tool_index_.find(tool->name()) != tool_index_.end()) {
         ESP_LOGW(TAG, "Tool %s already added", tool->name().c_str());
         return;
     }
 
     ESP_LOGI(TAG, "Add tool: %s%s", tool->name().c_str(), tool->user_only() ? " [user]" : "");
+    tool_index_.emplace(tool->name(), tools_.size());
     tools_.push_back(tool);
 }
 
-void McpServer::AddTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback) {
-    AddTool(new McpTool(name, description, properties, callback));
+McpTool* McpServer::FindTool(const std::string& name) const {
+    auto it = tool_index_.find(name);
+    return it == tool_index_.end() ? nullptr : tools_[it->second];
+}
+
+void McpServer::RebuildToolIndex() {
+    tool_index_.clear();
+    tool_index_.reserve(tools_.size());
+    for (size_t i = 0; i < tools_.size(); i++) {
+        // Keep the first occurrence, same as AddTool does
+        tool_index_.emplace(tools_[i]->name(), i);
+    }
+}
+
+void McpServer::AddTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback,
+    McpToolExecution execution) {
+    auto tool = new McpTool(name, description, properties, callback);
+    tool->set_execution(execution);
+    AddTool(tool);
 }
 
-void McpServer::AddUserOnlyTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback) {
+void McpServer::AddUserOnlyTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback,
+    McpToolExecution execution) {
     auto tool = new McpTool(name, description, properties, callback);
     tool->set_user_only(true);
+    tool->set_execution(execution);
     AddTool(tool);
 }
 
@@ -351,6 +394,32 @@ void McpServer::ParseCapabilities(const cJSON* capabilities) {
 }
 
 void McpServer::ParseMessage(const cJSON* json) {
+    if (!cJSON_IsArray(json)) {
+        ParseRequest(json, nullptr);
+        return;
+    }
+
+    // JSON-RPC batch: run every request, then answer with one array once all of them are done
+    if (cJSON_GetArraySize(json) == 0) {
+        ESP_LOGE(TAG, "Empty batch");
+        Reply(MakeInvalidRequest(), nullptr);
+        return;
+    }
+    auto batch = std::make_shared<Batch>();
+    const cJSON* request;
+    cJSON_ArrayForEach(request, json) {
+        if (!cJSON_IsObject(request)) {
+            ESP_LOGE(TAG, "Invalid request in batch");
+            Reply(MakeInvalidRequest(), batch);
+            continue;
+        }
+        ParseRequest(request, batch);
+    }
+    std::lock_guard<std::mutex> lock(calls_mutex_);
+    FinishBatchEntry(batch);
+}
+
+void McpServer::ParseRequest(const cJSON* json, const std::shared_ptr<Batch>& batch) {
     // Check JSONRPC version
     auto version = cJSON_GetObjectItem(json, "jsonrpc");
     if (version == nullptr || !cJSON_IsString(version) || strcmp(version->valuestring, "2.0") != 0) {
@@ -367,6 +436,13 @@ void McpServer::ParseMessage(const cJSON* json) {
     
     auto method_str = std::string(method->valuestring);
     if (method_str.find("notifications") == 0) {
+        if (method_str == "notifications/cancelled") {
+            auto params = cJSON_GetObjectItem(json, "params");
+            auto request_id = cJSON_GetObjectItem(params, "requestId");
+            if (cJSON_IsNumber(request_id)) {
+                CancelToolCall(request_id->valueint);
+            }
+        }
         return;
     }
     
@@ -395,7 +471,7 @@ void McpServer::ParseMessage(const cJSON* json) {
         std::string message = "{\"protocolVersion\":\"2024-11-05\",\"capabilities\":{\"tools\":{}},\"serverInfo\":{\"name\":\"" BOARD_NAME "\",\"version\":\"";
         message += app_desc->version;
         message += "\"}}";
-        ReplyResult(id_int, message);
+        ReplyResult(id_int, message, batch);
     } else if (method_str == "tools/list") {
         std::string cursor_str = "";
         bool list_user_only_tools = false;
@@ -409,83 +485,142 @@ void McpServer::ParseMessage(const cJSON* json) {
                 list_user_only_tools = with_user_tools->valueint == 1;
             }
         }
-        GetToolsList(id_int, cursor_str, list_user_only_tools);
+        GetToolsList(id_int, cursor_str, list_user_only_tools, batch);
     } else if (method_str == "tools/call") {
         if (!cJSON_IsObject(params)) {
             ESP_LOGE(TAG, "tools/call: Missing params");
-            ReplyError(id_int, "Missing params");
+            ReplyError(id_int, "Missing params", batch);
             return;
         }
         auto tool_name = cJSON_GetObjectItem(params, "name");
         if (!cJSON_IsString(tool_name)) {
             ESP_LOGE(TAG, "tools/call: Missing name");
-            ReplyError(id_int, "Missing name");
+            ReplyError(id_int, "Missing name", batch);
             return;
         }
         auto tool_arguments = cJSON_GetObjectItem(params, "arguments");
         if (tool_arguments != nullptr && !cJSON_IsObject(tool_arguments)) {
             ESP_LOGE(TAG, "tools/call: Invalid arguments");
-            ReplyError(id_int, "Invalid arguments");
+            ReplyError(id_int, "Invalid arguments", batch);
             return;
         }
-        DoToolCall(id_int, std::string(tool_name->valuestring), tool_arguments);
+        DoToolCall(id_int, std::string(tool_name->valuestring), tool_arguments, batch);
     } else {
         ESP_LOGE(TAG, "Method not implemented: %s", method_str.c_str());
-        ReplyError(id_int, "Method not implemented: " + method_str);
+        ReplyError(id_int, "Method not implemented: " + method_str, batch);
     }
 }
 
-void McpServer::ReplyResult(int id, const std::string& result) {
-    std::string payload = "{\"jsonrpc\":\"2.0\",\"id\":";
-    payload += std::to_string(id) + ",\"result\":";
+std::string McpServer::MakeResult(int id, const std::string& result) {
+    std::string payload;
+    payload.reserve(result.size() + 48 + MCP_ENVELOPE_RESERVE);
+    payload = "{\"jsonrpc\":\"2.0\",\"id\":";
+    payload += std::to_string(id);
+    payload += ",\"result\":";
     payload += result;
     payload += "}";
-    Application::GetInstance().SendMcpMessage(payload);
+    return payload;
 }
 
-void McpServer::ReplyError(int id, const std::string& message) {
+std::string McpServer::MakeError(int id, const std::string& message) {
+    // Error messages come from exceptions and may contain quotes, so let cJSON escape them
+    cJSON* text = cJSON_CreateString(message.c_str());
+    char* text_str = cJSON_PrintUnformatted(text);
     std::string payload = "{\"jsonrpc\":\"2.0\",\"id\":";
     payload += std::to_string(id);
-    payload += ",\"error\":{\"message\":\"";
-    payload += message;
-    payload += "\"}}";
-    Application::GetInstance().SendMcpMessage(payload);
+    payload += ",\"error\":{\"message\":";
+    payload += text_str;
+    payload += "}}";
+    cJSON_free(text_str);
+    cJSON_Delete(text);
+    return payload;
+}
+
+// The id of a request that is not an object cannot be known, so the spec answers with null
+std::string McpServer::MakeInvalidRequest() {
+    return "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32600,\"message\":\"Invalid Request\"}}";
+}
+
+void McpServer::Reply(std::string payload, const std::shared_ptr<Batch>& batch) {
+    if (!batch) {
+        Application::GetInstance().SendMcpMessage(std::move(payload));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(calls_mutex_);
+    batch->responses.push_back(std::move(payload));
+}
+
+void McpServer::ReplyResult(int id, const std::string& result, const std::shared_ptr<Batch>& batch) {
+    Reply(MakeResult(id, result), batch);
+}
+
+void McpServer::ReplyError(int id, const std::string& message, const std::shared_ptr<Batch>& batch) {
+    Reply(MakeError(id, message), batch);
+}
+
+// Called with calls_mutex_ held
+void McpServer::FinishBatchEntry(const std::shared_ptr<Batch>& batch) {
+    if (--batch->pending > 0 || batch->responses.empty()) {
+        return;
+    }
+    size_t size = 2;
+    for (auto& response : batch->responses) {
+        size += response.size() + 1;
+    }
+    std::string payload;
+    payload.reserve(size + MCP_ENVELOPE_RESERVE);
+    payload += '[';
+    for (auto& response : batch->responses) {
+        if (payload.size() > 1) {
+            payload += ',';
+        }
+        payload += response;
+    }
+    payload += ']';
+    ESP_LOGI(TAG, "Batch: %u responses, %u bytes", (unsigned)batch->responses.size(), (unsigned)payload.size());
+    batch->responses.clear();
+    Application::GetInstance().SendMcpMessage(std::move(payload));
 }
 
-void McpServer::GetToolsList(int id, const std::string& cursor, bool list_user_only_tools) {
-    const int max_payload_size = 8000;
-    std::string json = "{\"tools\":[";
+void McpServer::GetToolsList(int id, const std::string& cursor, bool list_user_only_tools, const std::shared_ptr<Batch>& batch) {
+    const size_t max_payload_size = 8000;
+    int64_t start_time = esp_timer_get_time();
     
-    bool found_cursor = cursor.empty();
-    auto it = tools_.begin();
+    // 通过索引直接定位游标, 找不到时与之前一样返回空列表
+    size_t start = 0;
+    if (!cursor.empty()) {
+        auto index = tool_index_.find(cursor);
+        start = index == tool_index_.end() ? tools_.size() : index->second;
+    }
     std::string next_cursor = "";
     
-    while (it != tools_.end()) {
-        // 如果我们还没有找到起始位置，继续搜索
-        if (!found_cursor) {
-            if ((*it)->name() == cursor) {
-                found_cursor = true;
-            } else {
-                ++it;
-                continue;
-            }
-        }
-
-        if (!list_user_only_tools && (*it)->user_only()) {
-            ++it;
+    // tool 的 JSON 已缓存, 先按缓存长度确定本页的 tool 和总长度, 再一次分配并拼接
+    size_t length = strlen("{\"tools\":[");
+    size_t end = start;
+    for (; end < tools_.size(); end++) {
+        const McpTool* tool = tools_[end];
+        if (!list_user_only_tools && tool->user_only()) {
             continue;
         }
-        
-        // 添加tool前检查大小
-        std::string tool_json = (*it)->to_json() + ",";
-        if (json.length() + tool_json.length() + 30 > max_payload_size) {
+        size_t tool_length = tool->to_json().length();
+        if (length + tool_length + 1 + 30 > max_payload_size) {
             // 如果添加这个tool会超出大小限制，设置next_cursor并退出循环
-            next_cursor = (*it)->name();
+            next_cursor = tool->name();
             break;
         }
-        
-        json += tool_json;
-        ++it;
+        length += tool_length + 1;
+    }
+    
+    std::string json;
+    json.reserve(length + strlen("],\"nextCursor\":\"\"}") + next_cursor.length());
+    json = "{\"tools\":[";
+    for (size_t i = start; i < end; i++) {
+        const McpTool* tool = tools_[i];
+        if (!list_user_only_tools && tool->user_only()) {
+            continue;
+        }
+        json += tool->to_json();
+        json += ',';
     }
     
     if (json.back() == ',') {
@@ -495,7 +630,7 @@ void McpServer::GetToolsList(int id, const std::string& cursor, bool list_user_o
     if (json.back() == '[' && !tools_.empty()) {
         // 如果没有添加任何tool，返回错误
         ESP_LOGE(TAG, "tools/list: Failed to add tool %s because of payload size limit", next_cursor.c_str());
-        ReplyError(id, "Failed to add tool " + next_cursor + " because of payload size limit");
+        ReplyError(id, "Failed to add tool " + next_cursor + " because of payload size limit", batch);
         return;
     }
 
@@ -505,22 +640,20 @@ void McpServer::GetToolsList(int id, const std::string& cursor, bool list_user_o
         json += "],\"nextCursor\":\"" + next_cursor + "\"}";
     }
     
-    ReplyResult(id, json);
+    ESP_LOGD(TAG, "tools/list: %u bytes built in %lld us", (unsigned)json.length(), esp_timer_get_time() - start_time);
+    ReplyResult(id, json, batch);
 }
 
-void McpServer::DoToolCall(int id, const std::string& tool_name, const cJSON* tool_arguments) {
-    auto tool_iter = std::find_if(tools_.begin(), tools_.end(), 
-                                 [&tool_name](const McpTool* tool) { 
-                                     return tool->name() == tool_name; 
-                                 });
-    
-    if (tool_iter == tools_.end()) {
+void McpServer::DoToolCall(int id, const std::string& tool_name, const cJSON* tool_arguments, const std::shared_ptr<Batch>& batch) {
+    int64_t start_time = esp_timer_get_time();
+    McpTool* tool = FindTool(tool_name);
+    if (tool == nullptr) {
         ESP_LOGE(TAG, "tools/call: Unknown tool: %s", tool_name.c_str());
-        ReplyError(id, "Unknown tool: " + tool_name);
+        ReplyError(id, "Unknown tool: " + tool_name, batch);
         return;
     }
 
-    PropertyList arguments = (*tool_iter)->properties();
+    PropertyList arguments = tool->properties();
     try {
         for (auto& argument : arguments) {
             bool found = false;
@@ -540,24 +673,145 @@ void McpServer::DoToolCall(int id, const std::string& tool_name, const cJSON* to
 
             if (!argument.has_default_value() && !found) {
                 ESP_LOGE(TAG, "tools/call: Missing valid argument: %s", argument.name().c_str());
-                ReplyError(id, "Missing valid argument: " + argument.name());
+                ReplyError(id, "Missing valid argument: " + argument.name(), batch);
                 return;
             }
         }
     } catch (const std::exception& e) {
         ESP_LOGE(TAG, "tools/call: %s", e.what());
-        ReplyError(id, e.what());
+        ReplyError(id, e.what(), batch);
         return;
     }
 
-    // Use main thread to call the tool
+    auto call = std::make_shared<ToolCall>();
+    call->id = id;
+    call->tool = tool;
+    call->arguments = std::move(arguments);
+    call->queued_time = esp_timer_get_time();
+    call->batch = batch;
+    {
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        call->sequence = next_call_sequence_++;
+        calls_in_flight_[id] = call;
+        if (batch) {
+            batch->pending++;
+        }
+    }
+    ESP_LOGD(TAG, "tools/call: %s dispatched in %lld us", tool_name.c_str(), call->queued_time - start_time);
+
+    switch (tool->execution()) {
+    case kMcpToolInline:
+        RunToolCall(call);
+        break;
+    case kMcpToolBackground:
+        StartWorkers();
+        {
+            std::lock_guard<std::mutex> lock(workers_mutex_);
+            background_calls_.push_back(call);
+        }
+        workers_cv_.notify_one();
+        break;
+    default:
+        // Use main thread to call the tool
+        Application::GetInstance().Schedule([this, call]() {
+            RunToolCall(call);
+        });
+        break;
+    }
+}
+
+void McpServer::RunToolCall(const std::shared_ptr<ToolCall>& call) {
+    if (call->cancelled) {
+        CompleteToolCall(call, "");
+        return;
+    }
+
+    int64_t start_time = esp_timer_get_time();
+    // The result is appended to the reply header in place, so an image result is only
+    // encoded once, directly into the buffer that goes out on the wire
+    std::string payload = "{\"jsonrpc\":\"2.0\",\"id\":";
+    payload += std::to_string(call->id);
+    payload += ",\"result\":";
+    try {
+        call->tool->Call(call->arguments, payload);
+        payload += "}";
+    } catch (const std::exception& e) {
+        ESP_LOGE(TAG, "tools/call: %s", e.what());
+        payload = MakeError(call->id, e.what());
+    }
+    int64_t end_time = esp_timer_get_time();
+    ESP_LOGD(TAG, "tools/call: %s waited %lld us, ran %lld us, reply %u bytes, min free heap %u", call->tool->name().c_str(),
+        start_time - call->queued_time, end_time - start_time, (unsigned)payload.size(),
+        (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+    CompleteToolCall(call, std::move(payload));
+}
+
+void McpServer::CompleteToolCall(const std::shared_ptr<ToolCall>& call, std::string payload) {
+    std::lock_guard<std::mutex> lock(calls_mutex_);
+    auto it = calls_in_flight_.find(call->id);
+    if (it != calls_in_flight_.end() && it->second == call) {
+        calls_in_flight_.erase(it);
+    }
+    if (call->cancelled) {
+        // The client gave up on this request, so no response is sent for it
+        ESP_LOGD(TAG, "tools/call: %s cancelled", call->tool->name().c_str());
+        payload.clear();
+    }
+    call->reply = std::move(payload);
+    pending_replies_[call->sequence] = call;
+
+    // Release replies in call order; SendMcpMessage keeps that order on the main task
     auto& app = Application::GetInstance();
-    app.Schedule([this, id, tool_iter, arguments = std::move(arguments)]() {
-        try {
-            ReplyResult(id, (*tool_iter)->Call(arguments));
-        } catch (const std::exception& e) {
-            ESP_LOGE(TAG, "tools/call: %s", e.what());
-            ReplyError(id, e.what());
+    for (auto it = pending_replies_.begin(); it != pending_replies_.end() && it->first == next_reply_sequence_;
+        it = pending_replies_.erase(it)) {
+        auto& done = it->second;
+        if (done->batch) {
+            if (!done->reply.empty()) {
+                done->batch->responses.push_back(std::move(done->reply));
+            }
+            FinishBatchEntry(done->batch);
+        } else if (!done->reply.empty()) {
+            app.SendMcpMessage(std::move(done->reply));
         }
-    });
+        next_reply_sequence_++;
+    }
+}
+
+void McpServer::CancelToolCall(int id) {
+    std::lock_guard<std::mutex> lock(calls_mutex_);
+    auto it = calls_in_flight_.find(id);
+    if (it == calls_in_flight_.end()) {
+        return;
+    }
+    // A call that has not started is skipped; a running one has its result dropped
+    it->second->cancelled = true;
+    ESP_LOGD(TAG, "tools/call: Cancel request %d (%s)", id, it->second->tool->name().c_str());
+}
+
+void McpServer::StartWorkers() {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    if (workers_started_) {
+        return;
+    }
+    workers_started_ = true;
+    for (int i = 0; i < CONFIG_MCP_TOOL_WORKER_COUNT; i++) {
+        xTaskCreate([](void* arg) {
+            McpServer* server = (McpServer*)arg;
+            server->WorkerTask();
+            vTaskDelete(NULL);
+        }, "mcp_tool", CONFIG_MCP_TOOL_WORKER_STACK_SIZE, this, 2, nullptr);
+    }
+}
+
+void McpServer::WorkerTask() {
+    while (true) {
+        std::shared_ptr<ToolCall> call;
+        {
+            std::unique_lock<std::mutex> lock(workers_mutex_);
+            workers_cv_.wait(lock, [this]() { return !background_calls_.empty(); });
+            call = std::move(background_calls_.front());
+            background_calls_.pop_front();
+        }
+        RunToolCall(call);
+    }
 }
@@ -4,44 +4,62 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <functional>
 #include <variant>
 #include <optional>
 #include <stdexcept>
 #include <thread>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
 #include <mbedtls/base64.h>
 
 #include <cJSON.h>
 
+// Extra capacity reserved in MCP replies for the envelope Protocol::SendMcpMessage adds,
+// so large payloads are wrapped in place instead of being copied
+#define MCP_ENVELOPE_RESERVE 128
+
 class ImageContent {
 private:
-    std::string encoded_data_;
+    std::string data_;
     std::string mime_type_;
 
-    static std::string Base64Encode(const std::string& data) {
-        size_t dlen = 0, olen = 0;
-        mbedtls_base64_encode((unsigned char*)nullptr, 0, &dlen, (const unsigned char*)data.data(), data.size());
-        std::string result(dlen, 0);
-        mbedtls_base64_encode((unsigned char*)result.data(), result.size(), &olen, (const unsigned char*)data.data(), data.size());
-        return result;
+public:
+    ImageContent(const std::string& mime_type, std::string data) : data_(std::move(data)), mime_type_(mime_type) {
     }
 
-public:
-    ImageContent(const std::string& mime_type, const std::string& data) {
-        mime_type_ = mime_type;
-        // base64 encode data
-        encoded_data_ = Base64Encode(data);
+    size_t encoded_size() const { return (data_.size() + 2) / 3 * 4; }
+
+    // Base64 encode the image straight into the tail of out, so the reply buffer is the
+    // only encoded copy of the image
+    void AppendBase64(std::string& out) const {
+        size_t offset = out.size();
+        size_t olen = 0;
+        // One extra byte for the NUL mbedtls writes after the output
+        out.resize(offset + encoded_size() + 1);
+        mbedtls_base64_encode((unsigned char*)&out[offset], out.size() - offset, &olen, (const unsigned char*)data_.data(), data_.size());
+        out.resize(offset + olen);
+    }
+
+    // MCP image content: {"type":"image","mimeType":"...","data":"<base64>"}
+    void AppendJson(std::string& out) const {
+        out += "{\"type\":\"image\",\"mimeType\":\"";
+        out += mime_type_;
+        out += "\",\"data\":\"";
+        AppendBase64(out);
+        out += "\"}";
     }
 
+    size_t json_size() const { return encoded_size() + mime_type_.size() + 48; }
+
     std::string to_json() const {
-        cJSON *json = cJSON_CreateObject();
-        cJSON_AddStringToObject(json, "type", "image");
-        cJSON_AddStringToObject(json, "mimeType", mime_type_.c_str());
-        cJSON_AddStringToObject(json, "data", encoded_data_.c_str());
-        char* json_str = cJSON_PrintUnformatted(json);
-        std::string result(json_str);
-        cJSON_free(json_str);
-        cJSON_Delete(json);
+        std::string result;
+        result.reserve(json_size());
+        AppendJson(result);
         return result;
     }
 };
@@ -120,7 +138,7 @@ public:
         value_ = value;
     }
 
-    std::string to_json() const {
+    cJSON* to_cjson() const {
         cJSON *json = cJSON_CreateObject();
         
         if (type_ == kPropertyTypeBoolean) {
@@ -146,6 +164,11 @@ public:
             }
         }
         
+        return json;
+    }
+
+    std::string to_json() const {
+        cJSON *json = to_cjson();
         char *json_str = cJSON_PrintUnformatted(json);
         std::string result(json_str);
         cJSON_free(json_str);
@@ -188,13 +211,16 @@ public:
         return required;
     }
 
-    std::string to_json() const {
+    cJSON* to_cjson() const {
         cJSON *json = cJSON_CreateObject();
-        
         for (const auto& property : properties_) {
-            cJSON *prop_json = cJSON_Parse(property.to_json().c_str());
-            cJSON_AddItemToObject(json, property.name().c_str(), prop_json);
+            cJSON_AddItemToObject(json, property.name().c_str(), property.to_cjson());
         }
+        return json;
+    }
+
+    std::string to_json() const {
+        cJSON *json = to_cjson();
         
         char *json_str = cJSON_PrintUnformatted(json);
         std::string result(json_str);
@@ -205,6 +231,13 @@ public:
     }
 };
 
+// Where a tool callback runs
+enum McpToolExecution {
+    kMcpToolInline,       // In the protocol receive task, for trivial getters
+    kMcpToolMainThread,   // On the main loop via Application::Schedule (default)
+    kMcpToolBackground,   // On an MCP worker task, for slow I/O such as HTTP or camera
+};
+
 class McpTool {
 private:
     std::string name_;
@@ -212,6 +245,8 @@ private:
     PropertyList properties_;
     std::function<ReturnValue(const PropertyList&)> callback_;
     bool user_only_ = false;
+    McpToolExecution execution_ = kMcpToolMainThread;
+    mutable std::string json_;
 
 public:
     McpTool(const std::string& name, 
@@ -223,13 +258,23 @@ public:
         properties_(properties), 
         callback_(callback) {}
 
-    void set_user_only(bool user_only) { user_only_ = user_only; }
+    void set_user_only(bool user_only) {
+        user_only_ = user_only;
+        json_.clear();
+    }
     inline const std::string& name() const { return name_; }
     inline const std::string& description() const { return description_; }
     inline const PropertyList& properties() const { return properties_; }
     inline bool user_only() const { return user_only_; }
+    void set_execution(McpToolExecution execution) { execution_ = execution; }
+    inline McpToolExecution execution() const { return execution_; }
+
+    // The schema never changes after registration, so it is rendered once and cached
+    const std::string& to_json() const {
+        if (!json_.empty()) {
+            return json_;
+        }
 
-    std::string to_json() const {
         std::vector<std::string> required = properties_.GetRequired();
         
         cJSON *json = cJSON_CreateObject();
@@ -238,9 +283,7 @@ public:
         
         cJSON *input_schema = cJSON_CreateObject();
         cJSON_AddStringToObject(input_schema, "type", "object");
-        
-        cJSON *properties = cJSON_Parse(properties_.to_json().c_str());
-        cJSON_AddItemToObject(input_schema, "properties", properties);
+        cJSON_AddItemToObject(input_schema, "properties", properties_.to_cjson());
         
         if (!required.empty()) {
             cJSON *required_array = cJSON_CreateArray();
@@ -262,52 +305,59 @@ public:
         }
         
         char *json_str = cJSON_PrintUnformatted(json);
-        std::string result(json_str);
+        json_ = json_str;
         cJSON_free(json_str);
         cJSON_Delete(json);
         
-        return result;
+        return json_;
     }
 
-    std::string Call(const PropertyList& properties) {
+    // Append the tool result JSON to out
+    void Call(const PropertyList& properties, std::string& out) {
         ReturnValue return_value = callback_(properties);
+
+        if (std::holds_alternative<ImageContent*>(return_value)) {
+            // Base64 needs no JSON escaping, so the image is appended without going through cJSON
+            std::unique_ptr<ImageContent> image_content(std::get<ImageContent*>(return_value));
+            out.reserve(out.size() + image_content->json_size() + 32 + MCP_ENVELOPE_RESERVE);
+            out += "{\"content\":[";
+            image_content->AppendJson(out);
+            out += "],\"isError\":false}";
+            return;
+        }
+
         // 返回结果
         cJSON* result = cJSON_CreateObject();
         cJSON* content = cJSON_CreateArray();
-
-        if (std::holds_alternative<ImageContent*>(return_value)) {
-            auto image_content = std::get<ImageContent*>(return_value);
-            cJSON* image = cJSON_CreateObject();
-            cJSON_AddStringToObject(image, "type", "image");
-            cJSON_AddStringToObject(image, "image", image_content->to_json().c_str());
-            cJSON_AddItemToArray(content, image);
-            delete image_content;
-        } else {
-            cJSON* text = cJSON_CreateObject();
-            cJSON_AddStringToObject(text, "type", "text");
-            if (std::holds_alternative<std::string>(return_value)) {
-                cJSON_AddStringToObject(text, "text", std::get<std::string>(return_value).c_str());
-            } else if (std::holds_alternative<bool>(return_value)) {
-                cJSON_AddStringToObject(text, "text", std::get<bool>(return_value) ? "true" : "false");
-            } else if (std::holds_alternative<int>(return_value)) {
-                cJSON_AddStringToObject(text, "text", std::to_string(std::get<int>(return_value)).c_str());
-            } else if (std::holds_alternative<cJSON*>(return_value)) {
-                cJSON* json = std::get<cJSON*>(return_value);
-                char* json_str = cJSON_PrintUnformatted(json);
-                cJSON_AddStringToObject(text, "text", json_str);
-                cJSON_free(json_str);
-                cJSON_Delete(json);
-            }
-            cJSON_AddItemToArray(content, text);
+        cJSON* text = cJSON_CreateObject();
+        cJSON_AddStringToObject(text, "type", "text");
+        if (std::holds_alternative<std::string>(return_value)) {
+            cJSON_AddStringToObject(text, "text", std::get<std::string>(return_value).c_str());
+        } else if (std::holds_alternative<bool>(return_value)) {
+            cJSON_AddStringToObject(text, "text", std::get<bool>(return_value) ? "true" : "false");
+        } else if (std::holds_alternative<int>(return_value)) {
+            cJSON_AddStringToObject(text, "text", std::to_string(std::get<int>(return_value)).c_str());
+        } else if (std::holds_alternative<cJSON*>(return_value)) {
+            cJSON* json = std::get<cJSON*>(return_value);
+            char* json_str = cJSON_PrintUnformatted(json);
+            cJSON_AddStringToObject(text, "text", json_str);
+            cJSON_free(json_str);
+            cJSON_Delete(json);
         }
+        cJSON_AddItemToArray(content, text);
         cJSON_AddItemToObject(result, "content", content);
         cJSON_AddBoolToObject(result, "isError", false);
 
         auto json_str = cJSON_PrintUnformatted(result);
-        std::string result_str(json_str);
+        out += json_str;
         cJSON_free(json_str);
         cJSON_Delete(result);
-        return result_str;
+    }
+
+    std::string Call(const PropertyList& properties) {
+        std::string result;
+        Call(properties, result);
+        return result;
     }
 };
 
@@ -321,8 +371,10 @@ public:
     void AddCommonTools();
     void AddUserOnlyTools();
     void AddTool(McpTool* tool);
-    void AddTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback);
-    void AddUserOnlyTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback);
+    void AddTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback,
+        McpToolExecution execution = kMcpToolMainThread);
+    void AddUserOnlyTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback,
+        McpToolExecution execution = kMcpToolMainThread);
     void ParseMessage(const cJSON* json);
     void ParseMessage(const std::string& message);
 
@@ -332,13 +384,58 @@ private:
 
     void ParseCapabilities(const cJSON* capabilities);
 
-    void ReplyResult(int id, const std::string& result);
-    void ReplyError(int id, const std::string& message);
-
-    void GetToolsList(int id, const std::string& cursor, bool list_user_only_tools);
-    void DoToolCall(int id, const std::string& tool_name, const cJSON* tool_arguments);
+    // Responses to the requests of one JSON-RPC batch array, sent as a single array
+    struct Batch {
+        std::vector<std::string> responses;
+        int pending = 1;    // Tool calls still running, plus one until parsing is done
+    };
+
+    void ParseRequest(const cJSON* json, const std::shared_ptr<Batch>& batch);
+    std::string MakeResult(int id, const std::string& result);
+    std::string MakeError(int id, const std::string& message);
+    std::string MakeInvalidRequest();
+    void Reply(std::string payload, const std::shared_ptr<Batch>& batch);
+    void ReplyResult(int id, const std::string& result, const std::shared_ptr<Batch>& batch = nullptr);
+    void ReplyError(int id, const std::string& message, const std::shared_ptr<Batch>& batch = nullptr);
+    void FinishBatchEntry(const std::shared_ptr<Batch>& batch);
+
+    void GetToolsList(int id, const std::string& cursor, bool list_user_only_tools, const std::shared_ptr<Batch>& batch);
+    void DoToolCall(int id, const std::string& tool_name, const cJSON* tool_arguments, const std::shared_ptr<Batch>& batch);
+    McpTool* FindTool(const std::string& name) const;
+    void RebuildToolIndex();
+
+    struct ToolCall {
+        int id;
+        uint32_t sequence;
+        McpTool* tool;
+        PropertyList arguments;
+        int64_t queued_time;
+        std::atomic<bool> cancelled{false};
+        std::shared_ptr<Batch> batch;
+        std::string reply;
+    };
+    void RunToolCall(const std::shared_ptr<ToolCall>& call);
+    void CompleteToolCall(const std::shared_ptr<ToolCall>& call, std::string payload);
+    void CancelToolCall(int id);
+    void StartWorkers();
+    void WorkerTask();
 
     std::vector<McpTool*> tools_;
+    // Tool name -> position in tools_, for O(1) tools/call lookup and tools/list cursors
+    std::unordered_map<std::string, size_t> tool_index_;
+
+    // Tool calls in flight, keyed by request id. Replies are released in call order.
+    std::mutex calls_mutex_;
+    std::unordered_map<int, std::shared_ptr<ToolCall>> calls_in_flight_;
+    std::map<uint32_t, std::shared_ptr<ToolCall>> pending_replies_;
+    uint32_t next_call_sequence_ = 0;
+    uint32_t next_reply_sequence_ = 0;
+
+    // Background worker pool
+    std::mutex workers_mutex_;
+    std::condition_variable workers_cv_;
+    std::deque<std::shared_ptr<ToolCall>> background_calls_;
+    bool workers_started_ = false;
 };
 
 #endif // MCP_SERVER_H
@@ -0,0 +1,69 @@
+#include "motion_planner.h"
+
+#include <cmath>
+
+MotionPlanner::MotionPlanner(int max_accel_percent_per_s, Profile profile)
+    : max_accel_(max_accel_percent_per_s / 1000000.0f), profile_(profile) {
+}
+
+void MotionPlanner::DirectionToWheels(int direction, int speed, int& left, int& right) {
+    // Same channel pairs as SetRealtimeMotorCommand: right = LF + RB, backward = LB + RB,
+    // left = LB + RF, forward = LF + RF
+    switch (direction) {
+        case 1: left = speed; right = -speed; break;
+        case 2: left = -speed; right = -speed; break;
+        case 3: left = -speed; right = speed; break;
+        case 4: left = speed; right = speed; break;
+        default: left = 0; right = 0; break;
+    }
+}
+
+void MotionPlanner::SetTarget(int left, int right, int64_t now_us) {
+    SetTarget(left, right, now_us, profile_);
+}
+
+void MotionPlanner::SetTarget(int left, int right, int64_t now_us, Profile profile) {
+    Plan(wheels_[0], left, now_us, profile);
+    Plan(wheels_[1], right, now_us, profile);
+}
+
+bool MotionPlanner::Sample(int64_t now_us, int& left, int& right) {
+    left = (int)lroundf(Evaluate(wheels_[0], now_us));
+    right = (int)lroundf(Evaluate(wheels_[1], now_us));
+    return now_us < wheels_[0].start_us + wheels_[0].duration_us ||
+           now_us < wheels_[1].start_us + wheels_[1].duration_us;
+}
+
+float MotionPlanner::Evaluate(const Ramp& ramp, int64_t now_us) const {
+    if (ramp.duration_us <= 0 || now_us >= ramp.start_us + ramp.duration_us) {
+        return ramp.to;
+    }
+    float u = (float)(now_us - ramp.start_us) / ramp.duration_us;
+    if (u < 0) {
+        u = 0;
+    }
+    if (ramp.profile == kProfileSCurve) {
+        u = u * u * (3 - 2 * u);
+    }
+    return ramp.from + (ramp.to - ramp.from) * u;
+}
+
+void MotionPlanner::Plan(Ramp& ramp, float target, int64_t now_us, Profile profile) {
+    // Start from wherever the wheel is now, so an unfinished ramp blends into the new one
+    float from = Evaluate(ramp, now_us);
+    float delta = fabsf(target - from);
+    ramp.from = from;
+    ramp.to = target;
+    ramp.start_us = now_us;
+    ramp.profile = profile;
+    if (profile == kProfileStep) {
+        ramp.duration_us = 0;
+        return;
+    }
+    // Smoothstep peaks at 1.5x the average slope, so it needs 1.5x the time for the same limit
+    float duration = delta / max_accel_;
+    if (profile == kProfileSCurve) {
+        duration *= 1.5f;
+    }
+    ramp.duration_us = (int64_t)duration;
+}
@@ -0,0 +1,54 @@
+#ifndef MOTION_PLANNER_H
+#define MOTION_PLANNER_H
+
+#include <cstdint>
+
+/**
+ * MotionPlanner - Acceleration limited velocity profiles for the two drive wheels
+ *
+ * Wheel speeds are signed duty percentages (-100..100, positive = forward). A new target
+ * is blended from the wheel's current speed, so consecutive motion segments join without
+ * stopping in between, and a reversal passes through zero at the same limited rate.
+ * Each ramp is planned when the target is set; Sample() only evaluates the profile.
+ */
+class MotionPlanner {
+public:
+    enum Profile {
+        kProfileTrapezoid,   // Constant acceleration
+        kProfileSCurve,      // Smoothstep: zero acceleration at both ends, same peak acceleration
+        kProfileStep,        // No ramp
+    };
+
+    MotionPlanner(int max_accel_percent_per_s, Profile profile);
+
+    /**
+     * Map a motor direction (0=stop, 1=right, 2=backward, 3=left, 4=forward) and speed to wheel speeds
+     */
+    static void DirectionToWheels(int direction, int speed, int& left, int& right);
+
+    void SetTarget(int left, int right, int64_t now_us);
+    void SetTarget(int left, int right, int64_t now_us, Profile profile);
+
+    /**
+     * Wheel speeds at now_us; returns false once both wheels have reached their targets
+     */
+    bool Sample(int64_t now_us, int& left, int& right);
+
+private:
+    struct Ramp {
+        float from = 0;
+        float to = 0;
+        int64_t start_us = 0;
+        int64_t duration_us = 0;
+        Profile profile = kProfileTrapezoid;
+    };
+
+    float max_accel_;    // Percent per microsecond
+    Profile profile_;
+    Ramp wheels_[2];
+
+    float Evaluate(const Ramp& ramp, int64_t now_us) const;
+    void Plan(Ramp& ramp, float target, int64_t now_us, Profile profile);
+};
+
+#endif // MOTION_PLANNER_H
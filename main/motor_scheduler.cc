@@ -0,0 +1,197 @@
+#include "motor_scheduler.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+#include <climits>
+
+#define TAG "MotorScheduler"
+
+// Timer callbacks arriving this early belong to an action that was already replaced
+#define MOTOR_TIMER_SLACK_US 1000
+
+MotorScheduler::MotorScheduler(DriveCallback drive) : drive_(std::move(drive)) {
+    timeline_.reserve(16);
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* arg) {
+            static_cast<MotorScheduler*>(arg)->OnTimer();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "motor_timeline",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&timer_args, &timer_);
+}
+
+MotorScheduler::~MotorScheduler() {
+    if (timer_ != nullptr) {
+        esp_timer_stop(timer_);
+        esp_timer_delete(timer_);
+    }
+}
+
+void MotorScheduler::Play(int direction, int speed, int duration_ms, int priority, std::string description) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PlayLocked(Action{direction, speed, duration_ms, priority, next_sequence_++, std::move(description)});
+}
+
+void MotorScheduler::Queue(int direction, int speed, int duration_ms, int priority, std::string description) {
+    if (duration_ms <= 0) {
+        // Nothing would ever end it, and everything behind it would wait forever
+        ESP_LOGW(TAG, "Ignoring queued action without a duration: %s", description.c_str());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    QueueLocked(Action{direction, speed, duration_ms, priority, next_sequence_++, std::move(description)});
+}
+
+static int KeyframeDuration(const ChoreoKeyframe& keyframe, int time_scale) {
+    return keyframe.duration_ms() * time_scale / 100;
+}
+
+static int RoutineDuration(const ChoreoRoutine& routine, int time_scale) {
+    int duration_ms = 0;
+    for (uint16_t i = 0; i < routine.keyframe_count; i++) {
+        duration_ms += KeyframeDuration(routine.keyframes[i], time_scale);
+    }
+    return duration_ms;
+}
+
+void MotorScheduler::Play(const ChoreoRoutine& routine, int speed_percent, int priority, int time_percent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Routine names fit the small string buffer, so the description does not allocate
+    PlayLocked(Action{0, speed_percent, RoutineDuration(routine, time_percent), priority, next_sequence_++,
+                      std::string(routine.name), routine.keyframes, routine.keyframe_count, time_percent});
+}
+
+void MotorScheduler::Queue(const ChoreoRoutine& routine, int speed_percent, int priority, int time_percent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    QueueLocked(Action{0, speed_percent, RoutineDuration(routine, time_percent), priority, next_sequence_++,
+                       std::string(routine.name), routine.keyframes, routine.keyframe_count, time_percent});
+}
+
+void MotorScheduler::PlayLocked(Action&& action) {
+    if (running_ && action.priority < running_priority_) {
+        ESP_LOGI(TAG, "Lower priority action (new:%d < current:%d), queued: %s",
+                 action.priority, running_priority_, action.description.c_str());
+        InsertLocked(std::move(action));
+        return;
+    }
+    if (running_) {
+        stats_.preempted++;
+        esp_timer_stop(timer_);
+    }
+    StartLocked(std::move(action), esp_timer_get_time());
+}
+
+void MotorScheduler::QueueLocked(Action&& action) {
+    if (running_) {
+        InsertLocked(std::move(action));
+    } else {
+        StartLocked(std::move(action), esp_timer_get_time());
+    }
+}
+
+void MotorScheduler::Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timeline_.clear();
+    if (running_) {
+        esp_timer_stop(timer_);
+        running_ = false;
+        running_keyframes_ = nullptr;
+        drive_(0, 0, kEaseDefault);
+    }
+}
+
+bool MotorScheduler::IsRunning() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+MotorScheduler::Stats MotorScheduler::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void MotorScheduler::InsertLocked(Action&& action) {
+    // Sorted ascending, so the back is the highest priority and, within it, the oldest
+    auto it = std::lower_bound(timeline_.begin(), timeline_.end(), action,
+        [](const Action& a, const Action& b) {
+            return a.priority < b.priority || (a.priority == b.priority && a.sequence > b.sequence);
+        });
+    timeline_.insert(it, std::move(action));
+}
+
+void MotorScheduler::StartLocked(Action&& action, int64_t start_us) {
+    running_ = true;
+    running_priority_ = action.priority;
+    stats_.started++;
+
+    if (action.keyframes != nullptr) {
+        ESP_LOGI(TAG, "Start routine: %s (%d keyframes, %dms, speed=%d%%, priority=%d)",
+                 action.description.c_str(), action.keyframe_count, action.duration_ms, action.speed, action.priority);
+        running_keyframes_ = action.keyframes;
+        running_keyframe_count_ = action.keyframe_count;
+        running_keyframe_ = 0;
+        running_speed_scale_ = action.speed;
+        running_time_scale_ = action.time_scale;
+        StartKeyframeLocked(start_us);
+        return;
+    }
+
+    ESP_LOGI(TAG, "Start: %s (direction=%d, speed=%d, duration=%dms, priority=%d)",
+             action.description.c_str(), action.direction, action.speed, action.duration_ms, action.priority);
+    running_keyframes_ = nullptr;
+    drive_(action.direction, action.speed, kEaseDefault);
+
+    if (action.duration_ms > 0) {
+        // Timed from the planned start, so late timer callbacks do not drift the timeline
+        running_end_us_ = start_us + action.duration_ms * 1000LL;
+        int64_t timeout_us = std::max<int64_t>(running_end_us_ - esp_timer_get_time(), 0);
+        esp_timer_start_once(timer_, timeout_us);
+    } else {
+        running_end_us_ = INT64_MAX;
+    }
+}
+
+void MotorScheduler::StartKeyframeLocked(int64_t start_us) {
+    // Runs for every keyframe from the timer task: no allocation, no logging
+    const ChoreoKeyframe& keyframe = running_keyframes_[running_keyframe_];
+    stats_.keyframes++;
+    drive_(keyframe.direction, keyframe.speed * running_speed_scale_ / 100, (ChoreoEasing)keyframe.easing);
+
+    running_end_us_ = start_us + KeyframeDuration(keyframe, running_time_scale_) * 1000LL;
+    int64_t timeout_us = std::max<int64_t>(running_end_us_ - esp_timer_get_time(), 0);
+    esp_timer_start_once(timer_, timeout_us);
+}
+
+void MotorScheduler::OnTimer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now_us = esp_timer_get_time();
+    if (!running_ || now_us + MOTOR_TIMER_SLACK_US < running_end_us_) {
+        return;
+    }
+
+    int64_t lag_us = now_us - running_end_us_;
+    if (lag_us > stats_.max_start_lag_us) {
+        stats_.max_start_lag_us = lag_us;
+    }
+
+    if (running_keyframes_ != nullptr && ++running_keyframe_ < running_keyframe_count_) {
+        StartKeyframeLocked(running_end_us_);
+        return;
+    }
+
+    if (timeline_.empty()) {
+        running_ = false;
+        running_keyframes_ = nullptr;
+        drive_(0, 0, kEaseDefault);
+        return;
+    }
+
+    // Start the next action straight away; the PWM ramp takes care of direction changes
+    Action next = std::move(timeline_.back());
+    timeline_.pop_back();
+    StartLocked(std::move(next), running_end_us_);
+}
@@ -0,0 +1,112 @@
+#ifndef MOTOR_SCHEDULER_H
+#define MOTOR_SCHEDULER_H
+
+#include <esp_timer.h>
+
+#include "choreography.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * MotorScheduler - Timer driven timeline of timed motor actions
+ *
+ * One action drives the motors at a time. When it ends, a one-shot esp_timer starts the
+ * next action on the timeline right away (no polling task, no gap, no task per action).
+ * The timeline is ordered by priority, then by arrival; a higher or equal priority Play()
+ * cuts the running action short.
+ *
+ * A choreography routine is one action on the timeline: its keyframes are stepped by the
+ * same timer, straight from the routine data, without allocating or logging per keyframe.
+ *
+ * Priority levels: 0=low (emotion, idle), 1=medium (speech), 2=high (MCP and web commands)
+ */
+class MotorScheduler {
+public:
+    /**
+     * Drive the motors; direction 0 (or speed 0) stops them, easing says how to get there.
+     * Called with the scheduler lock held, from the caller's task or the esp_timer task.
+     */
+    using DriveCallback = std::function<void(int direction, int speed, ChoreoEasing easing)>;
+
+    struct Stats {
+        uint32_t started;
+        uint32_t keyframes;          // Routine keyframes stepped
+        uint32_t preempted;          // Actions cut short by a higher or equal priority Play()
+        int64_t max_start_lag_us;    // Longest delay from an action's planned end to the next step
+    };
+
+    explicit MotorScheduler(DriveCallback drive);
+    ~MotorScheduler();
+
+    MotorScheduler(const MotorScheduler&) = delete;
+    MotorScheduler& operator=(const MotorScheduler&) = delete;
+
+    /**
+     * Start an action now if its priority is at least the running one's,
+     * otherwise put it on the timeline. duration_ms <= 0 runs until preempted or stopped.
+     */
+    void Play(int direction, int speed, int duration_ms, int priority, std::string description);
+
+    /**
+     * Append an action to the timeline, after everything of the same or higher priority
+     */
+    void Queue(int direction, int speed, int duration_ms, int priority, std::string description);
+
+    /**
+     * Same as above for a whole routine, with keyframe speeds scaled by speed_percent and
+     * keyframe durations by time_percent.
+     * The routine data must stay valid until the routine has finished or been stopped.
+     */
+    void Play(const ChoreoRoutine& routine, int speed_percent, int priority, int time_percent = 100);
+    void Queue(const ChoreoRoutine& routine, int speed_percent, int priority, int time_percent = 100);
+
+    /**
+     * Stop the running action and clear the timeline
+     */
+    void Stop();
+
+    bool IsRunning();
+    Stats GetStats();
+
+private:
+    struct Action {
+        int direction;
+        int speed;
+        int duration_ms;
+        int priority;
+        uint32_t sequence;
+        std::string description;
+        const ChoreoKeyframe* keyframes = nullptr;   // Routine actions; speed is then the scale
+        uint16_t keyframe_count = 0;
+        int time_scale = 100;
+    };
+
+    DriveCallback drive_;
+    esp_timer_handle_t timer_ = nullptr;
+    std::mutex mutex_;
+    std::vector<Action> timeline_;   // Next action at the back
+    bool running_ = false;
+    int running_priority_ = 0;
+    int64_t running_end_us_ = 0;     // INT64_MAX for actions without a duration
+    uint32_t next_sequence_ = 0;
+    // Running routine, if any
+    const ChoreoKeyframe* running_keyframes_ = nullptr;
+    uint16_t running_keyframe_count_ = 0;
+    uint16_t running_keyframe_ = 0;
+    int running_speed_scale_ = 100;
+    int running_time_scale_ = 100;
+    Stats stats_{};
+
+    void PlayLocked(Action&& action);
+    void QueueLocked(Action&& action);
+    void InsertLocked(Action&& action);
+    void StartLocked(Action&& action, int64_t start_us);
+    void StartKeyframeLocked(int64_t start_us);
+    void OnTimer();
+};
+
+#endif // MOTOR_SCHEDULER_H
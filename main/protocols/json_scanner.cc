@@ -0,0 +1,235 @@
+#include "json_scanner.h"
+
+#include <cstring>
+#include <cstdint>
+
+// Nesting is only tracked to skip over values, the server messages are shallow
+#define MAX_SKIP_DEPTH 16
+
+const char* JsonScanner::SkipWhitespace(const char* p) const {
+    while (p < end_ && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+// p points at the opening quote, returns the position after the closing quote or nullptr
+const char* JsonScanner::SkipString(const char* p) const {
+    for (p++; p < end_; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return nullptr;
+}
+
+// Returns the position right after the value (a scalar ends at the next ',' or '}')
+const char* JsonScanner::SkipValue(const char* p) const {
+    int depth = 0;
+    while (p < end_) {
+        char c = *p;
+        if (c == '"') {
+            p = SkipString(p);
+            if (p == nullptr || depth == 0) {
+                return p;
+            }
+        } else if (c == '{' || c == '[') {
+            if (++depth > MAX_SKIP_DEPTH) {
+                return nullptr;
+            }
+            p++;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) {
+                return p;
+            }
+            p++;
+            if (--depth == 0) {
+                return p;
+            }
+        } else if (c == ',' && depth == 0) {
+            return p;
+        } else {
+            p++;
+        }
+    }
+    return depth == 0 ? p : nullptr;
+}
+
+bool JsonScanner::FindMember(std::string_view key, const char*& value) const {
+    const char* p = SkipWhitespace(data_);
+    if (p >= end_ || *p != '{') {
+        return false;
+    }
+    p++;
+    while (true) {
+        p = SkipWhitespace(p);
+        if (p >= end_ || *p != '"') {
+            return false;
+        }
+        const char* key_start = p + 1;
+        p = SkipString(p);
+        if (p == nullptr) {
+            return false;
+        }
+        std::string_view member_key(key_start, p - 1 - key_start);
+        p = SkipWhitespace(p);
+        if (p >= end_ || *p != ':') {
+            return false;
+        }
+        p = SkipWhitespace(p + 1);
+        if (p >= end_) {
+            return false;
+        }
+        if (member_key == key) {
+            value = p;
+            return true;
+        }
+        p = SkipValue(p);
+        if (p == nullptr) {
+            return false;
+        }
+        p = SkipWhitespace(p);
+        if (p >= end_ || *p != ',') {
+            return false;
+        }
+        p++;
+    }
+}
+
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool ReadHex4(const char* p, const char* end, uint32_t& code) {
+    if (end - p < 4) {
+        return false;
+    }
+    code = 0;
+    for (int i = 0; i < 4; i++) {
+        int v = HexValue(p[i]);
+        if (v < 0) {
+            return false;
+        }
+        code = (code << 4) | v;
+    }
+    return true;
+}
+
+bool JsonScanner::GetString(std::string_view key, std::string_view& value, char* buffer, size_t buffer_size) const {
+    const char* p;
+    if (!FindMember(key, p) || *p != '"') {
+        return false;
+    }
+    const char* start = p + 1;
+    const char* end = SkipString(p);
+    if (end == nullptr) {
+        return false;
+    }
+    end--;
+
+    // Common case: nothing to unescape, point into the receive buffer
+    if (memchr(start, '\\', end - start) == nullptr) {
+        value = std::string_view(start, end - start);
+        return true;
+    }
+
+    size_t n = 0;
+    for (p = start; p < end; p++) {
+        uint32_t code = (uint8_t)*p;
+        if (*p == '\\') {
+            p++;
+            switch (*p) {
+            case '"': code = '"'; break;
+            case '\\': code = '\\'; break;
+            case '/': code = '/'; break;
+            case 'b': code = '\b'; break;
+            case 'f': code = '\f'; break;
+            case 'n': code = '\n'; break;
+            case 'r': code = '\r'; break;
+            case 't': code = '\t'; break;
+            case 'u': {
+                if (!ReadHex4(p + 1, end, code)) {
+                    return false;
+                }
+                p += 4;
+                // Surrogate pair, e.g. emoji
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    uint32_t low;
+                    if (end - p < 7 || p[1] != '\\' || p[2] != 'u' || !ReadHex4(p + 3, end, low) ||
+                        low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                // Encode as UTF-8
+                char utf8[4];
+                size_t len;
+                if (code < 0x80) {
+                    utf8[0] = code;
+                    len = 1;
+                } else if (code < 0x800) {
+                    utf8[0] = 0xC0 | (code >> 6);
+                    utf8[1] = 0x80 | (code & 0x3F);
+                    len = 2;
+                } else if (code < 0x10000) {
+                    utf8[0] = 0xE0 | (code >> 12);
+                    utf8[1] = 0x80 | ((code >> 6) & 0x3F);
+                    utf8[2] = 0x80 | (code & 0x3F);
+                    len = 3;
+                } else {
+                    utf8[0] = 0xF0 | (code >> 18);
+                    utf8[1] = 0x80 | ((code >> 12) & 0x3F);
+                    utf8[2] = 0x80 | ((code >> 6) & 0x3F);
+                    utf8[3] = 0x80 | (code & 0x3F);
+                    len = 4;
+                }
+                if (n + len > buffer_size) {
+                    return false;
+                }
+                memcpy(buffer + n, utf8, len);
+                n += len;
+                continue;
+            }
+            default:
+                return false;
+            }
+        }
+        if (n + 1 > buffer_size) {
+            return false;
+        }
+        buffer[n++] = (char)code;
+    }
+    value = std::string_view(buffer, n);
+    return true;
+}
+
+bool JsonScanner::GetInt(std::string_view key, int& value) const {
+    const char* p;
+    if (!FindMember(key, p)) {
+        return false;
+    }
+    bool negative = false;
+    if (*p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p >= end_ || *p < '0' || *p > '9') {
+        return false;
+    }
+    int64_t result = 0;
+    while (p < end_ && *p >= '0' && *p <= '9') {
+        result = result * 10 + (*p - '0');
+        if (result > INT32_MAX) {
+            return false;
+        }
+        p++;
+    }
+    value = negative ? -result : result;
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef JSON_SCANNER_H
+#define JSON_SCANNER_H
+
+#include <string_view>
+#include <cstddef>
+
+/**
+ * Allocation free lookup of top level members in a JSON object, reading straight from
+ * the receive buffer. Only meant for the small hot server messages (tts / stt / llm / pong);
+ * anything it cannot answer is left to cJSON.
+ */
+class JsonScanner {
+public:
+    JsonScanner(const char* data, size_t size) : data_(data), end_(data + size) {}
+
+    /**
+     * Find a top level string member. Without escapes the value points into the receive
+     * buffer; with escapes it is decoded into buffer. Returns false if the member is
+     * missing, not a string, malformed or does not fit in buffer.
+     */
+    bool GetString(std::string_view key, std::string_view& value, char* buffer, size_t buffer_size) const;
+    bool GetInt(std::string_view key, int& value) const;
+
+private:
+    const char* data_;
+    const char* end_;
+
+    bool FindMember(std::string_view key, const char*& value) const;
+    const char* SkipWhitespace(const char* p) const;
+    const char* SkipString(const char* p) const;
+    const char* SkipValue(const char* p) const;
+};
+
+#endif // JSON_SCANNER_H
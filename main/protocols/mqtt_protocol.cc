@@ -5,6 +5,7 @@
 
 #include <esp_log.h>
 #include <cstring>
+#include <algorithm>
 #include <arpa/inet.h>
 #include "assets/lang_config.h"
 
@@ -22,8 +23,15 @@ MqttProtocol::MqttProtocol() {
                 ESP_LOGI(TAG, "Reconnecting to MQTT server");
                 auto alive = protocol->alive_;  // Capture alive flag
                 app.Schedule([protocol, alive]() {
-                    if (*alive) {
+                    if (!*alive) {
+                        return;
+                    }
+                    // A preconnect holding the transport starts the client itself if needed
+                    std::unique_lock<std::recursive_mutex> lock(protocol->transport_mutex_, std::try_to_lock);
+                    if (lock.owns_lock()) {
                         protocol->StartMqttClient(false);
+                    } else {
+                        esp_timer_start_once(protocol->reconnect_timer_, MQTT_RECONNECT_INTERVAL_MS * 1000);
                     }
                 });
             }
@@ -38,6 +46,7 @@ MqttProtocol::~MqttProtocol() {
     
     // Mark as dead first to prevent any pending scheduled tasks from executing
     *alive_ = false;
+    WaitForPreconnect();
     
     if (reconnect_timer_ != nullptr) {
         esp_timer_stop(reconnect_timer_);
@@ -98,6 +107,10 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
     });
 
     mqtt_->OnMessage([this](const std::string& topic, const std::string& payload) {
+        if (DispatchTextMessage(payload.data(), payload.size())) {
+            last_incoming_time_ = std::chrono::steady_clock::now();
+            return;
+        }
         cJSON* root = cJSON_Parse(payload.c_str());
         if (root == nullptr) {
             ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());
@@ -188,24 +201,53 @@ bool MqttProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
     return udp_->Send(encrypted) > 0;
 }
 
-void MqttProtocol::CloseAudioChannel() {
+void MqttProtocol::CloseAudioChannel(bool keep_warm) {
+    {
+        std::lock_guard<std::recursive_mutex> lock(transport_mutex_);
+        if (keep_warm && udp_ != nullptr && EnterKeepWarm()) {
+            // Keep the UDP session and AES keys, the MQTT keepalive holds the control link
+            SendStopListening();
+        } else {
+            warm_ = false;
+            ReleaseTransport();
+        }
+    }
+    // The application was already told the channel closed when it went warm
+    NotifyAudioChannelClosed();
+}
+
+void MqttProtocol::ReleaseTransport() {
     {
         std::lock_guard<std::mutex> lock(channel_mutex_);
         udp_.reset();
     }
 
-    std::string message = "{";
-    message += "\"session_id\":\"" + session_id_ + "\",";
-    message += "\"type\":\"goodbye\"";
-    message += "}";
+    std::string message = MessagePrefix();
+    message += "\"type\":\"goodbye\"}";
     SendText(message);
+}
 
-    if (on_audio_channel_closed_ != nullptr) {
-        on_audio_channel_closed_();
-    }
+int MqttProtocol::KeepWarmSeconds() const {
+    // The MQTT keepalive holds the control link. The UDP session only carries audio, and an
+    // empty audio packet would use up a sequence number and reach the server's ASR, so
+    // instead the session expires before its NAT mapping can.
+    return std::min(Protocol::KeepWarmSeconds(), MQTT_UDP_KEEP_WARM_MAX_SECONDS);
 }
 
-bool MqttProtocol::OpenAudioChannel() {
+bool MqttProtocol::ConnectAudioChannel() {
+    // Reuse the UDP session kept warm by the previous conversation, no hello round trip needed
+    if (warm_.exchange(false)) {
+        if (udp_ != nullptr && mqtt_ != nullptr && mqtt_->IsConnected() && !error_occurred_) {
+            ESP_LOGI(TAG, "Reusing warm UDP session: %s", session_id_.c_str());
+            last_incoming_time_ = std::chrono::steady_clock::now();
+            // The server numbers the downlink of the new turn from the start again
+            remote_sequence_ = 0;
+            ResetDownlinkStats();
+            return true;
+        }
+        ReleaseTransport();
+    }
+
     if (mqtt_ == nullptr || !mqtt_->IsConnected()) {
         ESP_LOGI(TAG, "MQTT is not connected, try to connect now");
         if (!StartMqttClient(true)) {
@@ -214,11 +256,13 @@ bool MqttProtocol::OpenAudioChannel() {
     }
 
     error_occurred_ = false;
-    session_id_ = "";
+    SetSessionId("");
     xEventGroupClearBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);
 
-    auto message = GetHelloMessage();
-    if (!SendText(message)) {
+    if (hello_message_.empty()) {
+        hello_message_ = GetHelloMessage();
+    }
+    if (!SendText(hello_message_)) {
         return false;
     }
 
@@ -229,6 +273,7 @@ bool MqttProtocol::OpenAudioChannel() {
         SetError(Lang::Strings::SERVER_TIMEOUT);
         return false;
     }
+    ResetDownlinkStats();
 
     std::lock_guard<std::mutex> lock(channel_mutex_);
     auto network = Board::GetInstance().GetNetwork();
@@ -255,7 +300,9 @@ bool MqttProtocol::OpenAudioChannel() {
         }
         if (sequence != remote_sequence_ + 1) {
             ESP_LOGW(TAG, "Received audio packet with wrong sequence: %lu, expected: %lu", sequence, remote_sequence_ + 1);
+            RecordAudioLoss(sequence - remote_sequence_ - 1);
         }
+        RecordIncomingAudio(timestamp);
 
         size_t decrypted_size = data.size() - aes_nonce_.size();
         size_t nc_off = 0;
@@ -280,10 +327,6 @@ bool MqttProtocol::OpenAudioChannel() {
     });
 
     udp_->Connect(udp_server_, udp_port_);
-
-    if (on_audio_channel_opened_ != nullptr) {
-        on_audio_channel_opened_();
-    }
     return true;
 }
 
@@ -298,6 +341,9 @@ std::string MqttProtocol::GetHelloMessage() {
     cJSON_AddBoolToObject(features, "aec", true);
 #endif
     cJSON_AddBoolToObject(features, "mcp", true);
+#if CONFIG_LINK_PROBE_INTERVAL_SECONDS > 0
+    cJSON_AddBoolToObject(features, "ping", true);
+#endif
     cJSON_AddItemToObject(root, "features", features);
     cJSON* audio_params = cJSON_CreateObject();
     cJSON_AddStringToObject(audio_params, "format", "opus");
@@ -321,10 +367,14 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
 
     auto session_id = cJSON_GetObjectItem(root, "session_id");
     if (cJSON_IsString(session_id)) {
-        session_id_ = session_id->valuestring;
+        SetSessionId(session_id->valuestring);
         ESP_LOGI(TAG, "Session ID: %s", session_id_.c_str());
     }
 
+    // Servers that don't echo the feature are not pinged
+    auto features = cJSON_GetObjectItem(root, "features");
+    link_probe_ = cJSON_IsTrue(cJSON_GetObjectItem(features, "ping"));
+
     // Get sample rate from hello message
     auto audio_params = cJSON_GetObjectItem(root, "audio_params");
     if (cJSON_IsObject(audio_params)) {
@@ -378,5 +428,8 @@ std::string MqttProtocol::DecodeHexString(const std::string& hex_string) {
 }
 
 bool MqttProtocol::IsAudioChannelOpened() const {
+    if (IsPreconnecting() || warm_) {
+        return false;
+    }
     return udp_ != nullptr && !error_occurred_ && !IsTimeout();
 }
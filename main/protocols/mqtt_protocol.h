@@ -23,6 +23,10 @@
 
 #define MQTT_PROTOCOL_SERVER_HELLO_EVENT (1 << 0)
 
+// Nothing is sent on a warm UDP session, so it is given up before common NAT mappings for
+// idle UDP flows (30 s and up) expire
+#define MQTT_UDP_KEEP_WARM_MAX_SECONDS 25
+
 class MqttProtocol : public Protocol {
 public:
     MqttProtocol();
@@ -30,8 +34,7 @@ public:
 
     bool Start() override;
     bool SendAudio(std::unique_ptr<AudioStreamPacket> packet) override;
-    bool OpenAudioChannel() override;
-    void CloseAudioChannel() override;
+    void CloseAudioChannel(bool keep_warm = false) override;
     bool IsAudioChannelOpened() const override;
 
 private:
@@ -52,8 +55,12 @@ private:
     uint32_t local_sequence_;
     uint32_t remote_sequence_;
     esp_timer_handle_t reconnect_timer_;
+    std::string hello_message_;
 
     bool StartMqttClient(bool report_error=false);
+    bool ConnectAudioChannel() override;
+    void ReleaseTransport() override;
+    int KeepWarmSeconds() const override;
     void ParseServerHello(const cJSON* root);
     std::string DecodeHexString(const std::string& hex_string);
 
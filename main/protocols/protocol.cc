@@ -1,13 +1,28 @@
 #include "protocol.h"
+#include "json_scanner.h"
 
 #include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <cstdlib>
+#include <algorithm>
+#include <arpa/inet.h>
 
 #define TAG "Protocol"
 
+#define KEEP_ALIVE_INTERVAL_SECONDS 15
+#define PRECONNECT_CLAIM_TIMEOUT_SECONDS 10
+#define LINK_PROBE_MAX_BACKOFF_SHIFT 3
+#define JITTER_MAX_GAP_MS 1000
+
 void Protocol::OnIncomingJson(std::function<void(const cJSON* root)> callback) {
     on_incoming_json_ = callback;
 }
 
+void Protocol::OnIncomingControl(std::function<void(const ControlMessage& message)> callback) {
+    on_incoming_control_ = callback;
+}
+
 void Protocol::OnIncomingAudio(std::function<void(std::unique_ptr<AudioStreamPacket> packet)> callback) {
     on_incoming_audio_ = callback;
 }
@@ -34,13 +49,123 @@ void Protocol::OnDisconnected(std::function<void()> callback) {
 
 void Protocol::SetError(const std::string& message) {
     error_occurred_ = true;
+    {
+        // Raised later on the task that claims the preconnect, like the opened callback
+        std::lock_guard<std::mutex> lock(preconnect_mutex_);
+        if (preconnect_task_ != nullptr && preconnect_task_ == xTaskGetCurrentTaskHandle()) {
+            preconnect_error_ = message;
+            return;
+        }
+    }
     if (on_network_error_ != nullptr) {
         on_network_error_(message);
     }
 }
 
+bool Protocol::OpenAudioChannel() {
+    std::unique_lock<std::mutex> lock(preconnect_mutex_);
+    preconnect_cv_.wait(lock, [this]() { return preconnect_state_ != kPreconnectPending; });
+    bool opened;
+    if (preconnect_state_ == kPreconnectDone) {
+        preconnect_state_ = kPreconnectNone;
+        bool result = preconnect_result_;
+        std::string error = std::move(preconnect_error_);
+        preconnect_error_.clear();
+        lock.unlock();
+        // Report the failed attempt's error, but do not retry it here
+        if (!result) {
+            if (!error.empty() && on_network_error_ != nullptr) {
+                on_network_error_(error);
+            }
+            return false;
+        }
+        std::lock_guard<std::recursive_mutex> transport_lock(transport_mutex_);
+        opened = IsAudioChannelOpened() || ConnectAudioChannel();
+    } else {
+        lock.unlock();
+        std::lock_guard<std::recursive_mutex> transport_lock(transport_mutex_);
+        opened = ConnectAudioChannel();
+    }
+
+    // Raised here rather than in ConnectAudioChannel(), so that a preconnected channel is
+    // only announced once the caller claims it, on the caller's task
+    if (opened) {
+        channel_announced_ = true;
+        if (on_audio_channel_opened_ != nullptr) {
+            on_audio_channel_opened_();
+        }
+    }
+    return opened;
+}
+
+void Protocol::PreconnectAudioChannel() {
+    {
+        std::lock_guard<std::mutex> lock(preconnect_mutex_);
+        if (preconnect_state_ != kPreconnectNone) {
+            return;
+        }
+        preconnect_state_ = kPreconnectPending;
+        preconnect_error_.clear();
+    }
+
+    auto ret = xTaskCreate([](void* arg) {
+        Protocol* protocol = static_cast<Protocol*>(arg);
+        {
+            std::lock_guard<std::mutex> lock(protocol->preconnect_mutex_);
+            protocol->preconnect_task_ = xTaskGetCurrentTaskHandle();
+        }
+        bool result;
+        {
+            // The main task waits here to close or release the transport while it connects
+            std::lock_guard<std::recursive_mutex> transport_lock(protocol->transport_mutex_);
+            result = protocol->ConnectAudioChannel();
+        }
+        {
+            std::lock_guard<std::mutex> lock(protocol->preconnect_mutex_);
+            protocol->preconnect_task_ = nullptr;
+            protocol->preconnect_result_ = result;
+            protocol->preconnect_state_ = kPreconnectDone;
+            protocol->preconnect_done_time_ = std::chrono::steady_clock::now();
+        }
+        protocol->preconnect_cv_.notify_all();
+        vTaskDelete(NULL);
+    }, "preconnect", 4096 * 2, this, 3, NULL);
+
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create preconnect task");
+        std::lock_guard<std::mutex> lock(preconnect_mutex_);
+        preconnect_state_ = kPreconnectNone;
+    }
+}
+
+bool Protocol::IsPreconnecting() const {
+    std::lock_guard<std::mutex> lock(preconnect_mutex_);
+    return preconnect_state_ != kPreconnectNone;
+}
+
+void Protocol::WaitForPreconnect() {
+    std::unique_lock<std::mutex> lock(preconnect_mutex_);
+    preconnect_cv_.wait(lock, [this]() { return preconnect_state_ != kPreconnectPending; });
+}
+
+void Protocol::SetSessionId(const std::string& session_id) {
+    std::string prefix = "{\"session_id\":\"" + session_id + "\",";
+    std::lock_guard<std::mutex> lock(message_prefix_mutex_);
+    session_id_ = session_id;
+    message_prefix_ = std::move(prefix);
+}
+
+std::string Protocol::MessagePrefix() const {
+    std::lock_guard<std::mutex> lock(message_prefix_mutex_);
+    return message_prefix_;
+}
+
 void Protocol::SendAbortSpeaking(AbortReason reason) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"abort\"";
+    if (binary_control_ && SendControl(kControlAbort, reason, {})) {
+        return;
+    }
+    std::string message = MessagePrefix();
+    message += "\"type\":\"abort\"";
     if (reason == kAbortReasonWakeWordDetected) {
         message += ",\"reason\":\"wake_word_detected\"";
     }
@@ -49,14 +174,20 @@ void Protocol::SendAbortSpeaking(AbortReason reason) {
 }
 
 void Protocol::SendWakeWordDetected(const std::string& wake_word) {
-    std::string json = "{\"session_id\":\"" + session_id_ + 
-                      "\",\"type\":\"listen\",\"state\":\"detect\",\"text\":\"" + wake_word + "\"}";
-    SendText(json);
+    if (binary_control_ && SendControl(kControlListenDetect, 0, wake_word)) {
+        return;
+    }
+    std::string message = MessagePrefix();
+    message += "\"type\":\"listen\",\"state\":\"detect\",\"text\":\"" + wake_word + "\"}";
+    SendText(message);
 }
 
 void Protocol::SendStartListening(ListeningMode mode) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\"";
-    message += ",\"type\":\"listen\",\"state\":\"start\"";
+    if (binary_control_ && SendControl(kControlListenStart, mode, {})) {
+        return;
+    }
+    std::string message = MessagePrefix();
+    message += "\"type\":\"listen\",\"state\":\"start\"";
     if (mode == kListeningModeRealtime) {
         message += ",\"mode\":\"realtime\"";
     } else if (mode == kListeningModeAutoStop) {
@@ -69,13 +200,269 @@ void Protocol::SendStartListening(ListeningMode mode) {
 }
 
 void Protocol::SendStopListening() {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"listen\",\"state\":\"stop\"}";
+    if (binary_control_ && SendControl(kControlListenStop, 0, {})) {
+        return;
+    }
+    std::string message = MessagePrefix();
+    message += "\"type\":\"listen\",\"state\":\"stop\"}";
     SendText(message);
 }
 
-void Protocol::SendMcpMessage(const std::string& payload) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"mcp\",\"payload\":" + payload + "}";
+void Protocol::SendMcpMessage(std::string payload) {
+    std::string envelope = MessagePrefix();
+    envelope += "\"type\":\"mcp\",\"payload\":";
+    payload.reserve(envelope.size() + payload.size() + 1);
+    payload.insert(0, envelope);
+    payload += "}";
+    SendText(payload);
+}
+
+bool Protocol::ParseBinaryControl(const uint8_t* data, size_t size) {
+    if (size < sizeof(BinaryControl)) {
+        ESP_LOGE(TAG, "Invalid control frame size: %u", size);
+        return false;
+    }
+    auto control = (const BinaryControl*)data;
+    size_t text_size = ntohs(control->text_size);
+    if (sizeof(BinaryControl) + text_size > size) {
+        ESP_LOGE(TAG, "Invalid control frame text size: %u", text_size);
+        return false;
+    }
+    if (on_incoming_control_ != nullptr) {
+        ControlMessage message;
+        message.opcode = (ControlOpcode)control->opcode;
+        message.arg = control->arg;
+        message.text = std::string_view((const char*)control->text, text_size);
+        on_incoming_control_(message);
+    }
+    return true;
+}
+
+bool Protocol::EnterKeepWarm() {
+#if CONFIG_AUDIO_CHANNEL_KEEP_WARM_SECONDS > 0
+    if (error_occurred_ || IsTimeout()) {
+        return false;
+    }
+    warm_since_ = std::chrono::steady_clock::now();
+    last_keep_alive_time_ = warm_since_;
+    warm_ = true;
+    ESP_LOGI(TAG, "Keep audio channel warm for %d seconds", KeepWarmSeconds());
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Protocol::NotifyAudioChannelClosed() {
+    if (channel_announced_.exchange(false) && on_audio_channel_closed_ != nullptr) {
+        on_audio_channel_closed_();
+    }
+}
+
+int Protocol::KeepWarmSeconds() const {
+    return CONFIG_AUDIO_CHANNEL_KEEP_WARM_SECONDS;
+}
+
+void Protocol::CheckKeepWarm() {
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(preconnect_mutex_);
+        if (preconnect_state_ == kPreconnectDone &&
+            now - preconnect_done_time_ >= std::chrono::seconds(PRECONNECT_CLAIM_TIMEOUT_SECONDS)) {
+            preconnect_state_ = kPreconnectNone;
+            bool opened = preconnect_result_;
+            std::string error = std::move(preconnect_error_);
+            preconnect_error_.clear();
+            lock.unlock();
+            if (opened) {
+                // Never announced, so the application gets no closed callback for it
+                ESP_LOGI(TAG, "Preconnected audio channel was not claimed, releasing transport");
+                std::lock_guard<std::recursive_mutex> transport_lock(transport_mutex_);
+                ReleaseTransport();
+            } else if (!error.empty()) {
+                ESP_LOGW(TAG, "Unclaimed preconnect failed: %s", error.c_str());
+            }
+        }
+    }
+
+#if CONFIG_AUDIO_CHANNEL_KEEP_WARM_SECONDS > 0
+    if (!warm_) {
+        return;
+    }
+    // A preconnect holding the transport is about to reuse it, check again next second
+    std::unique_lock<std::recursive_mutex> lock(transport_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || !warm_) {
+        return;
+    }
+    if (now - warm_since_ >= std::chrono::seconds(KeepWarmSeconds()) || error_occurred_) {
+        ESP_LOGI(TAG, "Keep warm window expired, releasing transport");
+        warm_ = false;
+        ReleaseTransport();
+        return;
+    }
+    if (now - last_keep_alive_time_ >= std::chrono::seconds(KEEP_ALIVE_INTERVAL_SECONDS)) {
+        last_keep_alive_time_ = now;
+        SendKeepAlive();
+    }
+#endif
+}
+
+void Protocol::ProbeLink() {
+#if CONFIG_LINK_PROBE_INTERVAL_SECONDS > 0
+    // Servers that do not confirm the feature would treat pings as unknown messages
+    if (!link_probe_ || (!IsAudioChannelOpened() && !warm_)) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(link_stats_mutex_);
+        // Each unanswered ping doubles the interval, up to 8 times, until a pong arrives
+        int interval = CONFIG_LINK_PROBE_INTERVAL_SECONDS << std::min(probes_unanswered_, LINK_PROBE_MAX_BACKOFF_SHIFT);
+        if (now - probe_sent_time_ < std::chrono::seconds(interval)) {
+            return;
+        }
+        if (probe_pending_) {
+            probes_unanswered_++;
+            // Until the first pong the server may simply not echo pings
+            if (probe_answered_) {
+                link_stats_.probes_lost++;
+            }
+        }
+        id = ++probe_id_;
+        probe_pending_ = true;
+        probe_sent_time_ = now;
+        link_stats_.probes_sent++;
+    }
+
+    std::string message = MessagePrefix();
+    message += "\"type\":\"ping\",\"id\":" + std::to_string(id) + "}";
     SendText(message);
+#endif
+}
+
+void Protocol::HandleLinkProbeReply(int id) {
+    int rtt_ms;
+    {
+        std::lock_guard<std::mutex> lock(link_stats_mutex_);
+        if (!probe_pending_ || (uint32_t)id != probe_id_) {
+            return;
+        }
+        probe_pending_ = false;
+        probe_answered_ = true;
+        probes_unanswered_ = 0;
+        rtt_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - probe_sent_time_).count();
+    }
+    RecordRttSample(rtt_ms);
+}
+
+bool Protocol::DispatchTextMessage(const char* data, size_t size) {
+    JsonScanner scanner(data, size);
+    char type_buffer[16];
+    std::string_view type;
+    if (!scanner.GetString("type", type, type_buffer, sizeof(type_buffer))) {
+        return false;
+    }
+
+    if (type == "pong") {
+        int id;
+        if (scanner.GetInt("id", id)) {
+            HandleLinkProbeReply(id);
+        }
+        return true;
+    }
+
+    // Escaped text is decoded here, longer text falls back to cJSON
+    char text_buffer[256];
+    ControlMessage message;
+    if (type == "tts") {
+        char state_buffer[16];
+        std::string_view state;
+        if (!scanner.GetString("state", state, state_buffer, sizeof(state_buffer))) {
+            return false;
+        }
+        if (state == "start") {
+            message.opcode = kControlTtsStart;
+        } else if (state == "stop") {
+            message.opcode = kControlTtsStop;
+        } else if (state == "sentence_start") {
+            if (!scanner.GetString("text", message.text, text_buffer, sizeof(text_buffer))) {
+                return false;
+            }
+            message.opcode = kControlTtsSentence;
+        } else {
+            return false;
+        }
+    } else if (type == "stt") {
+        if (!scanner.GetString("text", message.text, text_buffer, sizeof(text_buffer))) {
+            return false;
+        }
+        message.opcode = kControlStt;
+    } else if (type == "llm") {
+        if (!scanner.GetString("emotion", message.text, text_buffer, sizeof(text_buffer))) {
+            return false;
+        }
+        message.opcode = kControlLlmEmotion;
+    } else {
+        return false;
+    }
+
+    if (on_incoming_control_ != nullptr) {
+        on_incoming_control_(message);
+    }
+    return true;
+}
+
+void Protocol::RecordRttSample(int rtt_ms) {
+    std::lock_guard<std::mutex> lock(link_stats_mutex_);
+    // Same smoothing as TCP SRTT (RFC 6298)
+    if (link_stats_.rtt_ms < 0) {
+        rtt_smoothed_ = rtt_ms;
+    } else {
+        rtt_smoothed_ += (rtt_ms - rtt_smoothed_) / 8.0f;
+    }
+    link_stats_.rtt_ms = (int)rtt_smoothed_;
+    if (link_stats_.rtt_min_ms < 0 || rtt_ms < link_stats_.rtt_min_ms) {
+        link_stats_.rtt_min_ms = rtt_ms;
+    }
+    ESP_LOGD(TAG, "RTT sample: %d ms, smoothed: %d ms", rtt_ms, link_stats_.rtt_ms);
+}
+
+void Protocol::RecordIncomingAudio(uint32_t timestamp) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(link_stats_mutex_);
+    link_stats_.audio_received++;
+    if (has_last_audio_) {
+        int arrival_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_audio_arrival_).count();
+        // A long gap is a pause between sentences, not jitter
+        if (arrival_ms < JITTER_MAX_GAP_MS) {
+            // Without a sender timestamp, the frames are expected one frame duration apart
+            int expected_ms = (timestamp != 0 && last_audio_timestamp_ != 0) ?
+                (int32_t)(timestamp - last_audio_timestamp_) : server_frame_duration_;
+            float d = std::abs(arrival_ms - expected_ms);
+            jitter_ += (d - jitter_) / 16.0f;
+            link_stats_.jitter_ms = (int)jitter_;
+        }
+    }
+    last_audio_arrival_ = now;
+    last_audio_timestamp_ = timestamp;
+    has_last_audio_ = true;
+}
+
+void Protocol::RecordAudioLoss(uint32_t lost) {
+    std::lock_guard<std::mutex> lock(link_stats_mutex_);
+    link_stats_.audio_lost += lost;
+}
+
+void Protocol::ResetDownlinkStats() {
+    std::lock_guard<std::mutex> lock(link_stats_mutex_);
+    has_last_audio_ = false;
+    last_audio_timestamp_ = 0;
+}
+
+LinkStats Protocol::GetLinkStats() const {
+    std::lock_guard<std::mutex> lock(link_stats_mutex_);
+    return link_stats_;
 }
 
 bool Protocol::IsTimeout() const {
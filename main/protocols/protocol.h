@@ -6,6 +6,12 @@
 #include <functional>
 #include <chrono>
 #include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string_view>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 struct AudioStreamPacket {
     int sample_rate = 0;
@@ -30,6 +36,58 @@ struct BinaryProtocol3 {
     uint8_t payload[];
 } __attribute__((packed));
 
+/*
+ * Binary control frame, carried in a BinaryProtocol2 / BinaryProtocol3 frame of type
+ * kBinaryTypeControl once both sides announced the "binary_control" feature in hello.
+ * Only the hot listen / abort / tts / stt / llm messages use it, everything else stays JSON.
+ */
+enum BinaryFrameType {
+    kBinaryTypeAudio = 0,
+    kBinaryTypeJson = 1,
+    kBinaryTypeControl = 2,
+};
+
+enum ControlOpcode : uint8_t {
+    // Device -> server
+    kControlListenStart = 0x01,   // arg: ListeningMode
+    kControlListenStop = 0x02,
+    kControlListenDetect = 0x03,  // text: wake word
+    kControlAbort = 0x04,         // arg: AbortReason
+    // Server -> device
+    kControlTtsStart = 0x81,
+    kControlTtsStop = 0x82,
+    kControlTtsSentence = 0x83,   // text: sentence
+    kControlStt = 0x84,           // text: recognized text
+    kControlLlmEmotion = 0x85,    // text: emotion
+};
+
+struct BinaryControl {
+    uint8_t opcode;
+    uint8_t arg;
+    uint16_t text_size;     // Text size in bytes, network order
+    uint8_t text[];         // UTF-8, not null terminated
+} __attribute__((packed));
+
+/*
+ * A decoded hot control message; text points into the receive buffer and is only
+ * valid during the OnIncomingControl callback
+ */
+struct ControlMessage {
+    ControlOpcode opcode;
+    uint8_t arg = 0;
+    std::string_view text;
+};
+
+struct LinkStats {
+    int rtt_ms = -1;              // Smoothed round trip time, -1 until the first sample
+    int rtt_min_ms = -1;
+    int jitter_ms = 0;            // Downlink audio interarrival jitter (RFC 3550)
+    uint32_t audio_received = 0;
+    uint32_t audio_lost = 0;      // Gaps in the downlink sequence (UDP only)
+    uint32_t probes_sent = 0;
+    uint32_t probes_lost = 0;
+};
+
 enum AbortReason {
     kAbortReasonNone,
     kAbortReasonWakeWordDetected
@@ -57,6 +115,7 @@ public:
 
     void OnIncomingAudio(std::function<void(std::unique_ptr<AudioStreamPacket> packet)> callback);
     void OnIncomingJson(std::function<void(const cJSON* root)> callback);
+    void OnIncomingControl(std::function<void(const ControlMessage& message)> callback);
     void OnAudioChannelOpened(std::function<void()> callback);
     void OnAudioChannelClosed(std::function<void()> callback);
     void OnNetworkError(std::function<void(const std::string& message)> callback);
@@ -64,18 +123,53 @@ public:
     void OnDisconnected(std::function<void()> callback);
 
     virtual bool Start() = 0;
-    virtual bool OpenAudioChannel() = 0;
-    virtual void CloseAudioChannel() = 0;
+    /**
+     * Open the audio channel, joining a pending PreconnectAudioChannel() attempt if any.
+     * The opened callback is raised from here, on the caller's task.
+     */
+    bool OpenAudioChannel();
+    /**
+     * Start opening the audio channel in a background task, so that the connect and
+     * hello round trip overlaps with wake word encoding or a button being held down
+     */
+    void PreconnectAudioChannel();
+    /**
+     * Close the audio channel. With keep_warm the transport and the negotiated session
+     * stay open for CONFIG_AUDIO_CHANNEL_KEEP_WARM_SECONDS, so the next
+     * OpenAudioChannel() can start streaming without a new handshake.
+     */
+    virtual void CloseAudioChannel(bool keep_warm = false) = 0;
     virtual bool IsAudioChannelOpened() const = 0;
+    inline bool IsKeepingWarm() const {
+        return warm_;
+    }
+    /**
+     * Called from the main loop every second to ping or release a warm transport, and to
+     * release a preconnected channel that no OpenAudioChannel() claimed in time
+     */
+    void CheckKeepWarm();
+    /**
+     * Called from the main loop every second. Sends a timestamp-echo ping every
+     * CONFIG_LINK_PROBE_INTERVAL_SECONDS while the channel is open, if the server hello
+     * confirmed the "ping" feature; the interval backs off while pings go unanswered and
+     * is back to normal after the next pong.
+     */
+    void ProbeLink();
+    LinkStats GetLinkStats() const;
     virtual bool SendAudio(std::unique_ptr<AudioStreamPacket> packet) = 0;
     virtual void SendWakeWordDetected(const std::string& wake_word);
     virtual void SendStartListening(ListeningMode mode);
     virtual void SendStopListening();
     virtual void SendAbortSpeaking(AbortReason reason);
-    virtual void SendMcpMessage(const std::string& message);
+    /**
+     * Wrap an MCP payload in the session envelope and send it. The envelope is inserted in
+     * front of the payload in place, so callers that reserve spare capacity avoid a copy.
+     */
+    virtual void SendMcpMessage(std::string payload);
 
 protected:
     std::function<void(const cJSON* root)> on_incoming_json_;
+    std::function<void(const ControlMessage& message)> on_incoming_control_;
     std::function<void(std::unique_ptr<AudioStreamPacket> packet)> on_incoming_audio_;
     std::function<void()> on_audio_channel_opened_;
     std::function<void()> on_audio_channel_closed_;
@@ -85,13 +179,94 @@ protected:
 
     int server_sample_rate_ = 24000;
     int server_frame_duration_ = 60;
-    bool error_occurred_ = false;
+    std::atomic<bool> error_occurred_{false};
     std::string session_id_;
     std::chrono::time_point<std::chrono::steady_clock> last_incoming_time_;
+    std::atomic<bool> warm_{false};
+    // The application was told the channel opened and has not been told it closed
+    std::atomic<bool> channel_announced_{false};
+    // Held by whichever task creates, reuses or releases the transport objects: the
+    // preconnect task for the whole connect, the main task to open, close or ping them
+    std::recursive_mutex transport_mutex_;
+    // Negotiated in hello: both sides support BinaryControl frames. Written on the network
+    // task, read from the main and audio tasks
+    std::atomic<bool> binary_control_{false};
+    // Negotiated in hello: the server answers {"type":"ping"} with a pong, so ProbeLink runs
+    std::atomic<bool> link_probe_{false};
 
+    // Called with transport_mutex_ held
+    virtual bool ConnectAudioChannel() = 0;
+    virtual void ReleaseTransport() = 0;
+    virtual void SendKeepAlive() {}
+    // How long a closed channel is kept warm, CONFIG_AUDIO_CHANNEL_KEEP_WARM_SECONDS by default
+    virtual int KeepWarmSeconds() const;
+    bool EnterKeepWarm();
+    // Raise the closed callback once for each channel the application was told opened
+    void NotifyAudioChannelClosed();
     virtual bool SendText(const std::string& text) = 0;
+    /**
+     * Send a binary control frame, returns false if the transport has no binary
+     * control support so the caller falls back to JSON
+     */
+    virtual bool SendControl(ControlOpcode opcode, uint8_t arg, std::string_view text) { return false; }
+    bool ParseBinaryControl(const uint8_t* data, size_t size);
+    // Set the session and rebuild the message prefix, on the task that parses the hello
+    void SetSessionId(const std::string& session_id);
+    // A copy of `{"session_id":"...",`, SendMcpMessage also runs on the MCP tool workers
+    std::string MessagePrefix() const;
     virtual void SetError(const std::string& message);
     virtual bool IsTimeout() const;
+    /**
+     * A preconnect is running, or has finished and not been claimed by OpenAudioChannel()
+     */
+    bool IsPreconnecting() const;
+    void WaitForPreconnect();
+
+    void RecordRttSample(int rtt_ms);
+    void RecordIncomingAudio(uint32_t timestamp);
+    void RecordAudioLoss(uint32_t lost);
+    void ResetDownlinkStats();
+    void HandleLinkProbeReply(int id);
+    /**
+     * Handle the hot tts / stt / llm / pong text messages straight from the receive buffer
+     * without building a cJSON tree. Returns false if the message must go through cJSON.
+     */
+    bool DispatchTextMessage(const char* data, size_t size);
+
+private:
+    enum PreconnectState {
+        kPreconnectNone,
+        kPreconnectPending,
+        kPreconnectDone,
+    };
+
+    mutable std::mutex preconnect_mutex_;
+    std::condition_variable preconnect_cv_;
+    PreconnectState preconnect_state_ = kPreconnectNone;
+    bool preconnect_result_ = false;
+    // Errors of the preconnect task, reported when OpenAudioChannel() claims the result
+    TaskHandle_t preconnect_task_ = nullptr;
+    std::string preconnect_error_;
+    std::chrono::time_point<std::chrono::steady_clock> preconnect_done_time_;
+    std::chrono::time_point<std::chrono::steady_clock> warm_since_;
+    std::chrono::time_point<std::chrono::steady_clock> last_keep_alive_time_;
+
+    mutable std::mutex link_stats_mutex_;
+    LinkStats link_stats_;
+    float rtt_smoothed_ = 0;
+    float jitter_ = 0;
+    std::chrono::time_point<std::chrono::steady_clock> last_audio_arrival_;
+    uint32_t last_audio_timestamp_ = 0;
+    bool has_last_audio_ = false;
+    uint32_t probe_id_ = 0;
+    bool probe_pending_ = false;
+    bool probe_answered_ = false;
+    int probes_unanswered_ = 0;
+    std::chrono::time_point<std::chrono::steady_clock> probe_sent_time_;
+
+    // Cached `{"session_id":"...",` for the JSON messages, rebuilt by SetSessionId
+    mutable std::mutex message_prefix_mutex_;
+    std::string message_prefix_ = "{\"session_id\":\"\",";
 };
 
 #endif // PROTOCOL_H
@@ -17,6 +17,7 @@ WebsocketProtocol::WebsocketProtocol() {
 }
 
 WebsocketProtocol::~WebsocketProtocol() {
+    WaitForPreconnect();
     vEventGroupDelete(event_group_handle_);
 }
 
@@ -57,6 +58,40 @@ bool WebsocketProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
     }
 }
 
+bool WebsocketProtocol::SendControl(ControlOpcode opcode, uint8_t arg, std::string_view text) {
+    if (websocket_ == nullptr || !websocket_->IsConnected() || version_ < 2) {
+        return false;
+    }
+
+    // Small enough to build on the stack, no heap allocation on the hot path
+    uint8_t frame[sizeof(BinaryProtocol2) + sizeof(BinaryControl) + 64];
+    size_t control_size = sizeof(BinaryControl) + text.size();
+    size_t header_size = version_ == 2 ? sizeof(BinaryProtocol2) : sizeof(BinaryProtocol3);
+    if (header_size + control_size > sizeof(frame)) {
+        return false;
+    }
+
+    if (version_ == 2) {
+        auto bp2 = (BinaryProtocol2*)frame;
+        bp2->version = htons(version_);
+        bp2->type = htons(kBinaryTypeControl);
+        bp2->reserved = 0;
+        bp2->timestamp = 0;
+        bp2->payload_size = htonl(control_size);
+    } else {
+        auto bp3 = (BinaryProtocol3*)frame;
+        bp3->type = kBinaryTypeControl;
+        bp3->reserved = 0;
+        bp3->payload_size = htons(control_size);
+    }
+    auto control = (BinaryControl*)(frame + header_size);
+    control->opcode = opcode;
+    control->arg = arg;
+    control->text_size = htons(text.size());
+    memcpy(control->text, text.data(), text.size());
+    return websocket_->Send(frame, header_size + control_size, true);
+}
+
 bool WebsocketProtocol::SendText(const std::string& text) {
     if (websocket_ == nullptr || !websocket_->IsConnected()) {
         return false;
@@ -72,22 +107,70 @@ bool WebsocketProtocol::SendText(const std::string& text) {
 }
 
 bool WebsocketProtocol::IsAudioChannelOpened() const {
+    if (IsPreconnecting() || warm_) {
+        return false;
+    }
     return websocket_ != nullptr && websocket_->IsConnected() && !error_occurred_ && !IsTimeout();
 }
 
-void WebsocketProtocol::CloseAudioChannel() {
+void WebsocketProtocol::CloseAudioChannel(bool keep_warm) {
+    std::lock_guard<std::recursive_mutex> lock(transport_mutex_);
+    if (keep_warm && websocket_ != nullptr && websocket_->IsConnected() && EnterKeepWarm()) {
+        // The server keeps the session, just tell it we stopped talking
+        SendStopListening();
+        NotifyAudioChannelClosed();
+        return;
+    }
+    warm_ = false;
+    ReleaseTransport();
+}
+
+void WebsocketProtocol::ReleaseTransport() {
     websocket_.reset();
+    // Reload on the next connect, OTA check or activation may have changed the url or token
+    settings_loaded_ = false;
+}
+
+void WebsocketProtocol::SendKeepAlive() {
+    if (websocket_ != nullptr && websocket_->IsConnected()) {
+        websocket_->Ping();
+    }
 }
 
-bool WebsocketProtocol::OpenAudioChannel() {
+void WebsocketProtocol::LoadSettings() {
+    if (settings_loaded_) {
+        return;
+    }
     Settings settings("websocket", false);
-    std::string url = settings.GetString("url");
-    std::string token = settings.GetString("token");
+    url_ = settings.GetString("url");
+    authorization_ = settings.GetString("token");
     int version = settings.GetInt("version");
     if (version != 0) {
         version_ = version;
     }
+    // If token not has a space, add "Bearer " prefix
+    if (!authorization_.empty() && authorization_.find(" ") == std::string::npos) {
+        authorization_ = "Bearer " + authorization_;
+    }
+    device_id_ = SystemInfo::GetMacAddress();
+    client_id_ = Board::GetInstance().GetUuid();
+    hello_message_ = GetHelloMessage();
+    settings_loaded_ = true;
+}
+
+bool WebsocketProtocol::ConnectAudioChannel() {
+    // Reuse the transport kept warm by the previous conversation, no handshake needed
+    if (warm_.exchange(false)) {
+        if (websocket_ != nullptr && websocket_->IsConnected() && !error_occurred_) {
+            ESP_LOGI(TAG, "Reusing warm websocket, session: %s", session_id_.c_str());
+            last_incoming_time_ = std::chrono::steady_clock::now();
+            ResetDownlinkStats();
+            return true;
+        }
+        ReleaseTransport();
+    }
 
+    LoadSettings();
     error_occurred_ = false;
 
     auto network = Board::GetInstance().GetNetwork();
@@ -97,54 +180,58 @@ bool WebsocketProtocol::OpenAudioChannel() {
         return false;
     }
 
-    if (!token.empty()) {
-        // If token not has a space, add "Bearer " prefix
-        if (token.find(" ") == std::string::npos) {
-            token = "Bearer " + token;
-        }
-        websocket_->SetHeader("Authorization", token.c_str());
+    if (!authorization_.empty()) {
+        websocket_->SetHeader("Authorization", authorization_.c_str());
     }
     websocket_->SetHeader("Protocol-Version", std::to_string(version_).c_str());
-    websocket_->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
-    websocket_->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
+    websocket_->SetHeader("Device-Id", device_id_.c_str());
+    websocket_->SetHeader("Client-Id", client_id_.c_str());
 
     websocket_->OnData([this](const char* data, size_t len, bool binary) {
         if (binary) {
-            if (on_incoming_audio_ != nullptr) {
-                if (version_ == 2) {
-                    BinaryProtocol2* bp2 = (BinaryProtocol2*)data;
-                    bp2->version = ntohs(bp2->version);
-                    bp2->type = ntohs(bp2->type);
-                    bp2->timestamp = ntohl(bp2->timestamp);
-                    bp2->payload_size = ntohl(bp2->payload_size);
-                    auto payload = (uint8_t*)bp2->payload;
+            if (version_ == 2) {
+                BinaryProtocol2* bp2 = (BinaryProtocol2*)data;
+                bp2->version = ntohs(bp2->version);
+                bp2->type = ntohs(bp2->type);
+                bp2->timestamp = ntohl(bp2->timestamp);
+                bp2->payload_size = ntohl(bp2->payload_size);
+                auto payload = (uint8_t*)bp2->payload;
+                if (bp2->type == kBinaryTypeControl) {
+                    ParseBinaryControl(payload, bp2->payload_size);
+                } else if (on_incoming_audio_ != nullptr) {
+                    RecordIncomingAudio(bp2->timestamp);
                     on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{
                         .sample_rate = server_sample_rate_,
                         .frame_duration = server_frame_duration_,
                         .timestamp = bp2->timestamp,
                         .payload = std::vector<uint8_t>(payload, payload + bp2->payload_size)
                     }));
-                } else if (version_ == 3) {
-                    BinaryProtocol3* bp3 = (BinaryProtocol3*)data;
-                    bp3->type = bp3->type;
-                    bp3->payload_size = ntohs(bp3->payload_size);
-                    auto payload = (uint8_t*)bp3->payload;
+                }
+            } else if (version_ == 3) {
+                BinaryProtocol3* bp3 = (BinaryProtocol3*)data;
+                bp3->payload_size = ntohs(bp3->payload_size);
+                auto payload = (uint8_t*)bp3->payload;
+                if (bp3->type == kBinaryTypeControl) {
+                    ParseBinaryControl(payload, bp3->payload_size);
+                } else if (on_incoming_audio_ != nullptr) {
+                    RecordIncomingAudio(0);
                     on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{
                         .sample_rate = server_sample_rate_,
                         .frame_duration = server_frame_duration_,
                         .timestamp = 0,
                         .payload = std::vector<uint8_t>(payload, payload + bp3->payload_size)
                     }));
-                } else {
-                    on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{
-                        .sample_rate = server_sample_rate_,
-                        .frame_duration = server_frame_duration_,
-                        .timestamp = 0,
-                        .payload = std::vector<uint8_t>((uint8_t*)data, (uint8_t*)data + len)
-                    }));
                 }
+            } else if (on_incoming_audio_ != nullptr) {
+                RecordIncomingAudio(0);
+                on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{
+                    .sample_rate = server_sample_rate_,
+                    .frame_duration = server_frame_duration_,
+                    .timestamp = 0,
+                    .payload = std::vector<uint8_t>((uint8_t*)data, (uint8_t*)data + len)
+                }));
             }
-        } else {
+        } else if (!DispatchTextMessage(data, len)) {
             // Parse JSON data
             auto root = cJSON_Parse(data);
             auto type = cJSON_GetObjectItem(root, "type");
@@ -166,21 +253,20 @@ bool WebsocketProtocol::OpenAudioChannel() {
 
     websocket_->OnDisconnected([this]() {
         ESP_LOGI(TAG, "Websocket disconnected");
-        if (on_audio_channel_closed_ != nullptr) {
-            on_audio_channel_closed_();
-        }
+        // A warm or unclaimed channel was not announced, so this raises nothing for it
+        warm_ = false;
+        NotifyAudioChannelClosed();
     });
 
-    ESP_LOGI(TAG, "Connecting to websocket server: %s with version: %d", url.c_str(), version_);
-    if (!websocket_->Connect(url.c_str())) {
+    ESP_LOGI(TAG, "Connecting to websocket server: %s with version: %d", url_.c_str(), version_);
+    if (!websocket_->Connect(url_.c_str())) {
         ESP_LOGE(TAG, "Failed to connect to websocket server, code=%d", websocket_->GetLastError());
         SetError(Lang::Strings::SERVER_NOT_CONNECTED);
         return false;
     }
 
     // Send hello message to describe the client
-    auto message = GetHelloMessage();
-    if (!SendText(message)) {
+    if (!SendText(hello_message_)) {
         return false;
     }
 
@@ -191,11 +277,7 @@ bool WebsocketProtocol::OpenAudioChannel() {
         SetError(Lang::Strings::SERVER_TIMEOUT);
         return false;
     }
-
-    if (on_audio_channel_opened_ != nullptr) {
-        on_audio_channel_opened_();
-    }
-
+    ResetDownlinkStats();
     return true;
 }
 
@@ -209,6 +291,13 @@ std::string WebsocketProtocol::GetHelloMessage() {
     cJSON_AddBoolToObject(features, "aec", true);
 #endif
     cJSON_AddBoolToObject(features, "mcp", true);
+    // Control frames need the type field of BinaryProtocol2 / BinaryProtocol3
+    if (version_ >= 2) {
+        cJSON_AddBoolToObject(features, "binary_control", true);
+    }
+#if CONFIG_LINK_PROBE_INTERVAL_SECONDS > 0
+    cJSON_AddBoolToObject(features, "ping", true);
+#endif
     cJSON_AddItemToObject(root, "features", features);
     cJSON_AddStringToObject(root, "transport", "websocket");
     cJSON* audio_params = cJSON_CreateObject();
@@ -233,10 +322,18 @@ void WebsocketProtocol::ParseServerHello(const cJSON* root) {
 
     auto session_id = cJSON_GetObjectItem(root, "session_id");
     if (cJSON_IsString(session_id)) {
-        session_id_ = session_id->valuestring;
+        SetSessionId(session_id->valuestring);
         ESP_LOGI(TAG, "Session ID: %s", session_id_.c_str());
     }
 
+    // Old servers don't echo features, they keep getting JSON control messages
+    auto features = cJSON_GetObjectItem(root, "features");
+    binary_control_ = version_ >= 2 && cJSON_IsTrue(cJSON_GetObjectItem(features, "binary_control"));
+    if (binary_control_) {
+        ESP_LOGI(TAG, "Binary control frames enabled");
+    }
+    link_probe_ = cJSON_IsTrue(cJSON_GetObjectItem(features, "ping"));
+
     auto audio_params = cJSON_GetObjectItem(root, "audio_params");
     if (cJSON_IsObject(audio_params)) {
         auto sample_rate = cJSON_GetObjectItem(audio_params, "sample_rate");
@@ -17,8 +17,7 @@ public:
 
     bool Start() override;
     bool SendAudio(std::unique_ptr<AudioStreamPacket> packet) override;
-    bool OpenAudioChannel() override;
-    void CloseAudioChannel() override;
+    void CloseAudioChannel(bool keep_warm = false) override;
     bool IsAudioChannelOpened() const override;
 
 private:
@@ -26,8 +25,22 @@ private:
     std::unique_ptr<WebSocket> websocket_;
     int version_ = 1;
 
+    // Loaded from Settings on the first connect after the channel was fully closed
+    bool settings_loaded_ = false;
+    std::string url_;
+    std::string authorization_;
+    std::string device_id_;
+    std::string client_id_;
+    std::string hello_message_;
+
+    void LoadSettings();
+
     void ParseServerHello(const cJSON* root);
+    bool ConnectAudioChannel() override;
+    void ReleaseTransport() override;
+    void SendKeepAlive() override;
     bool SendText(const std::string& text) override;
+    bool SendControl(ControlOpcode opcode, uint8_t arg, std::string_view text) override;
     std::string GetHelloMessage();
 };
 
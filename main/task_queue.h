@@ -0,0 +1,207 @@
+#ifndef TASK_QUEUE_H
+#define TASK_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * TaskQueue - Bounded multi-producer, single-consumer queue of callables
+ *
+ * Callables are constructed in place inside a fixed ring of cells (Vyukov bounded queue),
+ * so pushing a lambda whose captures fit in StorageSize takes no lock and no heap.
+ * Anything that does not fit (oversized captures, or a full ring) falls back to a
+ * mutex-protected std::function deque and is counted, so tasks are never dropped.
+ * Fallback tasks remember the ring position they were pushed at, and the consumer merges
+ * the two by it, so tasks run in the order they were pushed.
+ */
+template <size_t Capacity, size_t StorageSize>
+class TaskQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+    struct Stats {
+        uint32_t pushed;
+        uint32_t overflow_full;      // Ring was full, task went to the fallback deque
+        uint32_t overflow_oversize;  // Captures larger than StorageSize
+    };
+
+    TaskQueue() {
+        for (size_t i = 0; i < Capacity; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~TaskQueue() {
+        // Destroy tasks that were never run
+        while (dequeue_pos_ != enqueue_pos_.load(std::memory_order_acquire)) {
+            Cell& cell = cells_[dequeue_pos_ & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+                break;
+            }
+            cell.destroy(cell.storage);
+            dequeue_pos_++;
+        }
+    }
+
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    /**
+     * Push a callable from any task
+     */
+    template <typename F>
+    void Push(F&& task) {
+        using T = std::decay_t<F>;
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        if constexpr (sizeof(T) <= StorageSize && alignof(T) <= alignof(std::max_align_t)) {
+            if (TryPush<T>(std::forward<F>(task))) {
+                return;
+            }
+            overflow_full_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            overflow_oversize_.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        // Every ring task claimed before this point runs first
+        overflow_.push_back({enqueue_pos_.load(std::memory_order_acquire), std::function<void()>(std::forward<F>(task))});
+        overflow_pending_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Run the tasks queued before this call, from the consumer task only, in the order
+     * they were pushed. Tasks pushed while running, to the ring or the fallback deque,
+     * are left for the next call.
+     * after_each() is called after every task, so the caller can time tasks or
+     * service more urgent work in between.
+     * Returns the number of tasks run.
+     */
+    template <typename AfterEach>
+    size_t RunPending(AfterEach&& after_each) {
+        // Take the fallback tasks before the ring end, so all of them sit at or before it.
+        // The two deques are swapped rather than moved, so no deque is allocated per call.
+        auto& tasks = overflow_running_;
+        if (overflow_pending_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(overflow_mutex_);
+            tasks.swap(overflow_);
+            overflow_pending_.store(false, std::memory_order_release);
+        }
+
+        size_t count = 0;
+        size_t end = enqueue_pos_.load(std::memory_order_acquire);
+        while (true) {
+            // Fallback tasks pushed before the next ring task go first
+            while (!tasks.empty() && (intptr_t)(tasks.front().ring_pos - dequeue_pos_) <= 0) {
+                auto task = std::move(tasks.front().task);
+                tasks.pop_front();
+                task();
+                count++;
+                after_each();
+            }
+            if (dequeue_pos_ == end) {
+                break;
+            }
+
+            Cell& cell = cells_[dequeue_pos_ & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+                // A producer has claimed this cell but not finished writing it; it will
+                // signal again once it has. Later fallback tasks must wait behind it.
+                if (!tasks.empty()) {
+                    std::lock_guard<std::mutex> lock(overflow_mutex_);
+                    overflow_.insert(overflow_.begin(), std::make_move_iterator(tasks.begin()),
+                        std::make_move_iterator(tasks.end()));
+                    overflow_pending_.store(true, std::memory_order_release);
+                    tasks.clear();
+                }
+                return count;
+            }
+            // Run in place; the cell is not handed back to producers until the task is done
+            cell.run(cell.storage);
+            cell.sequence.store(dequeue_pos_ + Capacity, std::memory_order_release);
+            dequeue_pos_++;
+            count++;
+            after_each();
+        }
+        return count;
+    }
+
+    size_t RunPending() {
+        return RunPending([]() {});
+    }
+
+    Stats GetStats() const {
+        return Stats{
+            pushed_.load(std::memory_order_relaxed),
+            overflow_full_.load(std::memory_order_relaxed),
+            overflow_oversize_.load(std::memory_order_relaxed),
+        };
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        void (*run)(void* storage);      // Invoke, then destroy
+        void (*destroy)(void* storage);
+        alignas(std::max_align_t) unsigned char storage[StorageSize];
+    };
+
+    template <typename T, typename F>
+    bool TryPush(F&& task) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & (Capacity - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage) T(std::forward<F>(task));
+        cell->run = [](void* storage) {
+            T* callable = std::launder(reinterpret_cast<T*>(storage));
+            (*callable)();
+            callable->~T();
+        };
+        cell->destroy = [](void* storage) {
+            std::launder(reinterpret_cast<T*>(storage))->~T();
+        };
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    Cell cells_[Capacity];
+    std::atomic<size_t> enqueue_pos_{0};
+    size_t dequeue_pos_ = 0;
+
+    struct OverflowTask {
+        size_t ring_pos;    // enqueue_pos_ when the task was pushed
+        std::function<void()> task;
+    };
+
+    std::mutex overflow_mutex_;
+    std::deque<OverflowTask> overflow_;
+    std::atomic<bool> overflow_pending_{false};
+    // Fallback tasks taken by the current RunPending, consumer only
+    std::deque<OverflowTask> overflow_running_;
+
+    std::atomic<uint32_t> pushed_{0};
+    std::atomic<uint32_t> overflow_full_{0};
+    std::atomic<uint32_t> overflow_oversize_{0};
+};
+
+#endif // TASK_QUEUE_H
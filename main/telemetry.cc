@@ -0,0 +1,104 @@
+#include "telemetry.h"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+void TelemetrySampler::Sample(TelemetrySnapshot& snapshot) {
+    snapshot.uptime_ms = esp_timer_get_time() / 1000;
+    snapshot.free_sram = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    snapshot.min_free_sram = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    snapshot.largest_sram_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    snapshot.free_psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    snapshot.min_free_psram = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+
+    snapshot.task_count = 0;
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    configRUN_TIME_COUNTER_TYPE total;
+    // Returns 0 if there are more tasks than TELEMETRY_MAX_TASKS
+    int count = uxTaskGetSystemState(status_, TELEMETRY_MAX_TASKS, &total);
+    uint64_t elapsed = (configRUN_TIME_COUNTER_TYPE)(total - previous_total_) * (uint64_t)CONFIG_FREERTOS_NUMBER_OF_CORES;
+
+    for (int i = 0; i < count; i++) {
+        auto& status = status_[i];
+        auto& task = snapshot.tasks[i];
+        snprintf(task.name, sizeof(task.name), "%s", status.pcTaskName);
+        task.stack_free = status.usStackHighWaterMark;
+        task.cpu_permille = 0;
+        if (previous_total_ == 0 || elapsed == 0) {
+            continue;
+        }
+        for (int j = 0; j < previous_count_; j++) {
+            if (previous_[j].handle == status.xHandle) {
+                configRUN_TIME_COUNTER_TYPE run = status.ulRunTimeCounter - previous_[j].run_time;
+                task.cpu_permille = run * 1000ULL / elapsed;
+                break;
+            }
+        }
+    }
+    snapshot.task_count = count;
+
+    for (int i = 0; i < count; i++) {
+        previous_[i] = TaskRunTime{status_[i].xHandle, status_[i].ulRunTimeCounter};
+    }
+    previous_count_ = count;
+    previous_total_ = total;
+#endif
+}
+
+namespace {
+
+// Appends to a fixed buffer; once it runs out every further Append is ignored
+class EventWriter {
+public:
+    EventWriter(char* buffer, size_t size) : buffer_(buffer), size_(size) {}
+
+    void Append(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (length_ >= size_) {
+            return;
+        }
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buffer_ + length_, size_ - length_, format, args);
+        va_end(args);
+        length_ = n < 0 ? size_ : length_ + n;
+    }
+
+    size_t Finish() { return length_ < size_ ? length_ : 0; }
+
+private:
+    char* buffer_;
+    size_t size_;
+    size_t length_ = 0;
+};
+
+} // namespace
+
+size_t FormatTelemetryEvent(const TelemetrySnapshot& s, char* buffer, size_t size) {
+    EventWriter out(buffer, size);
+    out.Append("data: {\"seq\":%" PRIu32 ",\"uptime_ms\":%" PRId64, s.sequence, s.uptime_ms);
+    out.Append(",\"heap\":{\"sram\":%" PRIu32 ",\"sram_min\":%" PRIu32 ",\"sram_largest\":%" PRIu32
+               ",\"psram\":%" PRIu32 ",\"psram_min\":%" PRIu32 "}",
+               s.free_sram, s.min_free_sram, s.largest_sram_block, s.free_psram, s.min_free_psram);
+    out.Append(",\"audio_queues\":{\"decode\":%u,\"send\":%u,\"encode\":%u,\"playback\":%u}",
+               s.decode_queue, s.send_queue, s.encode_queue, s.playback_queue);
+
+    out.Append(",\"handler_max_us\":{");
+    for (int i = 0; i < kMainHandlerCount; i++) {
+        out.Append("%s\"%s\":%" PRId32, i == 0 ? "" : ",", MainLoopStats::HandlerName((MainLoopHandler)i), s.handler_max_us[i]);
+    }
+    out.Append("},\"link\":{\"rtt_ms\":%d,\"jitter_ms\":%d,\"audio_lost\":%" PRIu32 "}",
+               s.rtt_ms, s.jitter_ms, s.audio_lost);
+
+    out.Append(",\"tasks\":[");
+    for (int i = 0; i < s.task_count; i++) {
+        auto& task = s.tasks[i];
+        out.Append("%s{\"name\":\"%s\",\"cpu_permille\":%u,\"stack_free\":%u}",
+                   i == 0 ? "" : ",", task.name, task.cpu_permille, task.stack_free);
+    }
+    out.Append("]}\n\n");
+    return out.Finish();
+}
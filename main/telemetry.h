@@ -0,0 +1,80 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "main_loop_stats.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#define TELEMETRY_MAX_TASKS 32
+
+struct TelemetryTask {
+    char name[configMAX_TASK_NAME_LEN];
+    uint16_t cpu_permille;          // Share of all cores since the previous sample
+    uint16_t stack_free;            // Bytes, lowest ever
+};
+
+/**
+ * TelemetrySnapshot - One sample of the device's internals, pushed to /api/telemetry
+ *
+ * Fixed size: it is filled in place and formatted once per interval, however many
+ * observers are connected.
+ */
+struct TelemetrySnapshot {
+    uint32_t sequence;
+    int64_t uptime_ms;
+
+    uint32_t free_sram;
+    uint32_t min_free_sram;
+    uint32_t largest_sram_block;
+    uint32_t free_psram;            // 0 without PSRAM
+    uint32_t min_free_psram;
+
+    uint16_t decode_queue;          // Audio packets / tasks waiting in each AudioService queue
+    uint16_t send_queue;
+    uint16_t encode_queue;
+    uint16_t playback_queue;
+
+    int32_t handler_max_us[kMainHandlerCount];  // Longest run of each main loop handler since the previous sample
+
+    int16_t rtt_ms;                 // -1 without a measurement
+    int16_t jitter_ms;
+    uint32_t audio_lost;
+
+    uint8_t task_count;
+    TelemetryTask tasks[TELEMETRY_MAX_TASKS];
+};
+
+/**
+ * TelemetrySampler - Fills the system part of a snapshot (heap, per-task CPU)
+ *
+ * CPU usage is the difference of the FreeRTOS run time counters between two calls, kept
+ * in fixed arrays, so sampling does not allocate.
+ */
+class TelemetrySampler {
+public:
+    void Sample(TelemetrySnapshot& snapshot);
+
+private:
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    struct TaskRunTime {
+        TaskHandle_t handle;
+        configRUN_TIME_COUNTER_TYPE run_time;
+    };
+    TaskStatus_t status_[TELEMETRY_MAX_TASKS];
+    TaskRunTime previous_[TELEMETRY_MAX_TASKS];
+    int previous_count_ = 0;
+    configRUN_TIME_COUNTER_TYPE previous_total_ = 0;
+#endif
+};
+
+/**
+ * Format a snapshot as one Server-Sent Events message ("data: {json}\n\n").
+ * Returns the length, or 0 if the buffer is too small.
+ */
+size_t FormatTelemetryEvent(const TelemetrySnapshot& snapshot, char* buffer, size_t size);
+
+#endif // TELEMETRY_H
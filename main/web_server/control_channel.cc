@@ -0,0 +1,121 @@
+#include "control_channel.h"
+
+#include <esp_log.h>
+
+static const char* TAG = "ControlChannel";
+
+// A moving joystick that sends nothing for this long is treated as lost
+#define WS_CONTROL_TIMEOUT_MS 1000
+
+ControlChannel::ControlChannel(int tick_ms, MotorCallback motor, AckCallback ack)
+    : motor_(std::move(motor)), ack_(std::move(ack)), tick_ms_(tick_ms) {
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* arg) {
+            static_cast<ControlChannel*>(arg)->OnTimer();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ws_control",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&timer_args, &timer_);
+}
+
+ControlChannel::~ControlChannel() {
+    esp_timer_stop(timer_);
+    esp_timer_delete(timer_);
+}
+
+void ControlChannel::OnFrame(int fd, const uint8_t* data, size_t len) {
+    if (len < 4) {
+        return;
+    }
+    Command command{(uint16_t)(data[0] | (data[1] << 8)), data[2], data[3]};
+    if (command.direction == 0) {
+        command.speed = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    fd_ = fd;
+    stats_.frames++;
+    last_frame_us_ = esp_timer_get_time();
+
+    if (command.speed == 0) {
+        // Stops never wait for the tick
+        has_pending_ = false;
+        ApplyLocked(command);
+        return;
+    }
+
+    pending_ = command;
+    has_pending_ = true;
+    if (!flush_scheduled_) {
+        flush_scheduled_ = true;
+        int64_t delay_us = last_apply_us_ + tick_ms_ * 1000LL - last_frame_us_;
+        esp_timer_stop(timer_);
+        esp_timer_start_once(timer_, delay_us > 0 ? delay_us : 0);
+    }
+}
+
+void ControlChannel::OnClose(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd != fd_) {
+        return;
+    }
+    ESP_LOGI(TAG, "Joystick channel closed: %lu frames, %lu applied",
+             (unsigned long)stats_.frames, (unsigned long)stats_.applied);
+    fd_ = -1;
+    has_pending_ = false;
+    if (applied_.speed != 0) {
+        ApplyLocked(Command{applied_.sequence, 0, 0});
+    }
+}
+
+void ControlChannel::OnTimer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_scheduled_ = false;
+    if (has_pending_) {
+        has_pending_ = false;
+        ApplyLocked(pending_);
+    } else if (applied_.speed != 0 && esp_timer_get_time() - last_frame_us_ >= WS_CONTROL_TIMEOUT_MS * 1000LL) {
+        ESP_LOGW(TAG, "Joystick channel silent for %dms, stopping", WS_CONTROL_TIMEOUT_MS);
+        ApplyLocked(Command{applied_.sequence, 0, 0});
+        return;
+    }
+
+    if (applied_.speed != 0) {
+        // Deadman check
+        int64_t delay_us = last_frame_us_ + WS_CONTROL_TIMEOUT_MS * 1000LL - esp_timer_get_time();
+        esp_timer_start_once(timer_, delay_us > 0 ? delay_us : 0);
+    }
+}
+
+void ControlChannel::ApplyLocked(const Command& command) {
+    // Identical moves (heartbeats) are only acknowledged
+    if (command.direction != applied_.direction || command.speed != applied_.speed) {
+        motor_(command.direction, command.speed);
+        stats_.applied++;
+    }
+    applied_ = command;
+    last_apply_us_ = esp_timer_get_time();
+    if (command.speed == 0 && !flush_scheduled_) {
+        esp_timer_stop(timer_);
+    }
+    if (fd_ >= 0) {
+        ack_();
+    }
+}
+
+int ControlChannel::GetAck(uint8_t payload[4]) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    payload[0] = applied_.sequence & 0xFF;
+    payload[1] = applied_.sequence >> 8;
+    payload[2] = applied_.direction;
+    payload[3] = applied_.speed;
+    return fd_;
+}
+
+ControlChannel::Stats ControlChannel::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
@@ -0,0 +1,80 @@
+#ifndef CONTROL_CHANNEL_H
+#define CONTROL_CHANNEL_H
+
+#include <esp_timer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+/**
+ * ControlChannel - Command handling of the realtime joystick channel (/ws/control)
+ *
+ * The page sends 4-byte binary frames {seq_lo, seq_hi, direction, speed}. Moves are
+ * coalesced: at most one per control tick reaches the motor callback, always the latest.
+ * Stops are applied at once. Every applied command is acknowledged with a frame of the
+ * same layout, carrying the sequence of the newest frame it includes. If a moving
+ * joystick goes silent for WS_CONTROL_TIMEOUT_MS, the motors are stopped.
+ *
+ * The channel knows nothing about the transport: WebServer feeds it frames and socket
+ * closes, and sends the acks it asks for.
+ */
+class ControlChannel {
+public:
+    using MotorCallback = std::function<void(int direction, int speed)>;
+    // Called with the channel lock held, from the frame's task or the esp_timer task;
+    // it should only queue the send and fetch the ack with GetAck() later
+    using AckCallback = std::function<void()>;
+
+    struct Stats {
+        uint32_t frames;
+        uint32_t applied;       // Commands that changed what the motors do
+    };
+
+    ControlChannel(int tick_ms, MotorCallback motor, AckCallback ack);
+    ~ControlChannel();
+
+    ControlChannel(const ControlChannel&) = delete;
+    ControlChannel& operator=(const ControlChannel&) = delete;
+
+    void OnFrame(int fd, const uint8_t* data, size_t len);
+    /**
+     * The socket closed; stops the motors if it was the joystick channel
+     */
+    void OnClose(int fd);
+
+    /**
+     * Fill payload with the ack for the latest applied command
+     * @return socket to send it to, or -1 if the channel is closed
+     */
+    int GetAck(uint8_t payload[4]);
+
+    Stats GetStats();
+
+private:
+    struct Command {
+        uint16_t sequence;
+        uint8_t direction;
+        uint8_t speed;
+    };
+
+    MotorCallback motor_;
+    AckCallback ack_;
+    int tick_ms_;
+    std::mutex mutex_;
+    esp_timer_handle_t timer_ = nullptr;
+    int fd_ = -1;
+    Command pending_{};
+    Command applied_{};
+    bool has_pending_ = false;
+    bool flush_scheduled_ = false;
+    int64_t last_apply_us_ = 0;
+    int64_t last_frame_us_ = 0;
+    Stats stats_{};
+
+    void OnTimer();
+    void ApplyLocked(const Command& command);
+};
+
+#endif // CONTROL_CHANNEL_H
@@ -1,11 +1,19 @@
 #include "web_server.h"
+#include "web_pages.h"
+#include "telemetry.h"
+#include "audio_tap.h"
+#include "screen_streamer.h"
+#include "control_channel.h"
 #include <esp_log.h>
 #include <cstring>
+#include <algorithm>
 #include <cJSON.h>
 #include <esp_system.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
 
 // Forward declarations for motor control functions
 extern "C" void HandleMotorActionForApplication(int direction, int speed, int duration_ms, int priority);
@@ -14,12 +22,28 @@ extern "C" void HandleMotorActionForDance(uint8_t speed_percent);
 
 static const char *TAG = "WebServer";
 
+#define TELEMETRY_MIN_INTERVAL_MS 100
+#define TELEMETRY_MAX_INTERVAL_MS 60000
+
+#define SCREEN_DEFAULT_FPS 5
+#define SCREEN_MAX_FPS 15
+#define SCREEN_DEFAULT_QUALITY 60
+
+struct WebServer::TelemetryChannel {
+    TelemetrySnapshot snapshot;
+    char event[3072];
+};
+
 WebServer::WebServer()
-    : server_handle_(nullptr) {
+    : server_handle_(nullptr), telemetry_interval_ms_(CONFIG_TELEMETRY_INTERVAL_MS) {
 }
 
 WebServer::~WebServer() {
     Stop();
+    if (telemetry_timer_ != nullptr) {
+        esp_timer_stop(telemetry_timer_);
+        esp_timer_delete(telemetry_timer_);
+    }
 }
 
 bool WebServer::Start(int port) {
@@ -27,11 +51,46 @@ bool WebServer::Start(int port) {
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = port;
-    config.max_uri_handlers = 10;
+    config.max_uri_handlers = 17;
     // 增加超时设置以更好地处理频繁请求
     config.recv_wait_timeout = 5;  // 接收超时5秒
     config.send_wait_timeout = 5;  // 发送超时5秒
     config.max_resp_headers = 8;   // 减少响应头数量
+    // 连接关闭时移除遥测订阅、停止音频监听和屏幕镜像、摇杆通道停车；global_user_ctx 不归 httpd 释放
+    config.global_user_ctx = this;
+    config.global_user_ctx_free_fn = [](void*) {};
+    config.close_fn = close_socket_handler;
+
+    if (telemetry_timer_ == nullptr) {
+        esp_timer_create_args_t timer_args = {
+            .callback = [](void* arg) {
+                auto server = static_cast<WebServer*>(arg);
+                // Skip the tick if the previous push has not run yet
+                if (!server->telemetry_push_queued_.exchange(true)) {
+                    if (httpd_queue_work(server->server_handle_, push_telemetry, server) != ESP_OK) {
+                        server->telemetry_push_queued_ = false;
+                    }
+                }
+            },
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "telemetry",
+            .skip_unhandled_events = true,
+        };
+        esp_timer_create(&timer_args, &telemetry_timer_);
+    }
+
+#if CONFIG_HTTPD_WS_SUPPORT
+    if (!control_) {
+        control_ = std::make_unique<ControlChannel>(control_tick_ms_,
+            [this](int direction, int speed) {
+                InvokeMotorControl(direction, speed);
+            },
+            [this]() {
+                httpd_queue_work(server_handle_, send_control_ack, this);
+            });
+    }
+#endif
 
     if (httpd_start(&server_handle_, &config) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start HTTP server");
@@ -63,6 +122,17 @@ bool WebServer::Start(int port) {
     };
     httpd_register_uri_handler(server_handle_, &api_control_uri);
 
+#if CONFIG_HTTPD_WS_SUPPORT
+    httpd_uri_t ws_control_uri = {
+        .uri       = "/ws/control",
+        .method    = HTTP_GET,
+        .handler   = ws_control_handler,
+        .user_ctx  = this,
+        .is_websocket = true
+    };
+    httpd_register_uri_handler(server_handle_, &ws_control_uri);
+#endif
+
     httpd_uri_t api_motor_action_uri = {
         .uri       = "/api/motor/action",
         .method    = HTTP_POST,
@@ -79,6 +149,54 @@ bool WebServer::Start(int port) {
     };
     httpd_register_uri_handler(server_handle_, &debug_uri);
 
+    httpd_uri_t main_loop_stats_uri = {
+        .uri       = "/api/debug/main_loop",
+        .method    = HTTP_GET,
+        .handler   = api_main_loop_stats_handler,
+        .user_ctx  = this
+    };
+    httpd_register_uri_handler(server_handle_, &main_loop_stats_uri);
+
+    httpd_uri_t web_timing_uri = {
+        .uri       = "/api/web_timing",
+        .method    = HTTP_POST,
+        .handler   = web_timing_post_handler,
+        .user_ctx  = this
+    };
+    httpd_register_uri_handler(server_handle_, &web_timing_uri);
+
+    httpd_uri_t telemetry_uri = {
+        .uri       = "/api/telemetry",
+        .method    = HTTP_GET,
+        .handler   = telemetry_get_handler,
+        .user_ctx  = this
+    };
+    httpd_register_uri_handler(server_handle_, &telemetry_uri);
+
+    httpd_uri_t audio_page_uri = {
+        .uri       = "/audio",
+        .method    = HTTP_GET,
+        .handler   = audio_page_get_handler,
+        .user_ctx  = this
+    };
+    httpd_register_uri_handler(server_handle_, &audio_page_uri);
+
+    httpd_uri_t audio_tap_uri = {
+        .uri       = "/audio_tap",
+        .method    = HTTP_GET,
+        .handler   = audio_tap_get_handler,
+        .user_ctx  = this
+    };
+    httpd_register_uri_handler(server_handle_, &audio_tap_uri);
+
+    httpd_uri_t screen_uri = {
+        .uri       = "/screen",
+        .method    = HTTP_GET,
+        .handler   = screen_get_handler,
+        .user_ctx  = this
+    };
+    httpd_register_uri_handler(server_handle_, &screen_uri);
+
     // 注册配置页面处理器
     httpd_uri_t config_uri = {
         .uri       = "/config",
@@ -120,6 +238,9 @@ void WebServer::Stop() {
     if (server_handle_) {
         httpd_stop(server_handle_);
         server_handle_ = nullptr;
+        if (telemetry_timer_ != nullptr) {
+            esp_timer_stop(telemetry_timer_);
+        }
         ESP_LOGI(TAG, "Web server stopped");
     }
 }
@@ -150,6 +271,349 @@ void WebServer::SetEmotion(const char* emotion) {
     }
 }
 
+void WebServer::SetMainLoopStatsCallback(std::function<std::string()> callback) {
+    main_loop_stats_callback_ = callback;
+}
+
+esp_err_t WebServer::api_main_loop_stats_handler(httpd_req_t *req) {
+    WebServer* server = (WebServer*)req->user_ctx;
+
+    // 设置CORS头
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (!server->main_loop_stats_callback_) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Main loop stats callback not set");
+        return ESP_OK;
+    }
+    std::string json = server->main_loop_stats_callback_();
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json.c_str(), json.size());
+    return ESP_OK;
+}
+
+void WebServer::SetTelemetryCallback(std::function<void(TelemetrySnapshot& snapshot)> callback) {
+    telemetry_callback_ = callback;
+}
+
+// GET /api/telemetry[?interval_ms=N]：响应头发出后连接保持打开，之后由 PushTelemetry 写入事件
+esp_err_t WebServer::telemetry_get_handler(httpd_req_t *req) {
+    WebServer* server = (WebServer*)req->user_ctx;
+
+    if (!server->telemetry_callback_) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Telemetry callback not set");
+        return ESP_OK;
+    }
+    if (server->telemetry_observers_ >= kMaxTelemetryObservers) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "Too many telemetry observers", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    // 周期对所有订阅者共享，以最后一次请求为准
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "interval_ms", value, sizeof(value)) == ESP_OK) {
+        int interval_ms = atoi(value);
+        if (interval_ms < TELEMETRY_MIN_INTERVAL_MS) {
+            interval_ms = TELEMETRY_MIN_INTERVAL_MS;
+        } else if (interval_ms > TELEMETRY_MAX_INTERVAL_MS) {
+            interval_ms = TELEMETRY_MAX_INTERVAL_MS;
+        }
+        server->telemetry_interval_ms_ = interval_ms;
+    }
+
+    static const char headers[] = "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n"
+        "retry: 2000\n\n";
+    if (httpd_send(req, headers, sizeof(headers) - 1) != sizeof(headers) - 1) {
+        return ESP_FAIL;
+    }
+
+    if (!server->telemetry_) {
+        server->telemetry_ = std::make_unique<TelemetryChannel>();
+    }
+    int fd = httpd_req_to_sockfd(req);
+    for (auto& slot : server->telemetry_fds_) {
+        if (slot < 0) {
+            slot = fd;
+            break;
+        }
+    }
+    server->telemetry_observers_++;
+    ESP_LOGI(TAG, "Telemetry observer %d connected (%d total, every %dms)",
+             fd, server->telemetry_observers_, server->telemetry_interval_ms_);
+
+    // First event right away, then on the (re)started timer
+    esp_timer_stop(server->telemetry_timer_);
+    esp_timer_start_periodic(server->telemetry_timer_, server->telemetry_interval_ms_ * 1000LL);
+    server->PushTelemetry();
+    return ESP_OK;
+}
+
+void WebServer::push_telemetry(void* arg) {
+    WebServer* server = (WebServer*)arg;
+    server->telemetry_push_queued_ = false;
+    server->PushTelemetry();
+}
+
+void WebServer::PushTelemetry() {
+    if (telemetry_observers_ == 0) {
+        return;
+    }
+    auto& snapshot = telemetry_->snapshot;
+    snapshot.sequence++;
+    telemetry_callback_(snapshot);
+    size_t length = FormatTelemetryEvent(snapshot, telemetry_->event, sizeof(telemetry_->event));
+    if (length == 0) {
+        ESP_LOGW(TAG, "Telemetry event does not fit in %u bytes", sizeof(telemetry_->event));
+        return;
+    }
+
+    for (auto fd : telemetry_fds_) {
+        if (fd < 0) {
+            continue;
+        }
+        // Never wait for a slow observer; a partial event would corrupt its stream, so drop it
+        int sent = httpd_socket_send(server_handle_, fd, telemetry_->event, length, MSG_DONTWAIT);
+        if (sent != (int)length) {
+            ESP_LOGW(TAG, "Telemetry observer %d too slow (%d of %u bytes), closing", fd, sent, length);
+            RemoveTelemetryObserver(fd);
+            httpd_sess_trigger_close(server_handle_, fd);
+        }
+    }
+}
+
+bool WebServer::RemoveTelemetryObserver(int fd) {
+    for (auto& slot : telemetry_fds_) {
+        if (slot == fd) {
+            slot = -1;
+            if (--telemetry_observers_ == 0) {
+                esp_timer_stop(telemetry_timer_);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void WebServer::close_socket_handler(httpd_handle_t handle, int sockfd) {
+    WebServer* server = (WebServer*)httpd_get_global_user_ctx(handle);
+    if (server != nullptr) {
+        if (server->RemoveTelemetryObserver(sockfd)) {
+            ESP_LOGI(TAG, "Telemetry observer %d disconnected", sockfd);
+        }
+        if (sockfd == server->tap_fd_) {
+            ESP_LOGI(TAG, "Audio tap listener %d disconnected", sockfd);
+            server->tap_fd_ = -1;
+            server->audio_tap_->Stop();
+        }
+        if (sockfd == server->screen_fd_) {
+            ESP_LOGI(TAG, "Screen viewer %d disconnected", sockfd);
+            server->screen_fd_ = -1;
+            server->screen_streamer_->Stop();
+        }
+#if CONFIG_HTTPD_WS_SUPPORT
+        if (server->control_) {
+            server->control_->OnClose(sockfd);
+        }
+#endif
+    }
+    close(sockfd);
+}
+
+esp_err_t WebServer::audio_page_get_handler(httpd_req_t *req) {
+    WebServer* server = (WebServer*)req->user_ctx;
+    return server->send_page(req, kWebPageAudio);
+}
+
+// GET /audio_tap[?point=raw_mic|afe_output|encoder_input|decoder_output][&format=ogg|wav]
+// 响应没有长度，音频一直写到连接关闭；Ogg Opus 可直接用 <audio> 播放，WAV 为无损 PCM
+esp_err_t WebServer::audio_tap_get_handler(httpd_req_t *req) {
+    WebServer* server = (WebServer*)req->user_ctx;
+
+    if (server->audio_tap_ == nullptr) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Audio tap not set");
+        return ESP_OK;
+    }
+
+    AudioTapPoint point = kAudioTapRawMic;
+    AudioTapFormat format = kAudioTapOgg;
+    char query[64];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "point", value, sizeof(value)) == ESP_OK) {
+            point = AudioTap::PointFromName(value);
+            if (point == kAudioTapNone) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown tap point");
+                return ESP_OK;
+            }
+        }
+        if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK && strcmp(value, "wav") == 0) {
+            format = kAudioTapWav;
+        }
+    }
+
+    // 同一时间只有一个监听者，新请求取代旧的
+    server->CloseAudioTap();
+
+    const char* headers = format == kAudioTapWav ?
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: audio/wav\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: close\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n" :
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: audio/ogg\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: close\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n";
+    int length = strlen(headers);
+    if (httpd_send(req, headers, length) != length) {
+        return ESP_FAIL;
+    }
+
+    bool started = server->audio_tap_->Start(point, format, [server]() {
+        // Runs in the tap task: hand the send off to the httpd task, once per batch
+        if (!server->tap_send_queued_.exchange(true)) {
+            if (httpd_queue_work(server->server_handle_, send_audio_tap, server) != ESP_OK) {
+                server->tap_send_queued_ = false;
+            }
+        }
+    });
+    if (!started) {
+        return ESP_FAIL;
+    }
+    server->tap_fd_ = httpd_req_to_sockfd(req);
+    ESP_LOGI(TAG, "Audio tap listener %d: %s", server->tap_fd_, AudioTap::PointName(point));
+    return ESP_OK;
+}
+
+void WebServer::send_audio_tap(void* arg) {
+    WebServer* server = (WebServer*)arg;
+    server->tap_send_queued_ = false;
+    server->SendAudioTap();
+}
+
+void WebServer::SendAudioTap() {
+    const uint8_t* data;
+    size_t size;
+    while (tap_fd_ >= 0 && (size = audio_tap_->Peek(&data)) > 0) {
+        int sent = httpd_socket_send(server_handle_, tap_fd_, (const char*)data, size, MSG_DONTWAIT);
+        if (sent == HTTPD_SOCK_ERR_TIMEOUT) {
+            // Socket buffer full; the tap drops pages until the listener catches up
+            break;
+        }
+        if (sent < 0) {
+            ESP_LOGW(TAG, "Audio tap listener %d failed (%d), closing", tap_fd_, sent);
+            CloseAudioTap();
+            break;
+        }
+        audio_tap_->Consume(sent);
+    }
+}
+
+void WebServer::CloseAudioTap() {
+    if (tap_fd_ < 0) {
+        return;
+    }
+    int fd = tap_fd_;
+    tap_fd_ = -1;
+    audio_tap_->Stop();
+    httpd_sess_trigger_close(server_handle_, fd);
+}
+
+// GET /screen[?fps=N][&quality=Q]：MJPEG（multipart/x-mixed-replace），浏览器直接打开或放进 <img>
+// 只有屏幕内容变化时才编码发送新帧，静止画面不占带宽
+esp_err_t WebServer::screen_get_handler(httpd_req_t *req) {
+    WebServer* server = (WebServer*)req->user_ctx;
+
+    if (server->screen_streamer_ == nullptr) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No LVGL display to mirror");
+        return ESP_OK;
+    }
+
+    int fps = SCREEN_DEFAULT_FPS;
+    int quality = SCREEN_DEFAULT_QUALITY;
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "fps", value, sizeof(value)) == ESP_OK) {
+            fps = std::clamp(atoi(value), 1, SCREEN_MAX_FPS);
+        }
+        if (httpd_query_key_value(query, "quality", value, sizeof(value)) == ESP_OK) {
+            quality = std::clamp(atoi(value), 20, 95);
+        }
+    }
+
+    // 同一时间只有一个观看者，新请求取代旧的
+    server->CloseScreen();
+
+    static const char headers[] = "HTTP/1.1 200 OK\r\n"
+        "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: close\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n";
+    if (httpd_send(req, headers, sizeof(headers) - 1) != sizeof(headers) - 1) {
+        return ESP_FAIL;
+    }
+
+    bool started = server->screen_streamer_->Start(fps, quality, [server]() {
+        // Runs in the streamer task: hand the send off to the httpd task
+        if (!server->screen_send_queued_.exchange(true)) {
+            if (httpd_queue_work(server->server_handle_, send_screen, server) != ESP_OK) {
+                server->screen_send_queued_ = false;
+            }
+        }
+    });
+    if (!started) {
+        return ESP_FAIL;
+    }
+    server->screen_fd_ = httpd_req_to_sockfd(req);
+    ESP_LOGI(TAG, "Screen viewer %d: %d fps, quality %d", server->screen_fd_, fps, quality);
+    return ESP_OK;
+}
+
+void WebServer::send_screen(void* arg) {
+    WebServer* server = (WebServer*)arg;
+    server->screen_send_queued_ = false;
+    server->SendScreen();
+}
+
+void WebServer::SendScreen() {
+    const uint8_t* data;
+    size_t size;
+    while (screen_fd_ >= 0 && (size = screen_streamer_->Peek(&data)) > 0) {
+        int sent = httpd_socket_send(server_handle_, screen_fd_, (const char*)data, size, MSG_DONTWAIT);
+        if (sent == HTTPD_SOCK_ERR_TIMEOUT) {
+            // Socket buffer full; retried from the streamer's next tick
+            break;
+        }
+        if (sent < 0) {
+            ESP_LOGW(TAG, "Screen viewer %d failed (%d), closing", screen_fd_, sent);
+            CloseScreen();
+            break;
+        }
+        screen_streamer_->Consume(sent);
+    }
+}
+
+void WebServer::CloseScreen() {
+    if (screen_fd_ < 0) {
+        return;
+    }
+    int fd = screen_fd_;
+    screen_fd_ = -1;
+    screen_streamer_->Stop();
+    httpd_sess_trigger_close(server_handle_, fd);
+}
+
 esp_err_t WebServer::index_get_handler(httpd_req_t *req) {
     WebServer* server = (WebServer*)req->user_ctx;
 
@@ -158,9 +622,64 @@ esp_err_t WebServer::index_get_handler(httpd_req_t *req) {
     httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
 
+    return server->send_page(req, kWebPageIndex);
+}
+
+esp_err_t WebServer::send_page(httpd_req_t *req, const WebPage& page) {
+    // 页面随固件一起更新，每次打开都用 ETag 向设备确认，未变则回 304 不带正文
+    httpd_resp_set_hdr(req, "ETag", page.etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    char if_none_match[48];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, page.etag) != nullptr) {
+        page_not_modified_++;
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, nullptr, 0);
+        ESP_LOGI(TAG, "GET %s: 304", req->uri);
+        return ESP_OK;
+    }
+
+    // 所有浏览器都支持 gzip，flash 中只保存压缩后的页面
+    page_responses_++;
+    page_bytes_sent_ += page.size;
     httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, server->get_html_page(), HTTPD_RESP_USE_STRLEN);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_send(req, (const char*)page.data, page.size);
+    ESP_LOGI(TAG, "GET %s: %u bytes (gzip of %u)", req->uri, page.size, page.raw_size);
+    return ESP_OK;
+}
 
+// 页面加载性能回报（navigator.sendBeacon）
+esp_err_t WebServer::web_timing_post_handler(httpd_req_t *req) {
+    WebServer* server = (WebServer*)req->user_ctx;
+
+    char content[256];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No content");
+        return ESP_OK;
+    }
+    content[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_OK;
+    }
+    cJSON *page = cJSON_GetObjectItem(json, "page");
+    cJSON *transfer = cJSON_GetObjectItem(json, "transfer");
+    cJSON *decoded = cJSON_GetObjectItem(json, "decoded");
+    cJSON *interactive = cJSON_GetObjectItem(json, "interactive");
+    ESP_LOGI(TAG, "Page %s interactive after %dms, %d bytes transferred (%d decoded); served %lu full, %lu not modified, %lu bytes",
+             cJSON_IsString(page) ? page->valuestring : "?",
+             cJSON_IsNumber(interactive) ? interactive->valueint : -1,
+             cJSON_IsNumber(transfer) ? transfer->valueint : -1,
+             cJSON_IsNumber(decoded) ? decoded->valueint : -1,
+             server->page_responses_, server->page_not_modified_, server->page_bytes_sent_);
+    cJSON_Delete(json);
+
+    httpd_resp_send(req, nullptr, 0);
     return ESP_OK;
 }
 
@@ -227,6 +746,43 @@ esp_err_t WebServer::api_control_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+#if CONFIG_HTTPD_WS_SUPPORT
+esp_err_t WebServer::ws_control_handler(httpd_req_t *req) {
+    WebServer* server = (WebServer*)req->user_ctx;
+    if (req->method == HTTP_GET) {
+        ESP_LOGI(TAG, "Joystick channel opened (fd %d)", httpd_req_to_sockfd(req));
+        return ESP_OK;
+    }
+
+    uint8_t payload[8];
+    httpd_ws_frame_t frame = {};
+    frame.payload = payload;
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, sizeof(payload));
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Joystick channel: bad frame (%s)", esp_err_to_name(ret));
+        return ret;
+    }
+    if (frame.type == HTTPD_WS_TYPE_BINARY) {
+        server->control_->OnFrame(httpd_req_to_sockfd(req), payload, frame.len);
+    }
+    return ESP_OK;
+}
+
+void WebServer::send_control_ack(void* arg) {
+    WebServer* server = (WebServer*)arg;
+    uint8_t payload[4];
+    int fd = server->control_->GetAck(payload);
+    if (fd < 0) {
+        return;
+    }
+    httpd_ws_frame_t frame = {};
+    frame.type = HTTPD_WS_TYPE_BINARY;
+    frame.payload = payload;
+    frame.len = sizeof(payload);
+    httpd_ws_send_frame_async(server->server_handle_, fd, &frame);
+}
+#endif
+
 // Simple struct passed to the stop task
 struct debug_stop_param_t {
     WebServer* server;
@@ -447,584 +1003,6 @@ void WebServer::parse_simple_control_command(const char* data, int& direction, i
     free(str);
 }
 
-const char* WebServer::get_html_page() {
-    static const char html_page[] = R"html(
-<!DOCTYPE html>
-<html lang="zh-CN">
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>小智小车遥控器</title>
-    <style>
-        body {
-            font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif;
-            background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);
-            margin: 0;
-            padding: 20px;
-            min-height: 100vh;
-            display: flex;
-            flex-direction: column;
-            align-items: center;
-            justify-content: center;
-        }
-
-        .container {
-            background: rgba(255, 255, 255, 0.95);
-            border-radius: 20px;
-            padding: 30px;
-            box-shadow: 0 20px 40px rgba(0,0,0,0.1);
-            text-align: center;
-            max-width: 400px;
-            width: 100%;
-        }
-
-        h1 {
-            color: #333;
-            margin-bottom: 10px;
-            font-size: 2.2em;
-        }
-
-        .subtitle {
-            color: #666;
-            margin-bottom: 30px;
-            font-size: 1.1em;
-        }
-
-        .joystick-container {
-            position: relative;
-            width: 400px;
-            height: 400px;
-            margin: 0 auto 30px;
-            border-radius: 50%;
-            background: #f0f0f0;
-            border: 3px solid #ddd;
-            touch-action: none;
-        }
-
-        .joystick {
-            position: absolute;
-            width: 112px;
-            height: 112px;
-            background: linear-gradient(135deg, #4CAF50, #45a049);
-            border-radius: 50%;
-            top: 50%;
-            left: 50%;
-            transform: translate(-50%, -50%);
-            box-shadow: 0 4px 8px rgba(0,0,0,0.2);
-            transition: all 0.1s ease;
-            cursor: pointer;
-        }
-
-        .joystick.active {
-            background: linear-gradient(135deg, #2196F3, #1976D2);
-            transform: translate(-50%, -50%) scale(0.95);
-        }
-
-        .direction-indicator {
-            position: absolute;
-            top: 50%;
-            left: 50%;
-            transform: translate(-50%, -50%);
-            font-size: 18px;
-            font-weight: bold;
-            color: #333;
-            pointer-events: none;
-            transition: opacity 0.3s ease;
-        }
-
-        .direction-indicator.active {
-            opacity: 1;
-        }
-
-        .status {
-            margin-top: 20px;
-            padding: 10px;
-            border-radius: 10px;
-            background: #f8f9fa;
-            border: 1px solid #e9ecef;
-        }
-
-        .status.connected {
-            background: #d4edda;
-            border-color: #c3e6cb;
-            color: #155724;
-        }
-
-        .status.disconnected {
-            background: #f8d7da;
-            border-color: #f5c6cb;
-            color: #721c24;
-        }
-
-        .controls {
-            margin-top: 20px;
-        }
-
-        .control-btn {
-            background: linear-gradient(135deg, #FF6B6B, #EE5A24);
-            color: white;
-            border: none;
-            padding: 12px 24px;
-            border-radius: 25px;
-            font-size: 16px;
-            cursor: pointer;
-            margin: 5px;
-            transition: all 0.3s ease;
-            box-shadow: 0 4px 15px rgba(255, 107, 107, 0.3);
-        }
-
-        .control-btn:hover {
-            transform: translateY(-2px);
-            box-shadow: 0 6px 20px rgba(255, 107, 107, 0.4);
-        }
-
-        .control-btn:active {
-            transform: translateY(0);
-        }
-
-        .stop-btn {
-            background: linear-gradient(135deg, #DC3545, #C82333);
-        }
-
-        .stop-btn:hover {
-            box-shadow: 0 6px 20px rgba(220, 53, 69, 0.4);
-        }
-
-        /* 动作控制区域样式 */
-        .actions-section {
-            margin-top: 30px;
-            padding: 20px;
-            background: rgba(255, 255, 255, 0.9);
-            border-radius: 15px;
-            border: 1px solid #e9ecef;
-        }
-
-        .action-buttons {
-            display: grid;
-            grid-template-columns: repeat(auto-fit, minmax(280px, 1fr));
-            gap: 20px;
-        }
-
-        .action-group {
-            background: #f8f9fa;
-            padding: 15px;
-            border-radius: 10px;
-            border: 1px solid #dee2e6;
-        }
-
-        .action-group h4 {
-            margin: 0 0 15px 0;
-            color: #495057;
-            font-size: 1.1em;
-            text-align: center;
-            border-bottom: 2px solid #e9ecef;
-            padding-bottom: 8px;
-        }
-
-        .action-btn {
-            background: linear-gradient(135deg, #28a745, #20c997);
-            color: white;
-            border: none;
-            padding: 10px 15px;
-            border-radius: 8px;
-            font-size: 14px;
-            cursor: pointer;
-            margin: 5px;
-            transition: all 0.3s ease;
-            box-shadow: 0 2px 8px rgba(40, 167, 69, 0.2);
-            min-width: 100px;
-        }
-
-        .action-btn:hover {
-            transform: translateY(-2px);
-            box-shadow: 0 4px 12px rgba(40, 167, 69, 0.3);
-        }
-
-        .action-btn:active {
-            transform: translateY(0);
-        }
-
-        @media (max-width: 480px) {
-            .container {
-                padding: 20px;
-                margin: 10px;
-            }
-
-            .joystick-container {
-                width: 320px;
-                height: 320px;
-            }
-
-            .joystick {
-                width: 96px;
-                height: 96px;
-            }
-
-            h1 {
-                font-size: 1.8em;
-            }
-
-            .action-buttons {
-                grid-template-columns: 1fr;
-                gap: 15px;
-            }
-
-            .action-btn {
-                font-size: 13px;
-                padding: 8px 12px;
-                min-width: 80px;
-            }
-        }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <h1>🚗 小智小车遥控器</h1>
-        <div class="subtitle">触摸或拖拽摇杆控制小车移动</div>
-
-        <div class="joystick-container" id="joystick-container">
-            <div class="joystick" id="joystick"></div>
-            <div class="direction-indicator" id="direction-indicator">⏹️</div>
-        </div>
-
-        <div class="status connected" id="status">
-            <strong>状态:</strong> <span id="status-text">已连接</span>
-        </div>
-
-        <div class="controls">
-            <button class="control-btn stop-btn" onclick="stopCar()">🛑 停止</button>
-            <a href="/config" class="control-btn" style="background: linear-gradient(135deg, #FF9800, #F57C00);">⚙️ 配置</a>
-        </div>
-
-        <div class="actions-section">
-            <h3 style="color: #333; margin: 20px 0 15px 0; text-align: center;">🎭 动作控制</h3>
-
-            <div class="action-buttons">
-                <!-- 基本移动动作 -->
-                <div class="action-group">
-                    <h4>🚗 基本移动</h4>
-                    <button class="action-btn" onclick="executeAction('move_forward')">⬆️ 前进</button>
-                    <button class="action-btn" onclick="executeAction('move_backward')">⬇️ 后退</button>
-                    <button class="action-btn" onclick="executeAction('turn_left')">⬅️ 左转</button>
-                    <button class="action-btn" onclick="executeAction('turn_right')">➡️ 右转</button>
-                    <button class="action-btn" onclick="executeAction('spin_around')">🔄 转圈</button>
-                </div>
-
-                <!-- 情感动作 -->
-                <div class="action-group">
-                    <h4>😊 情感表达</h4>
-                    <button class="action-btn" onclick="executeAction('wake_up')">🌅 唤醒</button>
-                    <button class="action-btn" onclick="executeAction('happy')">😄 开心</button>
-                    <button class="action-btn" onclick="executeAction('sad')">😢 悲伤</button>
-                    <button class="action-btn" onclick="executeAction('thinking')">🤔 思考</button>
-                    <button class="action-btn" onclick="executeAction('listening')">👂 倾听</button>
-                    <button class="action-btn" onclick="executeAction('speaking')">💬 说话</button>
-                    <button class="action-btn" onclick="executeAction('wiggle')">🌊 摆动</button>
-                    <button class="action-btn" onclick="executeAction('dance')">💃 跳舞</button>
-                </div>
-
-                <!-- 高级情感 -->
-                <div class="action-group">
-                    <h4>🎭 高级情感</h4>
-                    <button class="action-btn" onclick="executeAction('excited')">🤩 兴奋</button>
-                    <button class="action-btn" onclick="executeAction('loving')">😍 爱慕</button>
-                    <button class="action-btn" onclick="executeAction('angry')">😠 生气</button>
-                    <button class="action-btn" onclick="executeAction('surprised')">😲 惊讶</button>
-                    <button class="action-btn" onclick="executeAction('confused')">😕 困惑</button>
-                </div>
-            </div>
-        </div>
-    </div>
-
-    <script>
-        let joystick = document.getElementById('joystick');
-        let joystickContainer = document.getElementById('joystick-container');
-        let directionIndicator = document.getElementById('direction-indicator');
-        let statusText = document.getElementById('status-text');
-
-        let isDragging = false;
-        let centerX = 0;
-        let centerY = 0;
-        let currentDirection = 0;
-        let currentSpeed = 0;
-        let isRequestPending = false; // 防止并发请求
-
-
-        // 初始化摇杆中心位置
-        function initJoystick() {
-            const rect = joystickContainer.getBoundingClientRect();
-            centerX = rect.left + rect.width / 2;
-            centerY = rect.top + rect.height / 2;
-        }
-
-        // 更新摇杆位置
-        function updateJoystickPosition(x, y) {
-            const rect = joystickContainer.getBoundingClientRect();
-            const containerCenterX = rect.left + rect.width / 2;
-            const containerCenterY = rect.top + rect.height / 2;
-
-            // 计算相对于容器的位置
-            let relativeX = x - containerCenterX;
-            let relativeY = y - containerCenterY;
-
-            // 限制在圆形范围内
-            const maxRadius = rect.width / 2 - 56;
-            const distance = Math.sqrt(relativeX * relativeX + relativeY * relativeY);
-
-            if (distance > maxRadius) {
-                relativeX = (relativeX / distance) * maxRadius;
-                relativeY = (relativeY / distance) * maxRadius;
-            }
-
-            // 更新摇杆位置
-            joystick.style.left = `calc(50% + ${relativeX}px)`;
-            joystick.style.top = `calc(50% + ${relativeY}px)`;
-
-            // 计算方向和速度
-            const normalizedX = relativeX / maxRadius;
-            const normalizedY = relativeY / maxRadius;
-
-            // 计算方向角度 (0-360度)
-            let angle = Math.atan2(normalizedY, normalizedX) * (180 / Math.PI);
-            if (angle < 0) angle += 360;
-
-            // 计算速度 (0-100)
-            const speed = Math.min(distance / maxRadius, 1) * 100;
-
-            // 转换方向为整数值
-            let direction = 0; // 停止
-            if (speed > 5) { // 最小阈值 (降低阈值以响应点击)
-                if (angle >= 315 || angle < 45) {
-                    direction = 1; // 右
-                } else if (angle >= 45 && angle < 135) {
-                    direction = 2; // 下
-                } else if (angle >= 135 && angle < 225) {
-                    direction = 3; // 左
-                } else if (angle >= 225 && angle < 315) {
-                    direction = 4; // 上
-                }
-            }
-
-            return { direction, speed: Math.round(speed) };
-        }
-
-        // 更新方向指示器
-        function updateDirectionIndicator(direction, speed) {
-            let icon = '⏹️';
-            let text = '停止';
-
-            if (speed > 5) {
-                switch(direction) {
-                    case 1: icon = '➡️'; text = '右转'; break;
-                    case 2: icon = '⬇️'; text = '后退'; break;
-                    case 3: icon = '⬅️'; text = '左转'; break;
-                    case 4: icon = '⬆️'; text = '前进'; break;
-                }
-            }
-
-            directionIndicator.textContent = icon;
-            directionIndicator.classList.toggle('active', speed > 5);
-        }
-
-        // 发送控制命令
-        // 发送控制命令
-        async function sendControl(direction, speed) {
-            // 停止命令(0, 0)优先处理，不受并发限制
-            if (direction === 0 && speed === 0) {
-                currentDirection = 0;
-                currentSpeed = 0;
-                try {
-                    const response = await fetch('/api/control', {
-                        method: 'POST',
-                        headers: {
-                            'Content-Type': 'application/json',
-                        },
-                        body: JSON.stringify({
-                            direction: 0,
-                            speed: 0
-                        })
-                    });
-                    if (!response.ok) {
-                        throw new Error('Network response was not ok');
-                    }
-                    statusText.textContent = '已连接';
-                    document.getElementById('status').className = 'status connected';
-                } catch (error) {
-                    console.error('Failed to send stop control:', error);
-                    statusText.textContent = '连接错误';
-                    document.getElementById('status').className = 'status error';
-                }
-                return;
-            }
-
-            if (direction === currentDirection && speed === currentSpeed) {
-                return; // 避免重复发送相同命令
-            }
-
-            // 如果有请求正在进行中，跳过
-            if (isRequestPending) {
-                return;
-            }
-
-            currentDirection = direction;
-            currentSpeed = speed;
-            isRequestPending = true;
-
-            try {
-                const response = await fetch('/api/control', {
-                    method: 'POST',
-                    headers: {
-                        'Content-Type': 'application/json',
-                    },
-                    body: JSON.stringify({
-                        direction: direction,
-                        speed: speed
-                    })
-                });
-
-                if (!response.ok) {
-                    throw new Error('Network response was not ok');
-                }
-
-                statusText.textContent = '已连接';
-                document.getElementById('status').className = 'status connected';
-            } catch (error) {
-                console.error('Failed to send control:', error);
-                statusText.textContent = '连接错误';
-                document.getElementById('status').className = 'status error';
-            } finally {
-                isRequestPending = false;
-            }
-        }
-
-        // 停止小车
-        function stopCar() {
-            // 重置状态
-            isDragging = false;
-            currentDirection = 0;
-            currentSpeed = 0;
-
-            // 重置UI
-            joystick.style.left = '50%';
-            joystick.style.top = '50%';
-            joystick.classList.remove('active');
-            updateDirectionIndicator(0, 0);
-
-            // 发送停止命令
-            sendControl(0, 0);
-        }
-
-
-        // 执行电机动作
-        async function executeAction(action) {
-            try {
-                const response = await fetch('/api/motor/action', {
-                    method: 'POST',
-                    headers: {
-                        'Content-Type': 'application/json',
-                    },
-                    body: JSON.stringify({
-                        action: action
-                    })
-                });
-
-                if (!response.ok) {
-                    throw new Error('Network response was not ok');
-                }
-
-                const result = await response.json();
-                console.log('Action executed:', action, result);
-
-                // 更新状态显示
-                statusText.textContent = '动作执行成功';
-                document.getElementById('status').className = 'status connected';
-
-            } catch (error) {
-                console.error('Failed to execute action:', action, error);
-                statusText.textContent = '动作执行失败';
-                document.getElementById('status').className = 'status disconnected';
-            }
-        }
-
-        // 鼠标事件
-        joystickContainer.addEventListener('mousedown', (e) => {
-            isDragging = true;
-            joystick.classList.add('active');
-            initJoystick();
-            const { direction, speed } = updateJoystickPosition(e.clientX, e.clientY);
-            updateDirectionIndicator(direction, speed);
-            sendControl(direction, speed);
-        });
-
-        document.addEventListener('mousemove', (e) => {
-            if (isDragging) {
-                const { direction, speed } = updateJoystickPosition(e.clientX, e.clientY);
-                updateDirectionIndicator(direction, speed);
-                sendControl(direction, speed);
-            }
-        });
-
-        document.addEventListener('mouseup', () => {
-            if (isDragging) {
-                stopCar();
-            }
-        });
-
-        // 触摸事件
-        joystickContainer.addEventListener('touchstart', (e) => {
-            e.preventDefault();
-            isDragging = true;
-            joystick.classList.add('active');
-            initJoystick();
-            const touch = e.touches[0];
-            const { direction, speed } = updateJoystickPosition(touch.clientX, touch.clientY);
-            updateDirectionIndicator(direction, speed);
-            sendControl(direction, speed);
-        });
-
-        joystickContainer.addEventListener('touchmove', (e) => {
-            e.preventDefault();
-            if (isDragging) {
-                const touch = e.touches[0];
-                const { direction, speed } = updateJoystickPosition(touch.clientX, touch.clientY);
-                updateDirectionIndicator(direction, speed);
-                sendControl(direction, speed);
-            }
-        });
-
-        joystickContainer.addEventListener('touchend', (e) => {
-            e.preventDefault();
-            if (isDragging) {
-                stopCar();
-            }
-        });
-
-        // 全局触摸结束事件，确保在任何地方松手都能停止
-        document.addEventListener('touchend', (e) => {
-            if (isDragging && e.target !== joystick && e.target !== joystickContainer) {
-                stopCar();
-            }
-        });
-
-        // 定期发送控制命令（当摇杆被拖拽时）
-        setInterval(() => {
-            if (isDragging) {
-                sendControl(currentDirection, currentSpeed);
-            }
-        }, 200); // 每200ms发送一次，减少服务器压力
-
-        // 初始化
-        initJoystick();
-        window.addEventListener('resize', initJoystick);
-    </script>
-</body>
-</html>
-)html";
-
-    return html_page;
-}
-
-
 // 解析JSON控制命令
 void WebServer::parse_json_control_command(const char* data, int& direction, int& speed) {
     cJSON *json = cJSON_Parse(data);
@@ -1057,10 +1035,7 @@ esp_err_t WebServer::config_get_handler(httpd_req_t *req) {
     httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
 
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, server->get_config_html_page(), HTTPD_RESP_USE_STRLEN);
-
-    return ESP_OK;
+    return server->send_page(req, kWebPageConfig);
 }
 
 // 配置页面POST处理器
@@ -1334,233 +1309,4 @@ void WebServer::parse_config_form_data(const char* data, MotorActionConfig& conf
     }
 
     free(str);
-}
-
-// 获取配置页面HTML
-const char* WebServer::get_config_html_page() {
-    static const char config_html_page[] = R"html(
-<!DOCTYPE html>
-<html lang="zh-CN">
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>电机动作配置</title>
-    <style>
-        body {
-            font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif;
-            background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);
-            margin: 0;
-            padding: 20px;
-            min-height: 100vh;
-            display: flex;
-            justify-content: center;
-            align-items: center;
-        }
-
-        .container {
-            background: rgba(255, 255, 255, 0.95);
-            border-radius: 20px;
-            padding: 30px;
-            box-shadow: 0 20px 40px rgba(0,0,0,0.1);
-            max-width: 600px;
-            width: 100%;
-        }
-
-        h1 {
-            color: #333;
-            text-align: center;
-            margin-bottom: 30px;
-        }
-
-        .form-group {
-            margin-bottom: 20px;
-        }
-
-        label {
-            display: block;
-            margin-bottom: 5px;
-            font-weight: bold;
-            color: #555;
-        }
-
-        input[type="number"] {
-            width: 100%;
-            padding: 10px;
-            border: 2px solid #ddd;
-            border-radius: 8px;
-            font-size: 16px;
-            transition: border-color 0.3s ease;
-        }
-
-        input[type="number"]:focus {
-            outline: none;
-            border-color: #4CAF50;
-        }
-
-        .unit {
-            color: #666;
-            font-size: 14px;
-            margin-left: 5px;
-        }
-
-        .description {
-            color: #777;
-            font-size: 14px;
-            margin-top: 3px;
-            font-weight: normal;
-        }
-
-        .buttons {
-            text-align: center;
-            margin-top: 30px;
-        }
-
-        .btn {
-            background: linear-gradient(135deg, #4CAF50, #45a049);
-            color: white;
-            border: none;
-            padding: 12px 30px;
-            border-radius: 25px;
-            font-size: 16px;
-            cursor: pointer;
-            margin: 0 10px;
-            text-decoration: none;
-            display: inline-block;
-            transition: all 0.3s ease;
-        }
-
-        .btn:hover {
-            transform: translateY(-2px);
-            box-shadow: 0 6px 20px rgba(76, 175, 80, 0.4);
-        }
-
-        .btn.secondary {
-            background: linear-gradient(135deg, #2196F3, #1976D2);
-        }
-
-        .btn.secondary:hover {
-            box-shadow: 0 6px 20px rgba(33, 150, 243, 0.4);
-        }
-
-        .grid {
-            display: grid;
-            grid-template-columns: 1fr 1fr;
-            gap: 20px;
-        }
-
-        @media (max-width: 480px) {
-            .grid {
-                grid-template-columns: 1fr;
-            }
-        }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <h1>⚙️ 电机动作配置</h1>
-        <form method="POST" action="/config">
-            <div class="grid">
-                <div class="form-group">
-                    <label for="forward_ms">前进时间</label>
-                    <input type="number" id="forward_ms" name="forward_ms" min="100" max="30000" step="100" required>
-                    <span class="unit">毫秒</span>
-                    <div class="description">默认前进动作的持续时间</div>
-                </div>
-
-                <div class="form-group">
-                    <label for="backward_ms">后退时间</label>
-                    <input type="number" id="backward_ms" name="backward_ms" min="100" max="30000" step="100" required>
-                    <span class="unit">毫秒</span>
-                    <div class="description">默认后退动作的持续时间</div>
-                </div>
-
-                <div class="form-group">
-                    <label for="left_turn_ms">左转时间</label>
-                    <input type="number" id="left_turn_ms" name="left_turn_ms" min="100" max="10000" step="50" required>
-                    <span class="unit">毫秒</span>
-                    <div class="description">左转动作的持续时间</div>
-                </div>
-
-                <div class="form-group">
-                    <label for="right_turn_ms">右转时间</label>
-                    <input type="number" id="right_turn_ms" name="right_turn_ms" min="100" max="10000" step="50" required>
-                    <span class="unit">毫秒</span>
-                    <div class="description">右转动作的持续时间</div>
-                </div>
-
-                <div class="form-group">
-                    <label for="spin_ms">转圈时间</label>
-                    <input type="number" id="spin_ms" name="spin_ms" min="500" max="10000" step="100" required>
-                    <span class="unit">毫秒</span>
-                    <div class="description">转圈动作的持续时间</div>
-                </div>
-
-
-                <div class="form-group">
-                    <label for="def_speed_pct">默认速度</label>
-                    <input type="number" id="def_speed_pct" name="def_speed_pct" min="10" max="100" step="5" required>
-                    <span class="unit">%</span>
-                    <div class="description">电机动作的默认速度百分比</div>
-                </div>
-            </div>
-
-            <div class="buttons">
-                <button type="submit" class="btn">💾 保存配置</button>
-                <a href="/" class="btn secondary">🏠 返回遥控器</a>
-            </div>
-        </form>
-    </div>
-
-    <script>
-        // 页面加载时获取当前配置
-        window.onload = function() {
-            fetch('/api/config')
-                .then(response => response.json())
-                .then(config => {
-                    document.getElementById('forward_ms').value = config.forward_ms;
-                    document.getElementById('backward_ms').value = config.backward_ms;
-                    document.getElementById('left_turn_ms').value = config.left_turn_ms;
-                    document.getElementById('right_turn_ms').value = config.right_turn_ms;
-                    document.getElementById('spin_ms').value = config.spin_ms;
-                    document.getElementById('def_speed_pct').value = config.def_speed_pct;
-                })
-                .catch(error => console.error('Failed to load config:', error));
-        };
-
-        // 处理表单提交
-        document.getElementById('config-form').addEventListener('submit', function(e) {
-            e.preventDefault(); // 阻止默认表单提交
-
-            const formData = new FormData(this);
-            const data = Object.fromEntries(formData.entries());
-
-            fetch('/api/config', {
-                method: 'POST',
-                headers: {
-                    'Content-Type': 'application/json',
-                },
-                body: JSON.stringify(data)
-            })
-            .then(response => response.json())
-            .then(result => {
-                if (result.status === 'success') {
-                    // 显示成功消息
-                    alert('配置保存成功！');
-                    // 自动跳转回遥控器界面
-                    window.location.href = '/';
-                } else {
-                    alert('配置保存失败，请重试');
-                }
-            })
-            .catch(error => {
-                console.error('Failed to save config:', error);
-                alert('配置保存失败，请检查网络连接');
-            });
-        });
-    </script>
-</body>
-</html>
-)html";
-
-    return config_html_page;
 }
\ No newline at end of file
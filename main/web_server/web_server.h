@@ -2,10 +2,19 @@
 #define WEB_SERVER_H
 
 #include <esp_http_server.h>
+#include <esp_timer.h>
+#include <atomic>
 #include <string>
 #include <functional>
+#include <memory>
 #include <vector>
 
+struct WebPage;
+struct TelemetrySnapshot;
+class AudioTap;
+class ScreenStreamer;
+class ControlChannel;
+
 class WebServer {
 public:
     WebServer();
@@ -18,6 +27,8 @@ public:
     void SetMotorControlCallback(std::function<void(int direction, int speed)> callback);
     // 由外部调用以触发电机控制（封装私有回调）
     void InvokeMotorControl(int direction, int speed);
+    // 摇杆 WebSocket 通道（/ws/control）的命令合并间隔，与电机运动规划的步进周期一致
+    void SetControlTickMs(int tick_ms) { control_tick_ms_ = tick_ms; }
 
     // 注册表情设置回调函数
     void SetEmotionCallback(std::function<void(const char* emotion)> callback);
@@ -38,6 +49,17 @@ public:
         int default_speed_percent = 100;
     };
 
+    // 主循环统计 JSON 回调（/api/debug/main_loop）
+    void SetMainLoopStatsCallback(std::function<std::string()> callback);
+
+    // 遥测推送（/api/telemetry，Server-Sent Events）：有订阅者时每个周期调用一次，填充共享快照
+    void SetTelemetryCallback(std::function<void(TelemetrySnapshot& snapshot)> callback);
+
+    // 音频监听（/audio 页面，/audio_tap 音频流）
+    void SetAudioTap(AudioTap* audio_tap) { audio_tap_ = audio_tap; }
+    // 屏幕镜像（/screen，MJPEG）
+    void SetScreenStreamer(ScreenStreamer* screen_streamer) { screen_streamer_ = screen_streamer; }
+
     void SetMotorActionConfigCallback(std::function<MotorActionConfig()> get_callback,
                                      std::function<void(const MotorActionConfig&)> set_callback);
 
@@ -50,6 +72,71 @@ private:
     std::function<void(const char* emotion)> emotion_callback_;
     std::function<MotorActionConfig()> get_motor_config_callback_;
     std::function<void(const MotorActionConfig&)> set_motor_config_callback_;
+    std::function<std::string()> main_loop_stats_callback_;
+    int control_tick_ms_ = 10;
+
+    /**
+     * Telemetry stream (/api/telemetry)
+     *
+     * While at least one observer is connected, a timer samples one shared snapshot and
+     * formats it once per interval; each observer then costs a single non-blocking send.
+     * An observer that cannot take a whole event is closed (EventSource reconnects).
+     */
+    static constexpr int kMaxTelemetryObservers = 3;
+    struct TelemetryChannel;
+    std::function<void(TelemetrySnapshot&)> telemetry_callback_;
+    std::unique_ptr<TelemetryChannel> telemetry_;
+    esp_timer_handle_t telemetry_timer_ = nullptr;
+    int telemetry_fds_[kMaxTelemetryObservers] = {-1, -1, -1};
+    int telemetry_observers_ = 0;
+    int telemetry_interval_ms_;
+    std::atomic<bool> telemetry_push_queued_{false};
+
+    static esp_err_t telemetry_get_handler(httpd_req_t *req);
+    static void push_telemetry(void* arg);
+    void PushTelemetry();
+    bool RemoveTelemetryObserver(int fd);
+    static void close_socket_handler(httpd_handle_t handle, int sockfd);
+
+    /**
+     * Audio tap stream (/audio_tap)
+     *
+     * One listener at a time; a new request replaces the previous listener. The tap task
+     * signals new output and the httpd task drains it with non-blocking sends, so a stalled
+     * listener only makes the tap drop pages.
+     */
+    AudioTap* audio_tap_ = nullptr;
+    int tap_fd_ = -1;
+    std::atomic<bool> tap_send_queued_{false};
+
+    static esp_err_t audio_page_get_handler(httpd_req_t *req);
+    static esp_err_t audio_tap_get_handler(httpd_req_t *req);
+    static void send_audio_tap(void* arg);
+    void SendAudioTap();
+    void CloseAudioTap();
+
+    /**
+     * Screen mirror (/screen)
+     *
+     * Same shape as the audio tap: one viewer at a time, parts handed over by the streamer
+     * task and drained by the httpd task with non-blocking sends.
+     */
+    ScreenStreamer* screen_streamer_ = nullptr;
+    int screen_fd_ = -1;
+    std::atomic<bool> screen_send_queued_{false};
+
+    static esp_err_t screen_get_handler(httpd_req_t *req);
+    static void send_screen(void* arg);
+    void SendScreen();
+    void CloseScreen();
+
+#if CONFIG_HTTPD_WS_SUPPORT
+    // Realtime joystick channel (/ws/control), see control_channel.h
+    std::unique_ptr<ControlChannel> control_;
+
+    static esp_err_t ws_control_handler(httpd_req_t *req);
+    static void send_control_ack(void* arg);
+#endif
 
     // HTTP请求处理函数
     static esp_err_t index_get_handler(httpd_req_t *req);
@@ -60,12 +147,17 @@ private:
     static esp_err_t config_post_handler(httpd_req_t *req);
     static esp_err_t api_config_get_handler(httpd_req_t *req);
     static esp_err_t api_config_post_handler(httpd_req_t *req);
+    static esp_err_t api_main_loop_stats_handler(httpd_req_t *req);
+    static esp_err_t web_timing_post_handler(httpd_req_t *req);
 
     // CORS处理
     static esp_err_t cors_handler(httpd_req_t *req);
 
-    // 获取HTML页面内容
-    static const char* get_html_page();
+    // 发送构建时压缩好的页面（gzip + ETag），浏览器缓存未变时回 304
+    esp_err_t send_page(httpd_req_t *req, const WebPage& page);
+    uint32_t page_responses_ = 0;
+    uint32_t page_not_modified_ = 0;
+    uint32_t page_bytes_sent_ = 0;
 
     // 解析控制命令
     void parse_simple_control_command(const char* data, int& direction, int& speed);
@@ -73,7 +165,6 @@ private:
 
     // 配置相关方法
     void parse_config_form_data(const char* data, MotorActionConfig& config);
-    static const char* get_config_html_page();
 };
 
 #endif // WEB_SERVER_H
\ No newline at end of file
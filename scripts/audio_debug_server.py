@@ -1,54 +1,71 @@
 import socket
 import wave
 import argparse
+import urllib.request
 
 
 '''
-  Create a UDP socket and bind it to the server's IP:8000.
-  Listen for incoming messages and print them to the console.
-  Save the audio to a WAV file.
+  Fetch a WAV stream from the device's audio tap (http://<device>/audio_tap).
+  Save the audio to a WAV file, and optionally forward the PCM over UDP
+  (e.g. to scripts/acoustic_check listening on 127.0.0.1:8000).
 '''
-def main(samplerate, channels):
-    # Create a UDP socket
-    server_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-    server_socket.bind(('0.0.0.0', 8000))
+def main(device, point, forward):
+    url = f"http://{device}/audio_tap?point={point}&format=wav"
+    response = urllib.request.urlopen(url)
+
+    # The device sends a 44 byte WAV header with open ended sizes
+    header = response.read(44)
+    if len(header) < 44 or header[0:4] != b"RIFF" or header[36:40] != b"data":
+        raise RuntimeError(f"Unexpected response from {url}")
+    channels = int.from_bytes(header[22:24], "little")
+    samplerate = int.from_bytes(header[24:28], "little")
 
     # Create WAV file with parameters
-    filename = f"{samplerate}_{channels}.wav"
+    filename = f"{point}_{samplerate}_{channels}.wav"
     wav_file = wave.open(filename, "wb")
-    wav_file.setnchannels(channels)     # channels parameter
+    wav_file.setnchannels(channels)
     wav_file.setsampwidth(2)            # 2 bytes per sample (16-bit)
-    wav_file.setframerate(samplerate)   # samplerate parameter
+    wav_file.setframerate(samplerate)
+
+    udp_socket = None
+    if forward:
+        host, port = forward.rsplit(":", 1)
+        forward_address = (host, int(port))
+        udp_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
 
-    print(f"Start saving audio from 0.0.0.0:8000 to {filename}...")
+    print(f"Start saving {point} ({samplerate}Hz, {channels} channel(s)) from {device} to {filename}...")
 
     try:
         while True:
-            # Receive a message from the client
-            message, address = server_socket.recvfrom(8000)
-            
+            # 20ms of audio per read
+            message = response.read(samplerate // 50 * channels * 2)
+            if not message:
+                break
+
             # Write PCM data to WAV file
             wav_file.writeframes(message)
+            if udp_socket:
+                udp_socket.sendto(message, forward_address)
 
-            # Print length of the message
-            print(f"Received {len(message)} bytes from {address}")
-    
     except KeyboardInterrupt:
         print("\nStopping recording...")
-    
+
     finally:
-        # Close files and socket
         wav_file.close()
-        server_socket.close()
+        response.close()
+        if udp_socket:
+            udp_socket.close()
         print(f"WAV file '{filename}' saved successfully")
 
 
 if __name__ == "__main__":
-    parser = argparse.ArgumentParser(description='UDP音频数据接收器，保存为WAV文件')
-    parser.add_argument('--samplerate', '-s', type=int, default=16000, 
-                        help='采样率 (默认: 16000)')
-    parser.add_argument('--channels', '-c', type=int, default=2, 
-                        help='声道数 (默认: 2)')
-    
+    parser = argparse.ArgumentParser(description='从设备的音频监听接口(/audio_tap)接收音频数据，保存为WAV文件')
+    parser.add_argument('device', help='设备地址, 例如 192.168.2.50')
+    parser.add_argument('--point', '-p', default='raw_mic',
+                        choices=['raw_mic', 'afe_output', 'encoder_input', 'decoder_output'],
+                        help='监听点 (默认: raw_mic)')
+    parser.add_argument('--forward', '-f', default=None,
+                        help='同时通过UDP转发PCM, 格式 IP:PORT, 例如 127.0.0.1:8000')
+
     args = parser.parse_args()
-    main(args.samplerate, args.channels)
+    main(args.device, args.point, args.forward)
@@ -272,6 +272,26 @@ def process_extra_files(extra_files_dir, assets_dir):
     return extra_files_list
 
 
+def process_choreography(choreography_file, assets_dir):
+    """Compile the JSON motor routines into choreography.bin"""
+    if not choreography_file:
+        return None
+
+    if not os.path.exists(choreography_file):
+        print(f"Warning: Choreography file not found: {choreography_file}")
+        return None
+
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    from choreography_compiler import compile_choreography
+
+    with open(choreography_file, 'r', encoding='utf-8') as f:
+        data = compile_choreography(json.load(f))
+    with open(os.path.join(assets_dir, "choreography.bin"), 'wb') as f:
+        f.write(data)
+    print(f"Compiled choreography: {choreography_file} ({len(data)} bytes)")
+    return "choreography.bin"
+
+
 def generate_index_json(assets_dir, srmodels, text_font, emoji_collection, extra_files=None, multinet_model_info=None):
     """Generate index.json file"""
     index_data = {
@@ -698,7 +718,7 @@ def get_emoji_collection_path(default_emoji_collection, xiaozhi_fonts_path):
         return None
 
 
-def build_assets_integrated(wakenet_model_paths, multinet_model_paths, text_font_path, emoji_collection_path, extra_files_path, output_path, multinet_model_info=None):
+def build_assets_integrated(wakenet_model_paths, multinet_model_paths, text_font_path, emoji_collection_path, extra_files_path, output_path, multinet_model_info=None, choreography_path=None):
     """
     Build assets using integrated functions (no external dependencies)
     """
@@ -720,6 +740,7 @@ def build_assets_integrated(wakenet_model_paths, multinet_model_paths, text_font
         text_font = process_text_font(text_font_path, assets_dir) if text_font_path else None
         emoji_collection = process_emoji_collection(emoji_collection_path, assets_dir) if emoji_collection_path else None
         extra_files = process_extra_files(extra_files_path, assets_dir) if extra_files_path else None
+        process_choreography(choreography_path, assets_dir)
         
         # Generate index.json
         generate_index_json(assets_dir, srmodels, text_font, emoji_collection, extra_files, multinet_model_info)
@@ -768,6 +789,7 @@ def main():
     parser.add_argument('--esp_sr_model_path', help='Path to ESP-SR model directory')
     parser.add_argument('--xiaozhi_fonts_path', help='Path to xiaozhi-fonts component directory')
     parser.add_argument('--extra_files', help='Path to extra files directory to be included in assets')
+    parser.add_argument('--choreography', help='Path to the JSON motor routines compiled into choreography.bin')
     
     args = parser.parse_args()
     
@@ -859,7 +881,7 @@ def main():
         print(f"  wake word threshold: {custom_wake_word_config['threshold']}")
     
     # Check if we have anything to build
-    if not wakenet_model_paths and not multinet_model_paths and not text_font_path and not emoji_collection_path and not extra_files_path and not multinet_model_info:
+    if not wakenet_model_paths and not multinet_model_paths and not text_font_path and not emoji_collection_path and not extra_files_path and not multinet_model_info and not args.choreography:
         print("Warning: No assets to build (no SR models, text font, emoji collection, extra files, or custom wake word)")
         # Create an empty assets.bin file
         os.makedirs(os.path.dirname(args.output), exist_ok=True)
@@ -870,7 +892,7 @@ def main():
     
     # Build the assets
     success = build_assets_integrated(wakenet_model_paths, multinet_model_paths, text_font_path, emoji_collection_path, 
-                                     extra_files_path, args.output, multinet_model_info)
+                                     extra_files_path, args.output, multinet_model_info, args.choreography)
     
     if not success:
         sys.exit(1)
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Compile JSON motor routines into the binary choreography format (see main/choreography.h)
+
+Routine file:
+    {
+        "version": 1,
+        "routines": {
+            "dance": [
+                {"move": "forward", "speed": 100, "ms": 300, "easing": "smooth"},
+                {"move": "pause", "ms": 50},
+                ...
+            ]
+        }
+    }
+
+    move:   pause, right, backward, left, forward
+    speed:  0-100 percent (default 100), scaled by the speed the routine is played at
+    ms:     1-65535
+    easing: default, linear, smooth, step (default: the firmware's configured ramp profile)
+
+Usage:
+    ./choreography_compiler.py routines.json --output choreography.bin
+    ./choreography_compiler.py routines.json --header main/choreography_builtin.h
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+VERSION = 1
+NAME_SIZE = 16
+MOVES = {"pause": 0, "stop": 0, "right": 1, "backward": 2, "left": 3, "forward": 4}
+EASINGS = {"default": 0, "linear": 1, "smooth": 2, "step": 3}
+
+
+class ChoreographyError(Exception):
+    pass
+
+
+def compile_keyframe(routine_name, index, keyframe):
+    where = f'{routine_name}[{index}]'
+    move = keyframe.get("move")
+    if move not in MOVES:
+        raise ChoreographyError(f'{where}: unknown move "{move}"')
+    direction = MOVES[move]
+
+    speed = keyframe.get("speed", 100) if direction != 0 else 0
+    if not isinstance(speed, int) or not 0 <= speed <= 100:
+        raise ChoreographyError(f'{where}: speed must be 0-100')
+
+    duration = keyframe.get("ms")
+    if not isinstance(duration, int) or not 0 < duration <= 0xFFFF:
+        raise ChoreographyError(f'{where}: ms must be 1-65535')
+
+    easing = keyframe.get("easing", "default")
+    if easing not in EASINGS:
+        raise ChoreographyError(f'{where}: unknown easing "{easing}"')
+
+    return struct.pack('<BBBH', direction, speed, EASINGS[easing], duration)
+
+
+def compile_choreography(source):
+    """Compile a parsed routine file into the binary format"""
+    if source.get("version", VERSION) != VERSION:
+        raise ChoreographyError(f'unsupported version {source.get("version")}')
+    routines = source.get("routines")
+    if not isinstance(routines, dict) or not routines:
+        raise ChoreographyError('"routines" must be a non-empty object')
+    if len(routines) > 0xFF:
+        raise ChoreographyError('too many routines (max 255)')
+
+    table = bytearray()
+    keyframes = bytearray()
+    keyframe_count = 0
+    for name, steps in routines.items():
+        encoded_name = name.encode('utf-8')
+        if not encoded_name or len(encoded_name) >= NAME_SIZE:
+            raise ChoreographyError(f'routine name "{name}" must be 1-{NAME_SIZE - 1} bytes')
+        if not isinstance(steps, list) or not steps:
+            raise ChoreographyError(f'routine "{name}" has no keyframes')
+
+        table += encoded_name.ljust(NAME_SIZE, b'\0')
+        table += struct.pack('<HH', keyframe_count, len(steps))
+        for index, step in enumerate(steps):
+            keyframes += compile_keyframe(name, index, step)
+        keyframe_count += len(steps)
+        if keyframe_count > 0xFFFF:
+            raise ChoreographyError('too many keyframes (max 65535)')
+
+    header = b'CHOR' + struct.pack('<BBH', VERSION, len(routines), keyframe_count)
+    return header + table + keyframes
+
+
+def write_header(data, path, source_name):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ' '.join(f'0x{b:02x},' for b in data[i:i + 16]))
+    with open(path, 'w', encoding='utf-8') as f:
+        f.write(f'// Auto-generated by scripts/choreography_compiler.py from {source_name}, do not edit\n')
+        f.write('#pragma once\n\n')
+        f.write('#include <cstdint>\n\n')
+        f.write('static const uint8_t kBuiltinChoreography[] = {\n')
+        f.write('\n'.join(lines))
+        f.write('\n};\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile JSON motor routines into choreography.bin')
+    parser.add_argument('input', help='JSON routine file')
+    parser.add_argument('--output', help='Binary output (e.g. choreography.bin for the assets partition)')
+    parser.add_argument('--header', help='C header output for the routines built into the firmware')
+    args = parser.parse_args()
+
+    if not args.output and not args.header:
+        parser.error('nothing to do, give --output and/or --header')
+
+    with open(args.input, 'r', encoding='utf-8') as f:
+        source = json.load(f)
+
+    try:
+        data = compile_choreography(source)
+    except ChoreographyError as e:
+        print(f'Error: {args.input}: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    if args.output:
+        with open(args.output, 'wb') as f:
+            f.write(data)
+    if args.header:
+        write_header(data, args.header, os.path.basename(args.input))
+    print(f'Compiled {len(source["routines"])} routines into {len(data)} bytes')
+
+
+if __name__ == '__main__':
+    main()
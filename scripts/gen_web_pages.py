@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""
+Compress the web UI pages (main/web_server/pages) into a C header at build time
+
+Each page is gzipped once here, so the device serves the compressed bytes straight from
+flash with Content-Encoding: gzip, and tags it with an ETag derived from the page source,
+which lets browsers revalidate with If-None-Match instead of downloading it again.
+
+Usage:
+    ./gen_web_pages.py --output web_pages.h main/web_server/pages/index.html main/web_server/pages/config.html
+
+    index.html -> kWebPageIndex, config.html -> kWebPageConfig
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+
+
+def symbol_name(path):
+    stem = os.path.splitext(os.path.basename(path))[0]
+    return ''.join(part.capitalize() for part in stem.replace('-', '_').split('_'))
+
+
+def write_header(pages, path):
+    with open(path, 'w', encoding='utf-8') as f:
+        f.write('// Auto-generated by scripts/gen_web_pages.py, do not edit\n')
+        f.write('#pragma once\n\n')
+        f.write('#include <cstddef>\n')
+        f.write('#include <cstdint>\n\n')
+        f.write('struct WebPage {\n')
+        f.write('    const char* etag;        // Quoted, as sent in the ETag header\n')
+        f.write('    const uint8_t* data;     // gzip\n')
+        f.write('    size_t size;\n')
+        f.write('    size_t raw_size;         // Before compression\n')
+        f.write('};\n')
+        for name, raw, compressed, etag in pages:
+            lines = []
+            for i in range(0, len(compressed), 16):
+                lines.append('    ' + ' '.join(f'0x{b:02x},' for b in compressed[i:i + 16]))
+            f.write(f'\nstatic const uint8_t kWebPage{name}Data[] = {{\n')
+            f.write('\n'.join(lines))
+            f.write('\n};\n')
+            f.write(f'static const WebPage kWebPage{name} = {{"\\"{etag}\\"", kWebPage{name}Data, '
+                    f'sizeof(kWebPage{name}Data), {len(raw)}}};\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compress web UI pages into a C header')
+    parser.add_argument('pages', nargs='+', help='HTML files')
+    parser.add_argument('--output', required=True, help='C header output')
+    args = parser.parse_args()
+
+    pages = []
+    for path in args.pages:
+        with open(path, 'rb') as f:
+            raw = f.read()
+        # mtime=0 keeps the output reproducible, so unchanged pages keep their bytes and ETag
+        compressed = gzip.compress(raw, compresslevel=9, mtime=0)
+        etag = hashlib.sha1(raw).hexdigest()[:16]
+        pages.append((symbol_name(path), raw, compressed, etag))
+        print(f'{os.path.basename(path)}: {len(raw)} -> {len(compressed)} bytes gzip, etag {etag}')
+
+    write_header(pages, args.output)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,574 @@
+// Joystick command path load test (user-044)
+//
+// Compares, over loopback TCP, the old path (one HTTP/1.1 keep-alive POST to /api/control
+// per pointer move) with the /ws/control channel. The HTTP side is a model of what httpd
+// and the old handler do per request: walk Chrome-size headers, read a Content-Length JSON
+// body and answer with the CORS response. The websocket side unmasks client frames and
+// feeds them to the real ControlChannel, whose acks go back the way WebServer sends them.
+//
+// Scenarios:
+//  - flood: as many commands as the channel takes in 3 s
+//  - drag: pointer events at 60 or 240 Hz for 5 s; like the old page, the HTTP client
+//    drops moves while a request is outstanding
+// both on plain loopback and behind an 8 ms one-way delay proxy standing in for Wi-Fi.
+//
+// Latency is measured at the client, from a pointer event to the first response or ack
+// covering it. Server CPU counts the threads that receive and answer commands; the
+// ControlChannel tick runs on the esp_timer thread, at most once per tick, and is left out.
+#include "control_channel.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CONTROL_TICK_MS 10
+#define MAX_EVENTS 65536
+
+using namespace std::chrono;
+
+static int64_t NowUs() {
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t ThreadCpuUs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static std::atomic<int64_t> g_server_cpu_us{0};
+static std::atomic<int> g_received{0};
+static std::atomic<int> g_applied{0};
+// Client side: time the first response or ack covering each event arrived
+static std::vector<int64_t> g_covered_at(MAX_EVENTS, 0);
+static int g_last_covered = -1;
+
+static void Reset() {
+    g_server_cpu_us = 0;
+    g_received = 0;
+    g_applied = 0;
+    g_last_covered = -1;
+    std::fill(g_covered_at.begin(), g_covered_at.end(), 0);
+}
+
+// A response or ack for event `value` covers it and every older event
+static void Covered(int value) {
+    int64_t now = NowUs();
+    for (int v = g_last_covered + 1; v <= value && v < MAX_EVENTS; v++) {
+        g_covered_at[v] = now;
+    }
+    g_last_covered = std::max(g_last_covered, value);
+}
+
+static int Listen(int& port) {
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(s, (sockaddr*)&addr, sizeof(addr));
+    listen(s, 4);
+    socklen_t len = sizeof(addr);
+    getsockname(s, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    return s;
+}
+
+static int Accept(int listen_fd) {
+    int s = accept(listen_fd, nullptr, nullptr);
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return s;
+}
+
+static int Connect(int port) {
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    connect(s, (sockaddr*)&addr, sizeof(addr));
+    return s;
+}
+
+static bool ReadAll(int s, void* buffer, size_t size) {
+    size_t got = 0;
+    while (got < size) {
+        ssize_t r = recv(s, (char*)buffer + got, size - got, 0);
+        if (r <= 0) {
+            return false;
+        }
+        got += r;
+    }
+    return true;
+}
+
+// One-way delay proxy (netem is not available everywhere)
+static int g_delay_us = 0;
+
+static void Pump(int from, int to) {
+    struct Chunk {
+        int64_t due_us;
+        std::string data;
+    };
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Chunk> chunks;
+    bool eof = false;
+    std::thread writer([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&]() { return !chunks.empty() || eof; });
+            if (chunks.empty()) {
+                break;
+            }
+            Chunk chunk = std::move(chunks.front());
+            chunks.erase(chunks.begin());
+            lock.unlock();
+            int64_t wait_us = chunk.due_us - NowUs();
+            if (wait_us > 0) {
+                std::this_thread::sleep_for(microseconds(wait_us));
+            }
+            send(to, chunk.data.data(), chunk.data.size(), MSG_NOSIGNAL);
+            lock.lock();
+        }
+        shutdown(to, SHUT_WR);
+    });
+    char buffer[4096];
+    while (true) {
+        ssize_t r = recv(from, buffer, sizeof(buffer), 0);
+        if (r <= 0) {
+            break;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.push_back({NowUs() + g_delay_us, std::string(buffer, r)});
+        cv.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        eof = true;
+        cv.notify_one();
+    }
+    writer.join();
+}
+
+static int ConnectThroughLink(int port) {
+    if (g_delay_us == 0) {
+        return Connect(port);
+    }
+    int proxy_port;
+    int proxy_listen = Listen(proxy_port);
+    std::thread([proxy_listen, port]() {
+        int a = Accept(proxy_listen);
+        close(proxy_listen);
+        int b = Connect(port);
+        std::thread up(Pump, a, b);
+        Pump(b, a);
+        up.join();
+        close(a);
+        close(b);
+    }).detach();
+    return Connect(proxy_port);
+}
+
+// ---- Old path: HTTP/1.1 keep-alive POST /api/control
+
+static void HttpServer(int listen_fd) {
+    int c = Accept(listen_fd);
+    char buffer[2048 + 512];
+    while (true) {
+        size_t len = 0;
+        char* end = nullptr;
+        while (end == nullptr) {
+            ssize_t r = recv(c, buffer + len, sizeof(buffer) - 1 - len, 0);
+            if (r <= 0) {
+                close(c);
+                return;
+            }
+            len += r;
+            buffer[len] = 0;
+            end = strstr(buffer, "\r\n\r\n");
+        }
+        int64_t start = ThreadCpuUs();
+        // httpd walks every header line
+        int content_length = 0;
+        char* line = strstr(buffer, "\r\n") + 2;
+        while (line < end) {
+            char* next = strstr(line, "\r\n");
+            char* colon = (char*)memchr(line, ':', next - line);
+            if (colon != nullptr && strncasecmp(line, "Content-Length", colon - line) == 0) {
+                content_length = atoi(colon + 1);
+            }
+            line = next + 2;
+        }
+        char* body = end + 4;
+        size_t have = len - (body - buffer);
+        while ((int)have < content_length) {
+            ssize_t r = recv(c, body + have, content_length - have, 0);
+            if (r <= 0) {
+                close(c);
+                return;
+            }
+            have += r;
+        }
+        char content[200];
+        int n = std::min(content_length, 199);
+        memcpy(content, body, n);
+        content[n] = 0;
+        // Stands in for cJSON_Parse, which also allocates a node per item, so this
+        // understates the old cost
+        int value = atoi(strstr(content, "\"value\":") + 8);
+        g_received++;
+        g_applied++;
+        char response[256];
+        int response_len = snprintf(response, sizeof(response),
+            "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\n"
+            "Access-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+            "Access-Control-Allow-Headers: Content-Type\r\n\r\n{\"value\":%05d}", 15, value);
+        send(c, response, response_len, 0);
+        g_server_cpu_us += ThreadCpuUs() - start;
+    }
+}
+
+static std::string HttpRequest(int value) {
+    char body[64];
+    // The old page sends direction and speed; value stands for the event index
+    int n = snprintf(body, sizeof(body), "{\"direction\":4,\"speed\":80,\"value\":%d}", value);
+    std::string request = "POST /api/control HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: keep-alive\r\n"
+        "Content-Length: " + std::to_string(n) + "\r\n"
+        "sec-ch-ua-platform: \"Android\"\r\n"
+        "User-Agent: Mozilla/5.0 (Linux; Android 14; Pixel 7) AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/129.0.0.0 Mobile Safari/537.36\r\n"
+        "sec-ch-ua: \"Google Chrome\";v=\"129\", \"Not=A?Brand\";v=\"8\", \"Chromium\";v=\"129\"\r\n"
+        "Content-Type: application/json\r\nsec-ch-ua-mobile: ?1\r\nAccept: */*\r\n"
+        "Origin: http://192.168.4.1\r\nReferer: http://192.168.4.1/\r\nAccept-Encoding: gzip, deflate\r\n"
+        "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n\r\n";
+    return request + body;
+}
+
+static bool HttpRoundTrip(int s, int value) {
+    std::string request = HttpRequest(value);
+    send(s, request.data(), request.size(), 0);
+    char buffer[512];
+    size_t len = 0;
+    while (true) {
+        ssize_t r = recv(s, buffer + len, sizeof(buffer) - len, 0);
+        if (r <= 0) {
+            return false;
+        }
+        len += r;
+        char* end = (char*)memmem(buffer, len, "\r\n\r\n", 4);
+        if (end != nullptr && len >= (size_t)(end + 4 - buffer) + 15) {
+            Covered(atoi(end + 4 + 9));
+            return true;
+        }
+    }
+}
+
+// ---- New path: masked binary frames into ControlChannel, acks back
+
+class WsServer {
+public:
+    explicit WsServer(int listen_fd)
+        : channel_(CONTROL_TICK_MS,
+              [](int direction, int speed) { g_applied++; },
+              [this]() {
+                  // httpd_queue_work: the ack is read and sent later on the server task
+                  std::lock_guard<std::mutex> lock(ack_mutex_);
+                  acks_queued_++;
+                  ack_cv_.notify_one();
+              }) {
+        fd_ = Accept(listen_fd);
+        reader_ = std::thread([this]() { Read(); });
+        sender_ = std::thread([this]() { SendAcks(); });
+    }
+
+    ~WsServer() {
+        reader_.join();
+        {
+            std::lock_guard<std::mutex> lock(ack_mutex_);
+            quit_ = true;
+            ack_cv_.notify_one();
+        }
+        sender_.join();
+        close(fd_);
+    }
+
+private:
+    ControlChannel channel_;
+    int fd_;
+    std::mutex ack_mutex_;
+    std::condition_variable ack_cv_;
+    int acks_queued_ = 0;
+    bool quit_ = false;
+    std::thread reader_;
+    std::thread sender_;
+
+    void Read() {
+        uint8_t header[2];
+        while (ReadAll(fd_, header, sizeof(header))) {
+            int64_t start = ThreadCpuUs();
+            size_t len = header[1] & 0x7F;
+            uint8_t mask[4], payload[8];
+            if (!ReadAll(fd_, mask, sizeof(mask)) || len > sizeof(payload) || !ReadAll(fd_, payload, len)) {
+                break;
+            }
+            for (size_t i = 0; i < len; i++) {
+                payload[i] ^= mask[i & 3];
+            }
+            g_received++;
+            channel_.OnFrame(fd_, payload, len);
+            g_server_cpu_us += ThreadCpuUs() - start;
+        }
+        channel_.OnClose(fd_);
+    }
+
+    void SendAcks() {
+        std::unique_lock<std::mutex> lock(ack_mutex_);
+        while (true) {
+            ack_cv_.wait(lock, [this]() { return acks_queued_ > 0 || quit_; });
+            if (quit_) {
+                break;
+            }
+            acks_queued_--;
+            lock.unlock();
+            int64_t start = ThreadCpuUs();
+            uint8_t frame[6] = {0x82, 4};
+            if (channel_.GetAck(frame + 2) >= 0) {
+                send(fd_, frame, sizeof(frame), MSG_NOSIGNAL);
+            }
+            g_server_cpu_us += ThreadCpuUs() - start;
+            lock.lock();
+        }
+    }
+};
+
+// Speeds vary between events so every applied move reaches the motor callback
+static void WsSend(int s, int value) {
+    uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    uint8_t payload[4] = {(uint8_t)(value & 0xFF), (uint8_t)(value >> 8), 4, (uint8_t)(50 + value % 50)};
+    uint8_t frame[10] = {0x82, 0x80 | 4, mask[0], mask[1], mask[2], mask[3]};
+    for (int i = 0; i < 4; i++) {
+        frame[6 + i] = payload[i] ^ mask[i];
+    }
+    send(s, frame, sizeof(frame), 0);
+}
+
+static std::thread ReadWsAcks(int s) {
+    return std::thread([s]() {
+        uint8_t frame[6];
+        while (ReadAll(s, frame, sizeof(frame))) {
+            Covered(frame[2] | (frame[3] << 8));
+        }
+    });
+}
+
+// ---- Scenarios
+
+struct Result {
+    double received_per_s;
+    double applied_per_s;
+    double cpu_per_command_us;
+    double p50_ms, p99_ms, max_ms;
+};
+
+static Result MakeResult(double seconds, int events, const std::vector<int64_t>& event_at) {
+    Result result{g_received / seconds, g_applied / seconds,
+        g_received > 0 ? (double)g_server_cpu_us / g_received : 0, 0, 0, 0};
+    std::vector<double> latencies;
+    for (int i = 0; i < events; i++) {
+        if (g_covered_at[i] != 0) {
+            latencies.push_back((g_covered_at[i] - event_at[i]) / 1000.0);
+        }
+    }
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.p50_ms = latencies[latencies.size() / 2];
+        result.p99_ms = latencies[latencies.size() * 99 / 100];
+        result.max_ms = latencies.back();
+    }
+    return result;
+}
+
+// Pointer events at a fixed rate; calls send(i) for each and records when it happened
+template <typename Send>
+static std::vector<int64_t> Drag(int hz, int events, Send&& send) {
+    std::vector<int64_t> event_at(events);
+    int64_t start = NowUs();
+    for (int i = 0; i < events; i++) {
+        int64_t at = start + (int64_t)i * 1000000 / hz;
+        while (NowUs() < at) {
+            std::this_thread::sleep_for(microseconds(200));
+        }
+        event_at[i] = NowUs();
+        send(i);
+    }
+    std::this_thread::sleep_for(milliseconds(200));
+    return event_at;
+}
+
+static Result DragHttp(int hz, double seconds) {
+    Reset();
+    int port;
+    int listen_fd = Listen(port);
+    std::thread server(HttpServer, listen_fd);
+    int s = ConnectThroughLink(port);
+
+    // The old page skips moves while a request is outstanding
+    std::mutex mutex;
+    std::condition_variable cv;
+    int to_send = -1;
+    bool done = false;
+    std::atomic<bool> outstanding{false};
+    std::thread fetcher([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&]() { return to_send >= 0 || done; });
+            if (to_send < 0) {
+                break;
+            }
+            int value = to_send;
+            to_send = -1;
+            lock.unlock();
+            HttpRoundTrip(s, value);
+            outstanding = false;
+            lock.lock();
+        }
+    });
+
+    int events = hz * seconds;
+    int64_t start = NowUs();
+    auto event_at = Drag(hz, events, [&](int i) {
+        if (!outstanding) {
+            outstanding = true;
+            std::lock_guard<std::mutex> lock(mutex);
+            to_send = i;
+            cv.notify_one();
+        }
+    });
+    double elapsed = (NowUs() - start) / 1e6;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_one();
+    }
+    fetcher.join();
+    shutdown(s, SHUT_RDWR);
+    close(s);
+    server.join();
+    close(listen_fd);
+    return MakeResult(elapsed, events, event_at);
+}
+
+static Result DragWs(int hz, double seconds) {
+    Reset();
+    int port;
+    int listen_fd = Listen(port);
+    int s = ConnectThroughLink(port);
+    Result result;
+    {
+        WsServer server(listen_fd);
+        std::thread acks = ReadWsAcks(s);
+        int events = hz * seconds;
+        int64_t start = NowUs();
+        auto event_at = Drag(hz, events, [s](int i) { WsSend(s, i); });
+        double elapsed = (NowUs() - start) / 1e6;
+        shutdown(s, SHUT_RDWR);
+        acks.join();
+        result = MakeResult(elapsed, events, event_at);
+    }
+    close(s);
+    close(listen_fd);
+    return result;
+}
+
+static Result FloodHttp(double seconds) {
+    Reset();
+    int port;
+    int listen_fd = Listen(port);
+    std::thread server(HttpServer, listen_fd);
+    int s = ConnectThroughLink(port);
+    int64_t start = NowUs();
+    int64_t end = start + seconds * 1e6;
+    for (int i = 0; NowUs() < end; i++) {
+        HttpRoundTrip(s, i % 60000);
+    }
+    double elapsed = (NowUs() - start) / 1e6;
+    shutdown(s, SHUT_RDWR);
+    close(s);
+    server.join();
+    close(listen_fd);
+    return MakeResult(elapsed, 0, {});
+}
+
+static Result FloodWs(double seconds) {
+    Reset();
+    int port;
+    int listen_fd = Listen(port);
+    int s = ConnectThroughLink(port);
+    Result result;
+    {
+        WsServer server(listen_fd);
+        std::thread acks = ReadWsAcks(s);
+        int64_t start = NowUs();
+        int64_t end = start + seconds * 1e6;
+        for (int i = 0; NowUs() < end; i++) {
+            WsSend(s, i % 60000);
+            if ((i & 63) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        std::this_thread::sleep_for(milliseconds(100));
+        double elapsed = (NowUs() - start) / 1e6;
+        shutdown(s, SHUT_RDWR);
+        acks.join();
+        result = MakeResult(elapsed, 0, {});
+    }
+    close(s);
+    close(listen_fd);
+    return result;
+}
+
+static void Print(const char* name, const Result& r) {
+    printf("%-16s %9.0f cmd/s in %7.0f applied/s %6.2f us cpu/cmd", name, r.received_per_s, r.applied_per_s,
+        r.cpu_per_command_us);
+    if (r.max_ms > 0) {
+        printf("   latency p50 %6.2f p99 %6.2f max %6.2f ms", r.p50_ms, r.p99_ms, r.max_ms);
+    }
+    printf("\n");
+}
+
+int main() {
+    printf("-- loopback --\n");
+    Print("flood http", FloodHttp(3));
+    Print("flood ws", FloodWs(3));
+    Print("drag 60Hz http", DragHttp(60, 5));
+    Print("drag 60Hz ws", DragWs(60, 5));
+    Print("drag 240Hz http", DragHttp(240, 5));
+    Print("drag 240Hz ws", DragWs(240, 5));
+
+    g_delay_us = 8000;
+    printf("-- 8 ms one-way link delay --\n");
+    Print("flood http", FloodHttp(3));
+    Print("flood ws", FloodWs(3));
+    Print("drag 60Hz http", DragHttp(60, 5));
+    Print("drag 60Hz ws", DragWs(60, 5));
+    return 0;
+}
@@ -0,0 +1,260 @@
+// The emotion string chains replaced by the emotion table in the user-041 commit, kept as
+// the reference for emotion_table_test.cc. Logging is stripped; the mappings are unchanged:
+// OldMotor from Application's "llm" handler, OldEyes from RoboEyesAdapter::SetEmotion and
+// OldBoard from the qebabe-xiaoche HandleMotorActionForEmotion.
+#include "emotion_reference.h"
+
+#include <cstring>
+#include <string>
+
+int OldMotor(const std::string& emotion_str) {
+    int motor_cmd = 0;
+
+    // 支持情绪文本和 emoji 字符两种情况 - 与眼睛表情完全对应
+    if (emotion_str == "smile") {
+        // smile -> happy
+        motor_cmd = 1;
+    } else if (emotion_str == "laugh") {
+        // laugh -> laughing
+        motor_cmd = 3;
+    } else if (emotion_str == "cry") {
+        // cry -> crying
+        motor_cmd = 2;
+    } else if (emotion_str == "wink") {
+        // wink -> winking
+        motor_cmd = 3;
+    } else if (emotion_str == "😶" || emotion_str == "neutral") {
+        // 1. 😶 - neutral
+        motor_cmd = 0;
+    } else if (emotion_str == "🙂" || emotion_str == "happy") {
+        // 2. 🙂 - happy
+        motor_cmd = 1;
+    } else if (emotion_str == "😆" || emotion_str == "laughing") {
+        // 3. 😆 - laughing
+        motor_cmd = 3;
+    } else if (emotion_str == "😂" || emotion_str == "funny") {
+        // 4. 😂 - funny
+        motor_cmd = 3;
+    } else if (emotion_str == "😔" || emotion_str == "sad") {
+        // 5. 😔 - sad
+        motor_cmd = 2;
+    } else if (emotion_str == "😠" || emotion_str == "angry") {
+        // 6. 😠 - angry
+        motor_cmd = 6;
+    } else if (emotion_str == "😭" || emotion_str == "crying") {
+        // 7. 😭 - crying
+        motor_cmd = 2;
+    } else if (emotion_str == "😍" || emotion_str == "loving") {
+        // 8. 😍 - loving
+        motor_cmd = 4;
+    } else if (emotion_str == "😳" || emotion_str == "embarrassed") {
+        // 9. 😳 - embarrassed
+        motor_cmd = 5;
+    } else if (emotion_str == "😲" || emotion_str == "surprised") {
+        // 10. 😲 - surprised
+        motor_cmd = 6;
+    } else if (emotion_str == "😱" || emotion_str == "shocked") {
+        // 11. 😱 - shocked
+        motor_cmd = 6;
+    } else if (emotion_str == "🤔" || emotion_str == "thinking") {
+        // 12. 🤔 - thinking
+        motor_cmd = 5;
+    } else if (emotion_str == "😉" || emotion_str == "winking") {
+        // 13. 😉 - winking
+        motor_cmd = 3;
+    } else if (emotion_str == "😎" || emotion_str == "cool") {
+        // 14. 😎 - cool
+        motor_cmd = 1;
+    } else if (emotion_str == "😌" || emotion_str == "relaxed") {
+        // 15. 😌 - relaxed
+        motor_cmd = 1;
+    } else if (emotion_str == "🤤" || emotion_str == "delicious") {
+        // 16. 🤤 - delicious
+        motor_cmd = 1;
+    } else if (emotion_str == "😘" || emotion_str == "kissy") {
+        // 17. 😘 - kissy
+        motor_cmd = 4;
+    } else if (emotion_str == "😏" || emotion_str == "confident") {
+        // 18. 😏 - confident
+        motor_cmd = 1;
+    } else if (emotion_str == "😴" || emotion_str == "sleepy") {
+        // 19. 😴 - sleepy
+        motor_cmd = 0;
+    } else if (emotion_str == "😜" || emotion_str == "silly") {
+        // 20. 😜 - silly
+        motor_cmd = 3;
+    } else if (emotion_str == "🙄" || emotion_str == "confused") {
+        // 21. 🙄 - confused
+        motor_cmd = 5;
+    } else {
+        // 如果 emotion 字段是原生 emoji 字符（例如 "😊"）但未覆盖上面分支，可在这里做更多指定
+        motor_cmd = 0;
+    }
+    return motor_cmd;
+}
+
+void OldEyes(const char* emotion, Eyes* eyes_ptr) {
+    // Exact emoji and emotion mapping based on user's list
+    // Handle English verb forms that might come from LLM emotion field
+    if (strcmp(emotion, "smile") == 0) {
+        // smile -> happy
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "laugh") == 0) {
+        // laugh -> laughing
+        eyes_ptr->anim_laugh();
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "cry") == 0) {
+        // cry -> crying
+        eyes_ptr->setMood(TIRED);
+        eyes_ptr->setSweat(true);
+    } else if (strcmp(emotion, "wink") == 0) {
+        // wink -> winking
+        eyes_ptr->anim_laugh();
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "😶") == 0 || strcmp(emotion, "neutral") == 0) {
+        // 1. 😶 - neutral
+        eyes_ptr->setMood(DEFAULT);
+        eyes_ptr->setIdleMode(true, 2, 4);  // Moderate idle movement
+    } else if (strcmp(emotion, "🙂") == 0 || strcmp(emotion, "happy") == 0) {
+        // 2. 🙂 - happy (animated)
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setIdleMode(true, 1, 6);  // Gentle happy movement
+    } else if (strcmp(emotion, "😆") == 0 || strcmp(emotion, "laughing") == 0) {
+        // 3. 😆 - laughing
+        eyes_ptr->anim_laugh();
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "😂") == 0 || strcmp(emotion, "funny") == 0) {
+        // 4. 😂 - funny
+        eyes_ptr->anim_laugh();
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "😔") == 0 || strcmp(emotion, "sad") == 0) {
+        // 5. 😔 - sad (animated with slow movement)
+        eyes_ptr->setMood(TIRED);
+        eyes_ptr->setIdleMode(true, 1, 8);  // Very slow, sad movement
+    } else if (strcmp(emotion, "😠") == 0 || strcmp(emotion, "angry") == 0) {
+        // 6. 😠 - angry (animated with aggressive movement)
+        eyes_ptr->setMood(ANGRY);
+        eyes_ptr->setIdleMode(true, 2, 2);  // Quick, angry movement
+    } else if (strcmp(emotion, "😭") == 0 || strcmp(emotion, "crying") == 0) {
+        // 7. 😭 - crying
+        eyes_ptr->setMood(TIRED);
+        eyes_ptr->setSweat(true);
+        eyes_ptr->setIdleMode(true, 1, 5);  // Slow crying movement
+    } else if (strcmp(emotion, "😍") == 0 || strcmp(emotion, "loving") == 0) {
+        // 8. 😍 - loving (animated with heart eyes effect)
+        eyes_ptr->setMood(LOVING);
+        eyes_ptr->setIdleMode(true, 1, 7);  // Gentle loving movement
+    } else if (strcmp(emotion, "😳") == 0 || strcmp(emotion, "embarrassed") == 0) {
+        // 9. 😳 - embarrassed
+        eyes_ptr->setIdleMode(true, 2, 2);  // Frequent idle movement for embarrassment
+        eyes_ptr->setMood(DEFAULT);
+    } else if (strcmp(emotion, "😲") == 0 || strcmp(emotion, "surprised") == 0) {
+        // 10. 😲 - surprised (animated with shocked movement)
+        eyes_ptr->setMood(SURPRISED);
+        eyes_ptr->setIdleMode(true, 2, 1);  // Quick, surprised movement
+    } else if (strcmp(emotion, "😱") == 0 || strcmp(emotion, "shocked") == 0) {
+        // 11. 😱 - shocked
+        eyes_ptr->anim_confused();
+        eyes_ptr->setMood(DEFAULT);
+    } else if (strcmp(emotion, "🤔") == 0 || strcmp(emotion, "thinking") == 0) {
+        // 12. 🤔 - thinking
+        eyes_ptr->setIdleMode(true, 2, 2);  // Looking around while thinking
+        eyes_ptr->setMood(DEFAULT);
+    } else if (strcmp(emotion, "😉") == 0 || strcmp(emotion, "winking") == 0) {
+        // 13. 😉 - winking
+        eyes_ptr->anim_laugh();
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "😎") == 0 || strcmp(emotion, "cool") == 0) {
+        // 14. 😎 - cool (animated with sunglasses vibe)
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setIdleMode(true, 1, 10);  // Very slow, cool movement
+    } else if (strcmp(emotion, "😌") == 0 || strcmp(emotion, "relaxed") == 0) {
+        // 15. 😌 - relaxed (animated with calm movement)
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setIdleMode(true, 1, 12);  // Extremely slow, relaxed movement
+    } else if (strcmp(emotion, "🤤") == 0 || strcmp(emotion, "delicious") == 0) {
+        // 16. 🤤 - delicious (animated with drooling effect)
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setIdleMode(true, 1, 8);  // Slow, savoring movement
+    } else if (strcmp(emotion, "😘") == 0 || strcmp(emotion, "kissy") == 0) {
+        // 17. 😘 - kissy
+        eyes_ptr->setMood(LOVING);
+        eyes_ptr->setIdleMode(true, 2, 3);  // Playful kissy movement
+    } else if (strcmp(emotion, "😏") == 0 || strcmp(emotion, "confident") == 0) {
+        // 18. 😏 - confident (animated with knowing movement)
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setIdleMode(true, 1, 9);  // Slow, confident movement
+    } else if (strcmp(emotion, "😴") == 0 || strcmp(emotion, "sleepy") == 0) {
+        // 19. 😴 - sleepy
+        eyes_ptr->setMood(SLEEPY);
+    } else if (strcmp(emotion, "😜") == 0 || strcmp(emotion, "silly") == 0) {
+        // 20. 😜 - silly
+        eyes_ptr->anim_laugh();
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "🙄") == 0 || strcmp(emotion, "confused") == 0) {
+        // 21. 🙄 - confused
+        eyes_ptr->setIdleMode(true, 3, 1);  // More frequent movement for confusion
+        eyes_ptr->setMood(DEFAULT);
+    } else if (strcmp(emotion, "wake") == 0) {
+        // 22. wake - waking up (animated sleepy to awake transition)
+        eyes_ptr->setMood(SLEEPY);
+        eyes_ptr->setIdleMode(true, 2, 3);  // Waking up movement
+    } else if (strcmp(emotion, "listening") == 0) {
+        // 23. listening - focused listening (use confident expression)
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setIdleMode(true, 1, 4);  // Slow, focused movement
+    } else if (strcmp(emotion, "speaking") == 0) {
+        // 24. speaking - talking (use wink animation)
+        eyes_ptr->anim_laugh();  // wink-like animation
+        eyes_ptr->setMood(HAPPY);
+    } else if (strcmp(emotion, "excited") == 0) {
+        // 25. excited - excited (use excited jumping animation)
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setVFlicker(true, 8);  // Excited jumping up and down
+        eyes_ptr->setIdleMode(true, 1, 2);  // Quick random movements
+    } else if (strcmp(emotion, "twinkle") == 0) {
+        // 26. twinkle - magical twinkling effect
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setHFlicker(true, 3);  // Gentle twinkling left-right
+        eyes_ptr->setVFlicker(true, 3);  // Gentle twinkling up-down
+    } else if (strcmp(emotion, "bounce") == 0) {
+        // 27. bounce - bouncy playful animation
+        eyes_ptr->setMood(HAPPY);
+        eyes_ptr->setVFlicker(true, 12);  // Big bouncy movements
+        eyes_ptr->setIdleMode(true, 1, 1);  // Very frequent position changes
+    } else {
+        // Default to neutral for unknown emotions
+        eyes_ptr->setMood(DEFAULT);
+        eyes_ptr->setIdleMode(true, 2, 4);  // Moderate idle movement
+    }
+}
+
+int OldBoard(const char* emotion, Board* board) {
+    board->g = 0;
+    std::string emotion_str(emotion);
+    if (emotion_str == "happy" || emotion_str == "joy") {
+        board->OnHappy();
+    } else if (emotion_str == "excited") {
+        board->OnExcited();
+    } else if (emotion_str == "sad" || emotion_str == "unhappy") {
+        board->OnSad();
+    } else if (emotion_str == "thinking") {
+        board->OnThinking();
+    } else if (emotion_str == "confused") {
+        board->OnConfused();
+    } else if (emotion_str == "listening" || emotion_str == "curious") {
+        board->OnListening();
+    } else if (emotion_str == "speaking" || emotion_str == "talking") {
+        board->OnSpeaking();
+    } else if (emotion_str == "wake" || emotion_str == "wakeup") {
+        board->OnWakeUp();
+    } else if (emotion_str == "loving") {
+        board->OnLoving();
+    } else if (emotion_str == "angry") {
+        board->OnAngry();
+    } else if (emotion_str == "surprised") {
+        board->OnSurprised();
+    }
+
+    return board->g;
+}
@@ -0,0 +1,58 @@
+// Recording stand-ins for RoboEyes and the qebabe-xiaoche board, and the pre-table emotion
+// chains in emotion_reference.cc
+#pragma once
+
+#include <string>
+
+// RoboEyes mood defines
+enum { DEFAULT, TIRED, ANGRY, HAPPY, SURPRISED, SLEEPY, EVIL, LOVING };
+
+struct Eyes {
+    int mood = -1;
+    int animation = 0;
+    bool sweat = false;
+    bool idle = false;
+    int idle_interval = 0;
+    int idle_variation = 0;
+    int hflicker = 0;
+    int vflicker = 0;
+
+    void setMood(int m) { mood = m; }
+    void anim_laugh() { animation = 1; }
+    void anim_confused() { animation = 2; }
+    void setSweat(bool on) { sweat = on; }
+    void setCuriosity(bool) {}
+    void setIdleMode(bool on, int interval = 0, int variation = 0) {
+        idle = on;
+        idle_interval = on ? interval : 0;
+        idle_variation = on ? variation : 0;
+    }
+    void setHFlicker(bool on, int amplitude = 0) { hflicker = on ? amplitude : 0; }
+    void setVFlicker(bool on, int amplitude = 0) { vflicker = on ? amplitude : 0; }
+
+    bool operator==(const Eyes& o) const {
+        return mood == o.mood && animation == o.animation && sweat == o.sweat && idle == o.idle &&
+               idle_interval == o.idle_interval && idle_variation == o.idle_variation &&
+               hflicker == o.hflicker && vflicker == o.vflicker;
+    }
+};
+
+// Records the gesture as its EmotionGesture value
+struct Board {
+    int g = 0;
+    void OnWakeUp() { g = 1; }
+    void OnHappy() { g = 2; }
+    void OnSad() { g = 3; }
+    void OnThinking() { g = 4; }
+    void OnListening() { g = 5; }
+    void OnSpeaking() { g = 6; }
+    void OnExcited() { g = 7; }
+    void OnLoving() { g = 8; }
+    void OnAngry() { g = 9; }
+    void OnSurprised() { g = 10; }
+    void OnConfused() { g = 11; }
+};
+
+int OldMotor(const std::string& emotion_str);
+void OldEyes(const char* emotion, Eyes* eyes_ptr);
+int OldBoard(const char* emotion, Board* board);
@@ -0,0 +1,143 @@
+// Emotion table test and microbenchmark (user-041)
+//
+// Resolves every alias in the table, plus strings that are not in it, and compares the motor
+// type, the RoboEyes reaction and the board gesture with the string chains the table replaced
+// (emotion_reference.cc). The table source is included directly to reach its alias list.
+#include "emotion_reference.h"
+
+#include "emotion_table.cc"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Same steps as RoboEyesAdapter::SetEmotion(EmotionId)
+static void NewEyes(EmotionId id, Eyes* e) {
+    const auto& eyes = GetEmotionInfo(id).eyes;
+    e->setIdleMode(false);
+    e->setCuriosity(false);
+    e->setSweat(false);
+    e->setHFlicker(false);
+    e->setVFlicker(false);
+    if (eyes.animation == kEyesAnimLaugh) {
+        e->anim_laugh();
+    } else if (eyes.animation == kEyesAnimConfused) {
+        e->anim_confused();
+    }
+    e->setMood(eyes.mood);
+    if (eyes.sweat) {
+        e->setSweat(true);
+    }
+    if (eyes.idle_interval > 0) {
+        e->setIdleMode(true, eyes.idle_interval, eyes.idle_variation);
+    }
+    if (eyes.hflicker > 0) {
+        e->setHFlicker(true, eyes.hflicker);
+    }
+    if (eyes.vflicker > 0) {
+        e->setVFlicker(true, eyes.vflicker);
+    }
+}
+
+// Aliases the old motor and eyes chains did not know, but the board chain did
+static bool IsMergedAlias(const std::string& name) {
+    return name == "joy" || name == "unhappy" || name == "wakeup" || name == "curious" || name == "talking";
+}
+
+// The board chain only knew the English names
+static bool IsEmoji(const std::string& name) {
+    return !name.empty() && (unsigned char)name[0] >= 0x80;
+}
+
+int main() {
+    std::vector<std::string> names;
+    for (const auto& alias : kAliases) {
+        names.emplace_back(alias.name);
+    }
+    const size_t alias_count = names.size();
+    for (const char* unknown : {"", "Happy", "happy ", "😊", "unknown", "neutra", "sleepyy", "🙂🙂"}) {
+        names.emplace_back(unknown);
+    }
+
+    int failures = 0, expected_differences = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+        const auto& name = names[i];
+        EmotionId id = ResolveEmotion(name);
+        if ((i < alias_count) != (id != kEmotionUnknown)) {
+            printf("FAIL %-12s resolves to %d\n", name.c_str(), id);
+            failures++;
+            continue;
+        }
+        const auto& info = GetEmotionInfo(id);
+
+        int old_motor = OldMotor(name);
+        Eyes old_eyes, new_eyes;
+        OldEyes(name.c_str(), &old_eyes);
+        NewEyes(id, &new_eyes);
+        Board board;
+        int old_gesture = OldBoard(name.c_str(), &board);
+
+        bool motor_same = old_motor == info.motor;
+        bool eyes_same = old_eyes == new_eyes;
+        bool gesture_same = old_gesture == info.gesture;
+        if (motor_same && eyes_same && gesture_same) {
+            continue;
+        }
+
+        // Aliases merged into one entry now get the whole reaction of the emotion
+        bool expected = false;
+        if (IsMergedAlias(name)) {
+            expected = gesture_same && old_motor == 0;
+        } else if (IsEmoji(name)) {
+            expected = motor_same && eyes_same && old_gesture == kGestureNone;
+        }
+        printf("%s %-12s motor %d -> %d, eyes %s, gesture %d -> %d\n", expected ? "merged" : "FAIL  ",
+            name.c_str(), old_motor, info.motor, eyes_same ? "same" : "differ", old_gesture, info.gesture);
+        if (expected) {
+            expected_differences++;
+        } else {
+            failures++;
+        }
+    }
+    printf("%zu names (%zu aliases), %d merged alias differences, %d failures\n",
+        names.size(), alias_count, expected_differences, failures);
+
+    // Resolve every name: old if-chain / strcmp chain against the table
+    const int rounds = 200000;
+    volatile int sink = 0;
+    double lookups = names.size() * (double)rounds;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const auto& name : names) {
+            sink = sink + OldMotor(name);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const auto& name : names) {
+            sink = sink + GetEmotionInfo(ResolveEmotion(name)).motor;
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    Eyes eyes;
+    for (int r = 0; r < rounds; r++) {
+        for (const auto& name : names) {
+            OldEyes(name.c_str(), &eyes);
+        }
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const auto& name : names) {
+            NewEyes(ResolveEmotion(name), &eyes);
+        }
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    auto ns = [lookups](auto d) { return std::chrono::duration<double, std::nano>(d).count() / lookups; };
+    printf("motor mapping: if-chain %.1f ns, table %.1f ns per lookup\n", ns(t1 - t0), ns(t2 - t1));
+    printf("eyes mapping:  strcmp chain %.1f ns, table %.1f ns per lookup\n", ns(t3 - t2), ns(t4 - t3));
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
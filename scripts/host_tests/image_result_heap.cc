@@ -0,0 +1,151 @@
+// Peak heap of an image tool result on top of the JPEG the camera hands over, up to the
+// framed reply SendMcpMessage sends. "before" keeps a base64 copy in ImageContent and appends it
+// to the reply; "after" is McpTool::Call with the ImageContent in mcp_server.h, which
+// encodes straight into the reply buffer.
+#include "mcp_server.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+static size_t g_current = 0;
+static size_t g_peak = 0;
+
+// Not inlined, so the compiler does not pair these mallocs with deletes at call sites
+__attribute__((noinline)) void* operator new(size_t size) {
+    // Keep the size in front of the block so delete can account for it
+    size_t* block = (size_t*)malloc(size + sizeof(size_t) * 2);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    block[0] = size;
+    g_current += size;
+    if (g_current > g_peak) {
+        g_peak = g_current;
+    }
+    return block + 2;
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    size_t* block = (size_t*)ptr - 2;
+    g_current -= block[0];
+    free(block);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+// ImageContent before the change: the encoded image is a member string
+class EncodedImageContent {
+private:
+    std::string encoded_data_;
+    std::string mime_type_;
+
+public:
+    EncodedImageContent(const std::string& mime_type, const std::string& data) : mime_type_(mime_type) {
+        size_t dlen = 0, olen = 0;
+        mbedtls_base64_encode(nullptr, 0, &dlen, (const unsigned char*)data.data(), data.size());
+        encoded_data_.resize(dlen);
+        mbedtls_base64_encode((unsigned char*)&encoded_data_[0], encoded_data_.size(), &olen,
+            (const unsigned char*)data.data(), data.size());
+        encoded_data_.resize(olen);
+    }
+
+    void AppendJson(std::string& out) const {
+        out += "{\"type\":\"image\",\"mimeType\":\"";
+        out += mime_type_;
+        out += "\",\"data\":\"";
+        out += encoded_data_;
+        out += "\"}";
+    }
+
+    size_t json_size() const { return encoded_data_.size() + mime_type_.size() + 48; }
+};
+
+static std::string MakeJpeg(size_t size) {
+    std::string jpeg(size, 0);
+    for (size_t i = 0; i < size; i++) {
+        jpeg[i] = (char)(i * 2654435761u >> 13);
+    }
+    return jpeg;
+}
+
+// McpServer::RunToolCall's reply header
+static std::string ReplyHeader() {
+    return "{\"jsonrpc\":\"2.0\",\"id\":7,\"result\":";
+}
+
+// Protocol::SendMcpMessage, with a fixed session prefix
+static void SendMcpMessage(std::string payload, std::string& wire) {
+    std::string envelope = "{\"session_id\":\"0123456789abcdef\",\"type\":\"mcp\",\"payload\":";
+    payload.reserve(envelope.size() + payload.size() + 1);
+    payload.insert(0, envelope);
+    payload += "}";
+    wire = std::move(payload);
+}
+
+static size_t RunBefore(size_t jpeg_size, std::string& wire) {
+    std::string jpeg = MakeJpeg(jpeg_size);
+    g_peak = g_current;
+    size_t base = g_current;
+    {
+        std::string payload = ReplyHeader();
+        {
+            auto image_content = new EncodedImageContent("image/jpeg", jpeg);
+            jpeg.clear();
+            jpeg.shrink_to_fit();
+            payload.reserve(payload.size() + image_content->json_size() + 32 + MCP_ENVELOPE_RESERVE);
+            payload += "{\"content\":[";
+            image_content->AppendJson(payload);
+            payload += "],\"isError\":false}";
+            delete image_content;
+        }
+        payload += "}";
+        SendMcpMessage(std::move(payload), wire);
+    }
+    return g_peak - base;
+}
+
+static size_t RunAfter(size_t jpeg_size, std::string& wire) {
+    std::string jpeg = MakeJpeg(jpeg_size);
+    McpTool tool("self.camera.take_photo", "", PropertyList(), [&jpeg](const PropertyList&) -> ReturnValue {
+        return new ImageContent("image/jpeg", std::move(jpeg));
+    });
+    g_peak = g_current;
+    size_t base = g_current;
+    {
+        std::string payload = ReplyHeader();
+        tool.Call(PropertyList(), payload);
+        payload += "}";
+        SendMcpMessage(std::move(payload), wire);
+    }
+    return g_peak - base;
+}
+
+int main() {
+    bool ok = true;
+    printf("%10s %12s %12s %12s %8s\n", "jpeg", "wire", "peak before", "peak after", "saved");
+    for (size_t jpeg_size : {1000, 12 * 1024, 48 * 1024, 96 * 1024}) {
+        std::string wire_before, wire_after;
+        size_t before = RunBefore(jpeg_size, wire_before);
+        size_t after = RunAfter(jpeg_size, wire_after);
+        if (wire_before != wire_after) {
+            printf("FAIL: %u byte image: replies differ\n", (unsigned)jpeg_size);
+            ok = false;
+        }
+        printf("%10u %12u %12u %12u %7.0f%%\n", (unsigned)jpeg_size, (unsigned)wire_after.size(),
+            (unsigned)before, (unsigned)after, 100.0 * (before - after) / before);
+        // On top of the JPEG, the reply buffer should be the only large block
+        if (after > wire_after.size() + 256) {
+            printf("FAIL: %u byte image: peak heap above the JPEG plus the reply\n", (unsigned)jpeg_size);
+            ok = false;
+        }
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// JsonScanner checks and benchmark (user-031)
+//
+// Checks the scanner against the hot server messages, nested values, escapes and truncated
+// input, then times the lookups Protocol::DispatchTextMessage does per message. Built with
+// -DHAVE_CJSON and ESP-IDF's cJSON sources, it also times cJSON_Parse on the same messages.
+#include "json_scanner.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef HAVE_CJSON
+#include <cJSON.h>
+#endif
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static bool GetString(const char* json, const char* key, std::string& out, size_t buffer_size = 256) {
+    JsonScanner scanner(json, strlen(json));
+    char buffer[256];
+    std::string_view value;
+    if (!scanner.GetString(key, value, buffer, buffer_size)) {
+        return false;
+    }
+    out.assign(value.data(), value.size());
+    return true;
+}
+
+static bool GetInt(const char* json, const char* key, int& out) {
+    JsonScanner scanner(json, strlen(json));
+    return scanner.GetInt(key, out);
+}
+
+static void TestMessages() {
+    std::string s;
+    int n = 0;
+
+    const char* tts = R"({"type":"tts","state":"sentence_start","text":"你好\n世界 😊","session_id":"abc"})";
+    CHECK(GetString(tts, "type", s) && s == "tts");
+    CHECK(GetString(tts, "state", s) && s == "sentence_start");
+    CHECK(GetString(tts, "text", s) && s == "你好\n世界 😊");
+    CHECK(!GetString(tts, "emotion", s));
+
+    // Members of nested values are not top level
+    const char* llm = R"( { "session_id" : "x", "nested": {"type":"no","a":[1,2,{"b":"}"}]}, "type" : "llm", "emotion":"happy", "n": -42 } )";
+    CHECK(GetString(llm, "type", s) && s == "llm");
+    CHECK(GetString(llm, "emotion", s) && s == "happy");
+    CHECK(GetInt(llm, "n", n) && n == -42);
+    CHECK(!GetString(llm, "b", s));
+
+    const char* pong = R"({"type":"pong","id":17})";
+    CHECK(GetInt(pong, "id", n) && n == 17);
+    CHECK(!GetString(pong, "id", s));
+    CHECK(!GetInt(pong, "type", n));
+
+    // Escaped quotes, and a decoded value that does not fit the buffer
+    const char* escaped = R"({"t":"a\"q\"b"})";
+    CHECK(GetString(escaped, "t", s) && s == "a\"q\"b");
+    CHECK(!GetString(escaped, "t", s, 4));
+
+    // Truncated and malformed input
+    CHECK(!GetString(R"({"type":"tts","state":)", "state", s));
+    CHECK(!GetString(R"({"type":"tts)", "type", s));
+    CHECK(!GetString(R"(["type","tts"])", "type", s));
+    CHECK(!GetString("", "type", s));
+}
+
+template <typename F>
+static double NanosecondsPerCall(int iterations, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        f();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+static void Benchmark() {
+    struct Message {
+        const char* name;
+        const char* json;
+        const char* field;
+    };
+    const Message messages[] = {
+        {"tts sentence", R"({"session_id":"5f3c2a1e","type":"tts","state":"sentence_start","text":"今天天气不错，适合出去走走。"})", "text"},
+        {"llm emotion", R"({"session_id":"5f3c2a1e","type":"llm","text":"😊","emotion":"happy"})", "emotion"},
+        {"stt", R"({"session_id":"5f3c2a1e","type":"stt","text":"What is the weather like today?"})", "text"},
+    };
+    const int iterations = 200000;
+    volatile size_t sink = 0;
+
+    for (const auto& message : messages) {
+        size_t size = strlen(message.json);
+        double scanner_ns = NanosecondsPerCall(iterations, [&]() {
+            JsonScanner scanner(message.json, size);
+            char buffer[256];
+            std::string_view type, value;
+            scanner.GetString("type", type, buffer, sizeof(buffer));
+            scanner.GetString(message.field, value, buffer, sizeof(buffer));
+            sink = sink + type.size() + value.size();
+        });
+        printf("%-14s %3zu bytes  scanner %7.1f ns", message.name, size, scanner_ns);
+#ifdef HAVE_CJSON
+        double cjson_ns = NanosecondsPerCall(iterations, [&]() {
+            cJSON* root = cJSON_ParseWithLength(message.json, size);
+            auto type = cJSON_GetObjectItem(root, "type");
+            auto value = cJSON_GetObjectItem(root, message.field);
+            sink = sink + strlen(type->valuestring) + strlen(value->valuestring);
+            cJSON_Delete(root);
+        });
+        printf("  cJSON %7.1f ns", cjson_ns);
+#endif
+        printf("\n");
+    }
+}
+
+int main() {
+    TestMessages();
+    Benchmark();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,366 @@
+// MCP tools/list and tools/call lookup benchmark (user-032)
+//
+// Registers the common tools and the qebabe-xiaoche motor tools (38 tools, two tools/list
+// pages) and times, per request:
+//  - tools/call: finding the tool by name with the linear scan DoToolCall used to do, and
+//    through the name index McpServer::FindTool uses
+//  - tools/list: every page built the old way (linear cursor search, each schema rendered
+//    again), with cached schemas into a fixed 8000 byte buffer, and the way
+//    McpServer::GetToolsList does now (indexed cursor, buffer sized from the cached schema
+//    lengths)
+// It checks that all three tools/list variants produce the same pages, and reports the heap
+// allocated per page. The page loops follow McpServer::GetToolsList.
+//
+// The cJSON stand-in cannot parse, so by default the old schema rendering skips the
+// print/parse round trip of each property and is a lower bound. Build with -DHAVE_CJSON and
+// ESP-IDF's cJSON to include it.
+#include "mcp_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define MAX_PAYLOAD_SIZE 8000
+
+static size_t g_allocated = 0;
+
+// Not inlined, so the compiler does not pair these mallocs with deletes at call sites
+__attribute__((noinline)) void* operator new(size_t size) {
+    g_allocated += size;
+    void* ptr = malloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+static std::vector<McpTool*> g_tools;
+static std::unordered_map<std::string, size_t> g_tool_index;
+
+static void AddTool(const std::string& name, const std::string& description, const PropertyList& properties,
+    bool user_only = false) {
+    auto tool = new McpTool(name, description, properties, [](const PropertyList&) -> ReturnValue { return true; });
+    tool->set_user_only(user_only);
+    g_tool_index.emplace(name, g_tools.size());
+    g_tools.push_back(tool);
+}
+
+static void AddTools() {
+    AddTool("self.get_device_status",
+        "Provides the real-time information of the device, including the current status of the audio speaker, "
+        "screen, battery, network, etc.\nUse this tool for: \n1. Answering questions about current condition "
+        "(e.g. what is the current volume of the audio speaker?)\n2. As the first step to control the device "
+        "(e.g. turn up / down the volume of the audio speaker, etc.)",
+        PropertyList());
+    AddTool("self.audio_speaker.set_volume",
+        "Set the volume of the audio speaker. If the current volume is unknown, you must call "
+        "`self.get_device_status` tool first and then call this tool.",
+        PropertyList({Property("volume", kPropertyTypeInteger, 0, 100)}));
+    AddTool("self.screen.set_brightness", "Set the brightness of the screen.",
+        PropertyList({Property("brightness", kPropertyTypeInteger, 0, 100)}));
+    AddTool("self.screen.set_theme", "Set the theme of the screen. The theme can be `light` or `dark`.",
+        PropertyList({Property("theme", kPropertyTypeString)}));
+    AddTool("self.camera.take_photo",
+        "Take a photo and explain it. Use this tool after the user asks you to see something.\nArgs:\n"
+        "  `question`: The question that you want to ask about the photo.\nReturn:\n"
+        "  A JSON object that provides the photo information.",
+        PropertyList({Property("question", kPropertyTypeString)}));
+    const char* motions[] = {"move_forward", "move_backward", "quick_forward", "quick_backward", "turn_left",
+        "turn_right", "spin_around", "wiggle", "dance", "stop"};
+    for (const char* motion : motions) {
+        AddTool(std::string("self.motor.") + motion,
+            std::string("Make the robot ") + motion + " with specified speed and duration.\nArgs:\n"
+            "  `speed_percent`: Motor speed (0-100), default 100\n"
+            "  `duration_ms`: Movement duration in milliseconds, default 5000\nReturn:\n"
+            "  Success message with parameters",
+            PropertyList({Property("speed_percent", kPropertyTypeInteger, 100, 0, 100),
+                Property("duration_ms", kPropertyTypeInteger, 5000, 100, 10000)}));
+    }
+    const char* emotions[] = {"happy", "sad", "angry", "surprised", "confused", "loving", "excited", "thinking",
+        "listening", "speaking", "wake_up"};
+    for (const char* emotion : emotions) {
+        AddTool(std::string("self.motor.") + emotion,
+            std::string("Play the ") + emotion + " motion: a short choreographed move that matches the "
+            "emotion. Use it together with the reply when the conversation calls for it.\nArgs:\n"
+            "  `intensity`: Scale of the move (1-3), default 2",
+            PropertyList({Property("intensity", kPropertyTypeInteger, 2, 1, 3)}));
+    }
+    const char* chassis[] = {"go_forward", "go_back", "turn_left", "turn_right", "dance", "switch_light_mode",
+        "get_light_mode"};
+    for (const char* action : chassis) {
+        AddTool(std::string("self.chassis.") + action,
+            std::string("Chassis action ") + action + ". Runs until the next chassis command.", PropertyList());
+    }
+    AddTool("self.get_system_info", "Get the system information", PropertyList(), true);
+    AddTool("self.reboot", "Reboot the system", PropertyList(), true);
+    AddTool("self.upgrade_firmware",
+        "Upgrade firmware from a specific URL. This will download and install the firmware, then reboot the device.",
+        PropertyList({Property("url", kPropertyTypeString)}), true);
+    AddTool("self.screen.get_info", "Information about the screen, including width, height, etc.", PropertyList(),
+        true);
+    AddTool("self.screen.snapshot", "Snapshot the screen and upload it to a specific URL",
+        PropertyList({Property("url", kPropertyTypeString), Property("quality", kPropertyTypeInteger, 80, 1, 100)}),
+        true);
+}
+
+// McpTool::to_json before schemas were cached
+static std::string RenderToolJson(McpTool* tool) {
+#ifdef HAVE_CJSON
+    // The print/parse round trip of each property the old PropertyList::to_json did
+    PropertyList property_list = tool->properties();
+    std::vector<std::string> required = property_list.GetRequired();
+    cJSON* properties = cJSON_CreateObject();
+    for (const auto& property : property_list) {
+        cJSON_AddItemToObject(properties, property.name().c_str(), cJSON_Parse(property.to_json().c_str()));
+    }
+    char* properties_str = cJSON_PrintUnformatted(properties);
+    cJSON_Delete(properties);
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "name", tool->name().c_str());
+    cJSON_AddStringToObject(json, "description", tool->description().c_str());
+    cJSON* input_schema = cJSON_CreateObject();
+    cJSON_AddStringToObject(input_schema, "type", "object");
+    cJSON_AddItemToObject(input_schema, "properties", cJSON_Parse(properties_str));
+    cJSON_free(properties_str);
+    if (!required.empty()) {
+        cJSON* required_array = cJSON_CreateArray();
+        for (const auto& property : required) {
+            cJSON_AddItemToArray(required_array, cJSON_CreateString(property.c_str()));
+        }
+        cJSON_AddItemToObject(input_schema, "required", required_array);
+    }
+    cJSON_AddItemToObject(json, "inputSchema", input_schema);
+    if (tool->user_only()) {
+        cJSON* annotations = cJSON_CreateObject();
+        cJSON* audience = cJSON_CreateArray();
+        cJSON_AddItemToArray(audience, cJSON_CreateString("user"));
+        cJSON_AddItemToObject(annotations, "audience", audience);
+        cJSON_AddItemToObject(json, "annotations", annotations);
+    }
+    char* json_str = cJSON_PrintUnformatted(json);
+    std::string result(json_str);
+    cJSON_free(json_str);
+    cJSON_Delete(json);
+    return result;
+#else
+    // set_user_only drops the cached schema, so it is rendered again
+    tool->set_user_only(tool->user_only());
+    return tool->to_json();
+#endif
+}
+
+static std::string FinishPage(std::string& json, const std::string& next_cursor) {
+    if (json.back() == ',') {
+        json.pop_back();
+    }
+    if (next_cursor.empty()) {
+        json += "]}";
+    } else {
+        json += "],\"nextCursor\":\"" + next_cursor + "\"}";
+    }
+    return json;
+}
+
+// Before user-032: linear cursor search, each schema rendered again
+static std::string OldToolsList(const std::string& cursor, bool list_user_only_tools) {
+    std::string json = "{\"tools\":[";
+    bool found_cursor = cursor.empty();
+    std::string next_cursor = "";
+    for (McpTool* tool : g_tools) {
+        if (!found_cursor) {
+            if (tool->name() != cursor) {
+                continue;
+            }
+            found_cursor = true;
+        }
+        if (!list_user_only_tools && tool->user_only()) {
+            continue;
+        }
+        std::string tool_json = RenderToolJson(tool) + ",";
+        if (json.length() + tool_json.length() + 30 > MAX_PAYLOAD_SIZE) {
+            next_cursor = tool->name();
+            break;
+        }
+        json += tool_json;
+    }
+    return FinishPage(json, next_cursor);
+}
+
+static size_t StartIndex(const std::string& cursor) {
+    if (cursor.empty()) {
+        return 0;
+    }
+    auto index = g_tool_index.find(cursor);
+    return index == g_tool_index.end() ? g_tools.size() : index->second;
+}
+
+// Cached schemas appended to a buffer that always reserves the page limit
+static std::string FixedReserveToolsList(const std::string& cursor, bool list_user_only_tools) {
+    std::string json;
+    json.reserve(MAX_PAYLOAD_SIZE);
+    json = "{\"tools\":[";
+    std::string next_cursor = "";
+    for (size_t i = StartIndex(cursor); i < g_tools.size(); i++) {
+        const McpTool* tool = g_tools[i];
+        if (!list_user_only_tools && tool->user_only()) {
+            continue;
+        }
+        const std::string& tool_json = tool->to_json();
+        if (json.length() + tool_json.length() + 1 + 30 > MAX_PAYLOAD_SIZE) {
+            next_cursor = tool->name();
+            break;
+        }
+        json += tool_json;
+        json += ',';
+    }
+    return FinishPage(json, next_cursor);
+}
+
+// McpServer::GetToolsList: the page is sized from the cached schema lengths first
+static std::string ToolsList(const std::string& cursor, bool list_user_only_tools) {
+    size_t start = StartIndex(cursor);
+    std::string next_cursor = "";
+    size_t length = strlen("{\"tools\":[");
+    size_t end = start;
+    for (; end < g_tools.size(); end++) {
+        const McpTool* tool = g_tools[end];
+        if (!list_user_only_tools && tool->user_only()) {
+            continue;
+        }
+        size_t tool_length = tool->to_json().length();
+        if (length + tool_length + 1 + 30 > MAX_PAYLOAD_SIZE) {
+            next_cursor = tool->name();
+            break;
+        }
+        length += tool_length + 1;
+    }
+    std::string json;
+    json.reserve(length + strlen("],\"nextCursor\":\"\"}") + next_cursor.length());
+    json = "{\"tools\":[";
+    for (size_t i = start; i < end; i++) {
+        const McpTool* tool = g_tools[i];
+        if (!list_user_only_tools && tool->user_only()) {
+            continue;
+        }
+        json += tool->to_json();
+        json += ',';
+    }
+    return FinishPage(json, next_cursor);
+}
+
+static std::string NextCursor(const std::string& page) {
+    const char* key = "\"nextCursor\":\"";
+    size_t pos = page.rfind(key);
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos += strlen(key);
+    return page.substr(pos, page.find('"', pos) - pos);
+}
+
+typedef std::string (*ToolsListFunction)(const std::string& cursor, bool list_user_only_tools);
+
+struct ListResult {
+    std::vector<std::string> pages;
+    double us_per_page = 0;
+    size_t allocated_per_page = 0;
+};
+
+// Fetch every page, following nextCursor, the given number of times
+static ListResult RunToolsList(ToolsListFunction function, bool list_user_only_tools, int rounds) {
+    ListResult result;
+    size_t allocated = g_allocated;
+    auto start = std::chrono::steady_clock::now();
+    long pages = 0;
+    for (int round = 0; round < rounds; round++) {
+        std::string cursor;
+        do {
+            std::string page = function(cursor, list_user_only_tools);
+            cursor = NextCursor(page);
+            if (round == 0) {
+                result.pages.push_back(std::move(page));
+            }
+            pages++;
+        } while (!cursor.empty());
+    }
+    result.us_per_page = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / pages;
+    result.allocated_per_page = (g_allocated - allocated) / pages;
+    return result;
+}
+
+int main() {
+    AddTools();
+    bool pass = true;
+
+    // tools/call: every tool once plus an unknown name, per round
+    std::vector<std::string> names;
+    for (const McpTool* tool : g_tools) {
+        names.push_back(tool->name());
+    }
+    names.push_back("self.motor.unknown");
+    const int call_rounds = 20000;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < call_rounds; round++) {
+        for (const auto& name : names) {
+            auto it = std::find_if(g_tools.begin(), g_tools.end(), [&name](const McpTool* tool) {
+                return tool->name() == name;
+            });
+            found += it != g_tools.end();
+        }
+    }
+    double linear_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < call_rounds; round++) {
+        for (const auto& name : names) {
+            auto it = g_tool_index.find(name);
+            found += it != g_tool_index.end();
+        }
+    }
+    double index_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    bool lookup_pass = found == 2 * (size_t)call_rounds * g_tools.size();
+    printf("tools/call lookup, %u tools: linear scan %.1f ns, name index %.1f ns: %s\n", (unsigned)g_tools.size(),
+        linear_ns / call_rounds / names.size(), index_ns / call_rounds / names.size(), lookup_pass ? "PASS" : "FAIL");
+    pass = pass && lookup_pass;
+
+    printf("%-26s %6s %8s %12s %14s\n", "tools/list", "pages", "bytes", "us per page", "heap per page");
+    for (bool list_user_only_tools : {false, true}) {
+        const int list_rounds = 2000;
+        ListResult old_list = RunToolsList(OldToolsList, list_user_only_tools, list_rounds);
+        ListResult fixed_list = RunToolsList(FixedReserveToolsList, list_user_only_tools, list_rounds);
+        ListResult list = RunToolsList(ToolsList, list_user_only_tools, list_rounds);
+        bool same = old_list.pages == list.pages && fixed_list.pages == list.pages;
+        size_t bytes = 0;
+        for (const auto& page : list.pages) {
+            bytes += page.size();
+        }
+        const char* scope = list_user_only_tools ? "with user tools" : "AI tools";
+        const struct {
+            const char* name;
+            const ListResult& result;
+        } rows[] = {{"old", old_list}, {"cached, 8000 B reserve", fixed_list}, {"cached, sized reserve", list}};
+        printf("%s:\n", scope);
+        for (const auto& row : rows) {
+            printf("  %-24s %6u %8u %12.2f %14u\n", row.name, (unsigned)row.result.pages.size(), (unsigned)bytes,
+                row.result.us_per_page, (unsigned)row.result.allocated_per_page);
+        }
+        printf("  same pages: %s\n", same ? "PASS" : "FAIL");
+        pass = pass && same && list.pages.size() > 1;
+    }
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// Motor settle time and current model (user-042)
+//
+// Drives a simulated brushed DC gear motor (6 V, 2.5 ohm, TT class) through a routine
+// (wiggle x4, forward 100, forward 50, backward 80, stop) and reports peak current, energy
+// and how many segments reach their steady speed, for the old fixed 50 ms LEDC fade and for
+// MotionPlanner at several acceleration limits and both ramp profiles.
+#include "motion_planner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Electrical and mechanical model, integrated with explicit Euler steps
+struct Motor {
+    double supply_v = 6, resistance = 2.5, inductance = 0.5e-3;
+    double k = 0.005, inertia = 1e-6, friction = 2e-7;
+    double current = 0, speed = 0, peak_current = 0, energy = 0;
+
+    // duty in -1..1, H-bridge drive
+    void Step(double duty, double dt) {
+        double v = supply_v * duty;
+        current += (v - resistance * current - k * speed) / inductance * dt;
+        speed += (k * current - friction * speed) / inertia * dt;
+        peak_current = std::max(peak_current, std::fabs(current));
+        energy += std::fabs(v * current) * dt;
+    }
+
+    double SteadySpeed(double duty) const {
+        return supply_v * duty * k / (k * k + resistance * friction);
+    }
+};
+
+struct Segment {
+    int direction;
+    int speed;
+    int ms;
+};
+
+static const std::vector<Segment> kRoutine = {
+    {3, 100, 100}, {1, 100, 100}, {3, 100, 100}, {1, 100, 100},
+    {4, 100, 500}, {4, 50, 300}, {2, 80, 300}, {0, 0, 400},
+};
+
+struct Result {
+    double peak_current;
+    double energy;
+    double settle_avg_ms;
+    int settled;
+};
+
+// Tracks when the motor last entered the +-10% band around the segment's steady speed
+struct SettleTracker {
+    double target;
+    double band;
+    double settle_s = -1;
+
+    void Update(double speed, double t) {
+        bool inside = std::fabs(speed - target) <= band;
+        if (!inside) {
+            settle_s = -1;
+        } else if (settle_s < 0) {
+            settle_s = t;
+        }
+    }
+};
+
+// Before: each bridge side faded linearly to its new duty over 50 ms, net duty = forward - back
+static Result RunOldFade() {
+    Motor motor;
+    const double dt = 1e-5;
+    double forward = 0, back = 0, settle_sum_ms = 0;
+    int settled = 0;
+    for (const auto& segment : kRoutine) {
+        int left, right;
+        MotionPlanner::DirectionToWheels(segment.direction, segment.speed, left, right);
+        double forward_from = forward, back_from = back;
+        double forward_to = left > 0 ? left / 100.0 : 0, back_to = left < 0 ? -left / 100.0 : 0;
+        SettleTracker tracker{motor.SteadySpeed(left / 100.0), 0.1 * motor.SteadySpeed(1)};
+        for (double t = 0; t < segment.ms / 1000.0; t += dt) {
+            double u = std::min(t / 0.05, 1.0);
+            forward = forward_from + (forward_to - forward_from) * u;
+            back = back_from + (back_to - back_from) * u;
+            motor.Step(forward - back, dt);
+            tracker.Update(motor.speed, t);
+        }
+        if (tracker.settle_s >= 0) {
+            settled++;
+            settle_sum_ms += tracker.settle_s * 1000;
+        }
+    }
+    return {motor.peak_current, motor.energy, settled ? settle_sum_ms / settled : 0, settled};
+}
+
+// After: the 10 ms control timer samples the profile and holds the duty until the next tick
+static Result RunPlanner(int max_accel, MotionPlanner::Profile profile) {
+    Motor motor;
+    MotionPlanner planner(max_accel, profile);
+    const int64_t step_us = 10, tick_us = 10000;
+    int64_t now_us = 0;
+    double duty = 0, settle_sum_ms = 0;
+    int settled = 0;
+    for (const auto& segment : kRoutine) {
+        int left, right;
+        MotionPlanner::DirectionToWheels(segment.direction, segment.speed, left, right);
+        planner.SetTarget(left, right, now_us);
+        SettleTracker tracker{motor.SteadySpeed(left / 100.0), 0.1 * motor.SteadySpeed(1)};
+        int64_t segment_start_us = now_us;
+        for (; now_us < segment_start_us + segment.ms * 1000; now_us += step_us) {
+            if (now_us % tick_us == 0 || now_us == segment_start_us) {
+                int sample_left, sample_right;
+                planner.Sample(now_us, sample_left, sample_right);
+                duty = sample_left / 100.0;
+            }
+            motor.Step(duty, step_us / 1e6);
+            tracker.Update(motor.speed, (now_us - segment_start_us) / 1e6);
+        }
+        if (tracker.settle_s >= 0) {
+            settled++;
+            settle_sum_ms += tracker.settle_s * 1000;
+        }
+    }
+    return {motor.peak_current, motor.energy, settled ? settle_sum_ms / settled : 0, settled};
+}
+
+static void Print(const char* name, const Result& result) {
+    printf("%-22s peak current %.2f A, energy %.3f J, settled %d/%zu segments, avg settle %.0f ms\n",
+        name, result.peak_current, result.energy, result.settled, kRoutine.size(), result.settle_avg_ms);
+}
+
+int main() {
+    Print("old 50 ms fade", RunOldFade());
+    for (int accel : {1000, 2000, 4000, 8000}) {
+        char name[32];
+        snprintf(name, sizeof(name), "trapezoid %d %%/s", accel);
+        Print(name, RunPlanner(accel, MotionPlanner::kProfileTrapezoid));
+        snprintf(name, sizeof(name), "s-curve %d %%/s", accel);
+        Print(name, RunPlanner(accel, MotionPlanner::kProfileSCurve));
+    }
+    return 0;
+}
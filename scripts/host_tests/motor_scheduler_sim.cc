@@ -0,0 +1,179 @@
+// MotorScheduler simulation with a fake PWM backend (user-039)
+//
+// The drive callback records every PWM change with its time. The scenarios are:
+//  - six 100 ms emotion actions on the old executor (10 ms polling, a sleep per action, a
+//    50 ms gap after each) and on the timeline
+//  - a high priority Play() preempting an idle action, and a medium one queued ahead of
+//    the remaining idle action
+//  - a two-keyframe routine played at 250% of its duration
+// Each scenario prints the PWM trace and checks the order and timing of the changes.
+// Timings use host threads for esp_timer, so the tolerances are loose.
+#include "motor_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Allowed deviation from the planned time of a PWM change
+#define TOLERANCE_US 15000
+
+struct PwmEvent {
+    int64_t time_us;
+    int direction;
+    int speed;
+};
+
+static std::mutex g_mutex;
+static std::vector<PwmEvent> g_events;
+static bool g_pass = true;
+
+static void Pwm(int direction, int speed) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_events.push_back({esp_timer_get_time(), direction, speed});
+}
+
+static void SleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Print the trace and return it, relative to start_us
+static std::vector<PwmEvent> Report(const char* name, int64_t start_us, int motion_ms) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::vector<PwmEvent> events;
+    events.swap(g_events);
+    printf("%s:\n", name);
+    int64_t idle_us = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        printf("  %7.1fms dir=%d speed=%d\n", (events[i].time_us - start_us) / 1000.0, events[i].direction, events[i].speed);
+        if (events[i].direction == 0 && i + 1 < events.size()) {
+            idle_us += events[i + 1].time_us - events[i].time_us;
+        }
+    }
+    for (auto& event : events) {
+        event.time_us -= start_us;
+    }
+    if (!events.empty() && motion_ms > 0) {
+        printf("  total %.1fms for %dms of motion, motors idle between actions %.1fms\n",
+            events.back().time_us / 1000.0, motion_ms, idle_us / 1000.0);
+    }
+    return events;
+}
+
+static void Expect(const char* scenario, const std::vector<PwmEvent>& events,
+    const std::vector<std::pair<int, int64_t>>& expected) {
+    bool ok = events.size() == expected.size();
+    for (size_t i = 0; ok && i < events.size(); i++) {
+        int64_t error = events[i].time_us - expected[i].second * 1000;
+        if (events[i].direction != expected[i].first || error < -TOLERANCE_US || error > TOLERANCE_US) {
+            printf("  %s: change %zu is dir=%d at %.1fms, expected dir=%d at %lldms\n", scenario, i,
+                events[i].direction, events[i].time_us / 1000.0, expected[i].first, (long long)expected[i].second);
+            ok = false;
+        }
+    }
+    if (events.size() != expected.size()) {
+        printf("  %s: %zu changes, expected %zu\n", scenario, events.size(), expected.size());
+    }
+    printf("  %s: %s\n", scenario, ok ? "PASS" : "FAIL");
+    g_pass = g_pass && ok;
+}
+
+// The executor MotorScheduler replaced: 10 ms polling, a sleep per action, 50 ms gap
+class OldExecutor {
+public:
+    OldExecutor() {
+        thread_ = std::thread([this]() {
+            while (running_) {
+                std::tuple<int, int, int> action;
+                bool has_action = false;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!actions_.empty()) {
+                        action = actions_.front();
+                        actions_.pop();
+                        has_action = true;
+                    }
+                }
+                if (has_action) {
+                    Pwm(std::get<0>(action), std::get<1>(action));
+                    SleepMs(std::get<2>(action));
+                    Pwm(0, 0);
+                    SleepMs(50);
+                } else {
+                    SleepMs(10);
+                }
+            }
+        });
+    }
+
+    ~OldExecutor() {
+        running_ = false;
+        thread_.join();
+    }
+
+    void Queue(int direction, int speed, int duration_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        actions_.push({direction, speed, duration_ms});
+    }
+
+private:
+    std::mutex mutex_;
+    std::queue<std::tuple<int, int, int>> actions_;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+int main() {
+    const int directions[] = {3, 1, 3, 1, 4, 2};
+    {
+        OldExecutor old;
+        SleepMs(25);
+        int64_t start = esp_timer_get_time();
+        for (int direction : directions) {
+            old.Queue(direction, 80, 100);
+        }
+        SleepMs(1200);
+        Report("old executor, 6 x 100ms emotion actions", start, 600);
+    }
+
+    MotorScheduler scheduler([](int direction, int speed, ChoreoEasing) { Pwm(direction, speed); });
+    {
+        int64_t start = esp_timer_get_time();
+        for (int direction : directions) {
+            scheduler.Queue(direction, 80, 100, 0, "emotion");
+        }
+        SleepMs(800);
+        auto events = Report("timeline, 6 x 100ms emotion actions", start, 600);
+        Expect("back to back", events, {{3, 0}, {1, 100}, {3, 200}, {1, 300}, {4, 400}, {2, 500}, {0, 600}});
+    }
+    {
+        int64_t start = esp_timer_get_time();
+        scheduler.Queue(4, 60, 500, 0, "idle");
+        scheduler.Queue(2, 60, 200, 0, "idle 2");
+        SleepMs(100);
+        scheduler.Play(1, 100, 150, 2, "mcp turn right");   // Preempts idle
+        scheduler.Play(3, 80, 100, 1, "speech");            // Below the running one: queued ahead of idle 2
+        SleepMs(700);
+        auto events = Report("timeline, preemption", start, 0);
+        Expect("preemption", events, {{4, 0}, {1, 100}, {3, 250}, {2, 350}, {0, 550}});
+    }
+    {
+        ChoreoKeyframe keyframes[2] = {{3, 100, 0, {100, 0}}, {1, 100, 0, {100, 0}}};
+        ChoreoRoutine routine{"wiggle_quick", keyframes, 2};
+        int64_t start = esp_timer_get_time();
+        scheduler.Queue(routine, 100, 0, 250);
+        SleepMs(700);
+        auto events = Report("timeline, routine at 250% duration", start, 0);
+        Expect("time scale", events, {{3, 0}, {1, 250}, {0, 500}});
+    }
+
+    auto stats = scheduler.GetStats();
+    printf("started=%u keyframes=%u preempted=%u max start lag=%lldus\n", stats.started, stats.keyframes,
+        stats.preempted, (long long)stats.max_start_lag_us);
+    printf("%s\n", g_pass ? "PASS" : "FAIL");
+    return g_pass ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// PlaybackClock alignment test (user-040)
+//
+// Simulates a tts stream: 8 sentences of 12 x 60 ms frames, sent at 3x real time to a speaker
+// thread that blocks one frame per write, like AudioOutputTask. Compares when each sentence's
+// cue would fire on message arrival with when it fires on the playback clock, against when
+// the sentence's first frame is actually played.
+#include "playback_clock.h"
+
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Frame {
+    int sentence;
+    bool first;
+};
+
+int main() {
+    const int kFrameMs = 60, kSentences = 8, kFramesPerSentence = 12;
+    PlaybackClock clock;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Frame> queue;
+    bool done = false;
+    std::vector<int64_t> heard(kSentences, 0), cued(kSentences, 0), arrived(kSentences, 0);
+
+    std::thread speaker([&]() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return !queue.empty() || done; });
+            if (queue.empty()) {
+                break;
+            }
+            Frame frame = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            if (frame.first) {
+                heard[frame.sentence] = esp_timer_get_time();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(kFrameMs));
+            clock.OnFramePlayed();
+        }
+    });
+
+    // The server sends faster than real time, so the decode queue runs ahead of the speaker
+    for (int s = 0; s < kSentences; s++) {
+        arrived[s] = esp_timer_get_time();
+        clock.AddCue([&cued, s]() { cued[s] = esp_timer_get_time(); });
+        for (int i = 0; i < kFramesPerSentence; i++) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back({s, i == 0});
+            }
+            clock.OnFrameQueued();
+            cv.notify_one();
+            std::this_thread::sleep_for(std::chrono::milliseconds(kFrameMs / 3));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    speaker.join();
+
+    double max_arrival = 0, max_clock = 0;
+    for (int s = 0; s < kSentences; s++) {
+        double arrival_error = (arrived[s] - heard[s]) / 1000.0;
+        double clock_error = (cued[s] - heard[s]) / 1000.0;
+        printf("sentence %d: on arrival %+8.1f ms, on playback clock %+6.1f ms\n", s, arrival_error, clock_error);
+        max_arrival = std::max(max_arrival, std::fabs(arrival_error));
+        max_clock = std::max(max_clock, std::fabs(clock_error));
+    }
+    auto stats = clock.GetStats();
+    bool pass = max_clock <= kFrameMs;
+    printf("max |error|: on arrival %.1f ms, on playback clock %.1f ms (cues %u, deferred %u, expired %u): %s\n",
+        max_arrival, max_clock, stats.cues, stats.deferred, stats.expired, pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// RoboEyesAdapter::FlushToPanel bus traffic (user-049)
+//
+// Runs the real adapter and emotion table with the panel task driven by hand: 30 ticks per
+// second of simulated time, 60 s per emotion, at 128x64 and 128x32. The panel is an SSD1306
+// model: each draw call writes its columns of one page into the modelled GDDRAM and costs 12
+// bytes of command overhead on the bus (column and page range, each its own I2C
+// transaction) on top of the data. The old path sent every page in full on every tick.
+// After each run the modelled GDDRAM must match the adapter's frame. A last run makes every
+// 50th draw call fail and checks that the panel still converges on the frame.
+
+// The check compares against the adapter's private frame
+#define private public
+#include "roboeyes_adapter.h"
+#undef private
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Command overhead of one draw call, in bus bytes
+#define DRAW_CALL_OVERHEAD 12
+
+// Simulated time, so RoboEyes sees 30 fps however long a tick takes on the host
+static int64_t g_time_us = 1000000;
+
+int64_t esp_timer_get_time() {
+    return g_time_us;
+}
+
+int esp_timer_stop(esp_timer_handle_t) {
+    return 0;
+}
+
+int esp_timer_delete(esp_timer_handle_t) {
+    return 0;
+}
+
+static uint8_t g_gram[8][128];
+static long g_payload_bytes = 0;
+static long g_bus_bytes = 0;
+static long g_draw_calls = 0;
+static int g_fail_every = 0;
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t, int x_start, int y_start, int x_end, int y_end,
+    const void* color_data) {
+    (void)y_end;
+    g_draw_calls++;
+    g_bus_bytes += x_end - x_start + DRAW_CALL_OVERHEAD;
+    if (g_fail_every > 0 && g_draw_calls % g_fail_every == 0) {
+        return -1;
+    }
+    memcpy(&g_gram[y_start / 8][x_start], color_data, x_end - x_start);
+    g_payload_bytes += x_end - x_start;
+    return ESP_OK;
+}
+
+// Run one emotion; returns false if the panel does not end up showing the frame
+static bool Run(const char* emotion, int width, int height, int seconds, int fail_every) {
+    srand(1);
+    memset(g_gram, 0, sizeof(g_gram));
+    g_payload_bytes = g_bus_bytes = g_draw_calls = 0;
+    g_fail_every = fail_every;
+
+    static lv_obj_t parent;
+    RoboEyesAdapter adapter;
+    adapter.Begin(&parent, width, height, 30, (esp_lcd_panel_io_handle_t)1, (esp_lcd_panel_handle_t)1);
+    adapter.SetEmotion(emotion);
+
+    long ticks = seconds * 30;
+    long flushes = 0;
+    double update_us = 0;
+    for (long t = 0; t < ticks; t++) {
+        g_time_us += 33333;
+        long calls = g_draw_calls;
+        auto start = std::chrono::steady_clock::now();
+        adapter.Update();
+        update_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (g_draw_calls != calls) flushes++;
+    }
+
+    // The panel must end up showing exactly the last frame drawn
+    g_fail_every = 0;
+    adapter.FlushToPanel();
+    int pages = height / 8;
+    bool match = true;
+    for (int p = 0; p < pages; p++) {
+        if (memcmp(g_gram[p], adapter.frame_buffer_ + p * width, width) != 0) match = false;
+    }
+
+    long old_bus = ticks * pages * (width + DRAW_CALL_OVERHEAD) / seconds;
+    printf("%-10s %9.1f %9.1f %11ld %9ld %9ld %9.1f  %s\n", emotion, flushes / (double)seconds,
+        g_draw_calls / (double)seconds, g_payload_bytes / seconds, g_bus_bytes / seconds, old_bus,
+        update_us / ticks, match ? "PASS" : "FAIL");
+    return match;
+}
+
+int main() {
+    const char* emotions[] = {"neutral", "happy", "sleepy", "angry", "laughing", "confused", "loving", "surprised"};
+    const int width = 128;
+    const int seconds = 60;
+    bool pass = true;
+    for (int height : {64, 32}) {
+        printf("%dx%d, 30 ticks/s, %d s per emotion\n", width, height, seconds);
+        printf("%-10s %9s %9s %11s %9s %9s %9s\n", "emotion", "flushes/s", "calls/s", "payload B/s", "bus B/s",
+            "old B/s", "update us");
+        for (const char* emotion : emotions) {
+            pass = Run(emotion, width, height, seconds, 0) && pass;
+        }
+    }
+    printf("128x64 with every 50th draw call failing\n");
+    pass = Run("surprised", width, 64, seconds, 50) && pass;
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+// RoboEyes shim equivalence test and render microbenchmark (user-050)
+//
+// The adapter source is included directly to reach its file-scoped AdafruitShim, which is
+// compared with the shim it replaced (roboeyes_shim_reference.cc):
+//  - 200k random shapes, clipped at every edge and in both colours, drawn with both shims
+//    on 128x64, 128x32 and 100x30 frames. The new shim draws in both layouts; every frame
+//    must hold the same pixels as the old one.
+//  - RoboEyes driven through 12 emotions for 30 s of simulated time each, once with each
+//    shim. Every drawn frame must match, as panel pages (the old frame packed the way the
+//    old FlushToPanel did) and as the row-major canvas frame.
+// It times the RoboEyes renders: the old shim plus page packing against the new shim in
+// the page layout, and both shims in the row-major layout.
+
+// The test reads the adapter's private frame state. Standard headers are included first so
+// the define only reaches the adapter.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define private public
+#include "display/roboeyes_adapter.cc"
+#undef private
+
+#include "roboeyes_shim_reference.h"
+
+// Simulated time, so RoboEyes sees 30 fps however long a frame takes on the host
+static int64_t g_time_us = 1000000;
+
+int64_t esp_timer_get_time() {
+    return g_time_us;
+}
+
+int esp_timer_stop(esp_timer_handle_t) {
+    return 0;
+}
+
+int esp_timer_delete(esp_timer_handle_t) {
+    return 0;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t, int, int, int, int, const void*) {
+    return ESP_OK;
+}
+
+static bool SamePixels(const uint8_t* old_frame, const uint8_t* frame, int width, int height, RoboEyesLayout layout) {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (FramePixel(old_frame, width, RoboEyesLayout::kRowMajor, x, y) != FramePixel(frame, width, layout, x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static int Random(int lo, int hi) {
+    return lo + rand() % (hi - lo + 1);
+}
+
+static bool RandomShapes(int width, int height, int shapes) {
+    std::vector<uint8_t> old_frame(FrameBytes(width, height, RoboEyesLayout::kRowMajor));
+    std::vector<uint8_t> row_frame(FrameBytes(width, height, RoboEyesLayout::kRowMajor));
+    std::vector<uint8_t> page_frame(FrameBytes(width, height, RoboEyesLayout::kPageMajor));
+    OldAdafruitShim old_shim(old_frame.data(), width, height);
+    AdafruitShim row_shim(row_frame.data(), width, height, RoboEyesLayout::kRowMajor, nullptr, TAG);
+    AdafruitShim page_shim(page_frame.data(), width, height, RoboEyesLayout::kPageMajor, nullptr, TAG);
+
+    srand(width * height);
+    for (int i = 0; i < shapes; ++i) {
+        uint8_t color = rand() % 3 != 0;
+        if (rand() % 2) {
+            int x = Random(-40, width + 8);
+            int y = Random(-30, height + 8);
+            int w = Random(-4, 100);
+            int h = Random(-4, 70);
+            int r = Random(-2, 40);
+            old_shim.fillRoundRect(x, y, w, h, r, color);
+            row_shim.fillRoundRect(x, y, w, h, r, color);
+            page_shim.fillRoundRect(x, y, w, h, r, color);
+        } else {
+            int x0 = Random(-40, width + 40), y0 = Random(-30, height + 30);
+            int x1 = Random(-40, width + 40), y1 = Random(-30, height + 30);
+            int x2 = Random(-40, width + 40), y2 = Random(-30, height + 30);
+            old_shim.fillTriangle(x0, y0, x1, y1, x2, y2, color);
+            row_shim.fillTriangle(x0, y0, x1, y1, x2, y2, color);
+            page_shim.fillTriangle(x0, y0, x1, y1, x2, y2, color);
+        }
+        // Row-major frames match byte for byte, padding bits included
+        bool same = old_frame == row_frame;
+        // The page frame is checked pixel by pixel, which is slower
+        if (same && (i % 16 == 0 || i == shapes - 1)) {
+            same = SamePixels(old_frame.data(), page_frame.data(), width, height, RoboEyesLayout::kPageMajor);
+        }
+        if (!same) {
+            printf("  %dx%d: frames differ after shape %d\n", width, height, i);
+            return false;
+        }
+        // Start over now and then so shapes are not always drawn over a busy frame
+        if (i % 64 == 63) {
+            old_shim.clearDisplay();
+            row_shim.clearDisplay();
+            page_shim.clearDisplay();
+        }
+    }
+    return true;
+}
+
+// Same steps as RoboEyesAdapter::Begin and SetEmotion(EmotionId)
+template <typename Shim>
+static void StartEyes(RoboEyes<Shim>& eyes, const char* emotion) {
+    eyes.setFramerate(30);
+    eyes.setIdleMode(true, 1, 3);
+    eyes.setAutoblinker(true, 3, 4);
+    const auto& info = GetEmotionInfo(ResolveEmotion(emotion));
+    eyes.setIdleMode(false);
+    eyes.setCuriosity(false);
+    eyes.setSweat(false);
+    eyes.setHFlicker(false);
+    eyes.setVFlicker(false);
+    if (info.eyes.animation == kEyesAnimLaugh) {
+        eyes.anim_laugh();
+    } else if (info.eyes.animation == kEyesAnimConfused) {
+        eyes.anim_confused();
+    }
+    eyes.setMood(info.eyes.mood);
+    if (info.eyes.sweat) {
+        eyes.setSweat(true);
+    }
+    if (info.eyes.idle_interval > 0) {
+        eyes.setIdleMode(true, info.eyes.idle_interval, info.eyes.idle_variation);
+    }
+    if (info.eyes.hflicker > 0) {
+        eyes.setHFlicker(true, info.eyes.hflicker);
+    }
+    if (info.eyes.vflicker > 0) {
+        eyes.setVFlicker(true, info.eyes.vflicker);
+    }
+}
+
+struct RenderResult {
+    long frames = 0;
+    long mismatches = 0;
+    double old_us = 0;
+    double new_us = 0;
+};
+
+static const char* kEmotions[] = {"neutral", "happy", "sleepy", "angry", "laughing", "confused", "loving",
+    "surprised", "sad", "crying", "shocked", "thinking"};
+
+// Renders every emotion with both shims and compares the drawn frames in the new layout
+static RenderResult Render(int width, int height, RoboEyesLayout layout) {
+    const int ticks = 30 * 30;
+    RenderResult result;
+    for (const char* emotion : kEmotions) {
+        // Old shim: row-major, packed into pages afterwards for the panel
+        std::vector<uint8_t> old_frame(FrameBytes(width, height, RoboEyesLayout::kRowMajor));
+        std::vector<uint8_t> old_pages(FrameBytes(width, height, RoboEyesLayout::kPageMajor));
+        std::vector<std::vector<uint8_t>> old_drawn;
+        {
+            srand(7);
+            g_time_us = 1000000;
+            OldAdafruitShim shim(old_frame.data(), width, height);
+            RoboEyes<OldAdafruitShim> eyes(shim);
+            StartEyes(eyes, emotion);
+            for (int t = 0; t < ticks; ++t) {
+                g_time_us += 33333;
+                shim.drew = false;
+                auto start = std::chrono::steady_clock::now();
+                eyes.update();
+                if (shim.drew && layout == RoboEyesLayout::kPageMajor) {
+                    OldPackPages(old_frame.data(), width, height, old_pages.data());
+                }
+                double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                if (shim.drew) {
+                    result.old_us += us;
+                    old_drawn.push_back(old_frame);
+                }
+            }
+        }
+
+        std::vector<uint8_t> frame(FrameBytes(width, height, layout));
+        {
+            srand(7);
+            g_time_us = 1000000;
+            RoboEyesAdapter parent;
+            AdafruitShim shim(frame.data(), width, height, layout, &parent, TAG);
+            RoboEyes<AdafruitShim> eyes(shim);
+            StartEyes(eyes, emotion);
+            size_t drawn = 0;
+            for (int t = 0; t < ticks; ++t) {
+                g_time_us += 33333;
+                parent.drew_this_frame_ = false;
+                auto start = std::chrono::steady_clock::now();
+                eyes.update();
+                double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                if (!parent.drew_this_frame_) continue;
+                result.new_us += us;
+                result.frames++;
+                if (drawn >= old_drawn.size() || !SamePixels(old_drawn[drawn].data(), frame.data(), width, height, layout)) {
+                    result.mismatches++;
+                }
+                drawn++;
+            }
+            if (drawn != old_drawn.size()) {
+                printf("  %s: %zu frames drawn, %zu with the old shim\n", emotion, drawn, old_drawn.size());
+                result.mismatches++;
+            }
+        }
+    }
+    return result;
+}
+
+int main() {
+    bool pass = true;
+
+    const int sizes[][2] = {{128, 64}, {128, 32}, {100, 30}};
+    const int shapes = 200000 / 3;
+    for (const auto& size : sizes) {
+        bool same = RandomShapes(size[0], size[1], shapes);
+        printf("%d random shapes on %dx%d, both layouts: %s\n", shapes, size[0], size[1], same ? "PASS" : "FAIL");
+        pass = pass && same;
+    }
+
+    printf("%-28s %7s %10s %10s %7s\n", "12 emotions x 900 ticks", "frames", "old us", "new us", "");
+    struct {
+        const char* name;
+        int height;
+        RoboEyesLayout layout;
+    } runs[] = {
+        {"panel 128x64 (render+pack)", 64, RoboEyesLayout::kPageMajor},
+        {"panel 128x32 (render+pack)", 32, RoboEyesLayout::kPageMajor},
+        {"canvas 128x64 (render)", 64, RoboEyesLayout::kRowMajor},
+        {"canvas 128x32 (render)", 32, RoboEyesLayout::kRowMajor},
+    };
+    for (const auto& run : runs) {
+        RenderResult result = Render(128, run.height, run.layout);
+        bool same = result.frames > 0 && result.mismatches == 0;
+        printf("%-28s %7ld %10.1f %10.1f %7s\n", run.name, result.frames, result.old_us / result.frames,
+            result.new_us / result.frames, same ? "PASS" : "FAIL");
+        pass = pass && same;
+    }
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
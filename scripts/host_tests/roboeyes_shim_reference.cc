@@ -0,0 +1,112 @@
+// The AdafruitShim fills and the page packing of FlushToPanel from before the user-050 commit,
+// kept as the reference for roboeyes_render_test.cc. Logging is stripped; the pixel loops are
+// unchanged.
+#include "roboeyes_shim_reference.h"
+
+#include <algorithm>
+#include <cstring>
+
+void OldAdafruitShim::clearDisplay() {
+    memset(bitbuf_, 0x00, stride_ * h_);
+    drew = true;
+}
+
+void OldAdafruitShim::fillRoundRect(int x, int y, int w, int h, int r, uint8_t color) {
+    bool on = color ? true : false;
+    int x1 = x;
+    int y1 = y;
+    int x2 = x + w - 1;
+    int y2 = y + h - 1;
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= w_) x2 = w_ - 1;
+    if (y2 >= h_) y2 = h_ - 1;
+    if (r > w/2) r = w/2;
+    if (r > h/2) r = h/2;
+    for (int yy = y1; yy <= y2; ++yy) {
+        uint8_t* row = bitbuf_ + yy * stride_;
+        for (int xx = x1; xx <= x2; ++xx) {
+            bool should_draw = true;
+
+            // Check if pixel is in a corner that should be rounded
+            if (xx < x1 + r && yy < y1 + r) {
+                // Top-left corner
+                int dx = (x1 + r) - xx;
+                int dy = (y1 + r) - yy;
+                if (dx*dx + dy*dy > r*r) should_draw = false;
+            } else if (xx > x2 - r && yy < y1 + r) {
+                // Top-right corner
+                int dx = xx - (x2 - r);
+                int dy = (y1 + r) - yy;
+                if (dx*dx + dy*dy > r*r) should_draw = false;
+            } else if (xx < x1 + r && yy > y2 - r) {
+                // Bottom-left corner
+                int dx = (x1 + r) - xx;
+                int dy = yy - (y2 - r);
+                if (dx*dx + dy*dy > r*r) should_draw = false;
+            } else if (xx > x2 - r && yy > y2 - r) {
+                // Bottom-right corner
+                int dx = xx - (x2 - r);
+                int dy = yy - (y2 - r);
+                if (dx*dx + dy*dy > r*r) should_draw = false;
+            }
+            // Non-corner areas are always drawn
+
+            if (should_draw) {
+                int byte_idx = xx / 8;
+                int bit_idx = 7 - (xx % 8);
+                if (on) row[byte_idx] |= (1 << bit_idx);
+                else row[byte_idx] &= ~(1 << bit_idx);
+            }
+        }
+    }
+}
+
+void OldAdafruitShim::fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color) {
+    int minx = std::min({x0, x1, x2});
+    int maxx = std::max({x0, x1, x2});
+    int miny = std::min({y0, y1, y2});
+    int maxy = std::max({y0, y1, y2});
+    if (minx < 0) minx = 0;
+    if (miny < 0) miny = 0;
+    if (maxx >= w_) maxx = w_ - 1;
+    if (maxy >= h_) maxy = h_ - 1;
+    bool on = color ? true : false;
+    auto edge = [](int x0,int y0,int x1,int y1,int x,int y)->bool{
+        return (x - x0) * (y1 - y0) - (y - y0) * (x1 - x0) >= 0;
+    };
+    for (int yy = miny; yy <= maxy; ++yy) {
+        uint8_t* row = bitbuf_ + yy * stride_;
+        for (int xx = minx; xx <= maxx; ++xx) {
+            bool b0 = edge(x0,y0,x1,y1,xx,yy);
+            bool b1 = edge(x1,y1,x2,y2,xx,yy);
+            bool b2 = edge(x2,y2,x0,y0,xx,yy);
+            if ((b0 && b1 && b2) || (!b0 && !b1 && !b2)) {
+                int byte_idx = xx / 8;
+                int bit_idx = 7 - (xx % 8);
+                if (on) row[byte_idx] |= (1 << bit_idx);
+                else row[byte_idx] &= ~(1 << bit_idx);
+            }
+        }
+    }
+}
+
+void OldPackPages(const uint8_t* bitbuf, int width, int height, uint8_t* pages) {
+    int stride = (width + 7) / 8;
+    int page_count = (height + 7) / 8;
+    // For each page (vertical 8-pixel band), for each column, pack bits LSB = top row in page
+    for (int p = 0; p < page_count; ++p) {
+        for (int x = 0; x < width; ++x) {
+            uint8_t b = 0;
+            for (int k = 0; k < 8; ++k) {
+                int y = p * 8 + k;
+                if (y >= height) continue;
+                int byte_idx = (y * stride) + (x / 8);
+                int bit_idx = 7 - (x % 8); // match how AdafruitShim sets bits
+                bool on = (bitbuf[byte_idx] >> bit_idx) & 0x1;
+                if (on) b |= (1 << k);
+            }
+            pages[p * width + x] = b;
+        }
+    }
+}
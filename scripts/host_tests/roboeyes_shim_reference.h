@@ -0,0 +1,29 @@
+// The AdafruitShim replaced in the user-050 commit and the page packing its FlushToPanel did,
+// kept as the reference for roboeyes_render_test.cc (implementation in
+// roboeyes_shim_reference.cc)
+#pragma once
+
+#include <cstdint>
+
+// Sets pixels one at a time in a row-major 1-bit frame (stride (w+7)/8, MSB = leftmost)
+class OldAdafruitShim {
+public:
+    OldAdafruitShim(uint8_t* bitbuf, int w, int h) : bitbuf_(bitbuf), w_(w), h_(h), stride_((w + 7) / 8) {}
+
+    void clearDisplay();
+    void display() {}
+    void fillRoundRect(int x, int y, int w, int h, int r, uint8_t color);
+    void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color);
+
+    // Set by clearDisplay, which RoboEyes calls at the start of every frame it draws
+    bool drew = false;
+
+private:
+    uint8_t* bitbuf_;
+    int w_;
+    int h_;
+    int stride_;
+};
+
+// Transposes a row-major frame into SSD1306 pages, one byte per column, LSB = top row
+void OldPackPages(const uint8_t* bitbuf, int width, int height, uint8_t* pages);
@@ -0,0 +1,103 @@
+// DeviceStateMachine stress test (user-038)
+//
+// Several threads transition concurrently while another adds and removes listeners, and a
+// sync listener sometimes transitions again from inside its callback. Checks that sync
+// listeners never run concurrently and see every change in order (each change starts
+// where the previous one ended), that an async listener sees changes in order apart from
+// the ones dropped from its queue, that both end in the final state, and that a slow async
+// listener does not hold up TransitionTo. The machine is destroyed with its async
+// listeners running, which must stop and join them.
+#include "device_state_machine.h"
+
+#include <esp_timer.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+int main() {
+    bool pass = true;
+    {
+        DeviceStateMachine sm;
+        std::atomic<int> calls{0}, broken{0}, overlap{0}, in_listener{0}, nested{0};
+        DeviceState last_seen = kDeviceStateUnknown;
+        sm.AddStateChangeListener([&](DeviceState o, DeviceState n) {
+            if (in_listener++ != 0) overlap++;
+            calls++;
+            if (o == n || o != last_seen) broken++;
+            last_seen = n;
+            in_listener--;
+            if (n == kDeviceStateSpeaking && calls % 64 == 0) {
+                nested++;
+                sm.TransitionTo(kDeviceStateIdle);
+            }
+        });
+
+        std::atomic<int> async_calls{0}, async_gaps{0};
+        std::atomic<DeviceState> async_last_seen{kDeviceStateUnknown};
+        sm.AddStateChangeListener([&](DeviceState o, DeviceState n) {
+            async_calls++;
+            if (o != async_last_seen) async_gaps++;
+            async_last_seen = n;
+        }, kStateListenerAsync);
+
+        sm.TransitionTo(kDeviceStateStarting);
+        sm.TransitionTo(kDeviceStateActivating);
+        sm.TransitionTo(kDeviceStateIdle);
+
+        std::atomic<int> ok{0};
+        std::vector<std::thread> threads;
+        DeviceState cycle[] = {kDeviceStateConnecting, kDeviceStateListening, kDeviceStateSpeaking, kDeviceStateIdle};
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < 20000; i++) {
+                    if (sm.TransitionTo(cycle[(i + t) % 4])) ok++;
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            for (int i = 0; i < 200; i++) {
+                int sync_id = sm.AddStateChangeListener([](DeviceState, DeviceState) {});
+                int async_id = sm.AddStateChangeListener([](DeviceState, DeviceState) {}, kStateListenerAsync);
+                sm.RemoveStateChangeListener(sync_id);
+                sm.RemoveStateChangeListener(async_id);
+            }
+        });
+        for (auto& t : threads) t.join();
+
+        // Let the async listener catch up with the final state
+        for (int i = 0; i < 1000 && async_last_seen != sm.GetState(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto s = sm.GetStats();
+        bool stress_pass = broken == 0 && overlap == 0 && last_seen == sm.GetState() &&
+            async_gaps <= (int)s.async_dropped && async_last_seen == sm.GetState();
+        printf("ok=%d delivered=%u calls=%d nested=%d broken=%d overlap=%d final=%d last_seen=%d\n",
+            ok.load(), s.transitions, calls.load(), nested.load(), broken.load(), overlap.load(), sm.GetState(), last_seen);
+        printf("async calls=%d gaps=%d dropped=%u last_seen=%d, notify avg=%lldus max=%lldus, async delay max=%lldus: %s\n",
+            async_calls.load(), async_gaps.load(), s.async_dropped, async_last_seen.load(),
+            (long long)(s.notify_total_us / s.transitions), (long long)s.notify_max_us,
+            (long long)s.async_max_delay_us, stress_pass ? "PASS" : "FAIL");
+        pass = pass && stress_pass;
+
+        // A slow async listener only delays its own task
+        sm.AddStateChangeListener([](DeviceState, DeviceState) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }, kStateListenerAsync);
+        int64_t max_us = 0;
+        for (int i = 0; i < 8; i++) {
+            int64_t start = esp_timer_get_time();
+            sm.TransitionTo(sm.GetState() == kDeviceStateIdle ? kDeviceStateConnecting : kDeviceStateIdle);
+            int64_t elapsed = esp_timer_get_time() - start;
+            if (elapsed > max_us) max_us = elapsed;
+        }
+        bool slow_pass = max_us < 5000;
+        printf("slow async listener: TransitionTo max %lldus: %s\n", (long long)max_us, slow_pass ? "PASS" : "FAIL");
+        pass = pass && slow_pass;
+    }
+    printf("destroyed with async listeners running: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
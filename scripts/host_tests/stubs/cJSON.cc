@@ -0,0 +1,136 @@
+#include "cJSON.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+enum { kNull, kFalse, kTrue, kNumber, kString, kArray, kObject };
+
+static cJSON* NewItem(int type) {
+    cJSON* item = (cJSON*)calloc(1, sizeof(cJSON));
+    item->type = type;
+    return item;
+}
+
+cJSON* cJSON_CreateObject() { return NewItem(kObject); }
+cJSON* cJSON_CreateArray() { return NewItem(kArray); }
+
+cJSON* cJSON_CreateString(const char* string) {
+    cJSON* item = NewItem(kString);
+    item->valuestring = strdup(string);
+    return item;
+}
+
+cJSON* cJSON_CreateNumber(double number) {
+    cJSON* item = NewItem(kNumber);
+    item->valuedouble = number;
+    item->valueint = (int)number;
+    return item;
+}
+
+cJSON* cJSON_CreateBool(cJSON_bool boolean) {
+    return NewItem(boolean ? kTrue : kFalse);
+}
+
+cJSON_bool cJSON_AddItemToArray(cJSON* array, cJSON* item) {
+    cJSON** tail = &array->child;
+    while (*tail != nullptr) {
+        tail = &(*tail)->next;
+    }
+    *tail = item;
+    return 1;
+}
+
+cJSON_bool cJSON_AddItemToObject(cJSON* object, const char* name, cJSON* item) {
+    item->string = strdup(name);
+    return cJSON_AddItemToArray(object, item);
+}
+
+cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* string) {
+    cJSON* item = cJSON_CreateString(string);
+    cJSON_AddItemToObject(object, name, item);
+    return item;
+}
+
+cJSON* cJSON_AddNumberToObject(cJSON* object, const char* name, double number) {
+    cJSON* item = cJSON_CreateNumber(number);
+    cJSON_AddItemToObject(object, name, item);
+    return item;
+}
+
+cJSON* cJSON_AddBoolToObject(cJSON* object, const char* name, cJSON_bool boolean) {
+    cJSON* item = cJSON_CreateBool(boolean);
+    cJSON_AddItemToObject(object, name, item);
+    return item;
+}
+
+static void PrintString(std::string& out, const char* s) {
+    out += '"';
+    for (; *s; s++) {
+        switch (*s) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: out += *s; break;
+        }
+    }
+    out += '"';
+}
+
+static void PrintItem(std::string& out, const cJSON* item) {
+    switch (item->type) {
+        case kNull: out += "null"; break;
+        case kFalse: out += "false"; break;
+        case kTrue: out += "true"; break;
+        case kNumber: {
+            char buffer[32];
+            if (item->valuedouble == (double)item->valueint) {
+                snprintf(buffer, sizeof(buffer), "%d", item->valueint);
+            } else {
+                snprintf(buffer, sizeof(buffer), "%g", item->valuedouble);
+            }
+            out += buffer;
+            break;
+        }
+        case kString: PrintString(out, item->valuestring); break;
+        case kArray:
+        case kObject:
+            out += item->type == kArray ? '[' : '{';
+            for (const cJSON* child = item->child; child != nullptr; child = child->next) {
+                if (item->type == kObject) {
+                    PrintString(out, child->string);
+                    out += ':';
+                }
+                PrintItem(out, child);
+                if (child->next != nullptr) {
+                    out += ',';
+                }
+            }
+            out += item->type == kArray ? ']' : '}';
+            break;
+    }
+}
+
+char* cJSON_PrintUnformatted(const cJSON* item) {
+    std::string out;
+    PrintItem(out, item);
+    return strdup(out.c_str());
+}
+
+void cJSON_Delete(cJSON* item) {
+    while (item != nullptr) {
+        cJSON* next = item->next;
+        cJSON_Delete(item->child);
+        free(item->valuestring);
+        free(item->string);
+        free(item);
+        item = next;
+    }
+}
+
+void cJSON_free(void* object) {
+    free(object);
+}
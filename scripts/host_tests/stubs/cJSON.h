@@ -0,0 +1,31 @@
+// Host stand-in for the subset of cJSON that inline firmware headers build and print.
+// Build against ESP-IDF's cJSON instead when exact output or parsing is needed.
+#pragma once
+
+#include <cstddef>
+
+typedef int cJSON_bool;
+
+struct cJSON {
+    cJSON* next;
+    cJSON* child;
+    int type;
+    char* valuestring;
+    int valueint;
+    double valuedouble;
+    char* string;
+};
+
+cJSON* cJSON_CreateObject();
+cJSON* cJSON_CreateArray();
+cJSON* cJSON_CreateString(const char* string);
+cJSON* cJSON_CreateNumber(double number);
+cJSON* cJSON_CreateBool(cJSON_bool boolean);
+cJSON_bool cJSON_AddItemToArray(cJSON* array, cJSON* item);
+cJSON_bool cJSON_AddItemToObject(cJSON* object, const char* name, cJSON* item);
+cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* string);
+cJSON* cJSON_AddNumberToObject(cJSON* object, const char* name, double number);
+cJSON* cJSON_AddBoolToObject(cJSON* object, const char* name, cJSON_bool boolean);
+char* cJSON_PrintUnformatted(const cJSON* item);
+void cJSON_Delete(cJSON* item);
+void cJSON_free(void* object);
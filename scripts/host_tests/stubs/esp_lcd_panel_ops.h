@@ -0,0 +1,12 @@
+// Host stand-in for esp_lcd panel operations: the test defines esp_lcd_panel_draw_bitmap
+// to model the panel it draws to
+#pragma once
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef struct esp_lcd_panel_io_t* esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t* esp_lcd_panel_handle_t;
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+    const void* color_data);
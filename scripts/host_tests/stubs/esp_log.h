@@ -0,0 +1,11 @@
+// Host stand-in for ESP-IDF logging: logs are dropped so they do not skew timings
+#pragma once
+
+// Like the real header, which pulls in stdio.h
+#include <cstdio>
+
+#define ESP_LOGE(tag, format, ...) do { (void)(tag); } while (0)
+#define ESP_LOGW(tag, format, ...) do { (void)(tag); } while (0)
+#define ESP_LOGI(tag, format, ...) do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, format, ...) do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, format, ...) do { (void)(tag); } while (0)
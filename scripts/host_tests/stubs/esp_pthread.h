@@ -0,0 +1,20 @@
+// Host stand-in for esp_pthread: thread settings are accepted and ignored
+#pragma once
+
+#include <cstddef>
+
+typedef struct {
+    size_t stack_size;
+    size_t prio;
+    bool inherit_cfg;
+    const char* thread_name;
+    int pin_to_core;
+} esp_pthread_cfg_t;
+
+inline esp_pthread_cfg_t esp_pthread_get_default_config() {
+    return esp_pthread_cfg_t{3072, 5, false, nullptr, -1};
+}
+
+inline int esp_pthread_set_cfg(const esp_pthread_cfg_t*) {
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "esp_timer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+int64_t esp_timer_get_time() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct HostTimer {
+    esp_timer_create_args_t args;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int64_t deadline_us = -1;
+    bool quit = false;
+    std::thread thread;
+
+    void Loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!quit) {
+            if (deadline_us < 0) {
+                cv.wait(lock);
+                continue;
+            }
+            int64_t now_us = esp_timer_get_time();
+            if (now_us < deadline_us) {
+                cv.wait_for(lock, std::chrono::microseconds(deadline_us - now_us));
+                continue;
+            }
+            deadline_us = -1;
+            lock.unlock();
+            args.callback(args.arg);
+            lock.lock();
+        }
+    }
+};
+
+int esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle) {
+    auto timer = new HostTimer;
+    timer->args = *args;
+    timer->thread = std::thread([timer]() { timer->Loop(); });
+    *out_handle = timer;
+    return 0;
+}
+
+int esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    timer->deadline_us = esp_timer_get_time() + timeout_us;
+    timer->cv.notify_one();
+    return 0;
+}
+
+int esp_timer_stop(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> lock(timer->mutex);
+    timer->deadline_us = -1;
+    return 0;
+}
+
+int esp_timer_delete(esp_timer_handle_t timer) {
+    {
+        std::lock_guard<std::mutex> lock(timer->mutex);
+        timer->quit = true;
+        timer->cv.notify_one();
+    }
+    timer->thread.join();
+    delete timer;
+    return 0;
+}
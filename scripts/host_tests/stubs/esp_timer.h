@@ -0,0 +1,26 @@
+// Host stand-in for esp_timer: a steady clock and one-shot timers, each served by its own
+// thread like callbacks on the esp_timer task
+#pragma once
+
+#include <cstdint>
+
+typedef struct HostTimer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time();
+int esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle);
+int esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+int esp_timer_stop(esp_timer_handle_t timer);
+int esp_timer_delete(esp_timer_handle_t timer);
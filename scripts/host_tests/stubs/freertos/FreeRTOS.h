@@ -0,0 +1,16 @@
+// Host stand-in for FreeRTOS types and macros
+#pragma once
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef struct HostTask* TaskHandle_t;
+
+#define pdPASS 1
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7FFFFFFF
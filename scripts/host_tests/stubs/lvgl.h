@@ -0,0 +1,30 @@
+// Host stand-in for the LVGL calls the RoboEyes adapter makes: objects and timers are
+// placeholders and drawing calls do nothing
+#pragma once
+
+#include <cstdint>
+
+struct lv_obj_t { int unused; };
+struct lv_timer_t { int unused; };
+struct lv_color_t { uint16_t full; };
+
+#define LV_COLOR_FORMAT_RGB565 0x12
+#define LV_OPA_COVER 255
+
+inline lv_color_t lv_color_black() { return {0x0000}; }
+inline lv_color_t lv_color_white() { return {0xFFFF}; }
+inline uint16_t lv_color_to_u16(lv_color_t color) { return color.full; }
+
+inline lv_obj_t* lv_canvas_create(lv_obj_t*) { static lv_obj_t canvas; return &canvas; }
+inline void lv_canvas_set_buffer(lv_obj_t*, void*, int32_t, int32_t, int) {}
+inline void lv_canvas_fill_bg(lv_obj_t*, lv_color_t, uint8_t) {}
+inline void lv_obj_set_size(lv_obj_t*, int32_t, int32_t) {}
+inline void lv_obj_invalidate(lv_obj_t*) {}
+inline void lv_obj_del(lv_obj_t*) {}
+
+inline lv_timer_t* lv_timer_create(void (*callback)(lv_timer_t*), uint32_t period, void* user_data) {
+    (void)callback; (void)period; (void)user_data;
+    static lv_timer_t timer;
+    return &timer;
+}
+inline void lv_timer_del(lv_timer_t*) {}
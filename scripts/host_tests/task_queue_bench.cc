@@ -0,0 +1,122 @@
+// Application::Schedule enqueue and dispatch cost (user-036)
+//
+// Producers push bursts of 8 tasks with 40-byte captures and wait for the consumer to make
+// progress, like network, MCP and display callbacks posting to the main task. Compares the
+// old mutex-guarded std::function deque with TaskQueue at the application's sizes, and
+// counts heap allocations on the way.
+#include "task_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#define MAIN_TASK_QUEUE_SIZE 32
+#define MAIN_TASK_STORAGE_SIZE 48
+
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations++;
+    return malloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+// The queue Application::Schedule used before TaskQueue
+class MutexQueue {
+public:
+    void Push(std::function<void()>&& task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+
+    size_t RunPending() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto tasks = std::move(tasks_);
+        lock.unlock();
+        for (auto& task : tasks) {
+            task();
+        }
+        return tasks.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<std::function<void()>> tasks_;
+};
+
+template <class Queue>
+static void Bench(const char* name, Queue& queue, int producers, int bursts) {
+    std::atomic<long> sum{0};
+    std::atomic<size_t> ran{0};
+    std::atomic<long long> push_ns{0};
+    size_t total = (size_t)producers * bursts * 8;
+    g_allocations = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread consumer([&]() {
+        while (ran < total) {
+            size_t n = queue.RunPending();
+            ran += n;
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int b = 0; b < bursts; b++) {
+                auto burst_start = std::chrono::steady_clock::now();
+                for (int i = 0; i < 8; i++) {
+                    // this, two ints, a long and an int64_t: 40 bytes with the reference
+                    void* self = &queue;
+                    int a = i;
+                    long c = p;
+                    int64_t d = b;
+                    queue.Push([&sum, self, a, c, d]() { sum += a + c + (d & 1) + (self != nullptr); });
+                }
+                push_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - burst_start).count();
+                size_t target = ran.load() + 1;
+                while (ran.load() < target && ran.load() < total) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    consumer.join();
+
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    printf("%-10s producers=%d tasks=%zu  enqueue %.1f ns/task  end-to-end %.1f ns/task  heap allocs %zu\n",
+        name, producers, total, (double)push_ns / total, us * 1000 / total, g_allocations.load());
+}
+
+int main() {
+    for (int producers : {1, 4}) {
+        {
+            MutexQueue queue;
+            Bench("mutex", queue, producers, 5000);
+        }
+        {
+            auto queue = new TaskQueue<MAIN_TASK_QUEUE_SIZE, MAIN_TASK_STORAGE_SIZE>();
+            Bench("taskqueue", *queue, producers, 5000);
+            auto stats = queue->GetStats();
+            printf("           overflow full=%u oversize=%u\n", stats.overflow_full, stats.overflow_oversize);
+            delete queue;
+        }
+    }
+    return 0;
+}
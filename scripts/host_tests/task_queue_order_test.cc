@@ -0,0 +1,99 @@
+// TaskQueue ordering test (user-036)
+//
+// Tasks from each producer must run in push order across the ring and the fallback deque
+// (full ring and oversized captures), including tasks pushed by a running task.
+#include "task_queue.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+int main() {
+    bool pass = true;
+    {
+        // Single producer, interleaving ring, full-ring and oversized pushes
+        TaskQueue<4, 16> q;
+        std::vector<int> order;
+        char big[64] = {};
+        int next = 0;
+        for (int round = 0; round < 1000; round++) {
+            int n = round % 7 + 1;
+            for (int i = 0; i < n; i++) {
+                int v = next++;
+                if (v % 3 == 0) {
+                    q.Push([&order, v, big]() { order.push_back(v + big[0]); });
+                } else {
+                    q.Push([&order, v]() { order.push_back(v); });
+                }
+            }
+            if (round % 2) {
+                q.RunPending();
+            }
+        }
+        q.RunPending();
+        for (size_t i = 0; i < order.size(); i++) {
+            if (order[i] != (int)i) {
+                printf("single producer: out of order at %zu (%d)\n", i, order[i]);
+                pass = false;
+                break;
+            }
+        }
+        if (order.size() != (size_t)next) {
+            printf("single producer: ran %zu of %d\n", order.size(), next);
+            pass = false;
+        }
+    }
+    {
+        // A running task pushes more than the ring holds: the ones that still fit the ring
+        // were pushed first and must run before the ones that went to the fallback deque
+        TaskQueue<4, 16> q;
+        std::vector<int> order;
+        q.Push([&]() {
+            for (int v = 0; v < 10; v++) {
+                q.Push([&order, v]() { order.push_back(v); });
+            }
+        });
+        while (q.RunPending() > 0) {
+        }
+        for (size_t i = 0; i < order.size(); i++) {
+            if (order[i] != (int)i) {
+                printf("pushed while running: out of order at %zu (%d)\n", i, order[i]);
+                pass = false;
+                break;
+            }
+        }
+    }
+    {
+        // Several producers against a small ring, consumer running concurrently
+        TaskQueue<8, 32> q;
+        const int kProducers = 4, kPerProducer = 50000;
+        std::vector<int> last(kProducers, -1);
+        std::atomic<int> done{0};
+        int bad = 0, ran = 0;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < kProducers; p++) {
+            producers.emplace_back([&, p]() {
+                for (int i = 0; i < kPerProducer; i++) {
+                    q.Push([&, p, i]() {
+                        if (i != last[p] + 1) bad++;
+                        last[p] = i;
+                        ran++;
+                    });
+                }
+                done++;
+            });
+        }
+        while (done < kProducers) {
+            q.RunPending();
+        }
+        for (auto& t : producers) t.join();
+        while (q.RunPending() > 0) {
+        }
+        auto stats = q.GetStats();
+        printf("multi producer: ran %d, out of order %d, pushed %u, ring full %u\n", ran, bad, stats.pushed, stats.overflow_full);
+        if (bad != 0 || ran != kProducers * kPerProducer) pass = false;
+    }
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
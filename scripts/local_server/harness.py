@@ -0,0 +1,396 @@
+# 端到端压测工具
+# 按设备端 WebsocketProtocol / MqttProtocol 的报文格式模拟多个设备并发对话,
+# 统计建连耗时、RTT、吞吐与丢帧率, 可在上行注入抖动与丢包
+import argparse
+import asyncio
+import json
+import statistics
+import time
+import uuid
+
+import websockets
+
+import wire
+
+
+def now_ms():
+    return time.monotonic() * 1000
+
+
+class TurnStats:
+    def __init__(self):
+        self.first_audio_ms = None
+        self.frames_expected = 0
+        self.frames_received = 0
+        self.bytes_received = 0
+        self.bytes_sent = 0
+        self.jitter = 0.0
+        self.last_arrival = None
+        self.duration_ms = 0
+
+    def on_audio(self, start_ms, payload, frame_duration):
+        arrival = now_ms()
+        if self.first_audio_ms is None:
+            self.first_audio_ms = arrival - start_ms
+        elif self.last_arrival is not None:
+            # RFC 3550 抖动, 与设备端 Protocol::RecordIncomingAudio 一致
+            d = abs((arrival - self.last_arrival) - frame_duration)
+            self.jitter += (d - self.jitter) / 16
+        self.last_arrival = arrival
+        self.frames_received += 1
+        self.bytes_received += len(payload)
+
+
+class Client:
+    """一个模拟设备, 子类实现具体传输"""
+
+    def __init__(self, args, index):
+        self.args = args
+        self.index = index
+        self.device_id = f'02:00:00:00:{index >> 8 & 0xFF:02x}:{index & 0xFF:02x}'
+        self.client_id = str(uuid.uuid4())
+        self.session_id = ''
+        self.impairment = wire.LinkImpairment(args.jitter, args.loss, None if args.seed is None else args.seed + index)
+        self.uplink = wire.dummy_opus_frames(args.uplink_frames, 40)
+        self.frame_duration = 60
+        self.connect_ms = None
+        self.hello_ms = None
+        self.rtts = []
+        self.turns = []
+        self.errors = []
+        self.pending_pings = {}
+        self.server_hello = asyncio.Event()
+        self.tts_stop = asyncio.Event()
+        self.turn = None
+        self.turn_start = 0
+        self.binary_control = False
+        self.ping_supported = False
+        self.control_bytes_up = 0
+        self.control_bytes_down = 0
+        self.mcp_calls = 0
+        self.mcp_frames_up = 0
+        self.mcp_lock = asyncio.Lock()
+
+    def hello_message(self, version, transport):
+        return {
+            'type': 'hello',
+            'version': version,
+            'transport': transport,
+            'features': {'mcp': True, 'binary_control': self.args.binary_control, 'ping': True},
+            'audio_params': {'format': 'opus', 'sample_rate': 16000, 'channels': 1, 'frame_duration': 60},
+        }
+
+    def on_json(self, data):
+        msg_type = data.get('type')
+        if msg_type == 'hello':
+            self.session_id = data.get('session_id', '')
+            self.frame_duration = data.get('audio_params', {}).get('frame_duration', 60)
+            self.binary_control = data.get('features', {}).get('binary_control', False)
+            self.ping_supported = data.get('features', {}).get('ping', False)
+            self.on_server_hello(data)
+            self.server_hello.set()
+        elif msg_type == 'pong':
+            sent = self.pending_pings.pop(data.get('id'), None)
+            if sent is not None:
+                self.rtts.append(now_ms() - sent)
+        elif msg_type == 'mcp':
+            asyncio.ensure_future(self.on_mcp(data.get('payload')))
+        elif msg_type == 'tts' and data.get('state') == 'stop':
+            if self.turn is not None:
+                self.turn.frames_expected = data.get('frames', self.turn.frames_received)
+            self.tts_stop.set()
+
+    def on_server_hello(self, data):
+        pass
+
+    async def on_mcp(self, payload):
+        """模拟设备端 McpServer: 每个工具耗时 --mcp-tool-ms, batch 请求合并成一个数组回复"""
+        requests = payload if isinstance(payload, list) else [payload]
+        responses = []
+        # 与固件一样, 默认的工具在主循环上逐个执行
+        async with self.mcp_lock:
+            for request in requests:
+                if 'id' not in request:
+                    continue
+                await asyncio.sleep(self.args.mcp_tool_ms / 1000)
+                self.mcp_calls += 1
+                responses.append({'jsonrpc': '2.0', 'id': request['id'],
+                                  'result': {'content': [{'type': 'text', 'text': 'true'}], 'isError': False}})
+        if not responses:
+            return
+        self.mcp_frames_up += 1
+        reply = responses if isinstance(payload, list) else responses[0]
+        await self.send_json({'session_id': self.session_id, 'type': 'mcp', 'payload': reply})
+
+    def on_audio(self, payload):
+        if self.turn is not None:
+            self.turn.on_audio(self.turn_start, payload, self.frame_duration)
+
+    async def send_json(self, message):
+        raise NotImplementedError
+
+    async def send_audio(self, payload, timestamp):
+        raise NotImplementedError
+
+    async def connect(self):
+        raise NotImplementedError
+
+    async def close(self):
+        pass
+
+    async def ping(self, ping_id):
+        self.pending_pings[ping_id] = now_ms()
+        await self.send_json({'session_id': self.session_id, 'type': 'ping', 'id': ping_id})
+
+    async def run_turn(self):
+        self.turn = TurnStats()
+        self.tts_stop.clear()
+        await self.send_json({'session_id': self.session_id, 'type': 'listen', 'state': 'start', 'mode': 'manual'})
+        start = now_ms()
+        for i, payload in enumerate(self.uplink):
+            target = start + i * 60
+            wait = target - now_ms()
+            if wait > 0:
+                await asyncio.sleep(wait / 1000)
+            if self.impairment.should_drop():
+                continue
+            await self.impairment.delay()
+            await self.send_audio(payload, i * 60)
+            self.turn.bytes_sent += len(payload)
+        await self.send_json({'session_id': self.session_id, 'type': 'listen', 'state': 'stop'})
+        # 从说完话开始计时, 即用户感知的响应延迟
+        self.turn_start = now_ms()
+        await asyncio.wait_for(self.tts_stop.wait(), self.args.timeout)
+        self.turn.duration_ms = now_ms() - start
+        self.turns.append(self.turn)
+        self.turn = None
+
+    async def run(self):
+        try:
+            start = now_ms()
+            await self.connect()
+            self.connect_ms = now_ms() - start
+            start = now_ms()
+            await asyncio.wait_for(self.server_hello.wait(), self.args.timeout)
+            self.hello_ms = now_ms() - start
+            for turn in range(self.args.turns):
+                # 与固件一致, 服务器未确认 ping 时不探测
+                if self.ping_supported:
+                    await self.ping(turn + 1)
+                await self.run_turn()
+        except Exception as e:
+            self.errors.append(repr(e))
+        finally:
+            await self.close()
+
+
+class WebsocketClient(Client):
+    async def connect(self):
+        headers = {
+            'Authorization': 'Bearer local',
+            'Protocol-Version': str(self.args.version),
+            'Device-Id': self.device_id,
+            'Client-Id': self.client_id,
+        }
+        try:
+            self.ws = await websockets.connect(self.args.url, additional_headers=headers, max_size=None)
+        except TypeError:
+            # websockets < 14
+            self.ws = await websockets.connect(self.args.url, extra_headers=headers, max_size=None)
+        self.reader = asyncio.ensure_future(self.read_loop())
+        await self.send_json(self.hello_message(self.args.version, 'websocket'))
+
+    async def read_loop(self):
+        try:
+            async for message in self.ws:
+                if isinstance(message, bytes):
+                    frame_type, _, payload = wire.unpack_binary(self.args.version, message)
+                    if frame_type == wire.TYPE_CONTROL:
+                        self.control_bytes_down += len(message)
+                        opcode, _, text = wire.unpack_control(payload)
+                        data = wire.downlink_control_to_json(opcode, text)
+                        if data is not None:
+                            self.on_json(data)
+                    else:
+                        self.on_audio(payload)
+                else:
+                    self.control_bytes_down += len(message.encode())
+                    self.on_json(json.loads(message))
+        except websockets.ConnectionClosed:
+            pass
+
+    async def send_json(self, message):
+        if self.binary_control:
+            frame = self.json_to_uplink_control(message)
+            if frame is not None:
+                self.control_bytes_up += len(frame)
+                await self.ws.send(frame)
+                return
+        text = json.dumps(message)
+        self.control_bytes_up += len(text.encode())
+        await self.ws.send(text)
+
+    def json_to_uplink_control(self, message):
+        msg_type = message.get('type')
+        state = message.get('state')
+        if msg_type == 'listen' and state == 'start':
+            return wire.pack_control(self.args.version, 0x01, wire.LISTEN_MODES.index(message.get('mode', 'auto')))
+        if msg_type == 'listen' and state == 'stop':
+            return wire.pack_control(self.args.version, 0x02)
+        if msg_type == 'listen' and state == 'detect':
+            return wire.pack_control(self.args.version, 0x03, 0, message.get('text', ''))
+        if msg_type == 'abort':
+            return wire.pack_control(self.args.version, 0x04, 1 if message.get('reason') else 0)
+        return None
+
+    async def send_audio(self, payload, timestamp):
+        await self.ws.send(wire.pack_audio(self.args.version, payload, timestamp))
+
+    async def close(self):
+        if hasattr(self, 'ws'):
+            await self.ws.close()
+            self.reader.cancel()
+
+
+class UdpClientProtocol(asyncio.DatagramProtocol):
+    def __init__(self, client):
+        self.client = client
+
+    def datagram_received(self, data, address):
+        self.client.on_udp(data)
+
+
+class MqttClient(Client):
+    async def connect(self):
+        import paho.mqtt.client as mqtt
+        self.loop = asyncio.get_running_loop()
+        self.remote_sequence = 0
+        self.lost = 0
+        self.local_sequence = 0
+        self.udp = None
+        self.mqtt = mqtt.Client(mqtt.CallbackAPIVersion.VERSION2, client_id=self.client_id)
+        self.mqtt.on_message = lambda c, u, msg: self.loop.call_soon_threadsafe(self.on_json, json.loads(msg.payload))
+        connected = asyncio.Event()
+        self.mqtt.on_connect = lambda *a: self.loop.call_soon_threadsafe(connected.set)
+        self.mqtt.connect(self.args.mqtt_broker, self.args.mqtt_port)
+        self.mqtt.subscribe(self.args.mqtt_reply_topic.format(client_id=self.client_id))
+        self.mqtt.loop_start()
+        await asyncio.wait_for(connected.wait(), self.args.timeout)
+        await self.send_json(self.hello_message(3, 'udp'))
+
+    def on_server_hello(self, data):
+        udp = data['udp']
+        self.key = bytes.fromhex(udp['key'])
+        self.nonce = bytes.fromhex(udp['nonce'])
+        asyncio.ensure_future(self.open_udp(udp['server'], udp['port']))
+
+    async def open_udp(self, host, port):
+        self.udp, _ = await self.loop.create_datagram_endpoint(
+            lambda: UdpClientProtocol(self), remote_addr=(host, port))
+
+    def on_udp(self, data):
+        result = wire.unpack_udp(self.key, data)
+        if result is None:
+            return
+        _, sequence, payload = result
+        if self.remote_sequence and sequence != self.remote_sequence + 1:
+            self.lost += sequence - self.remote_sequence - 1
+        self.remote_sequence = sequence
+        self.on_audio(payload)
+
+    async def send_json(self, message):
+        topic = self.args.mqtt_device_topic.replace('#', self.client_id)
+        self.mqtt.publish(topic, json.dumps(message))
+
+    async def send_audio(self, payload, timestamp):
+        if self.udp is None:
+            return
+        self.local_sequence += 1
+        self.udp.sendto(wire.pack_udp(self.key, self.nonce, payload, timestamp, self.local_sequence))
+
+    async def close(self):
+        if hasattr(self, 'mqtt'):
+            await self.send_json({'session_id': self.session_id, 'type': 'goodbye'})
+            self.mqtt.loop_stop()
+            self.mqtt.disconnect()
+        if self.udp is not None:
+            self.udp.close()
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def report(clients, elapsed_ms):
+    turns = [t for c in clients for t in c.turns]
+    connects = [c.connect_ms for c in clients if c.connect_ms is not None]
+    hellos = [c.hello_ms for c in clients if c.hello_ms is not None]
+    rtts = [r for c in clients for r in c.rtts]
+    first_audio = [t.first_audio_ms for t in turns if t.first_audio_ms is not None]
+    expected = sum(t.frames_expected for t in turns)
+    received = sum(t.frames_received for t in turns)
+    bytes_down = sum(t.bytes_received for t in turns)
+    bytes_up = sum(t.bytes_sent for t in turns)
+
+    def line(name, values):
+        if values:
+            print(f'  {name:<22} avg {statistics.mean(values):8.1f}  p50 {percentile(values, 50):8.1f}  '
+                  f'p95 {percentile(values, 95):8.1f}  max {max(values):8.1f} ms')
+
+    print(f'\nClients: {len(clients)}, turns: {len(turns)}, errors: {sum(len(c.errors) for c in clients)}')
+    line('connect', connects)
+    line('hello round trip', hellos)
+    line('ping rtt', rtts)
+    line('first tts audio', first_audio)
+    line('downlink jitter', [t.jitter for t in turns])
+    seconds = elapsed_ms / 1000
+    print(f'  throughput             up {bytes_up * 8 / seconds / 1000:8.1f} kbps  down {bytes_down * 8 / seconds / 1000:8.1f} kbps')
+    control_up = sum(c.control_bytes_up for c in clients)
+    control_down = sum(c.control_bytes_down for c in clients)
+    if turns and (control_up or control_down):
+        print(f'  control bytes / turn   up {control_up / len(turns):8.1f}  down {control_down / len(turns):8.1f}')
+    mcp_calls = sum(c.mcp_calls for c in clients)
+    if mcp_calls:
+        print(f'  mcp tool calls         {mcp_calls} answered in {sum(c.mcp_frames_up for c in clients)} frames')
+    if expected:
+        print(f'  downlink frames        {received}/{expected} received, loss {(expected - received) * 100 / expected:.2f}%')
+    for c in clients:
+        for e in c.errors:
+            print(f'  client {c.index}: {e}')
+
+
+async def run(args):
+    cls = MqttClient if args.transport == 'mqtt' else WebsocketClient
+    clients = [cls(args, i) for i in range(args.clients)]
+    start = now_ms()
+    await asyncio.gather(*(c.run() for c in clients))
+    report(clients, now_ms() - start)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='小智协议端到端压测工具')
+    parser.add_argument('--transport', choices=['websocket', 'mqtt'], default='websocket')
+    parser.add_argument('--url', default='ws://127.0.0.1:8765/xiaozhi/v1/')
+    parser.add_argument('--version', type=int, choices=[1, 2, 3], default=1, help='websocket 二进制协议版本')
+    parser.add_argument('--mqtt-broker', default='127.0.0.1')
+    parser.add_argument('--mqtt-port', type=int, default=1883)
+    parser.add_argument('--mqtt-device-topic', default='device-server/#')
+    parser.add_argument('--mqtt-reply-topic', default='devices/p2p/{client_id}')
+    parser.add_argument('--binary-control', action='store_true', help='协商二进制控制帧 (需要 --version 2 或 3)')
+    parser.add_argument('--mcp-tool-ms', type=int, default=5, help='模拟每个 MCP 工具的执行耗时 ms')
+    parser.add_argument('--clients', type=int, default=1, help='并发模拟设备数')
+    parser.add_argument('--turns', type=int, default=3, help='每个设备的对话轮数')
+    parser.add_argument('--uplink-frames', type=int, default=25, help='每轮上行音频帧数 (60ms/帧)')
+    parser.add_argument('--jitter', type=int, default=0, help='上行注入的随机时延上限 ms')
+    parser.add_argument('--loss', type=float, default=0.0, help='上行注入的丢帧率 %%')
+    parser.add_argument('--seed', type=int, default=None)
+    parser.add_argument('--timeout', type=float, default=30.0)
+    args = parser.parse_args()
+    asyncio.run(run(args))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,404 @@
+# 本地替身对话服务器
+# 不依赖云端, 模拟 websocket (BinaryProtocol 1/2/3) 与 MQTT + UDP (AES-CTR) 两种通道,
+# 回复 hello / stt / llm / tts 消息并按帧时长下发 Opus 音频, 可注入抖动与丢包
+import argparse
+import asyncio
+import json
+import os
+import threading
+import time
+import uuid
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+import websockets
+
+import wire
+
+
+def now_ms():
+    return int(time.monotonic() * 1000)
+
+
+class Session:
+    """一次对话会话, 与具体传输无关"""
+
+    def __init__(self, server, name):
+        self.server = server
+        self.name = name
+        self.session_id = str(uuid.uuid4())
+        self.listen_mode = 'auto'
+        self.uplink_frames = 0
+        self.tts_task = None
+        self.mcp_next_id = 1
+        self.mcp_pending = {}
+        self.mcp_frames = 0
+
+    async def send_json(self, message):
+        raise NotImplementedError
+
+    async def send_audio(self, payload, timestamp):
+        raise NotImplementedError
+
+    async def on_json(self, message):
+        msg_type = message.get('type')
+        if msg_type == 'listen':
+            state = message.get('state')
+            if state == 'start':
+                self.listen_mode = message.get('mode', 'auto')
+                self.uplink_frames = 0
+            elif state == 'stop':
+                self.start_reply()
+            elif state == 'detect':
+                print(f'[{self.name}] wake word: {message.get("text")}')
+                self.start_reply()
+        elif msg_type == 'abort':
+            if self.tts_task is not None:
+                self.tts_task.cancel()
+        elif msg_type == 'ping':
+            await self.send_json({'type': 'pong', 'id': message.get('id')})
+        elif msg_type == 'mcp':
+            self.on_mcp(message.get('payload'))
+        else:
+            print(f'[{self.name}] unhandled message: {message}')
+
+    def on_mcp(self, payload):
+        # 设备对 batch 请求回复一个数组, 对单个请求回复一个对象
+        self.mcp_frames += 1
+        responses = payload if isinstance(payload, list) else [payload]
+        for response in responses:
+            future = self.mcp_pending.pop(response.get('id'), None)
+            if future is not None and not future.done():
+                future.set_result(response)
+
+    async def run_mcp_bursts(self):
+        """连续下发多个 tools/call, 统计全部回复的总耗时"""
+        args = self.server.args
+        arguments = json.loads(args.mcp_arguments)
+        turnarounds = []
+        for _ in range(args.mcp_rounds):
+            requests = []
+            for _ in range(args.mcp_burst):
+                requests.append({'jsonrpc': '2.0', 'id': self.mcp_next_id, 'method': 'tools/call',
+                                 'params': {'name': args.mcp_tool, 'arguments': arguments}})
+                self.mcp_pending[self.mcp_next_id] = asyncio.get_running_loop().create_future()
+                self.mcp_next_id += 1
+            futures = [self.mcp_pending[r['id']] for r in requests]
+            frames = self.mcp_frames
+            start = now_ms()
+            if args.mcp_batch:
+                await self.send_json({'session_id': self.session_id, 'type': 'mcp', 'payload': requests})
+            else:
+                for request in requests:
+                    await self.send_json({'session_id': self.session_id, 'type': 'mcp', 'payload': request})
+            try:
+                responses = await asyncio.wait_for(asyncio.gather(*futures), 30)
+            except asyncio.TimeoutError:
+                print(f'[{self.name}] mcp burst timed out')
+                return
+            turnarounds.append(now_ms() - start)
+            errors = sum(1 for r in responses if 'error' in r)
+            print(f'[{self.name}] mcp burst: {len(requests)} calls, {self.mcp_frames - frames} reply frames, '
+                  f'{errors} errors, {turnarounds[-1]} ms')
+            await asyncio.sleep(args.mcp_interval / 1000)
+        print(f'[{self.name}] mcp bursts done, batch={args.mcp_batch}, avg {sum(turnarounds) / len(turnarounds):.1f} ms')
+
+    async def on_audio(self, payload):
+        self.uplink_frames += 1
+        # auto 模式下用固定帧数代替服务端 VAD 判断说话结束
+        if self.listen_mode == 'auto' and self.uplink_frames == self.server.args.vad_frames:
+            self.start_reply()
+
+    def start_reply(self):
+        if self.tts_task is None or self.tts_task.done():
+            self.tts_task = asyncio.ensure_future(self.reply())
+
+    async def reply(self):
+        args = self.server.args
+        await self.send_json({'session_id': self.session_id, 'type': 'stt', 'text': '你好'})
+        await self.send_json({'session_id': self.session_id, 'type': 'llm', 'text': '😊', 'emotion': 'happy'})
+        await self.send_json({'session_id': self.session_id, 'type': 'tts', 'state': 'start'})
+        await self.send_json({'session_id': self.session_id, 'type': 'tts', 'state': 'sentence_start', 'text': '你好，我是本地测试服务器'})
+        frames = self.server.tts_frames
+        start = now_ms()
+        sent = 0
+        try:
+            for i, payload in enumerate(frames):
+                # 按播放时钟节奏下发, 与真实服务器一致
+                target = start + i * args.frame_duration
+                wait = target - now_ms()
+                if wait > 0:
+                    await asyncio.sleep(wait / 1000)
+                if self.server.impairment.should_drop():
+                    continue
+                await self.server.impairment.delay()
+                await self.send_audio(payload, i * args.frame_duration)
+                sent += 1
+        finally:
+            # frames 为附加字段, 设备端会忽略, 压测工具用它计算丢帧率
+            await self.send_json({'session_id': self.session_id, 'type': 'tts', 'state': 'stop', 'frames': len(frames)})
+        print(f'[{self.name}] tts done, {sent}/{len(frames)} frames sent')
+
+
+class WebsocketSession(Session):
+    def __init__(self, server, ws, version):
+        super().__init__(server, f'ws:{id(ws) & 0xFFFF:04x}')
+        self.ws = ws
+        self.version = version
+        self.binary_control = False
+
+    async def send_json(self, message):
+        control = wire.json_to_control(message) if self.binary_control else None
+        if control is not None:
+            opcode, text = control
+            await self.ws.send(wire.pack_control(self.version, opcode, 0, text))
+            return
+        await self.ws.send(json.dumps(message, ensure_ascii=False))
+
+    async def send_audio(self, payload, timestamp):
+        await self.ws.send(wire.pack_audio(self.version, payload, timestamp))
+
+
+class UdpSession(Session):
+    def __init__(self, server, client_id):
+        super().__init__(server, f'mqtt:{client_id}')
+        self.client_id = client_id
+        self.key = os.urandom(16)
+        self.ssrc = os.urandom(4)
+        self.nonce = bytes([0x01, 0x00, 0x00, 0x00]) + self.ssrc + bytes(8)
+        self.address = None
+        self.remote_sequence = 0
+        self.local_sequence = 0
+
+    async def send_json(self, message):
+        self.server.mqtt_publish(self.client_id, message)
+
+    async def send_audio(self, payload, timestamp):
+        if self.address is None:
+            return
+        self.local_sequence += 1
+        packet = wire.pack_udp(self.key, self.nonce, payload, timestamp, self.local_sequence)
+        self.server.udp_transport.sendto(packet, self.address)
+
+
+class UdpAudioProtocol(asyncio.DatagramProtocol):
+    def __init__(self, server):
+        self.server = server
+
+    def datagram_received(self, data, address):
+        if len(data) < wire.UDP_NONCE.size:
+            return
+        session = self.server.udp_sessions.get(bytes(data[4:8]))
+        if session is None:
+            return
+        session.address = address
+        result = wire.unpack_udp(session.key, data)
+        if result is None:
+            return
+        _, sequence, payload = result
+        session.remote_sequence = sequence
+        asyncio.ensure_future(session.on_audio(payload))
+
+
+class LocalServer:
+    def __init__(self, args):
+        self.args = args
+        self.impairment = wire.LinkImpairment(args.jitter, args.loss, args.seed)
+        if args.tts_p3:
+            self.tts_frames = wire.read_p3(args.tts_p3)
+        else:
+            self.tts_frames = wire.dummy_opus_frames(args.tts_frames)
+        self.loop = None
+        self.udp_transport = None
+        self.udp_sessions = {}
+        self.mqtt_sessions = {}
+        self.mqtt_client = None
+
+    def server_hello(self, session, transport):
+        return {
+            'type': 'hello',
+            'transport': transport,
+            'session_id': session.session_id,
+            'audio_params': {
+                'format': 'opus',
+                'sample_rate': self.args.sample_rate,
+                'channels': 1,
+                'frame_duration': self.args.frame_duration,
+            },
+        }
+
+    async def handle_websocket(self, ws):
+        request = getattr(ws, 'request', None)
+        headers = request.headers if request is not None else ws.request_headers
+        version = int(headers.get('Protocol-Version', '1'))
+        session = WebsocketSession(self, ws, version)
+        print(f'[{session.name}] connected, device={headers.get("Device-Id")} version={version}')
+        try:
+            async for message in ws:
+                if isinstance(message, bytes):
+                    frame_type, _, payload = wire.unpack_binary(version, message)
+                    if frame_type == wire.TYPE_CONTROL:
+                        data = wire.control_to_json(session.session_id, *wire.unpack_control(payload))
+                        if data is not None:
+                            await session.on_json(data)
+                    else:
+                        await session.on_audio(payload)
+                    continue
+                data = json.loads(message)
+                if data.get('type') == 'hello':
+                    hello = self.server_hello(session, 'websocket')
+                    features = data.get('features', {})
+                    hello['features'] = {}
+                    if features.get('binary_control') and version >= 2 and not self.args.no_binary_control:
+                        hello['features']['binary_control'] = True
+                    # 设备只在服务器确认 ping 后才发送链路探测
+                    if features.get('ping'):
+                        hello['features']['ping'] = True
+                    await session.send_json(hello)
+                    session.binary_control = hello['features'].get('binary_control', False)
+                    if self.args.mcp_burst:
+                        asyncio.ensure_future(session.run_mcp_bursts())
+                else:
+                    await session.on_json(data)
+        except websockets.ConnectionClosed:
+            pass
+        print(f'[{session.name}] disconnected')
+
+    # MQTT 回调在 paho 线程中执行, 转到事件循环处理
+    def on_mqtt_message(self, client, userdata, msg):
+        client_id = msg.topic.split('/')[-1]
+        data = json.loads(msg.payload)
+        asyncio.run_coroutine_threadsafe(self.handle_mqtt_json(client_id, data), self.loop)
+
+    async def handle_mqtt_json(self, client_id, data):
+        msg_type = data.get('type')
+        if msg_type == 'hello':
+            session = UdpSession(self, client_id)
+            old = self.mqtt_sessions.pop(client_id, None)
+            if old is not None:
+                self.udp_sessions.pop(old.ssrc, None)
+            self.mqtt_sessions[client_id] = session
+            self.udp_sessions[session.ssrc] = session
+            hello = self.server_hello(session, 'udp')
+            hello['udp'] = {
+                'server': self.args.udp_host,
+                'port': self.args.udp_port,
+                'key': session.key.hex().upper(),
+                'nonce': session.nonce.hex().upper(),
+            }
+            if data.get('features', {}).get('ping'):
+                hello['features'] = {'ping': True}
+            await session.send_json(hello)
+            print(f'[{session.name}] udp session {session.session_id}')
+            if self.args.mcp_burst:
+                asyncio.ensure_future(session.run_mcp_bursts())
+        elif msg_type == 'goodbye':
+            session = self.mqtt_sessions.pop(client_id, None)
+            if session is not None:
+                self.udp_sessions.pop(session.ssrc, None)
+                print(f'[{session.name}] goodbye')
+        else:
+            session = self.mqtt_sessions.get(client_id)
+            if session is not None:
+                await session.on_json(data)
+
+    def mqtt_publish(self, client_id, message):
+        topic = self.args.mqtt_reply_topic.format(client_id=client_id)
+        self.mqtt_client.publish(topic, json.dumps(message, ensure_ascii=False))
+
+    def start_mqtt(self):
+        import paho.mqtt.client as mqtt
+        client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION2, client_id='xiaozhi-local-server')
+        client.on_message = self.on_mqtt_message
+        client.connect(self.args.mqtt_broker, self.args.mqtt_port)
+        client.subscribe(self.args.mqtt_device_topic)
+        client.loop_start()
+        self.mqtt_client = client
+        print(f'MQTT: broker {self.args.mqtt_broker}:{self.args.mqtt_port}, listening on {self.args.mqtt_device_topic}')
+
+    def start_ota(self):
+        """让真实设备把 OTA 地址指向本机, 即可拿到本地 websocket / mqtt 配置"""
+        args = self.args
+
+        class OtaHandler(BaseHTTPRequestHandler):
+            def do_POST(self):
+                length = int(self.headers.get('Content-Length', 0))
+                self.rfile.read(length)
+                client_id = self.headers.get('Client-Id', 'device')
+                body = {
+                    'server_time': {'timestamp': int(time.time() * 1000), 'timezone_offset': 480},
+                    'firmware': {'version': '0.0.0', 'url': ''},
+                    'websocket': {'url': f'ws://{args.public_host}:{args.ws_port}/xiaozhi/v1/', 'token': 'local'},
+                }
+                if args.mqtt_broker:
+                    body['mqtt'] = {
+                        'endpoint': f'{args.public_host}:{args.mqtt_port}',
+                        'client_id': client_id,
+                        'username': '',
+                        'password': '',
+                        'publish_topic': args.mqtt_device_topic.replace('#', client_id),
+                    }
+                data = json.dumps(body).encode()
+                self.send_response(200)
+                self.send_header('Content-Type', 'application/json')
+                self.send_header('Content-Length', str(len(data)))
+                self.end_headers()
+                self.wfile.write(data)
+
+            do_GET = do_POST
+
+            def log_message(self, format, *args):
+                pass
+
+        httpd = ThreadingHTTPServer(('0.0.0.0', args.ota_port), OtaHandler)
+        threading.Thread(target=httpd.serve_forever, daemon=True).start()
+        print(f'OTA: http://{args.public_host}:{args.ota_port}/xiaozhi/ota/')
+
+    async def run(self):
+        self.loop = asyncio.get_running_loop()
+        if self.args.mqtt_broker:
+            self.udp_transport, _ = await self.loop.create_datagram_endpoint(
+                lambda: UdpAudioProtocol(self), local_addr=('0.0.0.0', self.args.udp_port))
+            self.start_mqtt()
+        if self.args.ota_port:
+            self.start_ota()
+        async with websockets.serve(self.handle_websocket, '0.0.0.0', self.args.ws_port, max_size=None):
+            print(f'Websocket: ws://0.0.0.0:{self.args.ws_port}, {len(self.tts_frames)} tts frames per reply')
+            await asyncio.Future()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='小智本地替身对话服务器')
+    parser.add_argument('--ws-port', type=int, default=8765, help='websocket 端口 (默认: 8765)')
+    parser.add_argument('--ota-port', type=int, default=8002, help='OTA 配置接口端口, 0 为关闭 (默认: 8002)')
+    parser.add_argument('--public-host', default='127.0.0.1', help='下发给设备的本机地址 (默认: 127.0.0.1)')
+    parser.add_argument('--mqtt-broker', default='', help='MQTT broker 地址, 为空时不启用 MQTT 通道')
+    parser.add_argument('--mqtt-port', type=int, default=1883)
+    parser.add_argument('--mqtt-device-topic', default='device-server/#', help='设备发布消息的主题')
+    parser.add_argument('--mqtt-reply-topic', default='devices/p2p/{client_id}', help='回复设备的主题')
+    parser.add_argument('--udp-host', default='127.0.0.1', help='server hello 中下发的 UDP 地址')
+    parser.add_argument('--udp-port', type=int, default=8884)
+    parser.add_argument('--sample-rate', type=int, default=24000, help='下行音频采样率')
+    parser.add_argument('--frame-duration', type=int, default=60, help='下行帧时长 ms')
+    parser.add_argument('--tts-p3', default='', help='用作 TTS 回复的 p3 文件, 为空时发送伪造帧')
+    parser.add_argument('--tts-frames', type=int, default=50, help='伪造 TTS 帧数')
+    parser.add_argument('--vad-frames', type=int, default=25, help='auto 模式下收到多少帧上行音频后回复')
+    parser.add_argument('--jitter', type=int, default=0, help='下行注入的随机时延上限 ms')
+    parser.add_argument('--loss', type=float, default=0.0, help='下行注入的丢帧率 %%')
+    parser.add_argument('--seed', type=int, default=None)
+    parser.add_argument('--no-binary-control', action='store_true', help='不协商二进制控制帧, 始终使用 JSON')
+    parser.add_argument('--mcp-burst', type=int, default=0, help='hello 后每轮连续下发的 tools/call 个数, 0 为关闭')
+    parser.add_argument('--mcp-rounds', type=int, default=5, help='tools/call 突发轮数')
+    parser.add_argument('--mcp-interval', type=int, default=500, help='两轮突发之间的间隔 ms')
+    parser.add_argument('--mcp-batch', action='store_true', help='把一轮突发打包成一个 JSON-RPC batch 数组')
+    parser.add_argument('--mcp-tool', default='self.get_device_status', help='调用的工具名')
+    parser.add_argument('--mcp-arguments', default='{}', help='工具参数 (JSON)')
+    args = parser.parse_args()
+
+    try:
+        asyncio.run(LocalServer(args).run())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,182 @@
+# 本地替身服务器与压测工具共用的协议编解码
+# 与 main/protocols/protocol.h, websocket_protocol.cc, mqtt_protocol.cc 保持一致
+import asyncio
+import random
+import struct
+
+from cryptography.hazmat.primitives.ciphers import Cipher, algorithms, modes
+
+
+# BinaryProtocol2: |version 2u|type 2u|reserved 4u|timestamp 4u|payload_size 4u|payload|
+BP2_HEADER = struct.Struct('>HHIII')
+# BinaryProtocol3: |type 1u|reserved 1u|payload_size 2u|payload|
+BP3_HEADER = struct.Struct('>BBH')
+# BinaryControl: |opcode 1u|arg 1u|text_size 2u|text|, 放在 type=2 的 BinaryProtocol2/3 帧中
+CONTROL_HEADER = struct.Struct('>BBH')
+TYPE_AUDIO = 0
+TYPE_CONTROL = 2
+
+LISTEN_MODES = ['auto', 'manual', 'realtime']
+# 与 protocol.h 中的 ControlOpcode 一致
+CONTROL_UP = {0x01: 'listen_start', 0x02: 'listen_stop', 0x03: 'listen_detect', 0x04: 'abort'}
+CONTROL_DOWN = {'tts_start': 0x81, 'tts_stop': 0x82, 'tts_sentence': 0x83, 'stt': 0x84, 'llm_emotion': 0x85}
+
+# UDP 加密音频包: |type 1u|flags 1u|payload_len 2u|ssrc 4u|timestamp 4u|sequence 4u|payload|
+UDP_NONCE = struct.Struct('>BBHIII')
+
+
+def pack_audio(version, payload, timestamp=0, frame_type=TYPE_AUDIO):
+    """按 websocket 协议版本封装一帧 Opus 数据"""
+    if version == 2:
+        return BP2_HEADER.pack(2, frame_type, 0, timestamp & 0xFFFFFFFF, len(payload)) + payload
+    if version == 3:
+        return BP3_HEADER.pack(frame_type, 0, len(payload)) + payload
+    return payload
+
+
+def unpack_binary(version, data):
+    """解析 websocket 二进制帧, 返回 (type, timestamp, payload)"""
+    if version == 2:
+        _, frame_type, _, timestamp, size = BP2_HEADER.unpack_from(data)
+        return frame_type, timestamp, data[BP2_HEADER.size:BP2_HEADER.size + size]
+    if version == 3:
+        frame_type, _, size = BP3_HEADER.unpack_from(data)
+        return frame_type, 0, data[BP3_HEADER.size:BP3_HEADER.size + size]
+    return TYPE_AUDIO, 0, data
+
+
+def unpack_audio(version, data):
+    """解析 websocket 音频帧, 返回 (timestamp, payload)"""
+    _, timestamp, payload = unpack_binary(version, data)
+    return timestamp, payload
+
+
+def pack_control(version, opcode, arg=0, text=''):
+    body = text.encode()
+    return pack_audio(version, CONTROL_HEADER.pack(opcode, arg, len(body)) + body, frame_type=TYPE_CONTROL)
+
+
+def unpack_control(payload):
+    """返回 (opcode, arg, text)"""
+    opcode, arg, size = CONTROL_HEADER.unpack_from(payload)
+    return opcode, arg, payload[CONTROL_HEADER.size:CONTROL_HEADER.size + size].decode()
+
+
+def downlink_control_to_json(opcode, text):
+    """下行控制帧转成等价的 JSON 消息"""
+    if opcode == CONTROL_DOWN['tts_start']:
+        return {'type': 'tts', 'state': 'start'}
+    if opcode == CONTROL_DOWN['tts_stop']:
+        message = {'type': 'tts', 'state': 'stop'}
+        if text.isdigit():
+            message['frames'] = int(text)
+        return message
+    if opcode == CONTROL_DOWN['tts_sentence']:
+        return {'type': 'tts', 'state': 'sentence_start', 'text': text}
+    if opcode == CONTROL_DOWN['stt']:
+        return {'type': 'stt', 'text': text}
+    if opcode == CONTROL_DOWN['llm_emotion']:
+        return {'type': 'llm', 'emotion': text}
+    return None
+
+
+def control_to_json(session_id, opcode, arg, text):
+    """上行控制帧转成等价的 JSON 消息, 便于服务器复用同一套处理逻辑"""
+    name = CONTROL_UP.get(opcode)
+    if name == 'listen_start':
+        mode = LISTEN_MODES[arg] if arg < len(LISTEN_MODES) else 'auto'
+        return {'session_id': session_id, 'type': 'listen', 'state': 'start', 'mode': mode}
+    if name == 'listen_stop':
+        return {'session_id': session_id, 'type': 'listen', 'state': 'stop'}
+    if name == 'listen_detect':
+        return {'session_id': session_id, 'type': 'listen', 'state': 'detect', 'text': text}
+    if name == 'abort':
+        message = {'session_id': session_id, 'type': 'abort'}
+        if arg == 1:
+            message['reason'] = 'wake_word_detected'
+        return message
+    return None
+
+
+def json_to_control(message):
+    """下行热点消息转成 (opcode, text), 其余消息返回 None 继续用 JSON"""
+    msg_type = message.get('type')
+    if msg_type == 'tts':
+        state = message.get('state')
+        if state == 'start':
+            return CONTROL_DOWN['tts_start'], ''
+        if state == 'stop':
+            # frames 为本地服务器的附加字段, 设备端忽略 tts_stop 的文本
+            return CONTROL_DOWN['tts_stop'], str(message.get('frames', ''))
+        if state == 'sentence_start':
+            return CONTROL_DOWN['tts_sentence'], message.get('text', '')
+    elif msg_type == 'stt':
+        return CONTROL_DOWN['stt'], message.get('text', '')
+    elif msg_type == 'llm':
+        return CONTROL_DOWN['llm_emotion'], message.get('emotion', '')
+    return None
+
+
+def aes_ctr(key, nonce, data):
+    """AES-128-CTR, 加解密相同; nonce 即包头的 16 字节"""
+    cipher = Cipher(algorithms.AES(key), modes.CTR(nonce))
+    return cipher.encryptor().update(data)
+
+
+def pack_udp(key, nonce_template, payload, timestamp, sequence):
+    nonce = bytearray(nonce_template)
+    struct.pack_into('>H', nonce, 2, len(payload))
+    struct.pack_into('>I', nonce, 8, timestamp & 0xFFFFFFFF)
+    struct.pack_into('>I', nonce, 12, sequence & 0xFFFFFFFF)
+    nonce = bytes(nonce)
+    return nonce + aes_ctr(key, nonce, payload)
+
+
+def unpack_udp(key, data):
+    """返回 (timestamp, sequence, payload), 包类型不对时返回 None"""
+    if len(data) < UDP_NONCE.size or data[0] != 0x01:
+        return None
+    _, _, _, _, timestamp, sequence = UDP_NONCE.unpack_from(data)
+    nonce = data[:UDP_NONCE.size]
+    return timestamp, sequence, aes_ctr(key, nonce, data[UDP_NONCE.size:])
+
+
+def read_p3(path):
+    """读取 p3 文件 (4字节header + Opus数据包), 返回 Opus 包列表"""
+    packets = []
+    with open(path, 'rb') as f:
+        while True:
+            header = f.read(4)
+            if len(header) < 4:
+                break
+            _, _, size = struct.unpack('>BBH', header)
+            payload = f.read(size)
+            if len(payload) < size:
+                break
+            packets.append(payload)
+    return packets
+
+
+def dummy_opus_frames(count, size=120):
+    """没有 p3 文件时用固定长度的伪造帧, 只用于测吞吐, 设备端无法解码"""
+    return [bytes([0xF8]) + random.randbytes(size - 1) for _ in range(count)]
+
+
+class LinkImpairment:
+    """在发送路径上注入时延抖动与丢包"""
+
+    def __init__(self, jitter_ms=0, loss_percent=0.0, seed=None):
+        self.jitter_ms = jitter_ms
+        self.loss_percent = loss_percent
+        self.random = random.Random(seed)
+        self.dropped = 0
+
+    def should_drop(self):
+        if self.loss_percent > 0 and self.random.random() * 100 < self.loss_percent:
+            self.dropped += 1
+            return True
+        return False
+
+    async def delay(self):
+        if self.jitter_ms > 0:
+            await asyncio.sleep(self.random.uniform(0, self.jitter_ms) / 1000)